@@ -14,6 +14,8 @@
 #include <argos3/plugins/simulator/physics_engines/dynamics2d/dynamics2d_engine.h>
 #include <argos3/plugins/simulator/physics_engines/dynamics2d/chipmunk-physics/include/chipmunk.h>
 #include <argos3/plugins/simulator/physics_engines/dynamics2d/dynamics2d_multi_body_object_model.h>
+#include <argos3/plugins/robots/e-puck2/simulator/dynamics2d_epuck2_model.h>
+#include <argos3/plugins/robots/e-puck2/simulator/dynamics2d_epuck2_wind.h>
 
 #include <algorithm>
 #include <cmath>
@@ -41,8 +43,12 @@ void CAirResistance::Init(TConfigurationNode& t_node)
    /* devices */
    m_pcWheels = GetActuator<CCI_DifferentialSteeringActuator>("differential_steering");
    m_pcPos    = GetSensor  <CCI_PositioningSensor>           ("positioning");
-   m_pcRABSens= GetSensor  <CCI_RangeAndBearingSensor>       ("range_and_bearing");
-   m_pcRABAct = GetActuator<CCI_RangeAndBearingActuator>     ("range_and_bearing");
+
+   /* RAB is optional: without it there is no shielding (or a derived class provides it) */
+   if(HasSensor("range_and_bearing"))
+      m_pcRABSens = GetSensor  <CCI_RangeAndBearingSensor>  ("range_and_bearing");
+   if(HasActuator("range_and_bearing"))
+      m_pcRABAct  = GetActuator<CCI_RangeAndBearingActuator>("range_and_bearing");
 
    GetNodeAttributeOrDefault(t_node, "velocity", m_fBaseCms, m_fBaseCms);
 
@@ -54,6 +60,7 @@ void CAirResistance::Init(TConfigurationNode& t_node)
    Real deg = 0.0, mag = 0.0;
    GetNodeAttribute(tAir, "angle_deg", deg);
    GetNodeAttribute(tAir, "magnitude", mag);
+   GetNodeAttributeOrDefault(tAir, "native", m_bNativeWind, m_bNativeWind);
 
    const Real rad = deg * ARGOS_PI / 180.0;
    m_cWindCms.Set(mag * std::cos(rad), mag * std::sin(rad));
@@ -62,12 +69,22 @@ void CAirResistance::Init(TConfigurationNode& t_node)
 /* --------------------------------------------------------------- */
 void CAirResistance::EnsurePhysicsHandle()
 {
-   if(m_bBodyReady) return;
+   /* The body is looked up every step: with several dyn2d engines, the model
+      changes when the robot crosses into another engine */
+   if(m_pcEmbodied) {
+      ResolveBody();
+      return;
+   }
 
    /* Fetch this controller's entity and its dyn2d physics model */
    CEntity& cEntity = CSimulator::GetInstance().GetSpace().GetEntity(GetId());
    auto& cComposable = dynamic_cast<CComposableEntity&>(cEntity);
    auto& cEmbodied   = cComposable.GetComponent<CEmbodiedEntity>("body");
+   m_pcEmbodied = &cEmbodied;
+
+   /* native wind only exists in the e-puck2 dyn2d model; other robots keep the impulse */
+   if(m_bNativeWind && cEntity.GetTypeDescription() != "e-puck2")
+      m_bNativeWind = false;
 
    /* --- NEW: derive self radius from AABB (meters) --- */
    {
@@ -84,16 +101,33 @@ void CAirResistance::EnsurePhysicsHandle()
       /* else keep the existing m_fSelfRadiusM (default 0.04f) */
    }
 
-   /* Get the generic physics model and then downcast */
-   CPhysicsModel& cPhys = cEmbodied.GetPhysicsModel("dyn2d");
+   ResolveBody();
+}
+
+/* --------------------------------------------------------------- */
+void CAirResistance::ResolveBody()
+{
+   /* A robot lives in one engine at a time: take its only physics model and downcast */
+   if(m_pcEmbodied->GetPhysicsModelsNum() == 0) {
+      THROW_ARGOSEXCEPTION("No physics model for " << GetId());
+   }
+   CPhysicsModel& cPhys = m_pcEmbodied->GetPhysicsModel(0);
+   m_pcNativeModel = nullptr;
 
    /* --- Single-body (e-puck2 style) --- */
    if(auto* pcSingle = dynamic_cast<CDynamics2DSingleBodyObjectModel*>(&cPhys)) {
       m_ptBody     = pcSingle->GetBody();
+      m_pcEngine   = &pcSingle->GetDynamics2DEngine();
       m_bBodyReady = (m_ptBody != nullptr);
       if(!m_bBodyReady) {
          THROW_ARGOSEXCEPTION("dyn2d single-body model returned null Chipmunk body for " << GetId());
       }
+      /* native wind: the drive is applied with the wind of the engine */
+      if(m_bNativeWind) {
+         auto* pcEPuck2 = dynamic_cast<CDynamics2DEPuck2Model*>(pcSingle);
+         if(pcEPuck2 && pcEPuck2->GetWind() && pcEPuck2->GetWind()->IsNative())
+            m_pcNativeModel = pcEPuck2;
+      }
       return;
    }
 
@@ -105,6 +139,7 @@ void CAirResistance::EnsurePhysicsHandle()
          THROW_ARGOSEXCEPTION("dyn2d multi-body model body[0] is null for " << GetId());
       }
       m_ptBody     = pMain;
+      m_pcEngine   = &pcMulti->GetDynamics2DEngine();
       m_bBodyReady = true;
       return;
    }
@@ -275,6 +310,9 @@ CVector2 CAirResistance::ComputeEffectiveWind() const
 /* Adds wind impulse to the per-tick accumulator */
 void CAirResistance::ApplyWindImpulse()
 {
+   /* the physics engine already pushes this robot */
+   if(m_bNativeWind) return;
+
    const CVector2 eff = ComputeEffectiveWind();
    if(eff.Length() < 1e-9) return;
 
@@ -328,9 +366,17 @@ void CAirResistance::HandleAerodynamicsPreStep()
 /* POST: schedule one post-step to apply the summed impulse */
 void CAirResistance::HandleAerodynamicsPostStep()
 {
-   auto& dyn2d = dynamic_cast<CDynamics2DEngine&>(
-      CSimulator::GetInstance().GetPhysicsEngine("dyn2d"));
-   cpSpace* space = dyn2d.GetPhysicsSpace();
+   /* nothing to apply */
+   if(m_cAccumImpulse.SquareLength() < 1e-18) return;
+
+   /* native wind: join the single post-step of the engine, no allocation */
+   if(m_pcNativeModel) {
+      m_pcNativeModel->GetWind()->AddImpulse(m_pcNativeModel->GetWindIndex(), m_cAccumImpulse);
+      return;
+   }
+
+   /* the engine of the robot, which need not be called "dyn2d" */
+   cpSpace* space = m_pcEngine->GetPhysicsSpace();
 
    auto* payload = new SWindPostData{
       m_ptBody,
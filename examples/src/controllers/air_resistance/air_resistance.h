@@ -13,6 +13,10 @@ struct cpBody;
 
 namespace argos {
 
+   class CDynamics2DEngine;
+   class CEmbodiedEntity;
+   class CDynamics2DEPuck2Model;
+
    class CAirResistance : public CCI_Controller { /* removed 'final' to allow subclassing */
 
    public:
@@ -30,6 +34,7 @@ namespace argos {
       /* These helpers are virtual to allow alternative pipelines in derived classes.
          Derived classes can call the base implementations or replace them entirely. */
       virtual void EnsurePhysicsHandle();              /* obtains dyn2d handle */
+      virtual void ResolveBody();                      /* body + engine of this step */
       virtual void ApplyWindImpulse();                 /* adds to accumulator */
       virtual void DriveImpulse(Real velocity_cm_s);   /* adds to accumulator */
       virtual void HandleAerodynamicsPreStep();        /* reset + wind + broadcast */
@@ -50,13 +55,21 @@ namespace argos {
       Real     m_fBaseCms = 5.0f;  /* desired forward speed, cm/s */
       CVector2 m_cWindCms;         /* global wind vector, cm/s */
 
+      /* <air_resistance native="true">: the dyn2d e-puck2 model applies the wind itself */
+      bool     m_bNativeWind = false;
+
       /* simple fallback radius broadcast (meters) */
       Real m_fSelfRadiusM = 0.04f;
 
-      /* cached physics */
+      /* cached physics (body and engine are refreshed every step) */
+      CEmbodiedEntity*   m_pcEmbodied = nullptr;
+      CDynamics2DEngine* m_pcEngine   = nullptr;
       bool     m_bBodyReady = false;
       cpBody*  m_ptBody     = nullptr;
 
+      /* e-puck2 model whose native wind applies the impulse, or nullptr */
+      CDynamics2DEPuck2Model* m_pcNativeModel = nullptr;
+
       /* per-tick accumulated impulse (world frame) */
       CVector2 m_cAccumImpulse;    // J = (cm/s)/100 * mass * WIND_IMPULSE_SCALE
    };
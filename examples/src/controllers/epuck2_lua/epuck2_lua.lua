@@ -38,9 +38,7 @@ function step()
             robot.proximity[7].value, robot.proximity[8].value) )
 
   log( string.format("Light: %4d %4d %4d %4d %4d %4d %4d %4d",
-            robot.light[1].value, robot.light[2].value, robot.light[3].value,
-            robot.light[4].value, robot.light[5].value, robot.light[6].value,
-            robot.light[7].value, robot.light[8].value) )
+            table.unpack(robot.light.values())) )
 
   log( string.format("ToF: %4d", robot.tof) )
 
@@ -62,16 +60,13 @@ function step()
   end
 
   if counter % 10 == 0 then
-    robot.leds.set_single_rgb_color(2, robot.random.uniform(255), robot.random.uniform(255), robot.random.uniform(255))
-    robot.leds.set_single_rgb_color(4, robot.random.uniform(255), robot.random.uniform(255), robot.random.uniform(255))
-    robot.leds.set_single_rgb_color(6, robot.random.uniform(255), robot.random.uniform(255), robot.random.uniform(255))
-    robot.leds.set_single_rgb_color(8, robot.random.uniform(255), robot.random.uniform(255), robot.random.uniform(255))
-    robot.leds.set_single_red(1, robot.random.uniform(1) < 0.5)
-    robot.leds.set_single_red(3, robot.random.uniform(1) < 0.5)
-    robot.leds.set_single_red(5, robot.random.uniform(1) < 0.5)
-    robot.leds.set_single_red(7, robot.random.uniform(1) < 0.5)
-    robot.leds.set_front(robot.random.uniform(1) < 0.3333)
-    robot.leds.set_body(robot.random.uniform(1) < 0.3333)
+    -- All the LEDs in one call: LEDs 1 to 8, the front LED, then the body LEDs
+    local function red() return robot.random.uniform(1) < 0.5 end
+    local function rgb() return math.floor(robot.random.uniform(0x1000000)) end
+    local body = robot.random.uniform(1) < 0.3333
+    robot.leds.set_pattern{ red(), rgb(), red(), rgb(), red(), rgb(), red(), rgb(),
+                            robot.random.uniform(1) < 0.3333,
+                            body, body, body, body, body, body, body, body }
   end
   counter = counter + 1
 
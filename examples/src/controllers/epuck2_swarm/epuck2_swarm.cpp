@@ -12,6 +12,7 @@
 #include <argos3/core/simulator/space/space.h>
 #include <argos3/core/simulator/simulator.h>
 #include <argos3/plugins/robots/e-puck2/simulator/epuck2_entity.h>
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_log.h>
 #include "math.h"
 
 /****************************************/
@@ -69,7 +70,7 @@ void CEPuck2Swarm::ControlStep() {
                 Real range = tMsgs[i].Range;
                 CRadians bearing = tMsgs[i].HorizontalBearing;
                 if (m_iDebug >= 3) {
-                    LOG << sId << "> Rx: " << range << " " << ToDegrees(bearing).GetValue() << ": " << cRxData;
+                    EPUCK2_LOG_INFO("epuck2_swarm", sId << "> Rx: " << range << " " << ToDegrees(bearing).GetValue() << ": " << cRxData);
                 }
 
                 if (range < m_rDistance) {
@@ -83,7 +84,7 @@ void CEPuck2Swarm::ControlStep() {
             if (x != 0.0 || y != 0.0) {
                 angle = atan2(x, y) * 180 / CRadians::PI.GetValue();
                 if (m_iDebug >= 2) {
-                    LOG << sId << "> x,y: " << x << "," << y << " angle: " << angle << std::endl;
+                    EPUCK2_LOG_INFO("epuck2_swarm", sId << "> x,y: " << x << "," << y << " angle: " << angle);
                 }
             }
         }
@@ -91,11 +92,13 @@ void CEPuck2Swarm::ControlStep() {
         /* Get readings from proximity sensor */
         if (m_iDebug >= 4) {
             const CCI_EPuck2ProximitySensor::TReadings &tProxReads = m_pcProximity->GetReadings();
-            LOG << sId << "> Proximity: " << std::fixed << std::setprecision(3);
+            std::ostringstream cProx;
+            cProx << std::fixed << std::setprecision(3);
             for (size_t i = 0; i < tProxReads.size()-1; ++i) {
-                LOG << ToDegrees(tProxReads[i].Angle).GetValue() << ": " << tProxReads[i].Value << " # ";
+                cProx << ToDegrees(tProxReads[i].Angle).GetValue() << ": " << tProxReads[i].Value << " # ";
             }
-            LOG << ToDegrees(tProxReads[tProxReads.size()-1].Angle).GetValue() << ": " << tProxReads[tProxReads.size()-1].Value << std::endl;
+            cProx << ToDegrees(tProxReads[tProxReads.size()-1].Angle).GetValue() << ": " << tProxReads[tProxReads.size()-1].Value;
+            EPUCK2_LOG_INFO("epuck2_swarm", sId << "> Proximity: " << cProx.str());
         }
 
         switch (m_cState) {
@@ -106,7 +109,7 @@ void CEPuck2Swarm::ControlStep() {
                     float collision = Collision(COLLISION_DISTANCE);
                     if (collision != 0.0) {
                         if (m_iDebug >= 2) {
-                            LOG << sId << "> Collision: " << collision << std::endl;
+                            EPUCK2_LOG_INFO("epuck2_swarm", sId << "> Collision: " << collision);
                         }
                         m_rRotationTime = uTick + Rotation_Time(ROTATION_SPEED, collision);
                         m_cState = ROTATING;
@@ -119,18 +122,18 @@ void CEPuck2Swarm::ControlStep() {
                     } else {
                         Real target =  (cAngle + CDegrees(angle)).GetValue();
                         if (m_iDebug >= 2) {
-                            LOG << sId << "> Angle: " << angle << " Current: " << cAngle.GetValue() << " Target: " << target << std::endl;
+                            EPUCK2_LOG_INFO("epuck2_swarm", sId << "> Angle: " << angle << " Current: " << cAngle.GetValue() << " Target: " << target);
                         }
                         Real error = target - cAngle.GetValue();
                         if (std::abs(error) < 15.0) {
                             float offset = sin(CRadians(error * 180.0 / 15.0).GetValue()) / 5.0;
                             if (m_iDebug >= 2) {
-                                LOG << sId << "> Error: " << error << " Offset: " << offset << ": " << SPEED * (1.0 + offset) << "," << SPEED * (1.0 - offset) << std::endl;
+                                EPUCK2_LOG_INFO("epuck2_swarm", sId << "> Error: " << error << " Offset: " << offset << ": " << SPEED * (1.0 + offset) << "," << SPEED * (1.0 - offset));
                             }
                             m_pcWheels->SetLinearVelocity(SPEED * (1.0 - offset), SPEED * (1.0 + offset));
                         } else {
                             if (m_iDebug >= 2) {
-                                LOG << sId << "> Will Rotate: " << angle << std::endl;
+                                EPUCK2_LOG_INFO("epuck2_swarm", sId << "> Will Rotate: " << angle);
                             }
                             m_rRotationTime = uTick + Rotation_Time(ROTATION_SPEED, angle);
                             m_cState = ROTATING;
@@ -150,7 +153,7 @@ void CEPuck2Swarm::ControlStep() {
                     m_cState = m_cNext;
                     m_uEnd_Rotation = uTick;
                     if (m_iDebug >= 2) {
-                        LOG << sId << "> End Rotation: " << cAngle.GetValue() << std::endl;
+                        EPUCK2_LOG_INFO("epuck2_swarm", sId << "> End Rotation: " << cAngle.GetValue());
                     }
                 }
                 m_pcLedAct->SetBodyLed(true);
@@ -160,14 +163,14 @@ void CEPuck2Swarm::ControlStep() {
                 LOGERR << sId << "> " << "ERROR" << std::endl;
         }
         if (m_iDebug >= 1) {
-            LOG << sId << "> " << State(m_cState) << " -> " << State(m_cNext) << std::endl;
+            EPUCK2_LOG_INFO("epuck2_swarm", sId << "> " << State(m_cState) << " -> " << State(m_cNext));
         }
     }
     cTxData[1] = (UInt8) 0;
     cTxData[2] = (UInt8) '-';
     m_pcRABAct->SetData(cTxData);
     if (m_iDebug >= 3) {
-       LOG << sId << "> Tx:" << cTxData;
+       EPUCK2_LOG_INFO("epuck2_swarm", sId << "> Tx:" << cTxData);
     }
     m_pcRABAct->SetData(cTxData);
 
@@ -1,5 +1,6 @@
 #include "air_resistance.h"
 #include <argos3/core/utility/math/angles.h>   // for CRadians
+#include <argos3/plugins/robots/e-puck2/control_interface/ci_epuck2_anemometer_sensor.h>
 #include <cmath>
 
 using namespace argos;
@@ -10,15 +11,33 @@ using namespace argos;
  * desired ground track is straight WEST (−X) in world coordinates.
  *
  * Translation still uses the base impulse pipeline (HandleAerodynamics* + DriveImpulse).
+ *
+ * With an <epuck2_anemometer> sensor, the effective wind comes from the
+ * swarm-level wind computation and the range-and-bearing devices are not needed.
+ * Without it, the base RAB shielding is used.
  */
 class CWindAwareAirResistance : public CAirResistance {
 public:
    virtual ~CWindAwareAirResistance() = default;
 
+   void Init(TConfigurationNode& t_node) override {
+      CAirResistance::Init(t_node);
+      if(HasSensor("epuck2_anemometer"))
+         m_pcAnemometer = GetSensor<CCI_EPuck2AnemometerSensor>("epuck2_anemometer");
+   }
+
+   /* Anemometer reading (robot frame) -> world frame; RAB fallback otherwise */
+   CVector2 ComputeEffectiveWind() const override {
+      if(!m_pcAnemometer) return CAirResistance::ComputeEffectiveWind();
+      CVector2 wind = m_pcAnemometer->GetReading().Wind;
+      wind.Rotate(CRadians(GetYawRadians()));
+      return wind;
+   }
+
    /* Override just ControlStep; everything else comes from CAirResistance */
    void ControlStep() override {
       /* 1) run the usual pre-step: ensures physics handle, resets accumulator,
-            applies wind impulse, and broadcasts RAB byte */
+            applies wind impulse, and broadcasts RAB byte (if any) */
       HandleAerodynamicsPreStep();
 
       /* 2) Compute a crab heading so that:  fwd * Vd + wind_eff  ∥  track_dir
@@ -65,6 +84,9 @@ public:
       /* 5) Schedule post-step to apply (wind + drive) once collisions are resolved */
       HandleAerodynamicsPostStep();
    }
+
+private:
+   CCI_EPuck2AnemometerSensor* m_pcAnemometer = nullptr;
 };
 
 /* Register as a separate controller name so it can be used alongside the base one */
@@ -0,0 +1,123 @@
+/**
+ * @file <placement_loop_functions.cpp>
+ *
+ * @author Daniel H. Stolfi
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#include "placement_loop_functions.h"
+
+#include <argos3/core/simulator/loop_functions.h>
+#include <argos3/plugins/robots/e-puck2/simulator/epuck2_entity.h>
+#include <argos3/plugins/robots/e-puck2/simulator/epuck2_placement.h>
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_layout.h>
+#include <argos3/core/simulator/entity/embodied_entity.h>
+#include <argos3/plugins/simulator/entities/box_entity.h>
+#include <argos3/plugins/simulator/entities/cylinder_entity.h>
+#include <chrono>
+
+CPlacementLoopFunctions::CPlacementLoopFunctions() :
+   m_bPartition(false) {
+   /* Runs before the physics engines are created, so it can still change them */
+   m_bPartition = m_cPartition.Preprocess();
+}
+
+void CPlacementLoopFunctions::Init(TConfigurationNode& t_tree) {
+    try {
+        CRandom::CRNG* pcRNG = CRandom::CreateRNG("argos");
+        UInt32 unGroup = 0;
+        TConfigurationNodeIterator itPlacement("placement");
+        for(itPlacement = itPlacement.begin(&t_tree);
+            itPlacement != itPlacement.end();
+            ++itPlacement, ++unGroup) {
+            UInt32 unQuantity;
+            GetNodeAttribute(*itPlacement, "quantity", unQuantity);
+            std::string strController;
+            GetNodeAttribute(*itPlacement, "controller", strController);
+            CVector2 cMin, cMax;
+            GetNodeAttribute(*itPlacement, "min", cMin);
+            GetNodeAttribute(*itPlacement, "max", cMax);
+            std::string strMethod = "poisson";
+            GetNodeAttributeOrDefault(*itPlacement, "method", strMethod, strMethod);
+            Real fMinDistance = 2.0f * SEPuck2Layout::BODY_RADIUS + 0.005f;
+            GetNodeAttributeOrDefault(*itPlacement, "min_distance", fMinDistance, fMinDistance);
+            std::ostringstream cDefaultPrefix;
+            cDefaultPrefix << "ep" << unGroup << "_";
+            std::string strPrefix = cDefaultPrefix.str();
+            GetNodeAttributeOrDefault(*itPlacement, "id_prefix", strPrefix, strPrefix);
+
+            std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+            CEPuck2Placement cPlacement(cMin, cMax, fMinDistance, pcRNG);
+            /* Keep away from the robots and obstacles already in the arena */
+            ReserveTaken(cPlacement);
+            std::vector<CVector2> vecPositions;
+            cPlacement.Generate(unQuantity, CEPuck2Placement::ParseMethod(strMethod), vecPositions);
+            std::chrono::steady_clock::time_point tPlaced = std::chrono::steady_clock::now();
+            CEPuck2Placement::CreateEntities(vecPositions, strPrefix, strController, pcRNG);
+            std::chrono::steady_clock::time_point tCreated = std::chrono::steady_clock::now();
+            LOG << "Placed " << unQuantity << " e-puck2s in " <<
+                std::chrono::duration<double>(tPlaced - tStart).count() << "s, created them in " <<
+                std::chrono::duration<double>(tCreated - tPlaced).count() << "s" << std::endl;
+        }
+    } catch(CARGoSException& ex) {
+        THROW_ARGOSEXCEPTION_NESTED("Error initialising the loop functions", ex);
+    }
+}
+
+void CPlacementLoopFunctions::ReserveTaken(CEPuck2Placement& c_placement) {
+    /* A type with no entities has no map: the e-puck2s are often all created here */
+    CSpace::TMapPerTypePerId& tEntities = GetSpace().GetEntityMapPerTypePerId();
+    CSpace::TMapPerTypePerId::iterator itType = tEntities.find("e-puck2");
+    if(itType != tEntities.end()) {
+        for(CSpace::TMapPerType::iterator it = itType->second.begin();
+            it != itType->second.end();
+            ++it) {
+            const CVector3& cPos = any_cast<CEPuck2Entity*>(it->second)->GetEmbodiedEntity().GetOriginAnchor().Position;
+            c_placement.Reserve(CVector2(cPos.GetX(), cPos.GetY()));
+        }
+    }
+    /* Walls and boxes */
+    itType = tEntities.find("box");
+    if(itType != tEntities.end()) {
+        for(CSpace::TMapPerType::iterator it = itType->second.begin();
+            it != itType->second.end();
+            ++it) {
+            CBoxEntity* pcBox = any_cast<CBoxEntity*>(it->second);
+            const SAnchor& sOrigin = pcBox->GetEmbodiedEntity().GetOriginAnchor();
+            CRadians cZ, cY, cX;
+            sOrigin.Orientation.ToEulerAngles(cZ, cY, cX);
+            c_placement.ReserveRectangle(CVector2(sOrigin.Position.GetX(), sOrigin.Position.GetY()),
+                                         CVector2(pcBox->GetSize().GetX(), pcBox->GetSize().GetY()) * 0.5f,
+                                         cZ);
+        }
+    }
+    /* Cylinders */
+    itType = tEntities.find("cylinder");
+    if(itType != tEntities.end()) {
+        for(CSpace::TMapPerType::iterator it = itType->second.begin();
+            it != itType->second.end();
+            ++it) {
+            CCylinderEntity* pcCylinder = any_cast<CCylinderEntity*>(it->second);
+            const CVector3& cPos = pcCylinder->GetEmbodiedEntity().GetOriginAnchor().Position;
+            c_placement.ReserveDisc(CVector2(cPos.GetX(), cPos.GetY()),
+                                    pcCylinder->GetRadius());
+        }
+    }
+}
+
+void CPlacementLoopFunctions::PostStep() {
+    if(m_bPartition) m_cPartition.Sample();
+}
+
+void CPlacementLoopFunctions::PostExperiment() {
+    /* The density of this episode sets the boundaries of the next one */
+    if(m_bPartition) m_cPartition.Save();
+}
+
+void CPlacementLoopFunctions::Destroy() {
+    /* Nothing left to save if PostExperiment() already did */
+    if(m_bPartition) m_cPartition.Save();
+}
+
+REGISTER_LOOP_FUNCTIONS(CPlacementLoopFunctions, "placement_loop_functions")
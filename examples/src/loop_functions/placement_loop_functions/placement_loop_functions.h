@@ -0,0 +1,56 @@
+/**
+ * @file <placement_loop_functions.h>
+ *
+ * @author Daniel H. Stolfi
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#ifndef PLACEMENT_LOOP_FUNCTIONS_H_
+#define PLACEMENT_LOOP_FUNCTIONS_H_
+
+#include <argos3/core/simulator/loop_functions.h>
+#include <argos3/plugins/robots/e-puck2/simulator/epuck2_partition.h>
+#include <argos3/plugins/robots/e-puck2/simulator/epuck2_placement.h>
+
+using namespace argos;
+
+/*
+ * Scatters e-puck2s in the arena without overlaps.
+ *
+ * <loop_functions library="..." label="placement_loop_functions">
+ *   <placement quantity="10000" method="poisson" controller="fdc"
+ *              min="-9,-9" max="9,9" min_distance="0.075" id_prefix="ep" />
+ * </loop_functions>
+ *
+ * 'method' is either "poisson" or "grid_jitter". 'min_distance' defaults to
+ * twice the e-puck2 radius plus 5 mm. Several <placement> nodes can be given.
+ * The robots are kept clear of the e-puck2s, boxes and cylinders already in
+ * the arena, including the walls.
+ *
+ * An optional <partition> node splits the arena among several dynamics2d
+ * engines with the same number of robots each, see epuck2_partition.h:
+ *
+ *   <partition engines="4" density_file="density.txt" />
+ */
+class CPlacementLoopFunctions : public CLoopFunctions {
+
+public:
+
+   CPlacementLoopFunctions();
+   virtual ~CPlacementLoopFunctions() {}
+   virtual void Init(TConfigurationNode& t_tree);
+   virtual void PostStep();
+   virtual void PostExperiment();
+   virtual void Destroy();
+
+private:
+   /* Reserves the e-puck2s, boxes and cylinders already in the arena */
+   void ReserveTaken(CEPuck2Placement& c_placement);
+
+   CEPuck2Partition m_cPartition;
+   bool m_bPartition;
+};
+
+
+#endif /* PLACEMENT_LOOP_FUNCTIONS_H_ */
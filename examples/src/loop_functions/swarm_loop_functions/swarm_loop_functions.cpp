@@ -10,6 +10,7 @@
 
 #include <argos3/core/simulator/loop_functions.h>
 #include <argos3/plugins/robots/e-puck2/simulator/epuck2_entity.h>
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_log.h>
 
 CSwarmLoopFunctions::CSwarmLoopFunctions() {
 }
@@ -47,6 +48,8 @@ void CSwarmLoopFunctions::PostStep() {
         }
     }
     d /= (m_v.size() * (m_v.size()-1));
+    /* Write the output of the controllers of this step first */
+    CEPuck2Log::GetInstance().Flush();
     LOG << "Avg. Distance: " << d << std::endl;
 }
 
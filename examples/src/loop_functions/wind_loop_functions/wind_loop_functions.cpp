@@ -1,6 +1,8 @@
 #include "wind_loop_functions.h"
 
 #include <argos3/core/simulator/simulator.h>
+#include <argos3/core/simulator/space/space.h>
+#include <argos3/core/simulator/physics_engine/physics_engine.h>
 #include <argos3/core/utility/configuration/argos_configuration.h>
 #include <argos3/core/utility/math/angles.h>
 
@@ -20,6 +22,21 @@ void CWindLoopFunctions::Init(TConfigurationNode&) {
    const Real rad = deg * ARGOS_PI / 180.0;
    m_cWindCms.Set(mag * std::cos(rad),
                   mag * std::sin(rad));
+
+   /* optional <wind_field> child: gusts, corridors, lees */
+   m_cField.Init(tAir, m_cWindCms);
+}
+
+/* ---------- back to the first keyframe ------------------------- */
+void CWindLoopFunctions::Reset() {
+   m_cField.SetTime(0.0);
+}
+
+/* ---------- follow the simulated time --------------------------- */
+void CWindLoopFunctions::PreStep() {
+   if(m_cField.IsUniform()) return;
+   m_cField.SetTime(GetSpace().GetSimulationClock() *
+                    CPhysicsEngine::GetSimulationClockTick());
 }
 
 /* ---------- register with ARGoS -------------------------------- */
@@ -3,18 +3,25 @@
 
 #include <argos3/core/simulator/loop_functions.h>
 #include <argos3/core/utility/math/vector2.h>
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_wind_field.h>
 
 /* Logic-only loop-functions (no drawing) */
 class CWindLoopFunctions final : public argos::CLoopFunctions {
 
 public:
    void Init(argos::TConfigurationNode& t_node) override;
+   void Reset() override;
+   void PreStep() override;
 
-   /* Accessor for the wind vector (used by Qt user functions) */
-   const argos::CVector2& GetWind() const { return m_cWindCms; }
+   /* Accessor for the mean wind vector (used by Qt user functions) */
+   const argos::CVector2& GetWind() const { return m_cField.GetMean(); }
+
+   /* Accessor for the whole wind field (used by Qt user functions) */
+   const argos::CEPuck2WindField& GetField() const { return m_cField; }
 
 private:
-   argos::CVector2 m_cWindCms;   /* wind in cm s⁻¹ */
+   argos::CVector2 m_cWindCms;        /* uniform wind in cm s⁻¹ */
+   argos::CEPuck2WindField m_cField;  /* wind over the arena    */
 };
 
 #endif /* WIND_LOOP_FUNCTIONS_H */
@@ -5,6 +5,7 @@
 #include <argos3/core/utility/math/vector3.h>
 #include <argos3/core/utility/math/angles.h>
 
+#include <algorithm> /* for std::min / std::max */
 #include <cmath>   /* for std::sin / std::cos */
 
 using namespace argos;
@@ -18,31 +19,31 @@ void CWindQTUserFunctions::Init(TConfigurationNode&) {
 }
 
 /* ------------------------------------------------------------------ */
-/*  draw wind vector every frame (shaft + arrow-head)                 */
+/*  draw one arrow (shaft + arrow-head)                               */
 /* ------------------------------------------------------------------ */
-void CWindQTUserFunctions::DrawInWorld() {
-   const CVector2& cWind = m_pcLoop->GetWind();
-   if(cWind.Length() < 0.01) return;
+void CWindQTUserFunctions::DrawArrow(const CVector2& c_from,
+                                     const CVector2& c_wind,
+                                     Real f_scale,
+                                     Real f_width) {
+   if(c_wind.Length() < 0.01) return;
 
    /* === tweakable parameters ====================================== */
-   constexpr Real SCALE        = 0.03;                 /* length factor   */
    constexpr Real HEAD_FRAC    = 0.25;                 /* head/shaft      */
    constexpr Real HEAD_RAD     = ARGOS_PI * 25.0 / 180.0; /* 25° in rad   */
-   constexpr Real  RAY_WIDTH   = 5.0;                  /* pixels          */
    /* =============================================================== */
 
    /* shaft endpoints in 3-D space (arena z ≈ 0) */
-   CVector3 from(0, 0, 0.002);
-   CVector3 to  (cWind.GetX() * SCALE,
-                 cWind.GetY() * SCALE,
+   CVector3 from(c_from.GetX(), c_from.GetY(), 0.002);
+   CVector3 to  (c_from.GetX() + c_wind.GetX() * f_scale,
+                 c_from.GetY() + c_wind.GetY() * f_scale,
                  0.002);
 
    /* normalized 2-D direction of the wind */
-   CVector2 dir = cWind;
+   CVector2 dir = c_wind;
    dir.Normalize();
 
    /* length of head rays */
-   Real head_len = cWind.Length() * SCALE * HEAD_FRAC;
+   Real head_len = c_wind.Length() * f_scale * HEAD_FRAC;
 
    /* rotate ‘dir’ by ±HEAD_RAD to get head directions */
    auto rotate = [](const CVector2& v, Real ang) {
@@ -62,11 +63,50 @@ void CWindQTUserFunctions::DrawInWorld() {
                         0.002 );
 
    /* --- draw shaft --- */
-   DrawRay(CRay3(from, to), CColor::RED, RAY_WIDTH);
+   DrawRay(CRay3(from, to), CColor::RED, f_width);
 
    /* --- draw arrow-head (two short rays) --- */
-   DrawRay(CRay3(to, head_left ), CColor::RED, RAY_WIDTH);
-   DrawRay(CRay3(to, head_right), CColor::RED, RAY_WIDTH);
+   DrawRay(CRay3(to, head_left ), CColor::RED, f_width);
+   DrawRay(CRay3(to, head_right), CColor::RED, f_width);
+}
+
+/* ------------------------------------------------------------------ */
+/*  draw wind every frame: one arrow, or a grid of arrows             */
+/* ------------------------------------------------------------------ */
+void CWindQTUserFunctions::DrawInWorld() {
+   const CEPuck2WindField& cField = m_pcLoop->GetField();
+
+   /* === tweakable parameters ====================================== */
+   constexpr Real   SCALE       = 0.03;                /* length factor   */
+   constexpr Real   RAY_WIDTH   = 5.0;                 /* pixels          */
+   constexpr Real   FIELD_WIDTH = 2.0;                 /* pixels          */
+   constexpr UInt32 MAX_ARROWS  = 40;                  /* per axis        */
+   /* =============================================================== */
+
+   /* uniform wind: a single arrow at the origin */
+   if(cField.IsUniform()) {
+      DrawArrow(CVector2(), cField.GetMean(), SCALE, RAY_WIDTH);
+      return;
+   }
+
+   /* varying wind: one arrow every few nodes, shorter than the gap */
+   UInt32 step_x = (cField.GetSizeX() + MAX_ARROWS - 1) / MAX_ARROWS;
+   UInt32 step_y = (cField.GetSizeY() + MAX_ARROWS - 1) / MAX_ARROWS;
+   Real gap = cField.GetResolution() * std::min(step_x, step_y);
+   Real max_wind = 0.0;
+   for(UInt32 y = 0; y < cField.GetSizeY(); y += step_y)
+      for(UInt32 x = 0; x < cField.GetSizeX(); x += step_x)
+         max_wind = std::max(max_wind, cField.GetNodeWind(x, y).Length());
+   if(max_wind < 0.01) return;
+   Real scale = std::min(SCALE, 0.9 * gap / max_wind);
+
+   for(UInt32 y = 0; y < cField.GetSizeY(); y += step_y) {
+      for(UInt32 x = 0; x < cField.GetSizeX(); x += step_x) {
+         CVector2 node(cField.GetOrigin().GetX() + x * cField.GetResolution(),
+                       cField.GetOrigin().GetY() + y * cField.GetResolution());
+         DrawArrow(node, cField.GetNodeWind(x, y), scale, FIELD_WIDTH);
+      }
+   }
 }
 
 /* ------------------------------------------------------------------ */
@@ -11,6 +11,13 @@ public:
     void Init(argos::TConfigurationNode& t_node) override;
     void DrawInWorld() override;
 
+private:
+    /* one arrow from a point, scaled by the wind (cm s⁻¹) */
+    void DrawArrow(const argos::CVector2& c_from,
+                   const argos::CVector2& c_wind,
+                   argos::Real f_scale,
+                   argos::Real f_width);
+
 private:
     const CWindLoopFunctions* m_pcLoop = nullptr;   /* pointer to logic class */
 };
@@ -0,0 +1,56 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/control_interface/ci_epuck2_anemometer_sensor.cpp>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#include "ci_epuck2_anemometer_sensor.h"
+
+#ifdef ARGOS_WITH_LUA
+#include <argos3/core/wrappers/lua/lua_utility.h>
+#endif
+
+namespace argos {
+
+/****************************************/
+/****************************************/
+
+#ifdef ARGOS_WITH_LUA
+   void CCI_EPuck2AnemometerSensor::CreateLuaState(lua_State* pt_lua_state) {
+      CLuaUtility::OpenRobotStateTable(pt_lua_state, "anemometer");
+      CLuaUtility::AddToTable(pt_lua_state, "wind",      m_sReading.Wind     );
+      CLuaUtility::AddToTable(pt_lua_state, "shielding", m_sReading.Shielding);
+      /* Keep the table and the wind, so that ReadingsToLuaState() does not look them up */
+      lua_pushvalue(pt_lua_state, -1);
+      m_nLuaReading = luaL_ref(pt_lua_state, LUA_REGISTRYINDEX);
+      lua_getfield(pt_lua_state, -1, "wind");
+      m_nLuaWind = luaL_ref(pt_lua_state, LUA_REGISTRYINDEX);
+      CLuaUtility::CloseRobotStateTable(pt_lua_state);
+   }
+#endif
+
+/****************************************/
+/****************************************/
+
+#ifdef ARGOS_WITH_LUA
+   void CCI_EPuck2AnemometerSensor::ReadingsToLuaState(lua_State* pt_lua_state) {
+      /* The wind may be a vector with metamethods, so it is set normally */
+      lua_rawgeti(pt_lua_state, LUA_REGISTRYINDEX, m_nLuaWind);
+      lua_pushnumber(pt_lua_state, m_sReading.Wind.GetX());
+      lua_setfield  (pt_lua_state, -2, "x"                 );
+      lua_pushnumber(pt_lua_state, m_sReading.Wind.GetY());
+      lua_setfield  (pt_lua_state, -2, "y"                 );
+      lua_pop(pt_lua_state, 1);
+      lua_rawgeti(pt_lua_state, LUA_REGISTRYINDEX, m_nLuaReading);
+      lua_pushnumber(pt_lua_state, m_sReading.Shielding);
+      lua_setfield  (pt_lua_state, -2, "shielding"       );
+      lua_pop(pt_lua_state, 1);
+   }
+#endif
+
+/****************************************/
+/****************************************/
+
+}
@@ -0,0 +1,74 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/control_interface/ci_epuck2_anemometer_sensor.h>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#ifndef CCI_EPUCK2_ANEMOMETER_SENSOR_H
+#define CCI_EPUCK2_ANEMOMETER_SENSOR_H
+
+namespace argos {
+   class CCI_EPuck2AnemometerSensor;
+}
+
+#include <argos3/core/control_interface/ci_sensor.h>
+#include <argos3/core/utility/math/vector2.h>
+
+namespace argos {
+
+   /**
+    * The wind felt by the robot.
+    * <p>
+    * The wind is the local wind minus the shielding of the robots upwind,
+    * expressed in the frame of the robot (X forward, Y to the left), in cm/s.
+    * </p>
+    */
+   class CCI_EPuck2AnemometerSensor : public CCI_Sensor {
+
+   public:
+
+      virtual ~CCI_EPuck2AnemometerSensor() {}
+
+      struct SReading
+      {
+         /** Effective wind in the robot frame, in cm/s */
+         CVector2 Wind;
+         /** How much the robot is shielded, in [0,1] */
+         Real Shielding;
+
+         SReading() :
+            Shielding(0.0) {}
+
+         SReading(const CVector2& c_wind,
+                  Real f_shielding) :
+            Wind(c_wind),
+            Shielding(f_shielding) {}
+      };
+
+      inline const SReading& GetReading() const {
+         return m_sReading;
+      }
+
+#ifdef ARGOS_WITH_LUA
+      virtual void CreateLuaState(lua_State* pt_lua_state);
+
+      virtual void ReadingsToLuaState(lua_State* pt_lua_state);
+#endif
+
+   protected:
+
+      SReading m_sReading;
+
+#ifdef ARGOS_WITH_LUA
+      /** Registry references to the reading table and its wind, made by CreateLuaState() */
+      int m_nLuaReading;
+      int m_nLuaWind;
+#endif
+
+   };
+
+}
+
+#endif
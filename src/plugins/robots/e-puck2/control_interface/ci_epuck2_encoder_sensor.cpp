@@ -9,11 +9,18 @@
 #include "ci_epuck2_encoder_sensor.h"
 
 #ifdef ARGOS_WITH_LUA
+#include <argos3/plugins/robots/e-puck2/control_interface/ci_epuck2_ffi.h>
 #include <argos3/core/wrappers/lua/lua_utility.h>
 #endif
 
 namespace argos {
 
+   CCI_EPuck2EncoderSensor::CCI_EPuck2EncoderSensor()
+#ifdef ARGOS_WITH_LUA
+      : m_psFFIReadings(NULL)
+#endif
+   {}
+
 /****************************************/
 /****************************************/
 
@@ -26,9 +33,13 @@ namespace argos {
 
 #ifdef ARGOS_WITH_LUA
    void CCI_EPuck2EncoderSensor::CreateLuaState(lua_State* pt_lua_state) {
+      m_psFFIReadings = CCI_EPuck2FFI::GetReadings(pt_lua_state);
       CLuaUtility::OpenRobotStateTable(pt_lua_state, "encoder");
       CLuaUtility::AddToTable(pt_lua_state, "left",  m_tReadings.EncoderLeftWheel );
       CLuaUtility::AddToTable(pt_lua_state, "right", m_tReadings.EncoderRightWheel);
+      /* Keep the table, so that ReadingsToLuaState() does not look it up */
+      lua_pushvalue(pt_lua_state, -1);
+      m_nLuaReadings = luaL_ref(pt_lua_state, LUA_REGISTRYINDEX);
       CLuaUtility::CloseRobotStateTable(pt_lua_state);
    }
 #endif
@@ -38,7 +49,12 @@ namespace argos {
 
 #ifdef ARGOS_WITH_LUA
    void CCI_EPuck2EncoderSensor::ReadingsToLuaState(lua_State* pt_lua_state) {
-      lua_getfield(pt_lua_state, -1, "encoder");
+      if(m_psFFIReadings != NULL && m_psFFIReadings->Enabled) {
+         m_psFFIReadings->EncoderLeft  = m_tReadings.EncoderLeftWheel;
+         m_psFFIReadings->EncoderRight = m_tReadings.EncoderRightWheel;
+         return;
+      }
+      lua_rawgeti(pt_lua_state, LUA_REGISTRYINDEX, m_nLuaReadings);
       lua_pushnumber(pt_lua_state, m_tReadings.EncoderLeftWheel);
       lua_setfield  (pt_lua_state, -2, "left"         );
       lua_pushnumber(pt_lua_state, m_tReadings.EncoderRightWheel);
@@ -11,6 +11,7 @@
 
 namespace argos {
    class CCI_EPuck2EncoderSensor;
+   struct SEPuck2FFIReadings;
 }
 
 #include <argos3/core/control_interface/ci_sensor.h>
@@ -21,6 +22,7 @@ namespace argos {
 
    public:
 
+      CCI_EPuck2EncoderSensor();
       virtual ~CCI_EPuck2EncoderSensor() {}
 
       struct SReading
@@ -50,6 +52,13 @@ namespace argos {
 
       SReading m_tReadings;
 
+#ifdef ARGOS_WITH_LUA
+      /** Registry reference to the table of readings, made by CreateLuaState() */
+      int m_nLuaReadings;
+      /** The FFI block of the robot, made by CreateLuaState() */
+      SEPuck2FFIReadings* m_psFFIReadings;
+#endif
+
    };
 
 }
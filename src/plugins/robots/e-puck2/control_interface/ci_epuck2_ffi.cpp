@@ -0,0 +1,110 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/control_interface/ci_epuck2_ffi.cpp>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#include "ci_epuck2_ffi.h"
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+#ifdef ARGOS_WITH_LUA
+#include <argos3/core/wrappers/lua/lua_utility.h>
+#endif
+
+namespace argos {
+
+   /****************************************/
+   /****************************************/
+
+   /* The declaration below must follow the structure */
+   static_assert(std::is_standard_layout<SEPuck2FFIReadings>::value,
+                 "The FFI readings must have a C layout");
+   static_assert(sizeof(SInt32) == 4 && sizeof(UInt32) == 4,
+                 "The FFI readings are made of 32-bit integers");
+   static_assert(SEPuck2Layout::NUM_RING_SENSORS == 8 && SEPuck2Layout::NUM_GROUND_SENSORS == 3,
+                 "The FFI declaration must be updated with the number of sensors");
+   static_assert(offsetof(SEPuck2FFIReadings, EncoderRight) == 22 * 4 &&
+                 sizeof(SEPuck2FFIReadings) == 23 * 4,
+                 "The FFI readings must not have padding");
+
+   const char* CCI_EPuck2FFI::CDEF =
+      "typedef struct {\n"
+      "   uint32_t Enabled;\n"
+      "   int32_t Proximity[8];\n"
+      "   int32_t Light[8];\n"
+      "   int32_t Ground[3];\n"
+      "   int32_t TOF;\n"
+      "   int32_t EncoderLeft;\n"
+      "   int32_t EncoderRight;\n"
+      "} epuck2_readings;\n";
+
+   /****************************************/
+   /****************************************/
+
+#ifdef ARGOS_WITH_LUA
+   /*
+    * This function expects no argument or a boolean, true by default.
+    * The block is the upvalue of the function.
+    */
+   int LuaFFIEnable(lua_State* pt_lua_state) {
+      /* Check parameters */
+      if(lua_gettop(pt_lua_state) > 1) {
+         return luaL_error(pt_lua_state, "robot.ffi.enable() expects 0 or 1 arguments");
+      }
+      bool bEnabled = true;
+      if(lua_gettop(pt_lua_state) == 1) {
+         luaL_checktype(pt_lua_state, 1, LUA_TBOOLEAN);
+         bEnabled = lua_toboolean(pt_lua_state, 1);
+      }
+      /* Perform action */
+      static_cast<SEPuck2FFIReadings*>(lua_touserdata(pt_lua_state, lua_upvalueindex(1)))->Enabled = bEnabled;
+      return 0;
+   }
+#endif
+
+   /****************************************/
+   /****************************************/
+
+#ifdef ARGOS_WITH_LUA
+   SEPuck2FFIReadings* CCI_EPuck2FFI::GetReadings(lua_State* pt_lua_state) {
+      lua_pushliteral(pt_lua_state, "ffi");
+      lua_rawget(pt_lua_state, -2);
+      if(lua_isnil(pt_lua_state, -1)) {
+         lua_pop(pt_lua_state, 1);
+         /* robot.ffi */
+         lua_pushliteral(pt_lua_state, "ffi");
+         lua_newtable(pt_lua_state);
+         /* The block, pinned in the registry so that Lua never collects it */
+         lua_pushliteral(pt_lua_state, "readings");
+         SEPuck2FFIReadings* psReadings =
+            static_cast<SEPuck2FFIReadings*>(lua_newuserdata(pt_lua_state, sizeof(SEPuck2FFIReadings)));
+         ::memset(psReadings, 0, sizeof(SEPuck2FFIReadings));
+         lua_pushvalue(pt_lua_state, -1);
+         luaL_ref(pt_lua_state, LUA_REGISTRYINDEX);
+         lua_rawset(pt_lua_state, -3);
+         lua_pushliteral(pt_lua_state, "cdef");
+         lua_pushstring(pt_lua_state, CDEF);
+         lua_rawset(pt_lua_state, -3);
+         lua_pushliteral(pt_lua_state, "enable");
+         lua_pushlightuserdata(pt_lua_state, psReadings);
+         lua_pushcclosure(pt_lua_state, &LuaFFIEnable, 1);
+         lua_rawset(pt_lua_state, -3);
+         lua_rawset(pt_lua_state, -3);
+         return psReadings;
+      }
+      lua_pushliteral(pt_lua_state, "readings");
+      lua_rawget(pt_lua_state, -2);
+      SEPuck2FFIReadings* psReadings = static_cast<SEPuck2FFIReadings*>(lua_touserdata(pt_lua_state, -1));
+      lua_pop(pt_lua_state, 2);
+      return psReadings;
+   }
+#endif
+
+   /****************************************/
+   /****************************************/
+
+}
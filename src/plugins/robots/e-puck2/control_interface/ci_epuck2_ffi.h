@@ -0,0 +1,95 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/control_interface/ci_epuck2_ffi.h>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#ifndef CCI_EPUCK2_FFI_H
+#define CCI_EPUCK2_FFI_H
+
+namespace argos {
+   struct SEPuck2FFIReadings;
+   class CCI_EPuck2FFI;
+}
+
+#include <argos3/core/utility/datatypes/datatypes.h>
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_layout.h>
+
+#ifdef ARGOS_WITH_LUA
+extern "C" {
+#include <lua.h>
+}
+#endif
+
+namespace argos {
+
+   /**
+    * The readings of an e-puck2 after each step, in a plain C layout.
+    * <p>
+    * A Lua controller running on LuaJIT can read it in place through the
+    * FFI, with the declaration in CCI_EPuck2FFI::CDEF. The layout only uses
+    * 32-bit integers, so it is the same on every platform, and it only
+    * changes with the version of the plugin.
+    * </p>
+    */
+   struct SEPuck2FFIReadings {
+      /** Non-zero when the sensors write here instead of the Lua tables */
+      UInt32 Enabled;
+      SInt32 Proximity[SEPuck2Layout::NUM_RING_SENSORS];
+      SInt32 Light[SEPuck2Layout::NUM_RING_SENSORS];
+      SInt32 Ground[SEPuck2Layout::NUM_GROUND_SENSORS];
+      SInt32 TOF;
+      SInt32 EncoderLeft;
+      SInt32 EncoderRight;
+   };
+
+   /**
+    * Shares an SEPuck2FFIReadings block between the e-puck2 sensors of a Lua
+    * controller.
+    * <p>
+    * The first sensor that creates its Lua state adds the robot.ffi table,
+    * with the block as 'readings', its declaration as 'cdef' and an
+    * 'enable' function. Once enabled, the proximity, light, ground, ToF and
+    * encoder sensors copy their readings into the block and no longer
+    * update their Lua tables, which keep their initial values:
+    * </p>
+    * <pre>
+    *   local ffi = require("ffi")
+    *   ffi.cdef(robot.ffi.cdef)
+    *   local readings = ffi.cast("const epuck2_readings*", robot.ffi.readings)
+    *
+    *   function init()
+    *      robot.ffi.enable(true)
+    *   end
+    *
+    *   function step()
+    *      if readings.Proximity[0] > 1000 then ... end
+    *   end
+    * </pre>
+    * <p>
+    * The block belongs to the Lua state, and it is pinned in its registry,
+    * so the pointer stays valid until the state is closed.
+    * </p>
+    */
+   class CCI_EPuck2FFI {
+
+   public:
+
+      /** The FFI declaration of SEPuck2FFIReadings, as "epuck2_readings" */
+      static const char* CDEF;
+
+#ifdef ARGOS_WITH_LUA
+      /**
+       * Returns the block of the robot whose table is on top of the stack,
+       * creating robot.ffi on the first call.
+       */
+      static SEPuck2FFIReadings* GetReadings(lua_State* pt_lua_state);
+#endif
+
+   };
+
+}
+
+#endif
@@ -7,22 +7,34 @@
  */
 
 #include "ci_epuck2_ground_sensor.h"
+#include <argos3/core/utility/math/general.h>
 
 #ifdef ARGOS_WITH_LUA
+#include <argos3/plugins/robots/e-puck2/control_interface/ci_epuck2_ffi.h>
 #include <argos3/core/wrappers/lua/lua_utility.h>
 #endif
 
 namespace argos {
 
+   CCI_Epuck2GroundSensor::CCI_Epuck2GroundSensor()
+#ifdef ARGOS_WITH_LUA
+      : m_psFFIReadings(NULL)
+#endif
+   {}
+
    /****************************************/
    /****************************************/
 
 #ifdef ARGOS_WITH_LUA
    void CCI_Epuck2GroundSensor::CreateLuaState(lua_State* pt_lua_state) {
+      m_psFFIReadings = CCI_EPuck2FFI::GetReadings(pt_lua_state);
       CLuaUtility::StartTable(pt_lua_state, "ground");
       for(size_t i = 0; i < m_tReadings.size(); ++i) {
          CLuaUtility::AddToTable(pt_lua_state, i+1, m_tReadings[i]);
       }
+      /* Keep the table, so that ReadingsToLuaState() does not look it up */
+      lua_pushvalue(pt_lua_state, -1);
+      m_nLuaReadings = luaL_ref(pt_lua_state, LUA_REGISTRYINDEX);
       CLuaUtility::EndTable(pt_lua_state);
    }
 #endif
@@ -32,11 +44,17 @@ namespace argos {
 
 #ifdef ARGOS_WITH_LUA
    void CCI_Epuck2GroundSensor::ReadingsToLuaState(lua_State* pt_lua_state) {
-      lua_getfield(pt_lua_state, -1, "ground");
+      if(m_psFFIReadings != NULL && m_psFFIReadings->Enabled) {
+         size_t unReadings = Min<size_t>(m_tReadings.size(), SEPuck2Layout::NUM_GROUND_SENSORS);
+         for(size_t i = 0; i < unReadings; ++i) {
+            m_psFFIReadings->Ground[i] = m_tReadings[i];
+         }
+         return;
+      }
+      lua_rawgeti(pt_lua_state, LUA_REGISTRYINDEX, m_nLuaReadings);
       for(size_t i = 0; i < m_tReadings.size(); ++i) {
-         lua_pushnumber(pt_lua_state, i+1           );
          lua_pushnumber(pt_lua_state, m_tReadings[i]);
-         lua_settable  (pt_lua_state, -3            );
+         lua_rawseti   (pt_lua_state, -2, i+1       );
       }
       lua_pop(pt_lua_state, 1);
    }
@@ -10,6 +10,7 @@
 
 namespace argos {
    class CCI_Epuck2GroundSensor;
+   struct SEPuck2FFIReadings;
 }
 
 #include <argos3/core/control_interface/ci_sensor.h>
@@ -20,6 +21,7 @@ namespace argos {
 
    public:
 
+      CCI_Epuck2GroundSensor();
       virtual ~CCI_Epuck2GroundSensor() {}
 
       const std::vector<SInt32>& GetReadings() const;
@@ -34,6 +36,13 @@ namespace argos {
 
       std::vector<SInt32> m_tReadings;
 
+#ifdef ARGOS_WITH_LUA
+      /** Registry reference to the table of readings, made by CreateLuaState() */
+      int m_nLuaReadings;
+      /** The FFI block of the robot, made by CreateLuaState() */
+      SEPuck2FFIReadings* m_psFFIReadings;
+#endif
+
    };
 
 }
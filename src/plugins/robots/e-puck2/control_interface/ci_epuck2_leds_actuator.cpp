@@ -8,6 +8,7 @@
 
 
 #include "ci_epuck2_leds_actuator.h"
+#include <argos3/core/utility/math/general.h>
 
 #ifdef ARGOS_WITH_LUA
 #include <argos3/core/wrappers/lua/lua_utility.h>
@@ -211,6 +212,75 @@ namespace argos {
       return 0;
    }
 
+   /*
+    * This function expects a table with the state of each LED, in order: the
+    * LEDs 1 to 8, the front LED and the body LEDs. A boolean switches an LED
+    * on or off, with the colour of the single-LED functions (white for the
+    * RGB LEDs). The RGB LEDs also take a colour string or a 0xRRGGBB number.
+    * Missing entries are left as they are.
+    * The actuator is the upvalue of the function, so it is not looked up.
+    */
+   int LuaLEDSetPattern(lua_State* pt_lua_state) {
+      /* Check parameters */
+      if(lua_gettop(pt_lua_state) != 1) {
+         return luaL_error(pt_lua_state, "robot.leds.set_pattern() expects 1 argument");
+      }
+      luaL_checktype(pt_lua_state, 1, LUA_TTABLE);
+      CCI_EPuck2LEDsActuator* pcAct =
+         static_cast<CCI_EPuck2LEDsActuator*>(lua_touserdata(pt_lua_state, lua_upvalueindex(1)));
+      /*
+       * The colours are parsed into a plain array first, as luaL_error()
+       * does not unwind C++ objects
+       */
+      CColor pcPattern[32];
+      size_t unLEDs = Min<size_t>(pcAct->GetNumLEDs(), 32);
+      for(size_t i = 0; i < unLEDs; ++i) {
+         bool bRGB = (i == 1 || i == 3 || i == 5 || i == 7);
+         lua_rawgeti(pt_lua_state, 1, i+1);
+         switch(lua_type(pt_lua_state, -1)) {
+            case LUA_TNIL:
+               pcPattern[i] = pcAct->GetSettings()[i];
+               break;
+            case LUA_TBOOLEAN:
+               if(! lua_toboolean(pt_lua_state, -1)) {
+                  pcPattern[i] = CColor::BLACK;
+               }
+               else if(bRGB) {
+                  pcPattern[i] = CColor::WHITE;
+               }
+               else {
+                  pcPattern[i] = (i < 9) ? CColor::RED : CColor::GREEN;
+               }
+               break;
+            case LUA_TSTRING:
+               if(! bRGB) {
+                  return luaL_error(pt_lua_state, "LED %d is not an RGB LED [2,4,6,8]", static_cast<int>(i+1));
+               }
+               try {
+                  pcPattern[i].Set(lua_tostring(pt_lua_state, -1));
+               }
+               catch(CARGoSException& ex) {
+                  return luaL_error(pt_lua_state, ex.what());
+               }
+               break;
+            case LUA_TNUMBER: {
+               if(! bRGB) {
+                  return luaL_error(pt_lua_state, "LED %d is not an RGB LED [2,4,6,8]", static_cast<int>(i+1));
+               }
+               UInt32 unRGB = lua_tonumber(pt_lua_state, -1);
+               pcPattern[i].Set((unRGB >> 16) & 0xFF, (unRGB >> 8) & 0xFF, unRGB & 0xFF);
+               break;
+            }
+            default:
+               return luaL_error(pt_lua_state, "LED %d expects a boolean, a color or nil", static_cast<int>(i+1));
+         }
+         lua_pop(pt_lua_state, 1);
+      }
+      /* Perform action */
+      pcAct->SetPattern(CCI_EPuck2LEDsActuator::TSettings(pcPattern, pcPattern + unLEDs));
+      return 0;
+   }
+
 #endif
 
    /****************************************/
@@ -224,83 +294,83 @@ namespace argos {
    /****************************************/
 
    void CCI_EPuck2LEDsActuator::SetRedLed1(const bool b_state) {
-       m_tSettings[0] = b_state ? CColor::RED : CColor::BLACK;
+       SetLEDSetting(0, b_state ? CColor::RED : CColor::BLACK);
    }
 
    /****************************************/
    /****************************************/
 
    void CCI_EPuck2LEDsActuator::SetRedLed3(const bool b_state) {
-       m_tSettings[2] = b_state ? CColor::RED : CColor::BLACK;
+       SetLEDSetting(2, b_state ? CColor::RED : CColor::BLACK);
    }
 
    /****************************************/
    /****************************************/
 
    void CCI_EPuck2LEDsActuator::SetRedLed5(const bool b_state) {
-       m_tSettings[4] = b_state ? CColor::RED : CColor::BLACK;
+       SetLEDSetting(4, b_state ? CColor::RED : CColor::BLACK);
    }
 
    /****************************************/
    /****************************************/
 
    void CCI_EPuck2LEDsActuator::SetRedLed7(const bool b_state) {
-       m_tSettings[6] = b_state ? CColor::RED : CColor::BLACK;
+       SetLEDSetting(6, b_state ? CColor::RED : CColor::BLACK);
    }
 
    /****************************************/
    /****************************************/
 
    void CCI_EPuck2LEDsActuator::SetAllRedLeds(const bool b_state) {
-       m_tSettings[0] = b_state ? CColor::RED : CColor::BLACK;
-       m_tSettings[2] = b_state ? CColor::RED : CColor::BLACK;
-       m_tSettings[4] = b_state ? CColor::RED : CColor::BLACK;
-       m_tSettings[6] = b_state ? CColor::RED : CColor::BLACK;
+       SetLEDSetting(0, b_state ? CColor::RED : CColor::BLACK);
+       SetLEDSetting(2, b_state ? CColor::RED : CColor::BLACK);
+       SetLEDSetting(4, b_state ? CColor::RED : CColor::BLACK);
+       SetLEDSetting(6, b_state ? CColor::RED : CColor::BLACK);
    }
 
    /****************************************/
    /****************************************/
 
    void CCI_EPuck2LEDsActuator::SetRGBLed2Color(const CColor& c_color) {
-      m_tSettings[1] = c_color;
+      SetLEDSetting(1, c_color);
    }
 
    /****************************************/
    /****************************************/
 
    void CCI_EPuck2LEDsActuator::SetRGBLed4Color(const CColor& c_color) {
-      m_tSettings[3] = c_color;
+      SetLEDSetting(3, c_color);
    }
 
    /****************************************/
    /****************************************/
 
    void CCI_EPuck2LEDsActuator::SetRGBLed6Color(const CColor& c_color) {
-      m_tSettings[5] = c_color;
+      SetLEDSetting(5, c_color);
    }
 
    /****************************************/
    /****************************************/
 
    void CCI_EPuck2LEDsActuator::SetRGBLed8Color(const CColor& c_color) {
-      m_tSettings[7] = c_color;
+      SetLEDSetting(7, c_color);
    }
 
    /****************************************/
    /****************************************/
 
    void CCI_EPuck2LEDsActuator::SetAllRGBColors(const CColor& c_color) {
-       m_tSettings[1] = c_color;
-       m_tSettings[3] = c_color;
-       m_tSettings[5] = c_color;
-       m_tSettings[7] = c_color;
+       SetLEDSetting(1, c_color);
+       SetLEDSetting(3, c_color);
+       SetLEDSetting(5, c_color);
+       SetLEDSetting(7, c_color);
    }
 
    /****************************************/
    /****************************************/
 
    void CCI_EPuck2LEDsActuator::SetFrontLed(const bool b_state) {
-       m_tSettings[8] = b_state ? CColor::RED : CColor::BLACK;
+       SetLEDSetting(8, b_state ? CColor::RED : CColor::BLACK);
    }
 
    /****************************************/
@@ -308,7 +378,7 @@ namespace argos {
 
    void CCI_EPuck2LEDsActuator::SetBodyLed(const bool b_state) {
       for (UInt32 i = 9; i < m_tSettings.size(); ++i) {
-         m_tSettings[i] = b_state ? CColor::GREEN : CColor::BLACK;
+         SetLEDSetting(i, b_state ? CColor::GREEN : CColor::BLACK);
       }
    }
 
@@ -317,13 +387,23 @@ namespace argos {
 
    void CCI_EPuck2LEDsActuator::SetAllBlack() {
        for(size_t i = 0; i < m_tSettings.size(); ++i) {
-           m_tSettings[i] = CColor::BLACK;
+           SetLEDSetting(i, CColor::BLACK);
        }
    }
 
    /****************************************/
    /****************************************/
 
+   void CCI_EPuck2LEDsActuator::SetPattern(const TSettings& t_pattern) {
+      size_t unLEDs = Min(t_pattern.size(), m_tSettings.size());
+      for(size_t i = 0; i < unLEDs; ++i) {
+         SetLEDSetting(i, t_pattern[i]);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
 #ifdef ARGOS_WITH_LUA
    void CCI_EPuck2LEDsActuator::CreateLuaState(lua_State* pt_lua_state) {
       CLuaUtility::OpenRobotStateTable(pt_lua_state, "leds");
@@ -334,6 +414,10 @@ namespace argos {
       CLuaUtility::AddToTable(pt_lua_state, "set_all_reds", &LuaLEDSetAllRedLED);
       CLuaUtility::AddToTable(pt_lua_state, "set_front", &LuaLEDSetFrontLED);
       CLuaUtility::AddToTable(pt_lua_state, "set_body", &LuaLEDSetBodyLED);
+      lua_pushliteral(pt_lua_state, "set_pattern");
+      lua_pushlightuserdata(pt_lua_state, this);
+      lua_pushcclosure(pt_lua_state, &LuaLEDSetPattern, 1);
+      lua_rawset(pt_lua_state, -3);
       CLuaUtility::CloseRobotStateTable(pt_lua_state);
    }
 #endif
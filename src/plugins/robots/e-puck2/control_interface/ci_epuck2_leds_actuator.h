@@ -26,7 +26,8 @@ namespace argos {
 
    public:
 
-      CCI_EPuck2LEDsActuator() {}
+      CCI_EPuck2LEDsActuator() :
+         m_unDirtyMask(0) {}
 
       virtual ~CCI_EPuck2LEDsActuator() {}
 
@@ -127,15 +128,51 @@ namespace argos {
        */
       virtual void SetAllBlack();
 
+      /**
+       * @brief Sets all the LEDs at once.
+       * The colours are in the order of the LEDs: the LEDs 1 to 8, the front
+       * LED and the body LEDs. The LEDs past the end of the pattern are left
+       * as they are.
+       *
+       * @param t_pattern the colours of the LEDs
+       */
+      virtual void SetPattern(const TSettings& t_pattern);
+
+      /**
+       * @brief Returns the colours set for the LEDs.
+       */
+      inline const TSettings& GetSettings() const {
+         return m_tSettings;
+      }
+
 
 #ifdef ARGOS_WITH_LUA
       virtual void CreateLuaState(lua_State* pt_lua_state);
 #endif
 
+   protected:
+
+      /**
+       * @brief Stores the colour of an LED and flags it as changed.
+       * The LED is flagged only if the new colour differs from the stored one.
+       *
+       * @param un_index the index of the LED
+       * @param c_color the new colour of the LED
+       */
+      inline void SetLEDSetting(UInt32 un_index, const CColor& c_color) {
+         if(m_tSettings[un_index] != c_color) {
+            m_tSettings[un_index] = c_color;
+            m_unDirtyMask |= (1u << un_index);
+         }
+      }
+
    protected:
 
       TSettings m_tSettings;
 
+      /** One bit per LED, set when the LED changed since the last update */
+      UInt32 m_unDirtyMask;
+
    };
 
 }
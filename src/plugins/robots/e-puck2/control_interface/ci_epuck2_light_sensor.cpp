@@ -7,42 +7,70 @@
  */
 
 #include "ci_epuck2_light_sensor.h"
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_layout.h>
+#include <argos3/core/utility/math/general.h>
 
 #ifdef ARGOS_WITH_LUA
+#include <argos3/plugins/robots/e-puck2/control_interface/ci_epuck2_ffi.h>
 #include <argos3/core/wrappers/lua/lua_utility.h>
 #endif
 
 namespace argos {
 
    CCI_EPuck2LightSensor::CCI_EPuck2LightSensor() :
-      m_tReadings(8) {
-       // Set the values for the light sensor angles
-         m_tReadings[0].Angle = -CRadians::PI / 10.5884f;
-         m_tReadings[1].Angle = -CRadians::PI / 3.5999f;
-         m_tReadings[2].Angle = -CRadians::PI_OVER_TWO;
-         m_tReadings[3].Angle = -CRadians::PI / 1.2f;
-         m_tReadings[4].Angle = CRadians::PI / 1.2f;
-         m_tReadings[5].Angle = CRadians::PI_OVER_TWO;
-         m_tReadings[6].Angle = CRadians::PI / 3.5999f;
-         m_tReadings[7].Angle = CRadians::PI / 10.5884f;
+      m_tReadings(SEPuck2Layout::NUM_RING_SENSORS)
+#ifdef ARGOS_WITH_LUA
+      , m_psFFIReadings(NULL)
+#endif
+   {
+      /* The sensor angles come from the shared e-puck2 layout */
+      for(size_t i = 0; i < m_tReadings.size(); ++i) {
+         m_tReadings[i].Angle = SEPuck2Layout::GetRingSensorAngle(i);
+      }
+   }
 
-         for(size_t i = 0; i < 8; ++i) {
-             m_tReadings[i].Angle.SignedNormalize();
-         }
+   /****************************************/
+   /****************************************/
+
+#ifdef ARGOS_WITH_LUA
+   /*
+    * Returns the values of the readings as a flat array.
+    * The sensor is the upvalue of the function, so it is not looked up.
+    */
+   int LuaLightValues(lua_State* pt_lua_state) {
+      CCI_EPuck2LightSensor* pcSensor =
+         static_cast<CCI_EPuck2LightSensor*>(lua_touserdata(pt_lua_state, lua_upvalueindex(1)));
+      const CCI_EPuck2LightSensor::TReadings& tReadings = pcSensor->GetReadings();
+      lua_createtable(pt_lua_state, tReadings.size(), 0);
+      for(size_t i = 0; i < tReadings.size(); ++i) {
+         lua_pushnumber(pt_lua_state, tReadings[i].Value);
+         lua_rawseti   (pt_lua_state, -2, i+1           );
+      }
+      return 1;
    }
+#endif
 
    /****************************************/
    /****************************************/
 
 #ifdef ARGOS_WITH_LUA
    void CCI_EPuck2LightSensor::CreateLuaState(lua_State* pt_lua_state) {
+      m_psFFIReadings = CCI_EPuck2FFI::GetReadings(pt_lua_state);
       CLuaUtility::OpenRobotStateTable(pt_lua_state, "light");
+      m_vecLuaReadings.resize(GetReadings().size());
       for(size_t i = 0; i < GetReadings().size(); ++i) {
          CLuaUtility::StartTable(pt_lua_state, i+1                           );
          CLuaUtility::AddToTable(pt_lua_state, "angle",  m_tReadings[i].Angle);
          CLuaUtility::AddToTable(pt_lua_state, "value",  m_tReadings[i].Value);
+         /* Keep the table, so that ReadingsToLuaState() does not look it up */
+         lua_pushvalue(pt_lua_state, -1);
+         m_vecLuaReadings[i] = luaL_ref(pt_lua_state, LUA_REGISTRYINDEX);
          CLuaUtility::EndTable  (pt_lua_state                                );
       }
+      lua_pushliteral(pt_lua_state, "values");
+      lua_pushlightuserdata(pt_lua_state, this);
+      lua_pushcclosure(pt_lua_state, &LuaLightValues, 1);
+      lua_rawset(pt_lua_state, -3);
       CLuaUtility::CloseRobotStateTable(pt_lua_state);
    }
 #endif
@@ -52,12 +80,20 @@ namespace argos {
 
 #ifdef ARGOS_WITH_LUA
    void CCI_EPuck2LightSensor::ReadingsToLuaState(lua_State* pt_lua_state) {
-      lua_getfield(pt_lua_state, -1, "light");
-      for(size_t i = 0; i < GetReadings().size(); ++i) {
-         lua_pushnumber(pt_lua_state, i+1                 );
-         lua_gettable  (pt_lua_state, -2                  );
-         lua_pushnumber(pt_lua_state, m_tReadings[i].Value);
-         lua_setfield  (pt_lua_state, -2, "value"         );
+      if(m_psFFIReadings != NULL && m_psFFIReadings->Enabled) {
+         size_t unReadings = Min<size_t>(m_tReadings.size(), SEPuck2Layout::NUM_RING_SENSORS);
+         for(size_t i = 0; i < unReadings; ++i) {
+            m_psFFIReadings->Light[i] = m_tReadings[i].Value;
+         }
+         return;
+      }
+      /* The key is pushed once, and the tables are set without metamethods */
+      lua_pushliteral(pt_lua_state, "value");
+      for(size_t i = 0; i < m_vecLuaReadings.size(); ++i) {
+         lua_rawgeti   (pt_lua_state, LUA_REGISTRYINDEX, m_vecLuaReadings[i]);
+         lua_pushvalue (pt_lua_state, -2                                    );
+         lua_pushnumber(pt_lua_state, m_tReadings[i].Value                  );
+         lua_rawset    (pt_lua_state, -3                                    );
          lua_pop(pt_lua_state, 1);
       }
       lua_pop(pt_lua_state, 1);
@@ -11,6 +11,7 @@
 
 namespace argos {
    class CCI_EPuck2ProximitySensor;
+   struct SEPuck2FFIReadings;
 }
 
 #include <argos3/core/utility/math/angles.h>
@@ -57,6 +58,13 @@ namespace argos {
    protected:
 
       TReadings m_tReadings;
+
+#ifdef ARGOS_WITH_LUA
+      /** Registry references to the reading tables, made by CreateLuaState() */
+      std::vector<int> m_vecLuaReadings;
+      /** The FFI block of the robot, made by CreateLuaState() */
+      SEPuck2FFIReadings* m_psFFIReadings;
+#endif
    };
 
 }
@@ -9,11 +9,19 @@
 #include "ci_epuck2_tof_sensor.h"
 
 #ifdef ARGOS_WITH_LUA
+#include <argos3/plugins/robots/e-puck2/control_interface/ci_epuck2_ffi.h>
 #include <argos3/core/wrappers/lua/lua_utility.h>
 #endif
 
 namespace argos {
 
+   CCI_EPuck2TOFSensor::CCI_EPuck2TOFSensor() :
+      m_iReading(0)
+#ifdef ARGOS_WITH_LUA
+      , m_psFFIReadings(NULL)
+#endif
+   {}
+
    /****************************************/
    /****************************************/
 
@@ -26,6 +34,7 @@ namespace argos {
 
 #ifdef ARGOS_WITH_LUA
    void CCI_EPuck2TOFSensor::CreateLuaState(lua_State* pt_lua_state) {
+      m_psFFIReadings = CCI_EPuck2FFI::GetReadings(pt_lua_state);
       CLuaUtility::AddToTable(pt_lua_state, "tof", m_iReading);
    }
 #endif
@@ -35,6 +44,10 @@ namespace argos {
 
 #ifdef ARGOS_WITH_LUA
    void CCI_EPuck2TOFSensor::ReadingsToLuaState(lua_State* pt_lua_state) {
+      if(m_psFFIReadings != NULL && m_psFFIReadings->Enabled) {
+         m_psFFIReadings->TOF = m_iReading;
+         return;
+      }
       lua_pushnumber(pt_lua_state, m_iReading);
       lua_setfield(pt_lua_state, -2, "tof");
    }
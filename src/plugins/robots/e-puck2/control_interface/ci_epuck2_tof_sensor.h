@@ -11,6 +11,7 @@
 
 namespace argos {
    class CCI_EPuck2TOFSensor;
+   struct SEPuck2FFIReadings;
 }
 
 #include <argos3/core/control_interface/ci_sensor.h>
@@ -21,6 +22,7 @@ namespace argos {
 
    public:
 
+      CCI_EPuck2TOFSensor();
       virtual ~CCI_EPuck2TOFSensor() {}
 
       const SInt32 GetReading() const;
@@ -35,6 +37,11 @@ namespace argos {
 
       SInt32 m_iReading;
 
+#ifdef ARGOS_WITH_LUA
+      /** The FFI block of the robot, made by CreateLuaState() */
+      SEPuck2FFIReadings* m_psFFIReadings;
+#endif
+
    };
 
 }
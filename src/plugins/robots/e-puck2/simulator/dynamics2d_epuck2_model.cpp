@@ -7,8 +7,11 @@
  */
 
 #include "dynamics2d_epuck2_model.h"
+#include "dynamics2d_epuck2_wind.h"
+#include "epuck2_snapshot.h"
 #include <argos3/plugins/simulator/physics_engines/dynamics2d/dynamics2d_gripping.h>
 #include <argos3/plugins/simulator/physics_engines/dynamics2d/dynamics2d_engine.h>
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_layout.h>
 
 namespace argos {
 
@@ -17,13 +20,20 @@ namespace argos {
 
    static const Real EPUCK_MASS                = 0.4f;
 
-   static const Real EPUCK_RADIUS              = 0.035f;
-   static const Real EPUCK_INTERWHEEL_DISTANCE = 0.053f;
-   static const Real EPUCK_HEIGHT              = 0.086f;
+   static const Real EPUCK_RADIUS              = SEPuck2Layout::BODY_RADIUS;
+   static const Real EPUCK_INTERWHEEL_DISTANCE = SEPuck2Layout::INTERWHEEL_DISTANCE;
+   static const Real EPUCK_HEIGHT              = SEPuck2Layout::BODY_HEIGHT;
 
    static const Real EPUCK_MAX_FORCE           = 1.5f;
    static const Real EPUCK_MAX_TORQUE          = 1.5f;
 
+   /* Below this speed (m/s) a body is idle */
+   static const Real EPUCK_IDLE_SPEED          = 0.001f;
+   /* Steps a stopped body must stay idle before it is parked */
+   static const UInt32 EPUCK_IDLE_STEPS        = 10;
+   /* Seconds a parked body must stay idle before chipmunk puts it to sleep */
+   static const Real EPUCK_SLEEP_TIME          = 0.5f;
+
    enum EPUCK_WHEELS {
       EPUCK_LEFT_WHEEL = 0,
       EPUCK_RIGHT_WHEEL = 1
@@ -42,7 +52,28 @@ namespace argos {
                       EPUCK_MAX_TORQUE,
                       EPUCK_INTERWHEEL_DISTANCE,
                       c_entity.GetConfigurationNode()),
-      m_fCurrentWheelVelocity(m_cWheeledEntity.GetWheelVelocities()) {
+      m_fCurrentWheelVelocity(m_cWheeledEntity.GetWheelVelocities()),
+      m_bSleepEnabled(false),
+      m_bParked(false),
+      m_bBraking(false),
+      m_unIdleSteps(0),
+      m_pcWind(NULL),
+      m_unWindIndex(0) {
+      /* Parse the <dynamics2d sleep="..."/> node, if any */
+      if(c_entity.GetConfigurationNode() != NULL &&
+         NodeExists(*c_entity.GetConfigurationNode(), "dynamics2d")) {
+         GetNodeAttributeOrDefault(GetNode(*c_entity.GetConfigurationNode(), "dynamics2d"),
+                                   "sleep",
+                                   m_bSleepEnabled,
+                                   m_bSleepEnabled);
+      }
+      /* Sleeping must be enabled on the space for parked bodies to sleep.
+         This affects all the bodies of the space, hence the opt-in */
+      cpSpace* ptSpace = GetDynamics2DEngine().GetPhysicsSpace();
+      if(m_bSleepEnabled && cpSpaceGetSleepTimeThreshold(ptSpace) == INFINITY) {
+         cpSpaceSetSleepTimeThreshold(ptSpace, EPUCK_SLEEP_TIME);
+         cpSpaceSetIdleSpeedThreshold(ptSpace, EPUCK_IDLE_SPEED);
+      }
       /* Create the body with initial position and orientation */
       cpBody* ptBody =
          cpSpaceAddBody(GetDynamics2DEngine().GetPhysicsSpace(),
@@ -68,12 +99,21 @@ namespace argos {
       m_cDiffSteering.AttachTo(ptBody);
       /* Set the body so that the default methods work as expected */
       SetBody(ptBody, EPUCK_HEIGHT);
+      /* Register the body with the wind of the engine, if any */
+      m_pcWind = CDynamics2DEPuck2Wind::Acquire(c_engine);
+      if(m_pcWind != NULL) {
+         m_unWindIndex = m_pcWind->AddBody(*this, ptBody);
+      }
    }
 
    /****************************************/
    /****************************************/
 
    CDynamics2DEPuck2Model::~CDynamics2DEPuck2Model() {
+      if(m_pcWind != NULL) {
+         m_pcWind->RemoveBody(m_unWindIndex);
+         CDynamics2DEPuck2Wind::Release(GetDynamics2DEngine());
+      }
       m_cDiffSteering.Detach();
    }
 
@@ -81,24 +121,170 @@ namespace argos {
    /****************************************/
 
    void CDynamics2DEPuck2Model::Reset() {
+      Wake();
       CDynamics2DSingleBodyObjectModel::Reset();
       m_cDiffSteering.Reset();
+      m_bBraking = true;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CDynamics2DEPuck2Model::MoveTo(const CVector3& c_position,
+                                       const CQuaternion& c_orientation) {
+      Wake();
+      CDynamics2DSingleBodyObjectModel::MoveTo(c_position, c_orientation);
    }
 
    /****************************************/
    /****************************************/
 
    void CDynamics2DEPuck2Model::UpdateFromEntityStatus() {
+      /* The wind pushes all the bodies at once after the first chipmunk step */
+      if(m_pcWind != NULL) {
+         m_pcWind->Schedule();
+      }
       /* Do we want to move? */
       if((m_fCurrentWheelVelocity[EPUCK_LEFT_WHEEL] != 0.0f) ||
          (m_fCurrentWheelVelocity[EPUCK_RIGHT_WHEEL] != 0.0f)) {
+         Wake();
          m_cDiffSteering.SetWheelVelocity(m_fCurrentWheelVelocity[EPUCK_LEFT_WHEEL],
                                           m_fCurrentWheelVelocity[EPUCK_RIGHT_WHEEL]);
+         m_bBraking = false;
+      }
+      else if(m_bParked) {
+         /* A collision woke the body up and pushed it - brake again */
+         if(!cpBodyIsSleeping(GetBody()) && IsMoving()) {
+            Wake();
+         }
       }
       else {
          /* No, we don't want to move - zero all speeds */
+         if(!m_bBraking) {
+            m_cDiffSteering.Reset();
+            m_bBraking = true;
+         }
+         /* Park the body once it has been idle for a while */
+         if(m_bSleepEnabled) {
+            if(IsMoving() || !IsUntouched()) {
+               m_unIdleSteps = 0;
+            }
+            else if(++m_unIdleSteps >= EPUCK_IDLE_STEPS) {
+               Park();
+            }
+         }
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   bool CDynamics2DEPuck2Model::IsMoving() const {
+      const cpBody* ptBody = GetBody();
+      return
+         cpvlengthsq(ptBody->v) > EPUCK_IDLE_SPEED * EPUCK_IDLE_SPEED ||
+         Abs(ptBody->w) * EPUCK_RADIUS > EPUCK_IDLE_SPEED;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   static void AddContactImpulse(cpBody*,
+                                 cpArbiter* pt_arbiter,
+                                 void* pv_impulse) {
+      *reinterpret_cast<Real*>(pv_impulse) +=
+         cpvlength(cpArbiterTotalImpulseWithFriction(pt_arbiter));
+   }
+
+   bool CDynamics2DEPuck2Model::IsUntouched() const {
+      Real fImpulse = 0.0f;
+      cpBodyEachArbiter(const_cast<cpBody*>(GetBody()), AddContactImpulse, &fImpulse);
+      /* Negligible if it could not move the body faster than the idle speed */
+      return fImpulse <= EPUCK_MASS * EPUCK_IDLE_SPEED;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CDynamics2DEPuck2Model::Park() {
+      cpBody* ptBody = GetBody();
+      m_cDiffSteering.Detach();
+      /* Without the steering the body would drift at its residual speed */
+      cpBodySetVel(ptBody, cpvzero);
+      cpBodySetAngVel(ptBody, 0.0f);
+      m_bParked = true;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CDynamics2DEPuck2Model::Wake() {
+      if(m_bParked) {
+         cpBody* ptBody = GetBody();
+         cpBodyActivate(ptBody);
+         m_cDiffSteering.AttachTo(ptBody);
+         m_bParked = false;
+      }
+      m_unIdleSteps = 0;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CDynamics2DEPuck2Model::SaveState(CEPuck2Snapshot& c_snapshot) {
+      const cpBody* ptBody = GetBody();
+      c_snapshot.Write<Real>(ptBody->p.x);
+      c_snapshot.Write<Real>(ptBody->p.y);
+      c_snapshot.Write<Real>(ptBody->a);
+      c_snapshot.Write<Real>(ptBody->v.x);
+      c_snapshot.Write<Real>(ptBody->v.y);
+      c_snapshot.Write<Real>(ptBody->w);
+      c_snapshot.Write<UInt8>(m_bParked ? 1 : 0);
+      c_snapshot.Write<UInt8>(m_bBraking ? 1 : 0);
+      c_snapshot.Write(m_unIdleSteps);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CDynamics2DEPuck2Model::LoadState(CEPuck2Snapshot& c_snapshot) {
+      Real pfState[6];
+      for(UInt32 i = 0; i < 6; ++i) {
+         c_snapshot.Read(pfState[i]);
+      }
+      UInt8 unParked, unBraking;
+      UInt32 unIdleSteps;
+      c_snapshot.Read(unParked);
+      c_snapshot.Read(unBraking);
+      c_snapshot.Read(unIdleSteps);
+      /* Start from an awake body with the steering attached */
+      Wake();
+      cpBody* ptBody = GetBody();
+      cpBodySetPos(ptBody, cpv(pfState[0], pfState[1]));
+      cpBodySetAngle(ptBody, pfState[2]);
+      cpBodySetVel(ptBody, cpv(pfState[3], pfState[4]));
+      cpBodySetAngVel(ptBody, pfState[5]);
+      cpBodyResetForces(ptBody);
+      cpBodyActivate(ptBody);
+      cpSpaceReindexShapesForBody(GetDynamics2DEngine().GetPhysicsSpace(), ptBody);
+      /* The control body follows the restored wheel velocities */
+      if((m_fCurrentWheelVelocity[EPUCK_LEFT_WHEEL] != 0.0f) ||
+         (m_fCurrentWheelVelocity[EPUCK_RIGHT_WHEEL] != 0.0f)) {
+         m_cDiffSteering.SetWheelVelocity(m_fCurrentWheelVelocity[EPUCK_LEFT_WHEEL],
+                                          m_fCurrentWheelVelocity[EPUCK_RIGHT_WHEEL]);
+      }
+      else {
          m_cDiffSteering.Reset();
       }
+      /* Restore the idle state */
+      if(unParked != 0) {
+         m_cDiffSteering.Detach();
+         m_bParked = true;
+      }
+      m_bBraking = (unBraking != 0);
+      m_unIdleSteps = unIdleSteps;
+      /* Move the anchors and the bounding box */
+      UpdateEntityStatus();
    }
 
    /****************************************/
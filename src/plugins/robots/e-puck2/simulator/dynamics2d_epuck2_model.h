@@ -14,6 +14,8 @@ namespace argos {
    class CDynamics2DGripper;
    class CDynamics2DGrippable;
    class CDynamics2DEPuckModel;
+   class CEPuck2Snapshot;
+   class CDynamics2DEPuck2Wind;
 }
 
 #include <argos3/plugins/simulator/physics_engines/dynamics2d/dynamics2d_single_body_object_model.h>
@@ -22,6 +24,20 @@ namespace argos {
 
 namespace argos {
 
+   /**
+    * The dynamics2d model of the e-puck2.
+    * <p>
+    * With 'sleep' set to 'true' in the <dynamics2d> node of the e-puck2, a
+    * robot whose wheels are stopped and whose body has been at rest for a
+    * few steps is parked: the constraints of the differential steering are
+    * removed from the space, so chipmunk can put the body to sleep together
+    * with the bodies it touches. A parked robot is woken up by a wheel
+    * command, or when a collision sets it in motion.
+    * Sleeping is off by default, because enabling it turns on chipmunk
+    * sleeping for every movable body of the engine's space, not only for
+    * the e-puck2s.
+    * </p>
+    */
    class CDynamics2DEPuck2Model : public CDynamics2DSingleBodyObjectModel {
 
    public:
@@ -32,8 +48,61 @@ namespace argos {
 
       virtual void Reset();
 
+      virtual void MoveTo(const CVector3& c_position,
+                          const CQuaternion& c_orientation);
+
       virtual void UpdateFromEntityStatus();
 
+      /**
+       * Returns true if the robot is parked.
+       */
+      inline bool IsParked() const {
+         return m_bParked;
+      }
+
+      /**
+       * Returns the wind acting on the robot, or NULL.
+       */
+      inline CDynamics2DEPuck2Wind* GetWind() const {
+         return m_pcWind;
+      }
+
+      /**
+       * Returns the index of the robot in the wind.
+       */
+      inline UInt32 GetWindIndex() const {
+         return m_unWindIndex;
+      }
+
+      inline void SetWindIndex(UInt32 un_index) {
+         m_unWindIndex = un_index;
+      }
+
+      /**
+       * Writes the pose, velocity and idle state of the body into a snapshot.
+       */
+      void SaveState(CEPuck2Snapshot& c_snapshot);
+
+      /**
+       * Reads the pose, velocity and idle state of the body from a snapshot.
+       * The wheel velocities must have been restored already.
+       */
+      void LoadState(CEPuck2Snapshot& c_snapshot);
+
+   private:
+
+      /** Returns true if the body moves faster than the idle threshold */
+      bool IsMoving() const;
+
+      /** Returns true if the contacts of the body push it less than the idle threshold */
+      bool IsUntouched() const;
+
+      /** Removes the steering constraints, so the body can sleep */
+      void Park();
+
+      /** Wakes the body up and puts the steering constraints back */
+      void Wake();
+
    private:
 
       CEPuck2Entity& m_cEPuckEntity;
@@ -43,6 +112,19 @@ namespace argos {
 
       const Real* m_fCurrentWheelVelocity;
 
+      /** Whether idle bodies are allowed to sleep */
+      bool m_bSleepEnabled;
+      /** Whether the steering constraints are removed */
+      bool m_bParked;
+      /** Whether the control body is already stopped */
+      bool m_bBraking;
+      /** How many consecutive steps the body has been idle */
+      UInt32 m_unIdleSteps;
+
+      /** The wind, NULL without <air_resistance> */
+      CDynamics2DEPuck2Wind* m_pcWind;
+      UInt32 m_unWindIndex;
+
    };
 
 }
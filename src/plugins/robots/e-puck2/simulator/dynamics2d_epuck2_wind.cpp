@@ -0,0 +1,270 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/dynamics2d_epuck2_wind.cpp>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#include "dynamics2d_epuck2_wind.h"
+#include "dynamics2d_epuck2_model.h"
+#include <argos3/core/simulator/simulator.h>
+#include <argos3/core/simulator/physics_engine/physics_engine.h>
+#include <argos3/core/simulator/space/space.h>
+#include <argos3/core/utility/configuration/argos_configuration.h>
+#include <argos3/plugins/simulator/physics_engines/dynamics2d/dynamics2d_engine.h>
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_layout.h>
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_log.h>
+#include <algorithm>
+#include <map>
+
+namespace argos {
+
+   /****************************************/
+   /****************************************/
+
+   /* The wind of each dynamics2d engine */
+   static std::map<CDynamics2DEngine*, CDynamics2DEPuck2Wind*> s_mapWinds;
+
+   /* Whether an anemometer needs the wind */
+   static bool s_bRequested = false;
+
+   /****************************************/
+   /****************************************/
+
+   void CDynamics2DEPuck2Wind::Request() {
+      s_bRequested = true;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   static UInt32 CountDynamics2DEngines() {
+      CPhysicsEngine::TVector& vecEngines = CSimulator::GetInstance().GetPhysicsEngines();
+      UInt32 unEngines = 0;
+      for(size_t i = 0; i < vecEngines.size(); ++i) {
+         if(dynamic_cast<CDynamics2DEngine*>(vecEngines[i]) != NULL) {
+            ++unEngines;
+         }
+      }
+      return unEngines;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CDynamics2DEPuck2Wind* CDynamics2DEPuck2Wind::Acquire(CDynamics2DEngine& c_engine) {
+      std::map<CDynamics2DEngine*, CDynamics2DEPuck2Wind*>::iterator it = s_mapWinds.find(&c_engine);
+      if(it != s_mapWinds.end()) {
+         ++it->second->m_unUsers;
+         return it->second;
+      }
+      /* Parse <configuration><air_resistance>, if any */
+      TConfigurationNode& tRoot = CSimulator::GetInstance().GetConfigurationRoot();
+      if(!NodeExists(tRoot, "configuration")) {
+         return NULL;
+      }
+      TConfigurationNode& tConf = GetNode(tRoot, "configuration");
+      if(!NodeExists(tConf, "air_resistance")) {
+         return NULL;
+      }
+      TConfigurationNode& tAir = GetNode(tConf, "air_resistance");
+      try {
+         bool bNative = false;
+         GetNodeAttributeOrDefault(tAir, "native", bNative, bNative);
+         Real fAngle = 0.0, fMagnitude = 0.0, fDrag = 0.0;
+         GetNodeAttribute(tAir, "angle_deg", fAngle);
+         GetNodeAttribute(tAir, "magnitude", fMagnitude);
+         GetNodeAttributeOrDefault(tAir, "drag", fDrag, fDrag);
+         if(fDrag < 0.0) {
+            THROW_ARGOSEXCEPTION("The drag must be non-negative, got " << fDrag);
+         }
+         bool bShielding = true;
+         CEPuck2WakeSolver::SParams sWake;
+         GetNodeAttributeOrDefault(tAir, "shielding", bShielding, bShielding);
+         GetNodeAttributeOrDefault(tAir, "lateral_reach", sWake.LateralReach, sWake.LateralReach);
+         GetNodeAttributeOrDefault(tAir, "shadow_length", sWake.ShadowLength, sWake.ShadowLength);
+         GetNodeAttributeOrDefault(tAir, "upwind_gate", sWake.UpwindGate, sWake.UpwindGate);
+         GetNodeAttributeOrDefault(tAir, "gamma", sWake.Gamma, sWake.Gamma);
+         if(sWake.LateralReach <= 0.0 || sWake.ShadowLength <= 0.0 || sWake.UpwindGate < 0.0) {
+            THROW_ARGOSEXCEPTION("The wake lengths must be positive");
+         }
+         CRadians cAngle = ToRadians(CDegrees(fAngle));
+         CDynamics2DEPuck2Wind* pcWind =
+            new CDynamics2DEPuck2Wind(c_engine,
+                                      bNative,
+                                      fDrag,
+                                      bShielding,
+                                      sWake);
+         pcWind->m_cField.Init(tAir, CVector2(fMagnitude, cAngle));
+         if(s_mapWinds.empty() && CountDynamics2DEngines() > 1) {
+            EPUCK2_LOG_WARNING("wind", "The <air_resistance> wakes are computed per dynamics2d engine: "
+                               "robots do not shield each other across engine boundaries, and the "
+                               "anemometers near a boundary read too much wind. Use a single engine "
+                               "for exact shielding");
+         }
+         s_mapWinds[&c_engine] = pcWind;
+         EPUCK2_LOG_INFO("wind", (bNative ? "Native wind" : "Sensed wind") << " of " << fMagnitude
+                         << " cm/s at " << fAngle << " degrees in engine \"" << c_engine.GetId() << "\"");
+         return pcWind;
+      }
+      catch(CARGoSException& ex) {
+         THROW_ARGOSEXCEPTION_NESTED("Error parsing <air_resistance>", ex);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CDynamics2DEPuck2Wind::Release(CDynamics2DEngine& c_engine) {
+      std::map<CDynamics2DEngine*, CDynamics2DEPuck2Wind*>::iterator it = s_mapWinds.find(&c_engine);
+      if(it != s_mapWinds.end() && --it->second->m_unUsers == 0) {
+         delete it->second;
+         s_mapWinds.erase(it);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CDynamics2DEPuck2Wind::CDynamics2DEPuck2Wind(CDynamics2DEngine& c_engine,
+                                                bool b_native,
+                                                Real f_drag,
+                                                bool b_shielding,
+                                                const CEPuck2WakeSolver::SParams& s_wake) :
+      m_cEngine(c_engine),
+      m_fDrag(f_drag),
+      m_unUsers(1),
+      m_bNative(b_native),
+      m_bScheduled(false),
+      m_bShielding(b_shielding) {
+      m_cWakeSolver.Init(s_wake);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   UInt32 CDynamics2DEPuck2Wind::AddBody(CDynamics2DEPuck2Model& c_model,
+                                         cpBody* pt_body) {
+      m_vecBodies.push_back(pt_body);
+      m_vecModels.push_back(&c_model);
+      m_vecShielding.push_back(0.0);
+      m_vecWindX.push_back(m_cField.GetMean().GetX());
+      m_vecWindY.push_back(m_cField.GetMean().GetY());
+      m_vecImpulseX.push_back(0.0);
+      m_vecImpulseY.push_back(0.0);
+      return m_vecBodies.size() - 1;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CDynamics2DEPuck2Wind::RemoveBody(UInt32 un_body) {
+      UInt32 unLast = m_vecBodies.size() - 1;
+      if(un_body != unLast) {
+         m_vecBodies[un_body] = m_vecBodies[unLast];
+         m_vecModels[un_body] = m_vecModels[unLast];
+         m_vecShielding[un_body] = m_vecShielding[unLast];
+         m_vecWindX[un_body] = m_vecWindX[unLast];
+         m_vecWindY[un_body] = m_vecWindY[unLast];
+         m_vecImpulseX[un_body] = m_vecImpulseX[unLast];
+         m_vecImpulseY[un_body] = m_vecImpulseY[unLast];
+         m_vecModels[un_body]->SetWindIndex(un_body);
+      }
+      m_vecBodies.pop_back();
+      m_vecModels.pop_back();
+      m_vecShielding.pop_back();
+      m_vecWindX.pop_back();
+      m_vecWindY.pop_back();
+      m_vecImpulseX.pop_back();
+      m_vecImpulseY.pop_back();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CDynamics2DEPuck2Wind::Schedule() {
+      if(!m_bScheduled && (m_bNative || s_bRequested)) {
+         /* Runs at the end of the first chipmunk step, after the collisions */
+         cpSpaceAddPostStepCallback(m_cEngine.GetPhysicsSpace(), PostStep, this, this);
+         m_bScheduled = true;
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CDynamics2DEPuck2Wind::UpdateWind() {
+      size_t unBodies = m_vecBodies.size();
+      m_vecX.resize(unBodies);
+      m_vecY.resize(unBodies);
+      for(size_t i = 0; i < unBodies; ++i) {
+         m_vecX[i] = m_vecBodies[i]->p.x;
+         m_vecY[i] = m_vecBodies[i]->p.y;
+      }
+      /* Sample the field once for all the bodies */
+      m_cField.SetTime(CSimulator::GetInstance().GetSpace().GetSimulationClock() *
+                       CPhysicsEngine::GetSimulationClockTick());
+      m_cField.Sample(m_vecX.data(),
+                      m_vecY.data(),
+                      unBodies,
+                      m_vecWindX.data(),
+                      m_vecWindY.data());
+      /* The wakes follow the mean wind */
+      if(m_bShielding && m_cField.GetMean().SquareLength() > 1e-18) {
+         CVector2 cDirection = m_cField.GetMean();
+         cDirection.Normalize();
+         m_cWakeSolver.Solve(cDirection,
+                             m_vecX.data(),
+                             m_vecY.data(),
+                             unBodies,
+                             SEPuck2Layout::BODY_RADIUS,
+                             m_vecShielding.data());
+      }
+      else {
+         std::fill(m_vecShielding.begin(), m_vecShielding.end(), 0.0);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CDynamics2DEPuck2Wind::ApplyImpulses() {
+      UpdateWind();
+      if(!m_bNative) {
+         return;
+      }
+      /* Wind in m/s and drag over one control step */
+      cpFloat fDrag = m_fDrag * CPhysicsEngine::GetSimulationClockTick();
+      for(size_t i = 0; i < m_vecBodies.size(); ++i) {
+         cpBody* ptBody = m_vecBodies[i];
+         cpFloat fScale = 0.01 * (1.0 - m_vecShielding[i]);
+         cpVect tImpulse = cpvsub(cpv(m_vecWindX[i] * fScale, m_vecWindY[i] * fScale),
+                                  cpvmult(ptBody->v, fDrag));
+         tImpulse = cpvadd(cpvmult(tImpulse, cpBodyGetMass(ptBody)),
+                           cpv(m_vecImpulseX[i], m_vecImpulseY[i]));
+         if(tImpulse.x != 0.0 || tImpulse.y != 0.0) {
+            cpBodyActivate(ptBody);
+            cpBodyApplyImpulse(ptBody, tImpulse, cpvzero);
+         }
+      }
+      /* The added impulses are consumed */
+      std::fill(m_vecImpulseX.begin(), m_vecImpulseX.end(), 0.0);
+      std::fill(m_vecImpulseY.begin(), m_vecImpulseY.end(), 0.0);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CDynamics2DEPuck2Wind::PostStep(cpSpace*,
+                                        void*,
+                                        void* pv_wind) {
+      CDynamics2DEPuck2Wind* pcWind = reinterpret_cast<CDynamics2DEPuck2Wind*>(pv_wind);
+      pcWind->ApplyImpulses();
+      pcWind->m_bScheduled = false;
+   }
+
+   /****************************************/
+   /****************************************/
+
+}
@@ -0,0 +1,214 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/dynamics2d_epuck2_wind.h>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#ifndef DYNAMICS2D_EPUCK2_WIND_H
+#define DYNAMICS2D_EPUCK2_WIND_H
+
+namespace argos {
+   class CDynamics2DEPuck2Wind;
+   class CDynamics2DEPuck2Model;
+   class CDynamics2DEngine;
+}
+
+#include <argos3/core/utility/math/vector2.h>
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_wake_solver.h>
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_wind_field.h>
+#include <argos3/plugins/simulator/physics_engines/dynamics2d/chipmunk-physics/include/chipmunk.h>
+#include <vector>
+
+namespace argos {
+
+   /**
+    * The wind acting on the e-puck2s of a dynamics2d engine.
+    * <p>
+    * The wind is the one of the <air_resistance> node used by the air
+    * resistance examples, and it is applied by the physics engine when
+    * 'native' is set. Otherwise, the wind is only computed when an
+    * epuck2_anemometer sensor asks for it:
+    * </p>
+    * <pre>
+    *   <configuration>
+    *     ...
+    *     <air_resistance angle_deg="0" magnitude="10.0" native="true" drag="0"
+    *                     shielding="true" lateral_reach="3" shadow_length="4"
+    *                     upwind_gate="0.5" gamma="2" />
+    *   </configuration>
+    * </pre>
+    * <p>
+    * The magnitude is in cm/s. At each step, every e-puck2 receives an
+    * impulse equal to its mass times the effective wind in m/s, as with the
+    * air_resistance controllers. The optional 'drag' (1/s) opposes the
+    * velocity of the body. The effective wind is the wind reduced by the
+    * shielding of the body. Unless 'shielding' is false, the shielding is
+    * computed at each step for the whole swarm by a CEPuck2WakeSolver, whose
+    * wake shape is given by the other attributes. All the impulses are
+    * applied by a single post-step callback. With native wind, controllers
+    * can add their own impulses to this callback with AddImpulse(), instead
+    * of registering a callback per body.
+    * </p>
+    * <p>
+    * The wind can change in space and time with a <wind_field> child, see
+    * CEPuck2WindField. The field is sampled once per step for all the bodies,
+    * and the wakes follow its mean direction.
+    * </p>
+    * <p>
+    * Each dynamics2d engine has its own wind, because the engines step in
+    * parallel. With several engines, as made by CEPuck2Partition, the wakes
+    * do not cross the boundaries between them: a robot just downwind of a
+    * boundary is not shielded by the robots on the other side. A warning is
+    * logged when the first wind is created in such a setup.
+    * </p>
+    */
+   class CDynamics2DEPuck2Wind {
+
+   public:
+
+      /**
+       * Returns the wind of an engine, creating it if necessary.
+       * Returns NULL if there is no <air_resistance> node.
+       * Each successful call must be matched by a call to Release().
+       */
+      static CDynamics2DEPuck2Wind* Acquire(CDynamics2DEngine& c_engine);
+
+      /**
+       * Releases the wind of an engine, deleting it after the last user.
+       */
+      static void Release(CDynamics2DEngine& c_engine);
+
+      /**
+       * Adds a body and returns its index.
+       */
+      UInt32 AddBody(CDynamics2DEPuck2Model& c_model,
+                     cpBody* pt_body);
+
+      /**
+       * Removes a body. The last body takes its index.
+       */
+      void RemoveBody(UInt32 un_body);
+
+      /**
+       * Schedules the wind of the current step.
+       * Models call it at every step; only the first call has effect.
+       * Nothing is scheduled when the wind is neither native nor requested.
+       */
+      void Schedule();
+
+      /**
+       * Asks for the wind to be computed at every step, even if it is not
+       * native. The epuck2_anemometer sensors call it once, in Init().
+       */
+      static void Request();
+
+      /**
+       * Returns true if the physics engine pushes the bodies.
+       */
+      inline bool IsNative() const {
+         return m_bNative;
+      }
+
+      inline size_t GetNumBodies() const {
+         return m_vecBodies.size();
+      }
+
+      /**
+       * Returns the mean wind, in cm/s.
+       */
+      inline const CVector2& GetWind() const {
+         return m_cField.GetMean();
+      }
+
+      inline const CEPuck2WindField& GetField() const {
+         return m_cField;
+      }
+
+      /**
+       * Returns the wind at a body, before shielding, in cm/s.
+       */
+      inline CVector2 GetLocalWind(UInt32 un_body) const {
+         return CVector2(m_vecWindX[un_body], m_vecWindY[un_body]);
+      }
+
+      /**
+       * Returns the effective wind on a body, in cm/s.
+       */
+      inline CVector2 GetEffectiveWind(UInt32 un_body) const {
+         return GetLocalWind(un_body) * (1.0 - m_vecShielding[un_body]);
+      }
+
+      inline Real GetShielding(UInt32 un_body) const {
+         return m_vecShielding[un_body];
+      }
+
+      /**
+       * Sets how much a body is shielded from the wind, in [0,1].
+       * With shielding enabled, the value is overwritten at the next step.
+       */
+      inline void SetShielding(UInt32 un_body,
+                               Real f_shielding) {
+         m_vecShielding[un_body] = f_shielding;
+      }
+
+      /**
+       * Adds an impulse, in kg*m/s, to apply to a body with the wind of the
+       * current step. The impulses are only applied when the wind is native.
+       */
+      inline void AddImpulse(UInt32 un_body,
+                             const CVector2& c_impulse) {
+         m_vecImpulseX[un_body] += c_impulse.GetX();
+         m_vecImpulseY[un_body] += c_impulse.GetY();
+      }
+
+      inline cpBody* GetBody(UInt32 un_body) const {
+         return m_vecBodies[un_body];
+      }
+
+   private:
+
+      CDynamics2DEPuck2Wind(CDynamics2DEngine& c_engine,
+                            bool b_native,
+                            Real f_drag,
+                            bool b_shielding,
+                            const CEPuck2WakeSolver::SParams& s_wake);
+
+      /** Samples the wind and computes the shielding of all the bodies */
+      void UpdateWind();
+
+      /** Applies the impulses to all the bodies, if native */
+      void ApplyImpulses();
+
+      /** The post-step callback */
+      static void PostStep(cpSpace* pt_space,
+                           void* pv_key,
+                           void* pv_wind);
+
+   private:
+
+      CDynamics2DEngine& m_cEngine;
+      CEPuck2WindField m_cField;
+      Real m_fDrag;
+      UInt32 m_unUsers;
+      bool m_bNative;
+      bool m_bScheduled;
+      bool m_bShielding;
+      CEPuck2WakeSolver m_cWakeSolver;
+
+      std::vector<cpBody*> m_vecBodies;
+      std::vector<CDynamics2DEPuck2Model*> m_vecModels;
+      std::vector<Real> m_vecShielding;
+      std::vector<Real> m_vecWindX;
+      std::vector<Real> m_vecWindY;
+      std::vector<Real> m_vecImpulseX;
+      std::vector<Real> m_vecImpulseY;
+      std::vector<Real> m_vecX;
+      std::vector<Real> m_vecY;
+
+   };
+
+}
+
+#endif
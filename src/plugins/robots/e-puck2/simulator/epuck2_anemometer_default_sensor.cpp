@@ -0,0 +1,176 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/epuck2_anemometer_default_sensor.cpp>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#include "epuck2_anemometer_default_sensor.h"
+#include "dynamics2d_epuck2_model.h"
+#include "dynamics2d_epuck2_wind.h"
+
+#include <argos3/core/simulator/entity/composable_entity.h>
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_log.h>
+
+namespace argos {
+
+   /****************************************/
+   /****************************************/
+
+   CEPuck2AnemometerDefaultSensor::CEPuck2AnemometerDefaultSensor() :
+      m_pcEmbodiedEntity(NULL),
+      m_pcRNG(NULL),
+      m_bAddNoise(false),
+      m_bWarned(false) {}
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2AnemometerDefaultSensor::SetRobot(CComposableEntity& c_entity) {
+      try {
+         m_pcEmbodiedEntity = &(c_entity.GetComponent<CEmbodiedEntity>("body"));
+      }
+      catch(CARGoSException& ex) {
+         THROW_ARGOSEXCEPTION_NESTED("Can't set robot for the anemometer default sensor", ex);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2AnemometerDefaultSensor::Init(TConfigurationNode& t_tree) {
+      try {
+         CCI_EPuck2AnemometerSensor::Init(t_tree);
+         /* Parse noise level */
+         Real fNoiseLevel = 0.0f;
+         GetNodeAttributeOrDefault(t_tree, "noise_level", fNoiseLevel, fNoiseLevel);
+         if(fNoiseLevel < 0.0f) {
+            THROW_ARGOSEXCEPTION("Can't specify a negative value for the noise level of the anemometer sensor");
+         }
+         else if(fNoiseLevel > 0.0f) {
+            m_bAddNoise = true;
+            m_cNoiseRange.Set(-fNoiseLevel, fNoiseLevel);
+            m_pcRNG = CRandom::CreateRNG("argos");
+         }
+         /* Have the wind computed at every step */
+         CDynamics2DEPuck2Wind::Request();
+      }
+      catch(CARGoSException& ex) {
+         THROW_ARGOSEXCEPTION_NESTED("Initialization error in default anemometer sensor", ex);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CDynamics2DEPuck2Model* CEPuck2AnemometerDefaultSensor::FindModel() const {
+      for(UInt32 i = 0; i < m_pcEmbodiedEntity->GetPhysicsModelsNum(); ++i) {
+         CDynamics2DEPuck2Model* pcModel =
+            dynamic_cast<CDynamics2DEPuck2Model*>(&m_pcEmbodiedEntity->GetPhysicsModel(i));
+         if(pcModel != NULL) {
+            return pcModel;
+         }
+      }
+      return NULL;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2AnemometerDefaultSensor::Update() {
+      /* The model can change when the robot moves across engines */
+      CDynamics2DEPuck2Model* pcModel = FindModel();
+      if(pcModel == NULL || pcModel->GetWind() == NULL) {
+         if(!m_bWarned) {
+            EPUCK2_LOG_WARNING("anemometer", "No wind for \"" << m_pcEmbodiedEntity->GetRootEntity().GetId()
+                               << "\": it needs a dynamics2d engine and an <air_resistance> node");
+            m_bWarned = true;
+         }
+         m_sReading = SReading();
+         return;
+      }
+      CDynamics2DEPuck2Wind& cWind = *pcModel->GetWind();
+      UInt32 unBody = pcModel->GetWindIndex();
+      /* Rotate the wind into the robot frame */
+      CRadians cZAngle, cYAngle, cXAngle;
+      m_pcEmbodiedEntity->GetOriginAnchor().Orientation.ToEulerAngles(cZAngle, cYAngle, cXAngle);
+      m_sReading.Wind = cWind.GetEffectiveWind(unBody);
+      m_sReading.Wind.Rotate(-cZAngle);
+      m_sReading.Shielding = cWind.GetShielding(unBody);
+      /* Apply noise to the sensor */
+      if(m_bAddNoise) {
+         m_sReading.Wind += CVector2(m_pcRNG->Uniform(m_cNoiseRange),
+                                     m_pcRNG->Uniform(m_cNoiseRange));
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2AnemometerDefaultSensor::Reset() {
+      m_sReading = SReading();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   REGISTER_SENSOR(CEPuck2AnemometerDefaultSensor,
+                   "epuck2_anemometer", "default",
+                   "Daniel H. Stolfi based on Carlo Pinciroli's work",
+                   "1.0",
+                   "The EPuck2 anemometer sensor.",
+
+                   "This sensor returns the wind felt by the robot, in cm/s, in the frame of\n"
+                   "the robot (X forward, Y to the left), together with how much the robot is\n"
+                   "shielded by the robots upwind, in [0,1]. The wind is computed once per step\n"
+                   "for the whole swarm from the <air_resistance> node of the configuration, so\n"
+                   "the robots do not need to exchange their positions.\n"
+                   "The robot must be simulated by a dynamics2d engine; otherwise the reading\n"
+                   "is always zero. The reading is the one of the last physics step.\n"
+                   "In controllers, you must include the ci_epuck2_anemometer_sensor.h header.\n\n"
+
+                   "REQUIRED XML CONFIGURATION\n\n"
+                   "  <configuration>\n"
+                   "    ...\n"
+                   "    <air_resistance angle_deg=\"0\" magnitude=\"10.0\" />\n"
+                   "  </configuration>\n"
+                   "  ...\n"
+                   "  <controllers>\n"
+                   "    ...\n"
+                   "    <my_controller ...>\n"
+                   "      ...\n"
+                   "      <sensors>\n"
+                   "        ...\n"
+                   "        <epuck2_anemometer implementation=\"default\" />\n"
+                   "        ...\n"
+                   "      </sensors>\n"
+                   "      ...\n"
+                   "    </my_controller>\n"
+                   "    ...\n"
+                   "  </controllers>\n\n"
+
+                   "OPTIONAL XML CONFIGURATION\n\n"
+
+                   "It is possible to add uniform noise to the sensor, thus matching the\n"
+                   "characteristics of a real robot better. This can be done with the attribute\n"
+                   "\"noise_level\", in cm/s, which is added to each component of the wind.\n\n"
+                   "  <controllers>\n"
+                   "    ...\n"
+                   "    <my_controller ...>\n"
+                   "      ...\n"
+                   "      <sensors>\n"
+                   "        ...\n"
+                   "        <epuck2_anemometer implementation=\"default\"\n"
+                   "                           noise_level=\"0.5\" />\n"
+                   "        ...\n"
+                   "      </sensors>\n"
+                   "      ...\n"
+                   "    </my_controller>\n"
+                   "    ...\n"
+                   "  </controllers>\n\n",
+
+                   "Usable"
+		  );
+
+}
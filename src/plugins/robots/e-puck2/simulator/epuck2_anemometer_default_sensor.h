@@ -0,0 +1,75 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/epuck2_anemometer_default_sensor.h>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#ifndef EPUCK2_ANEMOMETER_DEFAULT_SENSOR_H
+#define EPUCK2_ANEMOMETER_DEFAULT_SENSOR_H
+
+namespace argos {
+   class CEPuck2AnemometerDefaultSensor;
+   class CDynamics2DEPuck2Model;
+}
+
+#include "../control_interface/ci_epuck2_anemometer_sensor.h"
+#include <argos3/core/utility/math/range.h>
+#include <argos3/core/utility/math/rng.h>
+#include <argos3/core/simulator/sensor.h>
+#include <argos3/core/simulator/entity/embodied_entity.h>
+
+namespace argos {
+
+   /**
+    * Reads the wind of the robot from the wind of its dynamics2d engine.
+    * <p>
+    * The wind and the shielding of the whole swarm are computed once per
+    * step by CDynamics2DEPuck2Wind, so a reading costs a lookup. The reading
+    * is the one of the last physics step.
+    * </p>
+    */
+   class CEPuck2AnemometerDefaultSensor : public CSimulatedSensor,
+                                          public CCI_EPuck2AnemometerSensor {
+
+   public:
+
+      CEPuck2AnemometerDefaultSensor();
+
+      virtual ~CEPuck2AnemometerDefaultSensor() {}
+
+      virtual void SetRobot(CComposableEntity& c_entity);
+
+      virtual void Init(TConfigurationNode& t_tree);
+
+      virtual void Update();
+
+      virtual void Reset();
+
+   protected:
+
+      /** Finds the dynamics2d model of the robot, NULL if there is none */
+      CDynamics2DEPuck2Model* FindModel() const;
+
+   protected:
+
+      /** Reference to embodied entity associated to this sensor */
+      CEmbodiedEntity* m_pcEmbodiedEntity;
+
+      /** Random number generator */
+      CRandom::CRNG* m_pcRNG;
+
+      /** Whether to add noise or not */
+      bool m_bAddNoise;
+
+      /** Noise range, in cm/s */
+      CRange<Real> m_cNoiseRange;
+
+      /** Whether the missing wind has been reported */
+      bool m_bWarned;
+   };
+
+}
+
+#endif
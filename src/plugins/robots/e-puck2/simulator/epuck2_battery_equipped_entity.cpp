@@ -6,6 +6,7 @@
  * ADARS project -- PCOG / SnT / University of Luxembourg
  */
 #include "epuck2_battery_equipped_entity.h"
+#include "epuck2_snapshot.h"
 
 #include <argos3/core/simulator/simulator.h>
 #include <argos3/core/simulator/space/space.h>
@@ -119,6 +120,32 @@ namespace argos {
    /****************************************/
    /****************************************/
 
+   void CEPuck2BatteryEquippedEntity::SaveState(CEPuck2Snapshot& c_snapshot) {
+      c_snapshot.Write(m_fFullCharge);
+      c_snapshot.Write(m_fAvailableCharge);
+      c_snapshot.Write<UInt8>(m_pcDischargeModel != nullptr);
+      if(m_pcDischargeModel)
+         m_pcDischargeModel->SaveState(c_snapshot);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2BatteryEquippedEntity::LoadState(CEPuck2Snapshot& c_snapshot) {
+      c_snapshot.Read(m_fFullCharge);
+      c_snapshot.Read(m_fAvailableCharge);
+      UInt8 unHasModel;
+      c_snapshot.Read(unHasModel);
+      if(unHasModel != (m_pcDischargeModel != nullptr)) {
+         THROW_ARGOSEXCEPTION("Battery \"" << GetContext() << GetId() << "\": discharge model mismatch in snapshot");
+      }
+      if(m_pcDischargeModel)
+         m_pcDischargeModel->LoadState(c_snapshot);
+   }
+
+   /****************************************/
+   /****************************************/
+
    CEPuck2BatteryDischargeModel::CEPuck2BatteryDischargeModel() :
       m_pcBattery(nullptr) {
    }
@@ -139,6 +166,35 @@ namespace argos {
    /****************************************/
    /****************************************/
 
+   void CEPuck2BatteryDischargeModel::SavePose(CEPuck2Snapshot& c_snapshot,
+                                               const CVector3& c_position,
+                                               const CQuaternion& c_orientation) {
+      c_snapshot.Write(c_position.GetX());
+      c_snapshot.Write(c_position.GetY());
+      c_snapshot.Write(c_position.GetZ());
+      c_snapshot.Write(c_orientation.GetW());
+      c_snapshot.Write(c_orientation.GetX());
+      c_snapshot.Write(c_orientation.GetY());
+      c_snapshot.Write(c_orientation.GetZ());
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2BatteryDischargeModel::LoadPose(CEPuck2Snapshot& c_snapshot,
+                                               CVector3& c_position,
+                                               CQuaternion& c_orientation) {
+      Real pfPose[7];
+      for(UInt32 i = 0; i < 7; ++i) {
+         c_snapshot.Read(pfPose[i]);
+      }
+      c_position.Set(pfPose[0], pfPose[1], pfPose[2]);
+      c_orientation = CQuaternion(pfPose[3], pfPose[4], pfPose[5], pfPose[6]);
+   }
+
+   /****************************************/
+   /****************************************/
+
 
    /****************************************/
    /****************************************/
@@ -12,6 +12,7 @@
 namespace argos {
    class CEPuck2BatteryEquippedEntity;
    class CEPuck2BatteryDischargeModel;
+   class CEPuck2Snapshot;
 }
 
 #include <argos3/core/utility/math/vector3.h>
@@ -85,6 +86,16 @@ namespace argos {
 
       void SetDischargeModel(const std::string& str_model);
 
+      /**
+       * Writes the charge and the discharge model state into a snapshot.
+       */
+      void SaveState(CEPuck2Snapshot& c_snapshot);
+
+      /**
+       * Reads the charge and the discharge model state from a snapshot.
+       */
+      void LoadState(CEPuck2Snapshot& c_snapshot);
+
    protected:
 
       /** Full charge */
@@ -121,8 +132,25 @@ namespace argos {
       virtual void SetBattery(CEPuck2BatteryEquippedEntity* pc_battery);
          
       virtual void operator()() = 0;
+
+      /** Writes the model state into a snapshot */
+      virtual void SaveState(CEPuck2Snapshot& c_snapshot) {}
+
+      /** Reads the model state from a snapshot */
+      virtual void LoadState(CEPuck2Snapshot& c_snapshot) {}
          
    protected:
+
+      /** Writes the last pose seen by a model */
+      static void SavePose(CEPuck2Snapshot& c_snapshot,
+                           const CVector3& c_position,
+                           const CQuaternion& c_orientation);
+
+      /** Reads the last pose seen by a model */
+      static void LoadPose(CEPuck2Snapshot& c_snapshot,
+                           CVector3& c_position,
+                           CQuaternion& c_orientation);
+
       Real MAX_SPEED = 0.15;  // 15 cm/s
       CEPuck2BatteryEquippedEntity* m_pcBattery;
    };
@@ -161,6 +189,14 @@ namespace argos {
       
       virtual void operator()();
 
+      virtual void SaveState(CEPuck2Snapshot& c_snapshot) {
+         SavePose(c_snapshot, m_cOldPosition, m_cOldOrientation);
+      }
+
+      virtual void LoadState(CEPuck2Snapshot& c_snapshot) {
+         LoadPose(c_snapshot, m_cOldPosition, m_cOldOrientation);
+      }
+
    protected:
       
       const SAnchor* m_psAnchor;
@@ -209,6 +245,14 @@ namespace argos {
 
       virtual void operator()();
 
+      virtual void SaveState(CEPuck2Snapshot& c_snapshot) {
+         SavePose(c_snapshot, m_cOldPosition, m_cOldOrientation);
+      }
+
+      virtual void LoadState(CEPuck2Snapshot& c_snapshot) {
+         LoadPose(c_snapshot, m_cOldPosition, m_cOldOrientation);
+      }
+
    protected:
 
       const SAnchor* m_psAnchor;
@@ -311,6 +355,14 @@ namespace argos {
 
       virtual void operator()();
 
+      virtual void SaveState(CEPuck2Snapshot& c_snapshot) {
+         SavePose(c_snapshot, m_cOldPosition, m_cOldOrientation);
+      }
+
+      virtual void LoadState(CEPuck2Snapshot& c_snapshot) {
+         LoadPose(c_snapshot, m_cOldPosition, m_cOldOrientation);
+      }
+
    protected:
 
       const SAnchor* m_psAnchor;
@@ -344,6 +396,14 @@ namespace argos {
 
       virtual void operator()();
 
+      virtual void SaveState(CEPuck2Snapshot& c_snapshot) {
+         SavePose(c_snapshot, m_cOldPosition, m_cOldOrientation);
+      }
+
+      virtual void LoadState(CEPuck2Snapshot& c_snapshot) {
+         LoadPose(c_snapshot, m_cOldPosition, m_cOldOrientation);
+      }
+
    private:
 
       const SAnchor* m_psAnchor;
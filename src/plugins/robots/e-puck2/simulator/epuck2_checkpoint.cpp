@@ -0,0 +1,339 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/epuck2_checkpoint.cpp>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#include "epuck2_checkpoint.h"
+
+#include <argos3/core/simulator/simulator.h>
+#include <argos3/core/simulator/space/space.h>
+#include <argos3/core/utility/math/rng.h>
+#include <argos3/core/utility/string_utilities.h>
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_log.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace argos {
+
+   /****************************************/
+   /****************************************/
+
+   static const UInt32 CHECKPOINT_MAGIC = 0x43325045; // "EP2C"
+   static const UInt32 CHECKPOINT_BYTE_ORDER = 0x01020304;
+
+   static_assert(sizeof(CEPuck2Checkpoint::SHeader) == 64,
+                 "The checkpoint header must be 64 bytes long");
+
+   /****************************************/
+   /****************************************/
+
+   static UInt32 Checksum(const UInt8* pun_data,
+                          size_t un_size) {
+      UInt32 unHash = 2166136261u;
+      for(size_t i = 0; i < un_size; ++i) {
+         unHash = (unHash ^ pun_data[i]) * 16777619u;
+      }
+      return unHash;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CEPuck2Checkpoint::CEPuck2Checkpoint() :
+      m_unPeriod(0),
+      m_bReseed(false),
+      m_bResumePending(false),
+      m_unSeed(0),
+      m_unPendingClock(0),
+      m_bPending(false),
+      m_bStop(false) {}
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Checkpoint::Init(TConfigurationNode& t_tree) {
+      try {
+         CMedium::Init(t_tree);
+         GetNodeAttribute(t_tree, "file", m_strFile);
+         GetNodeAttributeOrDefault(t_tree, "period", m_unPeriod, m_unPeriod);
+         GetNodeAttributeOrDefault(t_tree, "reseed", m_bReseed, m_bReseed);
+         std::string strCategories = "argos";
+         GetNodeAttributeOrDefault(t_tree, "categories", strCategories, strCategories);
+         Tokenize(strCategories, m_vecCategories, ", ");
+         GetNodeAttributeOrDefault(t_tree, "resume", m_bResumePending, m_bResumePending);
+         /* EPUCK2_RESUME=file resumes without editing the configuration */
+         const char* pchResume = ::getenv("EPUCK2_RESUME");
+         if(pchResume != NULL && *pchResume != '\0') {
+            m_strFile = pchResume;
+            m_bResumePending = true;
+         }
+         m_unSeed = CRandom::GetSeedOf("argos");
+         if(m_unPeriod > 0) {
+            m_cWriter = std::thread(&CEPuck2Checkpoint::Write, this);
+         }
+      }
+      catch(CARGoSException& ex) {
+         THROW_ARGOSEXCEPTION_NESTED("Error initializing the e-puck2 checkpoint medium", ex);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Checkpoint::Reset() {
+      /* A reset goes back to the beginning of the experiment, not to the checkpoint */
+      m_bResumePending = false;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Checkpoint::Destroy() {
+      if(m_cWriter.joinable()) {
+         {
+            std::lock_guard<std::mutex> cLock(m_cMutex);
+            m_bStop = true;
+         }
+         m_cCondition.notify_one();
+         /* The writer finishes the pending checkpoint before quitting */
+         m_cWriter.join();
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Checkpoint::Update() {
+      /*
+       * The first step after a resume runs from the initial state up to here,
+       * and is then overwritten by the checkpoint. From here, the step goes on
+       * exactly like the one that wrote the checkpoint.
+       */
+      if(m_bResumePending) {
+         m_bResumePending = false;
+         Resume();
+         return;
+      }
+      UInt32 unClock = CSimulator::GetInstance().GetSpace().GetSimulationClock();
+      if(m_unPeriod == 0 || unClock % m_unPeriod != 0) return;
+      if(m_bReseed) Reseed(unClock);
+      m_cSnapshot.Take();
+      {
+         std::lock_guard<std::mutex> cLock(m_cMutex);
+         /* If the writer is late, the older checkpoint is dropped */
+         m_vecPending = m_cSnapshot.GetData();
+         m_unPendingClock = unClock;
+         m_bPending = true;
+      }
+      m_cCondition.notify_one();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CEPuck2Checkpoint::SHeader CEPuck2Checkpoint::Load(const std::string& str_file,
+                                                      CEPuck2Snapshot& c_snapshot) {
+      int nFD = ::open(str_file.c_str(), O_RDONLY);
+      if(nFD < 0) {
+         THROW_ARGOSEXCEPTION("Cannot open checkpoint \"" << str_file << "\": " << ::strerror(errno));
+      }
+      struct stat sStat;
+      if(::fstat(nFD, &sStat) != 0 || sStat.st_size < static_cast<off_t>(sizeof(SHeader))) {
+         ::close(nFD);
+         THROW_ARGOSEXCEPTION("Checkpoint \"" << str_file << "\" is too short");
+      }
+      void* pvMap = ::mmap(NULL, sStat.st_size, PROT_READ, MAP_PRIVATE, nFD, 0);
+      ::close(nFD);
+      if(pvMap == MAP_FAILED) {
+         THROW_ARGOSEXCEPTION("Cannot map checkpoint \"" << str_file << "\": " << ::strerror(errno));
+      }
+      const UInt8* punData = static_cast<const UInt8*>(pvMap);
+      SHeader sHeader;
+      ::memcpy(&sHeader, punData, sizeof(SHeader));
+      std::string strError;
+      if(sHeader.Magic != CHECKPOINT_MAGIC) {
+         strError = "not an e-puck2 checkpoint";
+      }
+      else if(sHeader.ByteOrder != CHECKPOINT_BYTE_ORDER) {
+         strError = "written on a machine with a different byte order";
+      }
+      else if(sHeader.Version != VERSION) {
+         strError = "unsupported version";
+      }
+      else if(sHeader.HeaderSize < sizeof(SHeader) ||
+              sHeader.HeaderSize + sHeader.PayloadSize != static_cast<UInt64>(sStat.st_size)) {
+         strError = "truncated";
+      }
+      else if(Checksum(punData + sHeader.HeaderSize, sHeader.PayloadSize) != sHeader.Checksum) {
+         strError = "corrupted";
+      }
+      else {
+         c_snapshot.SetData(punData + sHeader.HeaderSize, sHeader.PayloadSize);
+      }
+      ::munmap(pvMap, sStat.st_size);
+      if(!strError.empty()) {
+         THROW_ARGOSEXCEPTION("Checkpoint \"" << str_file << "\": " << strError);
+      }
+      return sHeader;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Checkpoint::Resume() {
+      try {
+         SHeader sHeader = Load(m_strFile, m_cSnapshot);
+         m_cSnapshot.Restore();
+         /* Go on with the seed of the experiment that wrote the checkpoint */
+         m_unSeed = sHeader.Seed;
+         if(m_bReseed) Reseed(sHeader.Clock);
+         EPUCK2_LOG_INFO("checkpoint", "Resumed from \"" << m_strFile << "\" at step " << sHeader.Clock);
+      }
+      catch(CARGoSException& ex) {
+         THROW_ARGOSEXCEPTION_NESTED("Error resuming the e-puck2s", ex);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Checkpoint::Reseed(UInt32 un_clock) {
+      /* The controllers create their categories after the media, so look them up here */
+      if(m_vecSeeds.empty()) {
+         for(size_t i = 0; i < m_vecCategories.size(); ++i) {
+            if(!CRandom::ExistsCategory(m_vecCategories[i])) {
+               THROW_ARGOSEXCEPTION("Cannot reseed the unknown random category \"" << m_vecCategories[i] << "\"");
+            }
+            /* The seed of "argos" comes from the checkpoint when resuming */
+            m_vecSeeds.push_back(m_vecCategories[i] == "argos" ?
+                                 m_unSeed :
+                                 CRandom::GetSeedOf(m_vecCategories[i]));
+         }
+      }
+      for(size_t i = 0; i < m_vecCategories.size(); ++i) {
+         /* Mix the clock into the seed, so that each checkpoint gets its own seed */
+         UInt32 unSeed = m_vecSeeds[i] ^ (un_clock * 2654435761u);
+         CRandom::CCategory& cCategory = CRandom::GetCategory(m_vecCategories[i]);
+         cCategory.SetSeed(unSeed);
+         cCategory.ReseedRNGs();
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Checkpoint::Write() {
+      std::vector<UInt8> vecData;
+      UInt32 unClock;
+      std::unique_lock<std::mutex> cLock(m_cMutex);
+      while(true) {
+         m_cCondition.wait(cLock, [this] { return m_bStop || m_bPending; });
+         if(!m_bPending) return;
+         vecData.swap(m_vecPending);
+         unClock = m_unPendingClock;
+         m_bPending = false;
+         cLock.unlock();
+         WriteFile(vecData, unClock);
+         cLock.lock();
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Checkpoint::WriteFile(const std::vector<UInt8>& vec_data,
+                                     UInt32 un_clock) {
+      SHeader sHeader;
+      ::memset(&sHeader, 0, sizeof(SHeader));
+      sHeader.Magic = CHECKPOINT_MAGIC;
+      sHeader.Version = VERSION;
+      sHeader.ByteOrder = CHECKPOINT_BYTE_ORDER;
+      sHeader.HeaderSize = sizeof(SHeader);
+      sHeader.PayloadSize = vec_data.size();
+      sHeader.Checksum = Checksum(vec_data.data(), vec_data.size());
+      sHeader.Clock = un_clock;
+      sHeader.Seed = m_unSeed;
+      /* Write a temporary file, then replace the checkpoint in one go */
+      std::string strTemp = m_strFile + ".tmp";
+      FILE* pcFile = ::fopen(strTemp.c_str(), "wb");
+      bool bOK = (pcFile != NULL);
+      if(bOK) {
+         bOK = ::fwrite(&sHeader, sizeof(SHeader), 1, pcFile) == 1 &&
+            ::fwrite(vec_data.data(), 1, vec_data.size(), pcFile) == vec_data.size();
+         bOK = (::fflush(pcFile) == 0) && bOK;
+         bOK = (::fsync(::fileno(pcFile)) == 0) && bOK;
+         bOK = (::fclose(pcFile) == 0) && bOK;
+      }
+      if(bOK) {
+         bOK = ::rename(strTemp.c_str(), m_strFile.c_str()) == 0;
+      }
+      if(bOK) {
+         EPUCK2_LOG_DEBUG("checkpoint", "Saved step " << un_clock << " to \"" << m_strFile << "\"");
+      }
+      else {
+         /* This thread cannot throw, the simulation goes on without this checkpoint */
+         EPUCK2_LOG_ERROR("checkpoint", "Cannot write \"" << m_strFile << "\": " << ::strerror(errno));
+         ::remove(strTemp.c_str());
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   REGISTER_MEDIUM(CEPuck2Checkpoint,
+                   "epuck2_checkpoint",
+                   "Daniel H. Stolfi based on the Carlo Pinciroli's work",
+                   "1.0",
+                   "Saves the state of the e-puck2s to a file, and resumes from it.",
+                   "Every 'period' steps, this medium saves the state of all the e-puck2s to a\n"
+                   "checkpoint file: body poses and velocities, wheel speeds, battery charge and\n"
+                   "discharge model state, encoder counts, LED colours, and the state of the\n"
+                   "controllers that implement CEPuck2SnapshotState. The file is written by a\n"
+                   "background thread and replaced atomically.\n"
+                   "With 'resume' set, the experiment continues from the checkpoint: the arena\n"
+                   "is built from the configuration file as usual, then the first step loads\n"
+                   "the checkpoint. The configuration must create the same e-puck2s. Setting the\n"
+                   "EPUCK2_RESUME environment variable to a checkpoint file does the same without\n"
+                   "editing the configuration, e.g.:\n\n"
+                   "  EPUCK2_RESUME=run.ckp argos3 -c experiment.argos\n\n"
+                   "With 'reseed' set, the random number generators of the categories listed in\n"
+                   "'categories' (\"argos\" by default) are reseeded at each checkpoint, so that a\n"
+                   "resumed experiment draws the same numbers. List the categories of the\n"
+                   "controllers too. Reseeding changes the random numbers of the run, so it is\n"
+                   "off by default.\n"
+                   "The medium must be declared first, before the other media.\n\n"
+                   "REQUIRED XML CONFIGURATION\n\n"
+                   "  <media>\n"
+                   "    <epuck2_checkpoint id=\"checkpoint\" file=\"run.ckp\" period=\"10000\" />\n"
+                   "    ...\n"
+                   "  </media>\n\n"
+                   "OPTIONAL XML CONFIGURATION\n\n"
+                   "To reseed the random number generators at each checkpoint:\n\n"
+                   "  <media>\n"
+                   "    <epuck2_checkpoint id=\"checkpoint\" file=\"run.ckp\" period=\"10000\"\n"
+                   "                       reseed=\"true\" categories=\"argos,my_controller\" />\n"
+                   "    ...\n"
+                   "  </media>\n\n"
+                   "To resume an experiment:\n\n"
+                   "  <media>\n"
+                   "    <epuck2_checkpoint id=\"checkpoint\" file=\"run.ckp\" period=\"10000\"\n"
+                   "                       resume=\"true\" />\n"
+                   "    ...\n"
+                   "  </media>\n",
+                   "Usable"
+   );
+
+   /****************************************/
+   /****************************************/
+
+}
@@ -0,0 +1,142 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/epuck2_checkpoint.h>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#ifndef EPUCK2_CHECKPOINT_H
+#define EPUCK2_CHECKPOINT_H
+
+namespace argos {
+   class CEPuck2Checkpoint;
+}
+
+#include <argos3/core/simulator/medium/medium.h>
+#include <argos3/plugins/robots/e-puck2/simulator/epuck2_snapshot.h>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace argos {
+
+   /**
+    * Periodically saves the state of all the e-puck2s to a file, and resumes
+    * an experiment from it.
+    * <p>
+    * Every 'period' steps, the state is taken with CEPuck2Snapshot and handed
+    * to a background thread, which writes it to a temporary file and renames
+    * it over the checkpoint, so that the simulation does not wait for the disk
+    * and a crash never leaves a half-written checkpoint.
+    * </p>
+    * <p>
+    * The file starts with a fixed 64-byte header (SHeader), followed by the
+    * snapshot. It is read back with mmap().
+    * </p>
+    * <p>
+    * The state of the random number generators cannot be read from ARGoS. To
+    * continue with the same random numbers, set 'reseed': the generators of
+    * the categories listed in 'categories' ("argos" by default) are then
+    * reseeded at every checkpoint, from the seed of each category and the
+    * simulation clock. A resumed experiment reseeds them in the same way, so
+    * it produces the same results as the experiment that wrote the
+    * checkpoint. Reseeding changes the random numbers of the run, so it is
+    * off by default.
+    * </p>
+    */
+   class CEPuck2Checkpoint : public CMedium {
+
+   public:
+
+      /** Version of the file layout, bumped when it changes */
+      static const UInt32 VERSION = 1;
+
+      /**
+       * The header of a checkpoint file.
+       */
+      struct SHeader {
+         /** "EP2C" */
+         UInt32 Magic;
+         /** Version of the file layout */
+         UInt32 Version;
+         /** 0x01020304 in the byte order of the writer */
+         UInt32 ByteOrder;
+         /** Size of the header, where the snapshot starts */
+         UInt32 HeaderSize;
+         /** Size of the snapshot */
+         UInt64 PayloadSize;
+         /** FNV-1a hash of the snapshot */
+         UInt32 Checksum;
+         /** Simulation clock of the snapshot */
+         UInt32 Clock;
+         /** Random seed of the experiment */
+         UInt32 Seed;
+         UInt8 Reserved[28];
+      };
+
+   public:
+
+      CEPuck2Checkpoint();
+
+      virtual ~CEPuck2Checkpoint() {}
+
+      virtual void Init(TConfigurationNode& t_tree);
+      virtual void Reset();
+      virtual void Destroy();
+      virtual void Update();
+
+      /**
+       * Loads a checkpoint file into a snapshot.
+       * @param str_file The file.
+       * @param c_snapshot The snapshot to fill.
+       * @return The header of the file.
+       * @throws CARGoSException if the file is not a valid checkpoint.
+       */
+      static SHeader Load(const std::string& str_file,
+                          CEPuck2Snapshot& c_snapshot);
+
+   private:
+
+      /** Resumes the experiment from the checkpoint file */
+      void Resume();
+
+      /** Reseeds the random number generators for the given clock */
+      void Reseed(UInt32 un_clock);
+
+      /** Writes the pending checkpoints in the background */
+      void Write();
+
+      /** Writes a checkpoint to the file */
+      void WriteFile(const std::vector<UInt8>& vec_data,
+                     UInt32 un_clock);
+
+   private:
+
+      std::string m_strFile;
+      UInt32 m_unPeriod;
+      bool m_bReseed;
+      bool m_bResumePending;
+      UInt32 m_unSeed;
+      /* The categories to reseed, and their seeds, taken at the first reseed */
+      std::vector<std::string> m_vecCategories;
+      std::vector<UInt32> m_vecSeeds;
+
+      CEPuck2Snapshot m_cSnapshot;
+
+      /* Background writer */
+      std::thread m_cWriter;
+      std::mutex m_cMutex;
+      std::condition_variable m_cCondition;
+      std::vector<UInt8> m_vecPending;
+      UInt32 m_unPendingClock;
+      bool m_bPending;
+      bool m_bStop;
+
+   };
+
+}
+
+#endif
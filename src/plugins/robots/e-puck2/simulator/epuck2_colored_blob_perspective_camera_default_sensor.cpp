@@ -13,6 +13,7 @@
 #include <argos3/plugins/simulator/entities/led_entity.h>
 #include <argos3/plugins/simulator/media/led_medium.h>
 #include "epuck2_camera_equipped_entity.h"
+#include "epuck2_led_equipped_entity.h"
 
 
 namespace argos {
@@ -57,10 +58,11 @@ namespace argos {
             /* Filter out the LEDs belonging to the sensing entity by checking if they share the same parent entity */
             if(m_pcRootSensingEntity == &c_led.GetRootEntity()) return true;
             /* If we are here, it's because the LED must be processed */
+            const CVector3& cLEDPosition = GetApparentPosition(c_led);
             /* Set the end of the ray for occlusion checking */
-            m_cOcclusionCheckRay.SetEnd(c_led.GetPosition());
+            m_cOcclusionCheckRay.SetEnd(cLEDPosition);
             /* Calculate the vector to LED in the camera-anchor frame of reference */
-            m_cLEDRelative = c_led.GetPosition();
+            m_cLEDRelative = cLEDPosition;
             m_cLEDRelative -= m_cCamEntity.GetPosition();
             m_cLEDRelative.Rotate(m_cInvCameraOrient);
             /* Calculate the projection of the LED vector into the camera direction */
@@ -108,13 +110,36 @@ namespace argos {
                   m_cControllableEntity.AddCheckedRay(
                      false,
                      CRay3(m_cCamEntity.GetPosition(),
-                           c_led.GetPosition()));
+                           cLEDPosition));
                }
             }
          }
          return true;
       }
       
+      /*
+       * Returns the position at which the camera sees the LED.
+       * A collapsed e-puck2 body ring sits at the centre of the ring, so it is
+       * moved to the point of the ring facing the camera. Otherwise, the robot
+       * body would occlude it.
+       */
+      const CVector3& GetApparentPosition(CLEDEntity& c_led) {
+         const CEPuck2LEDEquippedEntity* pcLEDs =
+            CEPuck2LEDEquippedEntity::GetBodyRingOwner(c_led);
+         if(pcLEDs != NULL) {
+            m_cApparentPosition = m_cCamEntity.GetPosition();
+            m_cApparentPosition -= c_led.GetPosition();
+            m_cApparentPosition.SetZ(0.0f);
+            if(m_cApparentPosition.SquareLength() > 0.0f) {
+               m_cApparentPosition.Normalize();
+               m_cApparentPosition *= pcLEDs->GetBodyRingRadius();
+            }
+            m_cApparentPosition += c_led.GetPosition();
+            return m_cApparentPosition;
+         }
+         return c_led.GetPosition();
+      }
+
       void Setup() {
          /* Erase blobs */
          while(! m_tBlobs.empty()) {
@@ -138,6 +163,7 @@ namespace argos {
       CEntity* m_pcRootSensingEntity;
       CRadians m_cTmp1, m_cTmp2;
       CVector3 m_cLEDRelative;
+      CVector3 m_cApparentPosition;
       SEmbodiedEntityIntersectionItem m_sIntersectionItem;
       CRay3 m_cOcclusionCheckRay;
       Real m_fNoiseStdDev;
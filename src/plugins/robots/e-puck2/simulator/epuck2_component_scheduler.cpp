@@ -0,0 +1,205 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/epuck2_component_scheduler.cpp>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#include "epuck2_component_scheduler.h"
+#include "epuck2_entity.h"
+#include "epuck2_led_equipped_entity.h"
+#include "epuck2_tof_equipped_entity.h"
+#include "epuck2_encoder_equipped_entity.h"
+#include "epuck2_battery_equipped_entity.h"
+
+#include <argos3/core/simulator/simulator.h>
+#include <argos3/plugins/simulator/entities/rab_equipped_entity.h>
+#include <argos3/plugins/simulator/media/led_medium.h>
+#include <argos3/plugins/simulator/media/rab_medium.h>
+#include <algorithm>
+
+namespace argos {
+
+   /****************************************/
+   /****************************************/
+
+   CEPuck2ComponentScheduler* CEPuck2ComponentScheduler::m_pcInstance = NULL;
+   std::vector<CEPuck2Entity*> CEPuck2ComponentScheduler::m_vecEntities;
+   bool CEPuck2ComponentScheduler::m_bDirty = true;
+
+   /****************************************/
+   /****************************************/
+
+   CEPuck2ComponentScheduler::CEPuck2ComponentScheduler() {}
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2ComponentScheduler::Init(TConfigurationNode& t_tree) {
+      try {
+         CMedium::Init(t_tree);
+         if(m_pcInstance != NULL) {
+            THROW_ARGOSEXCEPTION("Only one epuck2_components medium is allowed");
+         }
+         /* The media are initialized and updated in the order they are declared,
+            so those already here would index the components before they move */
+         CMedium::TVector& tMedia = CSimulator::GetInstance().GetMedia();
+         for(size_t i = 0; i < tMedia.size(); ++i) {
+            if(dynamic_cast<CLEDMedium*>(tMedia[i]) != NULL ||
+               dynamic_cast<CRABMedium*>(tMedia[i]) != NULL) {
+               THROW_ARGOSEXCEPTION("The medium \"" << tMedia[i]->GetId() <<
+                                    "\" is declared before \"" << GetId() <<
+                                    "\": declare the epuck2_components medium before the LED and range-and-bearing media");
+            }
+         }
+         /* By default, use as many threads as the simulator */
+         UInt32 unThreads = CSimulator::GetInstance().GetNumThreads();
+         GetNodeAttributeOrDefault(t_tree, "threads", unThreads, unThreads);
+         UInt32 unChunkSize = 64;
+         GetNodeAttributeOrDefault(t_tree, "chunk_size", unChunkSize, unChunkSize);
+         if(unChunkSize == 0) {
+            THROW_ARGOSEXCEPTION("The chunk size must be positive");
+         }
+         m_cThreadPool.Start(unThreads, unChunkSize);
+         m_pcInstance = this;
+         m_bDirty = true;
+      }
+      catch(CARGoSException& ex) {
+         THROW_ARGOSEXCEPTION_NESTED("Error initializing the e-puck2 component scheduler", ex);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2ComponentScheduler::PostSpaceInit() {
+      /* The e-puck2s created before this medium updated themselves */
+      Update();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2ComponentScheduler::Reset() {
+      Update();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2ComponentScheduler::Destroy() {
+      m_cThreadPool.Stop();
+      if(m_pcInstance == this) {
+         m_pcInstance = NULL;
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2ComponentScheduler::Update() {
+      if(m_bDirty) Rebuild();
+      UpdateAll(m_vecRABs);
+      UpdateAll(m_vecLEDs);
+      UpdateAll(m_vecTOFs);
+      UpdateAll(m_vecEncoders);
+      UpdateAll(m_vecBatteries);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2ComponentScheduler::Register(CEPuck2Entity& c_entity) {
+      m_vecEntities.push_back(&c_entity);
+      m_bDirty = true;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2ComponentScheduler::Unregister(CEPuck2Entity& c_entity) {
+      std::vector<CEPuck2Entity*>::iterator it =
+         std::find(m_vecEntities.begin(), m_vecEntities.end(), &c_entity);
+      if(it != m_vecEntities.end()) {
+         m_vecEntities.erase(it);
+         m_bDirty = true;
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2ComponentScheduler::Rebuild() {
+      m_vecRABs.clear();
+      m_vecLEDs.clear();
+      m_vecTOFs.clear();
+      m_vecEncoders.clear();
+      m_vecBatteries.clear();
+      for(size_t i = 0; i < m_vecEntities.size(); ++i) {
+         CEPuck2Entity& cEntity = *m_vecEntities[i];
+         if(cEntity.HasRABEquippedEntity())
+            m_vecRABs.push_back(&cEntity.GetRABEquippedEntity());
+         if(cEntity.HasLEDEquippedEntity())
+            m_vecLEDs.push_back(&cEntity.GetLEDEquippedEntity());
+         if(cEntity.HasEPuck2TOFEquippedEntity())
+            m_vecTOFs.push_back(&cEntity.GetEPuck2TOFEquippedEntity());
+         if(cEntity.HasEPuck2EncoderEquippedEntity())
+            m_vecEncoders.push_back(&cEntity.GetEPuck2EncoderEquippedEntity());
+         if(cEntity.HasBatterySensorEquippedEntity())
+            m_vecBatteries.push_back(&cEntity.GetBatterySensorEquippedEntity());
+      }
+      m_bDirty = false;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2ComponentScheduler::UpdateAll(const std::vector<CEntity*>& vec_entities) {
+      m_cThreadPool.ParallelFor(vec_entities.size(),
+                                [&vec_entities](size_t un_begin, size_t un_end) {
+                                   for(size_t i = un_begin; i < un_end; ++i) {
+                                      if(vec_entities[i]->IsEnabled()) vec_entities[i]->Update();
+                                   }
+                                });
+   }
+
+   /****************************************/
+   /****************************************/
+
+   REGISTER_MEDIUM(CEPuck2ComponentScheduler,
+                   "epuck2_components",
+                   "Daniel H. Stolfi based on the Carlo Pinciroli's work",
+                   "1.0",
+                   "Updates the components of all the e-puck2s in bulk.",
+                   "Every simulation step, each e-puck2 updates the position and state of its\n"
+                   "range-and-bearing, LED, ToF, encoder and battery entities. When this medium\n"
+                   "is present, the e-puck2s skip that step, and the medium updates each type of\n"
+                   "component for the whole swarm in one pass, split in chunks among a pool of\n"
+                   "threads. This is faster with large swarms.\n"
+                   "The media are updated in the order they are declared, so this medium must be\n"
+                   "declared before the LED and range-and-bearing media, otherwise the simulation\n"
+                   "does not start.\n\n"
+                   "REQUIRED XML CONFIGURATION\n\n"
+                   "  <media>\n"
+                   "    ...\n"
+                   "    <epuck2_components id=\"components\" />\n"
+                   "    <led id=\"leds\" />\n"
+                   "    ...\n"
+                   "  </media>\n\n"
+                   "OPTIONAL XML CONFIGURATION\n\n"
+                   "The 'threads' attribute sets the number of threads, including the main one.\n"
+                   "By default, it is the number of threads of the simulator. The 'chunk_size'\n"
+                   "attribute sets how many robots a thread updates at a time, 64 by default:\n\n"
+                   "  <media>\n"
+                   "    ...\n"
+                   "    <epuck2_components id=\"components\" threads=\"4\" chunk_size=\"128\" />\n"
+                   "    ...\n"
+                   "  </media>\n",
+                   "Usable"
+   );
+
+   /****************************************/
+   /****************************************/
+
+}
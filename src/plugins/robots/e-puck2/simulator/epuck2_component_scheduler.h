@@ -0,0 +1,100 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/epuck2_component_scheduler.h>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#ifndef EPUCK2_COMPONENT_SCHEDULER_H
+#define EPUCK2_COMPONENT_SCHEDULER_H
+
+namespace argos {
+   class CEPuck2ComponentScheduler;
+   class CEPuck2Entity;
+   class CEntity;
+}
+
+#include <argos3/core/simulator/medium/medium.h>
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_thread_pool.h>
+#include <vector>
+
+namespace argos {
+
+   /**
+    * Updates the components of all the e-puck2s in bulk.
+    * <p>
+    * Without this medium, each e-puck2 updates its range-and-bearing, LED, ToF,
+    * encoder and battery entities when the physics engine updates it. With this
+    * medium, the e-puck2s skip that step, and the medium updates each component
+    * type for the whole swarm in one pass, split in chunks among a pool of
+    * worker threads.
+    * </p>
+    * <p>
+    * The media are updated in the order they are declared, so this medium must
+    * come before the LED and range-and-bearing media.
+    * </p>
+    */
+   class CEPuck2ComponentScheduler : public CMedium {
+
+   public:
+
+      CEPuck2ComponentScheduler();
+
+      virtual ~CEPuck2ComponentScheduler() {}
+
+      virtual void Init(TConfigurationNode& t_tree);
+      virtual void PostSpaceInit();
+      virtual void Reset();
+      virtual void Destroy();
+      virtual void Update();
+
+      /**
+       * Returns <tt>true</tt> if the components are updated by the scheduler.
+       */
+      static inline bool IsActive() {
+         return m_pcInstance != NULL;
+      }
+
+      /**
+       * Adds an e-puck2 to the swarm.
+       * Called by the e-puck2 when it is created.
+       */
+      static void Register(CEPuck2Entity& c_entity);
+
+      /**
+       * Removes an e-puck2 from the swarm.
+       * Called by the e-puck2 when it is destroyed.
+       */
+      static void Unregister(CEPuck2Entity& c_entity);
+
+   private:
+
+      /** Rebuilds the per-type component lists */
+      void Rebuild();
+
+      /** Updates the enabled entities of a list */
+      void UpdateAll(const std::vector<CEntity*>& vec_entities);
+
+   private:
+
+      static CEPuck2ComponentScheduler* m_pcInstance;
+
+      /* All the e-puck2s, shared by the instances */
+      static std::vector<CEPuck2Entity*> m_vecEntities;
+      static bool m_bDirty;
+
+      /* The components, one list per type */
+      std::vector<CEntity*> m_vecRABs;
+      std::vector<CEntity*> m_vecLEDs;
+      std::vector<CEntity*> m_vecTOFs;
+      std::vector<CEntity*> m_vecEncoders;
+      std::vector<CEntity*> m_vecBatteries;
+
+      CEPuck2ThreadPool m_cThreadPool;
+
+   };
+
+}
+
+#endif
@@ -13,6 +13,7 @@
 #include <argos3/core/simulator/entity/embodied_entity.h>
 
 #include "epuck2_encoder_equipped_entity.h"
+#include "epuck2_snapshot.h"
 
 namespace argos {
 
@@ -113,6 +114,24 @@ namespace argos {
    /****************************************/
    /****************************************/
 
+   void CEPuck2EncoderDefaultSensor::SaveState(CEPuck2Snapshot& c_snapshot) {
+      c_snapshot.Write(m_fLeft);
+      c_snapshot.Write(m_fRight);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2EncoderDefaultSensor::LoadState(CEPuck2Snapshot& c_snapshot) {
+      c_snapshot.Read(m_fLeft);
+      c_snapshot.Read(m_fRight);
+      m_tReadings.EncoderLeftWheel = int(floor(m_fLeft));
+      m_tReadings.EncoderRightWheel = int(floor(m_fRight));
+   }
+
+   /****************************************/
+   /****************************************/
+
    REGISTER_SENSOR(CEPuck2EncoderDefaultSensor,
                    "epuck2_encoder", "default",
                    "Daniel H. Stolfi based on Carlo Pinciroli's work",
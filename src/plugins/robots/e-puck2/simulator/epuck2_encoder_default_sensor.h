@@ -15,6 +15,7 @@
 namespace argos {
    class CEPuck2EncoderSensor;
    class CEPuck2EncoderEquippedEntity;
+   class CEPuck2Snapshot;
 }
 
 #include "../control_interface/ci_epuck2_encoder_sensor.h"
@@ -42,6 +43,16 @@ namespace argos {
 
       virtual void Reset();
 
+      /**
+       * Writes the encoder counts into a snapshot.
+       */
+      void SaveState(CEPuck2Snapshot& c_snapshot);
+
+      /**
+       * Reads the encoder counts from a snapshot.
+       */
+      void LoadState(CEPuck2Snapshot& c_snapshot);
+
    protected:
 
       /** Reference to embodied entity associated to this sensor */
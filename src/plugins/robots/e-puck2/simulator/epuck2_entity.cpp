@@ -9,6 +9,7 @@
 #include "epuck2_entity.h"
 
 #include <argos3/core/utility/math/matrix/rotationmatrix3.h>
+#include <argos3/core/simulator/simulator.h>
 #include <argos3/core/simulator/space/space.h>
 #include <argos3/core/simulator/entity/controllable_entity.h>
 #include <argos3/core/simulator/entity/embodied_entity.h>
@@ -19,42 +20,98 @@
 #include <argos3/plugins/simulator/entities/proximity_sensor_equipped_entity.h>
 #include <argos3/plugins/simulator/entities/proximity_sensor_equipped_entity.h>
 
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_layout.h>
+
 #include "epuck2_led_equipped_entity.h"
 #include "epuck2_tof_equipped_entity.h"
 #include "epuck2_encoder_equipped_entity.h"
 #include "epuck2_battery_equipped_entity.h"
 #include "epuck2_camera_equipped_entity.h"
+#include "epuck2_component_scheduler.h"
 
 namespace argos {
 
    /****************************************/
    /****************************************/
 
-   static const Real BODY_RADIUS                = 0.035f;
-
-   static const Real INTERWHEEL_DISTANCE        = 0.053f;
-   static const Real HALF_INTERWHEEL_DISTANCE   = INTERWHEEL_DISTANCE * 0.5f;
-   static const Real WHEEL_RADIUS               = 0.0205f;
-
-   static const Real PROXIMITY_SENSOR_RING_ELEVATION       = 0.043f;
-   static const Real PROXIMITY_SENSOR_RING_RADIUS          = BODY_RADIUS+0.001f;
-   static const Real PROXIMITY_SENSOR_RING_RANGE           = 0.05f;
-   static const Real LIGHT_SENSOR_RING_RANGE               = 0.50f;
-
-   static const CRadians LED_RING_START_ANGLE   = CRadians::ZERO;
-   static const Real LED_RING_RADIUS            = BODY_RADIUS + 0.002;
-   static const Real LED_RING_ELEVATION         = 0.048f;
-   static const Real RAB_ELEVATION              = LED_RING_ELEVATION;
+   static const Real HALF_INTERWHEEL_DISTANCE = SEPuck2Layout::INTERWHEEL_DISTANCE * 0.5f;
+
+   /*
+    * The components each sensor or actuator needs.
+    * Devices not listed here make the robot build all the components.
+    */
+   struct SDeviceComponents {
+      const char* Device;
+      UInt32 Components;
+   };
+
+   static const SDeviceComponents DEVICE_COMPONENTS[] = {
+      { "differential_steering",                  0                                  },
+      { "positioning",                            0                                  },
+      { "epuck2_leds",                            CEPuck2Entity::COMPONENT_LEDS      },
+      { "epuck2_proximity",                       CEPuck2Entity::COMPONENT_PROXIMITY },
+      { "proximity",                              CEPuck2Entity::COMPONENT_PROXIMITY },
+      { "epuck2_light",                           CEPuck2Entity::COMPONENT_LIGHT     },
+      { "light",                                  CEPuck2Entity::COMPONENT_LIGHT     },
+      { "epuck2_tof",                             CEPuck2Entity::COMPONENT_TOF       },
+      { "epuck2_ground",                          CEPuck2Entity::COMPONENT_GROUND    },
+      { "ground",                                 CEPuck2Entity::COMPONENT_GROUND    },
+      { "epuck2_encoder",                         CEPuck2Entity::COMPONENT_ENCODER   },
+      { "range_and_bearing",                      CEPuck2Entity::COMPONENT_RAB       },
+      { "epuck2_colored_blob_perspective_camera", CEPuck2Entity::COMPONENT_CAMERA    },
+      { "colored_blob_perspective_camera",        CEPuck2Entity::COMPONENT_CAMERA    },
+      { "epuck2_battery",                         CEPuck2Entity::COMPONENT_BATTERY   },
+      { "epuck2_anemometer",                      0                                  }
+   };
+
+   static UInt32 GetDeviceComponents(TConfigurationNode& t_devices) {
+      UInt32 unComponents = 0;
+      TConfigurationNodeIterator itDevice;
+      for(itDevice = itDevice.begin(&t_devices);
+          itDevice != itDevice.end();
+          ++itDevice) {
+         UInt32 i = 0;
+         while(i < sizeof(DEVICE_COMPONENTS) / sizeof(SDeviceComponents) &&
+               itDevice->Value() != DEVICE_COMPONENTS[i].Device) {
+            ++i;
+         }
+         if(i == sizeof(DEVICE_COMPONENTS) / sizeof(SDeviceComponents)) {
+            /* Unknown device, better safe than sorry */
+            return CEPuck2Entity::COMPONENT_ALL;
+         }
+         unComponents |= DEVICE_COMPONENTS[i].Components;
+      }
+      return unComponents;
+   }
 
-   static const Real TOF_SENSOR_RANGE     = 2.0f;
-   static const Real TOF_SENSOR_ELEVATION = 0.036f;
-   static const Real TOF_SENSOR_OFFSET    = BODY_RADIUS - 0.003f;
+   /****************************************/
+   /****************************************/
 
-   static const Real GREEN_LED_ELEVATION = PROXIMITY_SENSOR_RING_ELEVATION;
+   UInt32 CEPuck2Entity::GetRequiredComponents(const std::string& str_controller_id) {
+      TConfigurationNode& tRoot = CSimulator::GetInstance().GetConfigurationRoot();
+      if(! NodeExists(tRoot, "controllers")) return COMPONENT_ALL;
+      TConfigurationNode& tControllers = GetNode(tRoot, "controllers");
+      TConfigurationNodeIterator itController;
+      for(itController = itController.begin(&tControllers);
+          itController != itController.end();
+          ++itController) {
+         std::string strId;
+         GetNodeAttributeOrDefault(*itController, "id", strId, strId);
+         if(strId == str_controller_id) {
+            UInt32 unComponents = 0;
+            if(NodeExists(*itController, "sensors")) {
+               unComponents |= GetDeviceComponents(GetNode(*itController, "sensors"));
+            }
+            if(NodeExists(*itController, "actuators")) {
+               unComponents |= GetDeviceComponents(GetNode(*itController, "actuators"));
+            }
+            return unComponents;
+         }
+      }
+      /* The controllable entity will complain about the missing controller */
+      return COMPONENT_ALL;
+   }
 
-   static const Real RED_LED_ELEVATION   = 0.032f;
-   static const Real RED_LED_SIDE        = -0.01f;
-   static const Real RED_LED_POS         = 0.0345f;
    /****************************************/
    /****************************************/
 
@@ -71,7 +128,8 @@ namespace argos {
       m_pcPerspectiveCameraEquippedEntity(NULL),
       m_pcWheeledEntity(NULL),
       m_pcBatteryEquippedEntity(NULL),
-      m_pcEPuck2EncoderEquippedEntity(NULL) {
+      m_pcEPuck2EncoderEquippedEntity(NULL),
+      m_unComponents(COMPONENT_ALL) {
    }
 
    /****************************************/
@@ -86,7 +144,9 @@ namespace argos {
                               const std::string& str_bat_model,
                               const CRadians& c_perspcam_aperture,
                               Real f_perspcam_focal_length,
-                              Real f_perspcam_range) :
+                              Real f_perspcam_range,
+                              bool b_single_body_led,
+                              bool b_lazy_components) :
       CComposableEntity(NULL, str_id),
       m_pcControllableEntity(NULL),
       m_pcEmbodiedEntity(NULL),
@@ -99,8 +159,16 @@ namespace argos {
       m_pcPerspectiveCameraEquippedEntity(NULL),
       m_pcWheeledEntity(NULL),
       m_pcBatteryEquippedEntity(NULL),
-      m_pcEPuck2EncoderEquippedEntity(NULL) {
+      m_pcEPuck2EncoderEquippedEntity(NULL),
+      m_unComponents(COMPONENT_ALL) {
       try {
+         /*
+          * Create only the components the controller needs
+          */
+         if(b_lazy_components) {
+            m_unComponents = GetRequiredComponents(str_controller_id);
+            if(! str_bat_model.empty()) m_unComponents |= COMPONENT_BATTERY;
+         }
          /*
           * Create and init components
           */
@@ -110,105 +178,108 @@ namespace argos {
          /* Wheeled entity and wheel positions (left, right) */
          m_pcWheeledEntity = new CWheeledEntity(this, "wheels_0", 2);
          AddComponent(*m_pcWheeledEntity);
-         m_pcWheeledEntity->SetWheel(0, CVector3(0.0f,  HALF_INTERWHEEL_DISTANCE, 0.0f), WHEEL_RADIUS);
-         m_pcWheeledEntity->SetWheel(1, CVector3(0.0f, -HALF_INTERWHEEL_DISTANCE, 0.0f), WHEEL_RADIUS);
+         m_pcWheeledEntity->SetWheel(0, CVector3(0.0f,  HALF_INTERWHEEL_DISTANCE, 0.0f), SEPuck2Layout::WHEEL_RADIUS);
+         m_pcWheeledEntity->SetWheel(1, CVector3(0.0f, -HALF_INTERWHEEL_DISTANCE, 0.0f), SEPuck2Layout::WHEEL_RADIUS);
          /* LED equipped entity */
-         m_pcEPuck2LEDEquippedEntity = new CEPuck2LEDEquippedEntity(this, "leds_0");
-         AddComponent(*m_pcEPuck2LEDEquippedEntity);
-         m_pcEPuck2LEDEquippedEntity->AddLEDs(CVector3(0.0f, 0.0f, LED_RING_ELEVATION),
-                                              LED_RING_RADIUS,
-                                              LED_RING_START_ANGLE,
-                                              8,
-                                              CVector3(0.0f, 0.0f, GREEN_LED_ELEVATION),
-                                              CVector3(RED_LED_POS, RED_LED_SIDE, RED_LED_ELEVATION),
-                                              m_pcEmbodiedEntity->GetOriginAnchor());
+         if(m_unComponents & COMPONENT_LEDS) {
+            m_pcEPuck2LEDEquippedEntity = new CEPuck2LEDEquippedEntity(this, "leds_0");
+            AddComponent(*m_pcEPuck2LEDEquippedEntity);
+            m_pcEPuck2LEDEquippedEntity->AddLEDs(CVector3(0.0f, 0.0f, SEPuck2Layout::LED_RING_ELEVATION),
+                                                 SEPuck2Layout::LED_RING_RADIUS,
+                                                 CRadians::ZERO,
+                                                 SEPuck2Layout::NUM_RING_LEDS,
+                                                 CVector3(0.0f, 0.0f, SEPuck2Layout::BODY_LED_ELEVATION),
+                                                 CVector3(SEPuck2Layout::FRONT_LED_X,
+                                                          SEPuck2Layout::FRONT_LED_Y,
+                                                          SEPuck2Layout::FRONT_LED_ELEVATION),
+                                                 m_pcEmbodiedEntity->GetOriginAnchor(),
+                                                 b_single_body_led);
+         }
          /* Proximity sensor equipped entity */
-         m_pcProximitySensorEquippedEntity = new CProximitySensorEquippedEntity(this, "proximity_0");
-         AddComponent(*m_pcProximitySensorEquippedEntity);
-
-         m_pcLightSensorEquippedEntity = new CLightSensorEquippedEntity(this, "light_0");
-         AddComponent(*m_pcLightSensorEquippedEntity);
-
-         CRadians sensor_angle[8];
-         sensor_angle[0] = -CRadians::PI / 10.5884f;
-         sensor_angle[1] = -CRadians::PI / 3.5999f;
-         sensor_angle[2] = -CRadians::PI_OVER_TWO; //side sensor
-         sensor_angle[3] = -CRadians::PI / 1.2f; // back sensor
-         sensor_angle[4] = CRadians::PI / 1.2f;  // back sensor
-         sensor_angle[5] = CRadians::PI_OVER_TWO; //side sensor
-         sensor_angle[6] = CRadians::PI / 3.5999f;
-         sensor_angle[7] = CRadians::PI / 10.5884f;
-
-         CRadians cAngle;
-         CVector3 cOff, cDir, c_center = CVector3(0.0f, 0.0f, PROXIMITY_SENSOR_RING_ELEVATION);
-         for(UInt32 i = 0; i < 8; ++i) {
-            cAngle = sensor_angle[i];
-            cAngle.SignedNormalize();
-            cOff.Set(PROXIMITY_SENSOR_RING_RADIUS, 0.0f, 0.0f);
-            cOff.RotateZ(cAngle);
-            cOff += c_center;
-            cDir.Set(PROXIMITY_SENSOR_RING_RANGE, 0.0f, 0.0f);
-            cDir.RotateZ(cAngle);
-            m_pcProximitySensorEquippedEntity->AddSensor(cOff, cDir, PROXIMITY_SENSOR_RING_RANGE, m_pcEmbodiedEntity->GetOriginAnchor());
-            m_pcLightSensorEquippedEntity->AddSensor(cOff, cDir, LIGHT_SENSOR_RING_RANGE, m_pcEmbodiedEntity->GetOriginAnchor());
+         if(m_unComponents & COMPONENT_PROXIMITY) {
+            m_pcProximitySensorEquippedEntity = new CProximitySensorEquippedEntity(this, "proximity_0");
+            AddComponent(*m_pcProximitySensorEquippedEntity);
+         }
+         /* Light sensor equipped entity */
+         if(m_unComponents & COMPONENT_LIGHT) {
+            m_pcLightSensorEquippedEntity = new CLightSensorEquippedEntity(this, "light_0");
+            AddComponent(*m_pcLightSensorEquippedEntity);
+         }
+
+         const SEPuck2Layout::SRingSensor* psRing = SEPuck2Layout::GetRingSensors();
+         for(UInt32 i = 0; i < SEPuck2Layout::NUM_RING_SENSORS; ++i) {
+            CVector3 cDir = psRing[i].Direction * SEPuck2Layout::PROXIMITY_RANGE;
+            if(m_pcProximitySensorEquippedEntity != NULL) {
+               m_pcProximitySensorEquippedEntity->AddSensor(psRing[i].Offset, cDir, SEPuck2Layout::PROXIMITY_RANGE, m_pcEmbodiedEntity->GetOriginAnchor());
+            }
+            if(m_pcLightSensorEquippedEntity != NULL) {
+               m_pcLightSensorEquippedEntity->AddSensor(psRing[i].Offset, cDir, SEPuck2Layout::LIGHT_RANGE, m_pcEmbodiedEntity->GetOriginAnchor());
+            }
          }
 
          /* TOF equipped entity */
-         m_pcEPuck2TOFEquippedEntity = new CEPuck2TOFEquippedEntity(this, "tof_0");
-         AddComponent(*m_pcEPuck2TOFEquippedEntity);
-         cOff = CVector3(0.0f, 0.0f, TOF_SENSOR_ELEVATION);
-         cDir = CVector3(0.0f, 0.0f, TOF_SENSOR_ELEVATION);
-         c_center = CVector3(0.0f, 0.0f, TOF_SENSOR_ELEVATION);
-         cOff.Set(TOF_SENSOR_OFFSET, 0.0f, 0.0f);
-         cOff += c_center;
-         cDir.Set(TOF_SENSOR_RANGE, 0.0f, 0.0f);
-         m_pcEPuck2TOFEquippedEntity->AddSensor(cOff, cDir, TOF_SENSOR_RANGE, m_pcEmbodiedEntity->GetOriginAnchor());
+         if(m_unComponents & COMPONENT_TOF) {
+            m_pcEPuck2TOFEquippedEntity = new CEPuck2TOFEquippedEntity(this, "tof_0");
+            AddComponent(*m_pcEPuck2TOFEquippedEntity);
+            m_pcEPuck2TOFEquippedEntity->AddSensor(CVector3(SEPuck2Layout::TOF_OFFSET, 0.0f, SEPuck2Layout::TOF_ELEVATION),
+                                                   CVector3(SEPuck2Layout::TOF_RANGE, 0.0f, 0.0f),
+                                                   SEPuck2Layout::TOF_RANGE,
+                                                   m_pcEmbodiedEntity->GetOriginAnchor());
+         }
 
          /* Ground sensor equipped entity */
-         m_pcGroundSensorEquippedEntity = new CGroundSensorEquippedEntity(this, "ground_0");
-         AddComponent(*m_pcGroundSensorEquippedEntity);
-         m_pcGroundSensorEquippedEntity->AddSensor(CVector2(0.03f, -0.009f),
-                                                   CGroundSensorEquippedEntity::TYPE_GRAYSCALE,
-                                                   m_pcEmbodiedEntity->GetOriginAnchor());
-         m_pcGroundSensorEquippedEntity->AddSensor(CVector2(0.03f,  0.0f),
-                                                   CGroundSensorEquippedEntity::TYPE_GRAYSCALE,
-                                                   m_pcEmbodiedEntity->GetOriginAnchor());
-         m_pcGroundSensorEquippedEntity->AddSensor(CVector2(0.03f,  0.009f),
-                                                   CGroundSensorEquippedEntity::TYPE_GRAYSCALE,
-                                                   m_pcEmbodiedEntity->GetOriginAnchor());
+         if(m_unComponents & COMPONENT_GROUND) {
+            m_pcGroundSensorEquippedEntity = new CGroundSensorEquippedEntity(this, "ground_0");
+            AddComponent(*m_pcGroundSensorEquippedEntity);
+            for(UInt32 i = 0; i < SEPuck2Layout::NUM_GROUND_SENSORS; ++i) {
+               m_pcGroundSensorEquippedEntity->AddSensor(CVector2(SEPuck2Layout::GROUND_SENSOR_OFFSETS[i][0],
+                                                                  SEPuck2Layout::GROUND_SENSOR_OFFSETS[i][1]),
+                                                         CGroundSensorEquippedEntity::TYPE_GRAYSCALE,
+                                                         m_pcEmbodiedEntity->GetOriginAnchor());
+            }
+         }
          /* Encoder sensor equipped entity */
-         m_pcEPuck2EncoderEquippedEntity = new CEPuck2EncoderEquippedEntity(this, "encoder_0");
-         AddComponent(*m_pcEPuck2EncoderEquippedEntity);
-         m_pcEPuck2EncoderEquippedEntity->AddSensor(*m_pcWheeledEntity);
+         if(m_unComponents & COMPONENT_ENCODER) {
+            m_pcEPuck2EncoderEquippedEntity = new CEPuck2EncoderEquippedEntity(this, "encoder_0");
+            AddComponent(*m_pcEPuck2EncoderEquippedEntity);
+            m_pcEPuck2EncoderEquippedEntity->AddSensor(*m_pcWheeledEntity);
+         }
          /* RAB equipped entity */
-         m_pcRABEquippedEntity = new CRABEquippedEntity(this,
-                                                        "rab_0",
-                                                        un_rab_data_size,
-                                                        f_rab_range,
-                                                        m_pcEmbodiedEntity->GetOriginAnchor(),
-                                                        *m_pcEmbodiedEntity,
-                                                        CVector3(0.0f, 0.0f, RAB_ELEVATION));
-         AddComponent(*m_pcRABEquippedEntity);
+         if(m_unComponents & COMPONENT_RAB) {
+            m_pcRABEquippedEntity = new CRABEquippedEntity(this,
+                                                           "rab_0",
+                                                           un_rab_data_size,
+                                                           f_rab_range,
+                                                           m_pcEmbodiedEntity->GetOriginAnchor(),
+                                                           *m_pcEmbodiedEntity,
+                                                           CVector3(0.0f, 0.0f, SEPuck2Layout::RAB_ELEVATION));
+            AddComponent(*m_pcRABEquippedEntity);
+         }
          /* Perspective camera equipped entity */
-         m_pcEmbodiedEntity->EnableAnchor("perspective_camera");
-         m_pcPerspectiveCameraEquippedEntity = new CEPuck2CameraEquippedEntity(this,
-                                                                                    "perspective_camera_0",
-                                                                                    c_perspcam_aperture,
-                                                                                    f_perspcam_focal_length,
-                                                                                    f_perspcam_range,
-                                                                                    160, 120,
-                                                                                    m_pcEmbodiedEntity->GetOriginAnchor());
-         AddComponent(*m_pcPerspectiveCameraEquippedEntity);
+         if(m_unComponents & COMPONENT_CAMERA) {
+            m_pcEmbodiedEntity->EnableAnchor("perspective_camera");
+            m_pcPerspectiveCameraEquippedEntity = new CEPuck2CameraEquippedEntity(this,
+                                                                                  "perspective_camera_0",
+                                                                                  c_perspcam_aperture,
+                                                                                  f_perspcam_focal_length,
+                                                                                  f_perspcam_range,
+                                                                                  160, 120,
+                                                                                  m_pcEmbodiedEntity->GetOriginAnchor());
+            AddComponent(*m_pcPerspectiveCameraEquippedEntity);
+         }
          /* Battery equipped entity */
-         m_pcBatteryEquippedEntity = new CEPuck2BatteryEquippedEntity(this, "battery_0", str_bat_model);
-         AddComponent(*m_pcBatteryEquippedEntity);
+         if(m_unComponents & COMPONENT_BATTERY) {
+            m_pcBatteryEquippedEntity = new CEPuck2BatteryEquippedEntity(this, "battery_0", str_bat_model);
+            AddComponent(*m_pcBatteryEquippedEntity);
+         }
          /* Controllable entity
             It must be the last one, for actuators/sensors to link to composing entities correctly */
          m_pcControllableEntity = new CControllableEntity(this, "controller_0");
          AddComponent(*m_pcControllableEntity);
          m_pcControllableEntity->SetController(str_controller_id);
          /* Update components */
-         UpdateComponents();
+         UpdateComponentsNow();
+         CEPuck2ComponentScheduler::Register(*this);
       }
       catch(CARGoSException& ex) {
          THROW_ARGOSEXCEPTION_NESTED("Failed to initialize entity \"" << GetId() << "\".", ex);
@@ -224,6 +295,18 @@ namespace argos {
           * Init parent
           */
          CComposableEntity::Init(t_tree);
+         /*
+          * Create only the components the controller needs
+          */
+         bool bLazyComponents = false;
+         GetNodeAttributeOrDefault(t_tree, "lazy_components", bLazyComponents, bLazyComponents);
+         if(bLazyComponents) {
+            std::string strController;
+            GetNodeAttribute(GetNode(t_tree, "controller"), "config", strController);
+            m_unComponents = GetRequiredComponents(strController);
+            /* An explicitly configured battery is always built */
+            if(NodeExists(t_tree, "epuck2_battery")) m_unComponents |= COMPONENT_BATTERY;
+         }
          /*
           * Create and init components
           */
@@ -234,111 +317,119 @@ namespace argos {
          /* Wheeled entity and wheel positions (left, right) */
          m_pcWheeledEntity = new CWheeledEntity(this, "wheels_0", 2);
          AddComponent(*m_pcWheeledEntity);
-         m_pcWheeledEntity->SetWheel(0, CVector3(0.0f,  HALF_INTERWHEEL_DISTANCE, 0.0f), WHEEL_RADIUS);
-         m_pcWheeledEntity->SetWheel(1, CVector3(0.0f, -HALF_INTERWHEEL_DISTANCE, 0.0f), WHEEL_RADIUS);
+         m_pcWheeledEntity->SetWheel(0, CVector3(0.0f,  HALF_INTERWHEEL_DISTANCE, 0.0f), SEPuck2Layout::WHEEL_RADIUS);
+         m_pcWheeledEntity->SetWheel(1, CVector3(0.0f, -HALF_INTERWHEEL_DISTANCE, 0.0f), SEPuck2Layout::WHEEL_RADIUS);
          /* LED equipped entity */
-         m_pcEPuck2LEDEquippedEntity = new CEPuck2LEDEquippedEntity(this, "leds_0");
-         AddComponent(*m_pcEPuck2LEDEquippedEntity);
-         m_pcEPuck2LEDEquippedEntity->AddLEDs(CVector3(0.0f, 0.0f, LED_RING_ELEVATION),
-                                              LED_RING_RADIUS,
-                                              LED_RING_START_ANGLE,
-                                              8,
-                                              CVector3(0.0f, 0.0f, GREEN_LED_ELEVATION),
-                                              CVector3(RED_LED_POS, RED_LED_SIDE, RED_LED_ELEVATION),
-                                              m_pcEmbodiedEntity->GetOriginAnchor());
+         std::string strBodyLEDMode = "multiple";
+         GetNodeAttributeOrDefault(t_tree, "body_led_mode", strBodyLEDMode, strBodyLEDMode);
+         if(strBodyLEDMode != "multiple" && strBodyLEDMode != "single") {
+            THROW_ARGOSEXCEPTION("Unknown body_led_mode \"" << strBodyLEDMode << "\", use \"multiple\" or \"single\"");
+         }
+         if(m_unComponents & COMPONENT_LEDS) {
+            m_pcEPuck2LEDEquippedEntity = new CEPuck2LEDEquippedEntity(this, "leds_0");
+            AddComponent(*m_pcEPuck2LEDEquippedEntity);
+            m_pcEPuck2LEDEquippedEntity->AddLEDs(CVector3(0.0f, 0.0f, SEPuck2Layout::LED_RING_ELEVATION),
+                                                 SEPuck2Layout::LED_RING_RADIUS,
+                                                 CRadians::ZERO,
+                                                 SEPuck2Layout::NUM_RING_LEDS,
+                                                 CVector3(0.0f, 0.0f, SEPuck2Layout::BODY_LED_ELEVATION),
+                                                 CVector3(SEPuck2Layout::FRONT_LED_X,
+                                                          SEPuck2Layout::FRONT_LED_Y,
+                                                          SEPuck2Layout::FRONT_LED_ELEVATION),
+                                                 m_pcEmbodiedEntity->GetOriginAnchor(),
+                                                 strBodyLEDMode == "single");
+         }
          /* Proximity sensor equipped entity */
-         m_pcProximitySensorEquippedEntity = new CProximitySensorEquippedEntity(this, "proximity_0");
-         AddComponent(*m_pcProximitySensorEquippedEntity);
+         if(m_unComponents & COMPONENT_PROXIMITY) {
+            m_pcProximitySensorEquippedEntity = new CProximitySensorEquippedEntity(this, "proximity_0");
+            AddComponent(*m_pcProximitySensorEquippedEntity);
+         }
          /* Light sensor equipped entity */
-         m_pcLightSensorEquippedEntity = new CLightSensorEquippedEntity(this, "light_0");
-         AddComponent(*m_pcLightSensorEquippedEntity);
-
-         CRadians sensor_angle[8];
-         sensor_angle[0] = -CRadians::PI / 10.5884f;
-         sensor_angle[1] = -CRadians::PI / 3.5999f;
-         sensor_angle[2] = -CRadians::PI_OVER_TWO; //side sensor
-         sensor_angle[3] = -CRadians::PI / 1.2f; // back sensor
-         sensor_angle[4] = CRadians::PI / 1.2f;  // back sensor
-         sensor_angle[5] = CRadians::PI_OVER_TWO; //side sensor
-         sensor_angle[6] = CRadians::PI / 3.5999f;
-         sensor_angle[7] = CRadians::PI / 10.5884f;
-
-         CRadians cAngle;
-         CVector3 cOff, cDir, c_center = CVector3(0.0f, 0.0f, PROXIMITY_SENSOR_RING_ELEVATION);
-         for(UInt32 i = 0; i < 8; ++i) {
-            cAngle = sensor_angle[i];
-            cAngle.SignedNormalize();
-            cOff.Set(PROXIMITY_SENSOR_RING_RADIUS, 0.0f, 0.0f);
-            cOff.RotateZ(cAngle);
-            cOff += c_center;
-            cDir.Set(PROXIMITY_SENSOR_RING_RANGE, 0.0f, 0.0f);
-            cDir.RotateZ(cAngle);
-            m_pcProximitySensorEquippedEntity->AddSensor(cOff, cDir, PROXIMITY_SENSOR_RING_RANGE, m_pcEmbodiedEntity->GetOriginAnchor());
-            m_pcLightSensorEquippedEntity->AddSensor(cOff, cDir, LIGHT_SENSOR_RING_RANGE, m_pcEmbodiedEntity->GetOriginAnchor());
+         if(m_unComponents & COMPONENT_LIGHT) {
+            m_pcLightSensorEquippedEntity = new CLightSensorEquippedEntity(this, "light_0");
+            AddComponent(*m_pcLightSensorEquippedEntity);
+         }
+
+         const SEPuck2Layout::SRingSensor* psRing = SEPuck2Layout::GetRingSensors();
+         for(UInt32 i = 0; i < SEPuck2Layout::NUM_RING_SENSORS; ++i) {
+            CVector3 cDir = psRing[i].Direction * SEPuck2Layout::PROXIMITY_RANGE;
+            if(m_pcProximitySensorEquippedEntity != NULL) {
+               m_pcProximitySensorEquippedEntity->AddSensor(psRing[i].Offset, cDir, SEPuck2Layout::PROXIMITY_RANGE, m_pcEmbodiedEntity->GetOriginAnchor());
+            }
+            if(m_pcLightSensorEquippedEntity != NULL) {
+               m_pcLightSensorEquippedEntity->AddSensor(psRing[i].Offset, cDir, SEPuck2Layout::LIGHT_RANGE, m_pcEmbodiedEntity->GetOriginAnchor());
+            }
          }
          /* TOF equipped entity */
-         m_pcEPuck2TOFEquippedEntity = new CEPuck2TOFEquippedEntity(this, "tof_0");
-         AddComponent(*m_pcEPuck2TOFEquippedEntity);
-         cOff = CVector3(0.0f, 0.0f, TOF_SENSOR_ELEVATION);
-         cDir = CVector3(0.0f, 0.0f, TOF_SENSOR_ELEVATION);
-         c_center = CVector3(0.0f, 0.0f, TOF_SENSOR_ELEVATION);
-         cOff.Set(TOF_SENSOR_OFFSET, 0.0f, 0.0f);
-         cOff += c_center;
-         cDir.Set(TOF_SENSOR_RANGE, 0.0f, 0.0f);
-         m_pcEPuck2TOFEquippedEntity->AddSensor(cOff, cDir, TOF_SENSOR_RANGE, m_pcEmbodiedEntity->GetOriginAnchor());
-         /* Ground sensor equipped entity */
-         m_pcGroundSensorEquippedEntity = new CGroundSensorEquippedEntity(this, "ground_0");
-         AddComponent(*m_pcGroundSensorEquippedEntity);
-         m_pcGroundSensorEquippedEntity->AddSensor(CVector2(0.03f, -0.009f),
-                                                   CGroundSensorEquippedEntity::TYPE_GRAYSCALE,
-                                                   m_pcEmbodiedEntity->GetOriginAnchor());
-         m_pcGroundSensorEquippedEntity->AddSensor(CVector2(0.03f,  0.0f),
-                                                   CGroundSensorEquippedEntity::TYPE_GRAYSCALE,
-                                                   m_pcEmbodiedEntity->GetOriginAnchor());
-         m_pcGroundSensorEquippedEntity->AddSensor(CVector2(0.03f,  0.009f),
-                                                   CGroundSensorEquippedEntity::TYPE_GRAYSCALE,
+         if(m_unComponents & COMPONENT_TOF) {
+            m_pcEPuck2TOFEquippedEntity = new CEPuck2TOFEquippedEntity(this, "tof_0");
+            AddComponent(*m_pcEPuck2TOFEquippedEntity);
+            m_pcEPuck2TOFEquippedEntity->AddSensor(CVector3(SEPuck2Layout::TOF_OFFSET, 0.0f, SEPuck2Layout::TOF_ELEVATION),
+                                                   CVector3(SEPuck2Layout::TOF_RANGE, 0.0f, 0.0f),
+                                                   SEPuck2Layout::TOF_RANGE,
                                                    m_pcEmbodiedEntity->GetOriginAnchor());
+         }
+         /* Ground sensor equipped entity */
+         if(m_unComponents & COMPONENT_GROUND) {
+            m_pcGroundSensorEquippedEntity = new CGroundSensorEquippedEntity(this, "ground_0");
+            AddComponent(*m_pcGroundSensorEquippedEntity);
+            for(UInt32 i = 0; i < SEPuck2Layout::NUM_GROUND_SENSORS; ++i) {
+               m_pcGroundSensorEquippedEntity->AddSensor(CVector2(SEPuck2Layout::GROUND_SENSOR_OFFSETS[i][0],
+                                                                  SEPuck2Layout::GROUND_SENSOR_OFFSETS[i][1]),
+                                                         CGroundSensorEquippedEntity::TYPE_GRAYSCALE,
+                                                         m_pcEmbodiedEntity->GetOriginAnchor());
+            }
+         }
          /* Encoder sensor equipped entity */
-         m_pcEPuck2EncoderEquippedEntity = new CEPuck2EncoderEquippedEntity(this, "encoder_0");
-         AddComponent(*m_pcEPuck2EncoderEquippedEntity);
-         m_pcEPuck2EncoderEquippedEntity->AddSensor(*m_pcWheeledEntity);
+         if(m_unComponents & COMPONENT_ENCODER) {
+            m_pcEPuck2EncoderEquippedEntity = new CEPuck2EncoderEquippedEntity(this, "encoder_0");
+            AddComponent(*m_pcEPuck2EncoderEquippedEntity);
+            m_pcEPuck2EncoderEquippedEntity->AddSensor(*m_pcWheeledEntity);
+         }
          /* RAB equipped entity */
-         Real fRange = 0.8f;
-         GetNodeAttributeOrDefault(t_tree, "rab_range", fRange, fRange);
-         UInt32 unDataSize = 2;
-         GetNodeAttributeOrDefault(t_tree, "rab_data_size", unDataSize, unDataSize);
-         m_pcRABEquippedEntity = new CRABEquippedEntity(this,
-                                                        "rab_0",
-                                                        unDataSize,
-                                                        fRange,
-                                                        m_pcEmbodiedEntity->GetOriginAnchor(),
-                                                        *m_pcEmbodiedEntity,
-                                                        CVector3(0.0f, 0.0f, RAB_ELEVATION));
-         AddComponent(*m_pcRABEquippedEntity);
+         if(m_unComponents & COMPONENT_RAB) {
+            Real fRange = 0.8f;
+            GetNodeAttributeOrDefault(t_tree, "rab_range", fRange, fRange);
+            UInt32 unDataSize = 2;
+            GetNodeAttributeOrDefault(t_tree, "rab_data_size", unDataSize, unDataSize);
+            m_pcRABEquippedEntity = new CRABEquippedEntity(this,
+                                                           "rab_0",
+                                                           unDataSize,
+                                                           fRange,
+                                                           m_pcEmbodiedEntity->GetOriginAnchor(),
+                                                           *m_pcEmbodiedEntity,
+                                                           CVector3(0.0f, 0.0f, SEPuck2Layout::RAB_ELEVATION));
+            AddComponent(*m_pcRABEquippedEntity);
+         }
          /* Perspective camera equipped entity */
-         Real fPerspCamFocalLength = 0.035;
-         Real fPerspCamRange = 1.0;
-         CDegrees cAperture(18.5f);
-         m_pcPerspectiveCameraEquippedEntity = new CEPuck2CameraEquippedEntity(this,
-                                                                                    "perspective_camera_0",
-                                                                                    ToRadians(cAperture),
-                                                                                    fPerspCamFocalLength,
-                                                                                    fPerspCamRange,
-                                                                                    160, 120,
-                                                                                    m_pcEmbodiedEntity->GetOriginAnchor());
-         AddComponent(*m_pcPerspectiveCameraEquippedEntity);
+         if(m_unComponents & COMPONENT_CAMERA) {
+            Real fPerspCamFocalLength = 0.035;
+            Real fPerspCamRange = 1.0;
+            CDegrees cAperture(18.5f);
+            m_pcPerspectiveCameraEquippedEntity = new CEPuck2CameraEquippedEntity(this,
+                                                                                  "perspective_camera_0",
+                                                                                  ToRadians(cAperture),
+                                                                                  fPerspCamFocalLength,
+                                                                                  fPerspCamRange,
+                                                                                  160, 120,
+                                                                                  m_pcEmbodiedEntity->GetOriginAnchor());
+            AddComponent(*m_pcPerspectiveCameraEquippedEntity);
+         }
          /* Battery equipped entity */
-         m_pcBatteryEquippedEntity = new CEPuck2BatteryEquippedEntity(this, "battery_0");
-         if(NodeExists(t_tree, "epuck2_battery"))
-            m_pcBatteryEquippedEntity->Init(GetNode(t_tree, "epuck2_battery"));
-         AddComponent(*m_pcBatteryEquippedEntity);
+         if(m_unComponents & COMPONENT_BATTERY) {
+            m_pcBatteryEquippedEntity = new CEPuck2BatteryEquippedEntity(this, "battery_0");
+            if(NodeExists(t_tree, "epuck2_battery"))
+               m_pcBatteryEquippedEntity->Init(GetNode(t_tree, "epuck2_battery"));
+            AddComponent(*m_pcBatteryEquippedEntity);
+         }
          /* Controllable entity
             It must be the last one, for actuators/sensors to link to composing entities correctly */
          m_pcControllableEntity = new CControllableEntity(this);
          AddComponent(*m_pcControllableEntity);
          m_pcControllableEntity->Init(GetNode(t_tree, "controller"));
          /* Update components */
-         UpdateComponents();
+         UpdateComponentsNow();
+         CEPuck2ComponentScheduler::Register(*this);
 
       }
       catch(CARGoSException& ex) {
@@ -353,22 +444,33 @@ namespace argos {
       /* Reset all components */
       CComposableEntity::Reset();
       /* Update components */
-      UpdateComponents();
+      UpdateComponentsNow();
    }
 
    /****************************************/
    /****************************************/
 
    void CEPuck2Entity::Destroy() {
+      CEPuck2ComponentScheduler::Unregister(*this);
       CComposableEntity::Destroy();
    }
 
    /****************************************/
    /****************************************/
 
-#define UPDATE(COMPONENT) if(COMPONENT->IsEnabled()) COMPONENT->Update();
+#define UPDATE(COMPONENT) if(COMPONENT != NULL && COMPONENT->IsEnabled()) COMPONENT->Update();
 
    void CEPuck2Entity::UpdateComponents() {
+      /* The epuck2_components medium updates the whole swarm at once */
+      if(! CEPuck2ComponentScheduler::IsActive()) {
+         UpdateComponentsNow();
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Entity::UpdateComponentsNow() {
       UPDATE(m_pcRABEquippedEntity);
       UPDATE(m_pcEPuck2LEDEquippedEntity);
       UPDATE(m_pcEPuck2TOFEquippedEntity);
@@ -466,7 +568,71 @@ namespace argos {
                    "      <battery model=\"linear\"/>\n"
                    "    </e-puck2>\n"
                    "    ...\n"
-                   "  </arena>\n\n",
+                   "  </arena>\n\n"
+                   "The green body LEDs are always switched on and off together. By default, they\n"
+                   "are simulated as 8 separate LEDs. By setting 'body_led_mode' to 'single', the\n"
+                   "body ring is simulated by a single LED, which cameras see at the point of the\n"
+                   "ring facing them. This reduces the number of LEDs in the LED medium from 17 to\n"
+                   "10 per robot. The LED actuator API does not change.\n\n"
+                   "  <arena ...>\n"
+                   "    ...\n"
+                   "    <e-puck2 id=\"eb0\" body_led_mode=\"single\">\n"
+                   "      <body position=\"0.4,2.3,0.0\" orientation=\"45,0,0\" />\n"
+                   "      <controller config=\"mycntrl\" />\n"
+                   "    </e-puck2>\n"
+                   "    ...\n"
+                   "  </arena>\n\n"
+                   "By default, the robot builds all its components. In large swarms, set\n"
+                   "'lazy_components' to 'true' to only build the components needed by the sensors\n"
+                   "and actuators of its controller, as declared in the <controllers> section. For\n"
+                   "instance, a lazy robot whose controller does not use the range-and-bearing\n"
+                   "system has no range-and-bearing entity, so it is invisible to the\n"
+                   "range-and-bearing sensors of the other robots; likewise, without the LED\n"
+                   "actuator it has no LEDs for the cameras of the other robots. The wheels and the\n"
+                   "body are always built, and so is the battery when the <epuck2_battery> node is\n"
+                   "present. If the controller uses a device the robot does not know about, all the\n"
+                   "components are built:\n\n"
+                   "  <arena ...>\n"
+                   "    ...\n"
+                   "    <e-puck2 id=\"eb0\" lazy_components=\"true\">\n"
+                   "      <body position=\"0.4,2.3,0.0\" orientation=\"45,0,0\" />\n"
+                   "      <controller config=\"mycntrl\" />\n"
+                   "    </e-puck2>\n"
+                   "    ...\n"
+                   "  </arena>\n\n"
+                   "In the dynamics2d engine, with 'sleep' set to 'true', a robot whose wheels are\n"
+                   "stopped and whose body has been at rest for a few steps is parked, and\n"
+                   "chipmunk puts it to sleep with the bodies it touches. Sleeping bodies cost\n"
+                   "nothing to the solver. A parked robot wakes up when its wheels move, or when a\n"
+                   "collision pushes it. Sleeping is off by default: turning it on for one e-puck2\n"
+                   "turns on chipmunk sleeping for all the movable bodies of its engine, such as\n"
+                   "boxes, cylinders and other robots:\n\n"
+                   "  <arena ...>\n"
+                   "    ...\n"
+                   "    <e-puck2 id=\"eb0\">\n"
+                   "      <body position=\"0.4,2.3,0.0\" orientation=\"45,0,0\" />\n"
+                   "      <controller config=\"mycntrl\" />\n"
+                   "      <dynamics2d sleep=\"true\" />\n"
+                   "    </e-puck2>\n"
+                   "    ...\n"
+                   "  </arena>\n\n"
+                   "In the Qt-OpenGL visualization, large swarms can be drawn with the instanced\n"
+                   "path, set in an <epuck2> node of <qt-opengl>. The robots are then transformed on\n"
+                   "the CPU and drawn with a few calls per frame. The path needs the\n"
+                   "epuck2_qtopengl_user_functions user functions, or user functions derived from\n"
+                   "CQTOpenGLEPuck2UserFunctions that call its DrawInWorld(), because they end the\n"
+                   "frame. Without them, a warning is logged and each robot is drawn on its own.\n"
+                   "Only one visualization per process can use the instanced path. Distant robots\n"
+                   "can be drawn as discs beyond 'disc_distance', and as points of 'point_size'\n"
+                   "pixels beyond 'point_distance' (in meters, 0 to disable):\n\n"
+                   "  <visualization>\n"
+                   "    <qt-opengl>\n"
+                   "      <epuck2 instanced=\"true\"\n"
+                   "              disc_distance=\"1.5\" point_distance=\"5\" point_size=\"4\" />\n"
+                   "      <user_functions label=\"epuck2_qtopengl_user_functions\" />\n"
+                   "      ...\n"
+                   "    </qt-opengl>\n"
+                   "  </visualization>\n\n",
                    "Usable"
       );
 
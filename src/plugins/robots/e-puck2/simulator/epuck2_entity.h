@@ -35,6 +35,23 @@ namespace argos {
 
       ENABLE_VTABLE();
 
+      /**
+       * The optional components of the robot.
+       * The body, the wheels and the controller are always built.
+       */
+      enum EComponent {
+         COMPONENT_LEDS      = 1 << 0,
+         COMPONENT_PROXIMITY = 1 << 1,
+         COMPONENT_LIGHT     = 1 << 2,
+         COMPONENT_TOF       = 1 << 3,
+         COMPONENT_GROUND    = 1 << 4,
+         COMPONENT_ENCODER   = 1 << 5,
+         COMPONENT_RAB       = 1 << 6,
+         COMPONENT_CAMERA    = 1 << 7,
+         COMPONENT_BATTERY   = 1 << 8,
+         COMPONENT_ALL       = (1 << 9) - 1
+      };
+
    public:
 
       CEPuck2Entity();
@@ -48,7 +65,9 @@ namespace argos {
                    const std::string& str_bat_model = "",
                    const CRadians& c_perspcam_aperture = ToRadians(CDegrees(18.5f)),
                    Real f_perspcam_focal_length = 0.035f,
-                   Real f_perspcam_range = 1.0f);
+                   Real f_perspcam_range = 1.0f,
+                   bool b_single_body_led = false,
+                   bool b_lazy_components = false);
 
       virtual void Init(TConfigurationNode& t_tree);
       virtual void Reset();
@@ -100,14 +119,65 @@ namespace argos {
           return *m_pcBatteryEquippedEntity;
       }
 
+      /**
+       * Returns <tt>true</tt> if the given component was built.
+       * @param e_component The component.
+       */
+      inline bool HasComponent(EComponent e_component) const {
+         return (m_unComponents & e_component) != 0;
+      }
+
+      inline bool HasLEDEquippedEntity() const {
+         return m_pcEPuck2LEDEquippedEntity != NULL;
+      }
+
+      inline bool HasProximitySensorEquippedEntity() const {
+         return m_pcProximitySensorEquippedEntity != NULL;
+      }
+
+      inline bool HasLightSensorEquippedEntity() const {
+         return m_pcLightSensorEquippedEntity != NULL;
+      }
+
+      inline bool HasEPuck2TOFEquippedEntity() const {
+         return m_pcEPuck2TOFEquippedEntity != NULL;
+      }
+
+      inline bool HasGroundSensorEquippedEntity() const {
+         return m_pcGroundSensorEquippedEntity != NULL;
+      }
+
+      inline bool HasEPuck2EncoderEquippedEntity() const {
+         return m_pcEPuck2EncoderEquippedEntity != NULL;
+      }
+
+      inline bool HasRABEquippedEntity() const {
+         return m_pcRABEquippedEntity != NULL;
+      }
+
+      inline bool HasBatterySensorEquippedEntity() const {
+         return m_pcBatteryEquippedEntity != NULL;
+      }
+
       virtual std::string GetTypeDescription() const {
          return "e-puck2";
       }
 
    private:
 
+      /**
+       * Returns the components needed by the sensors and actuators of a controller.
+       * The controller is looked up by id in the <controllers> section.
+       * @param str_controller_id The id of the controller.
+       * @return A mask of EComponent values.
+       */
+      static UInt32 GetRequiredComponents(const std::string& str_controller_id);
+
       void SetLEDPosition();
 
+      /** Updates the components, even if the swarm-wide scheduler is active */
+      void UpdateComponentsNow();
+
    private:
 
       CControllableEntity*                   m_pcControllableEntity;
@@ -122,6 +192,7 @@ namespace argos {
       CWheeledEntity*                        m_pcWheeledEntity;
       CEPuck2BatteryEquippedEntity*          m_pcBatteryEquippedEntity;
       CEPuck2EncoderEquippedEntity*          m_pcEPuck2EncoderEquippedEntity;
+      UInt32                                 m_unComponents;
    };
 
 }
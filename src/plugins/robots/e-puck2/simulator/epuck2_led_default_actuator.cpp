@@ -24,7 +24,14 @@ namespace argos {
 
    void CEPuck2LEDsDefaultActuator::SetRobot(CComposableEntity& c_entity) {
       m_pcLEDEquippedEntity = &(c_entity.GetComponent<CEPuck2LEDEquippedEntity>("epuck2_leds"));
-      m_tSettings.resize(m_pcLEDEquippedEntity->GetLEDs().size());
+      /* The dirty mask has one bit per LED */
+      if(m_pcLEDEquippedEntity->GetLEDs().size() > 32) {
+         THROW_ARGOSEXCEPTION("The EPuck2 LEDs actuator supports at most 32 LEDs, but \"" <<
+                              c_entity.GetId() << "\" has " <<
+                              m_pcLEDEquippedEntity->GetLEDs().size());
+      }
+      m_tSettings.resize(m_pcLEDEquippedEntity->GetLEDs().size(), CColor::BLACK);
+      m_unDirtyMask = 0;
    }
 
    /****************************************/
@@ -48,14 +55,34 @@ namespace argos {
    /****************************************/
 
    void CEPuck2LEDsDefaultActuator::Update() {
-      m_pcLEDEquippedEntity->SetAllLEDsColors(m_tSettings);
+      /* Nothing to do if the controller did not change any LED */
+      if(m_unDirtyMask == 0) return;
+      /* Forward only the LEDs that changed */
+      for(UInt32 i = 0; i < m_tSettings.size(); ++i) {
+         if(m_unDirtyMask & (1u << i)) {
+            m_pcLEDEquippedEntity->SetLEDColor(i, m_tSettings[i]);
+         }
+      }
+      m_unDirtyMask = 0;
    }
 
    /****************************************/
    /****************************************/
 
    void CEPuck2LEDsDefaultActuator::Reset() {
+      /* The LED entity puts the LEDs back on its own, do not write them again */
       SetAllBlack();
+      m_unDirtyMask = 0;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2LEDsDefaultActuator::SyncWithLEDs() {
+      for(UInt32 i = 0; i < m_tSettings.size(); ++i) {
+         m_tSettings[i] = m_pcLEDEquippedEntity->GetLED(i).GetColor();
+      }
+      m_unDirtyMask = 0;
    }
 
    /****************************************/
@@ -77,7 +104,10 @@ REGISTER_ACTUATOR(CEPuck2LEDsDefaultActuator,
                   "The EPuck2 LEDs actuator.",
 
                   "This actuator controls a group of LEDs. For a complete description of its\n"
-                  "usage, refer to the ci_leds_actuator.h file.\n\n"
+                  "usage, refer to the ci_leds_actuator.h file.\n"
+                  "Only the LEDs that the controller changed are written to the robot. A colour\n"
+                  "set from outside the controller, e.g., by the loop functions or a snapshot,\n"
+                  "stays until the controller changes that LED.\n\n"
 
                   "REQUIRED XML CONFIGURATION\n\n"
 
@@ -39,6 +39,12 @@ namespace argos {
       virtual void Reset();
       virtual void Destroy();
 
+      /**
+       * Copies the colours of the LEDs into the settings.
+       * Needed when the LEDs are changed from outside, e.g., by a snapshot.
+       */
+      void SyncWithLEDs();
+
    private:
 
       CEPuck2LEDEquippedEntity* m_pcLEDEquippedEntity;
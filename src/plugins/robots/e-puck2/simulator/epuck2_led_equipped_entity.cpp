@@ -9,10 +9,24 @@
 #include <argos3/core/simulator/simulator.h>
 #include <argos3/core/simulator/space/space.h>
 #include <argos3/plugins/simulator/media/led_medium.h>
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_log.h>
 #include "epuck2_led_equipped_entity.h"
+#include <mutex>
+#include <unordered_map>
 
 namespace argos {
 
+   /****************************************/
+   /****************************************/
+
+   /*
+    * Maps each single body ring LED to the entity that owns it. Written only
+    * while entities are created or destroyed, read by the cameras during
+    * the sense phase.
+    */
+   typedef std::unordered_map<const CLEDEntity*, const CEPuck2LEDEquippedEntity*> TBodyRingOwnerMap;
+   static TBodyRingOwnerMap s_mapBodyRingOwners;
+
    /****************************************/
    /****************************************/
 
@@ -23,13 +37,29 @@ namespace argos {
       LED(c_led),
       Offset(c_offset),
       Anchor(s_anchor),
-      Type(c_type) {}
+      Type(c_type),
+      Indexed(false),
+      Pose(0),
+      PoseVersion(0) {}
+
+   /****************************************/
+   /****************************************/
+
+   CEPuck2LEDEquippedEntity::SAnchorPose::SAnchorPose(const SAnchor& s_anchor) :
+      Anchor(&s_anchor),
+      Version(0),
+      Planar(true),
+      Cos(1.0f),
+      Sin(0.0f) {}
 
    /****************************************/
    /****************************************/
 
     CEPuck2LEDEquippedEntity::CEPuck2LEDEquippedEntity(CComposableEntity* pc_parent) :
-      CComposableEntity(pc_parent) {
+      CComposableEntity(pc_parent),
+      m_pcMedium(NULL),
+      m_pcBodyRingLED(NULL),
+      m_fBodyRingRadius(0.0f) {
       Disable();
    }
 
@@ -38,7 +68,10 @@ namespace argos {
 
     CEPuck2LEDEquippedEntity::CEPuck2LEDEquippedEntity(CComposableEntity* pc_parent,
                                           const std::string& str_id) :
-      CComposableEntity(pc_parent, str_id) {
+      CComposableEntity(pc_parent, str_id),
+      m_pcMedium(NULL),
+      m_pcBodyRingLED(NULL),
+      m_fBodyRingRadius(0.0f) {
       Disable();
    }
 
@@ -46,6 +79,9 @@ namespace argos {
    /****************************************/
 
     CEPuck2LEDEquippedEntity::~CEPuck2LEDEquippedEntity() {
+      if(m_pcBodyRingLED != NULL) {
+         s_mapBodyRingOwners.erase(m_pcBodyRingLED);
+      }
       while(! m_tLEDs.empty()) {
          delete m_tLEDs.back();
          m_tLEDs.pop_back();
@@ -97,6 +133,7 @@ namespace argos {
             CEmbodiedEntity& cBody = GetParent().GetComponent<CEmbodiedEntity>("body");
             /* Add the LED to this container */
             m_tLEDs.push_back(new SActuator(*pcLED, cOffset, cBody.GetAnchor(strAnchorId), cTypeId));
+            m_tLEDs.back()->Pose = GetAnchorPose(m_tLEDs.back()->Anchor);
             AddComponent(*pcLED);
          }
          UpdateComponents();
@@ -110,10 +147,16 @@ namespace argos {
    /****************************************/
 
    void CEPuck2LEDEquippedEntity::Reset() {
+      /* LED.Reset() moves the LEDs back, compute their positions again */
+      for(size_t i = 0; i < m_vecAnchorPoses.size(); ++i) {
+         m_vecAnchorPoses[i].Version = 0;
+      }
       for(SActuator::TList::iterator it = m_tLEDs.begin();
           it != m_tLEDs.end();
           ++it) {
          (*it)->LED.Reset();
+         (*it)->PoseVersion = 0;
+         UpdateIndex(**it);
       }
    }
 
@@ -123,9 +166,10 @@ namespace argos {
    void CEPuck2LEDEquippedEntity::Enable() {
       /* Perform generic enable behavior */
       CComposableEntity::Enable();
-      /* Enable anchors */
+      /* Enable anchors and put the lit LEDs back in the index */
       for(size_t i = 0; i < m_tLEDs.size(); ++i) {
          m_tLEDs[i]->Anchor.Enable();
+         UpdateIndex(*m_tLEDs[i]);
       }
    }
 
@@ -135,9 +179,10 @@ namespace argos {
    void CEPuck2LEDEquippedEntity::Disable() {
       /* Perform generic disable behavior */
       CComposableEntity::Disable();
-      /* Disable anchors */
+      /* Disable anchors and take the LEDs out of the index */
       for(size_t i = 0; i < m_tLEDs.size(); ++i) {
          m_tLEDs[i]->Anchor.Disable();
+         UpdateIndex(*m_tLEDs[i]);
       }
    }
 
@@ -154,19 +199,30 @@ namespace argos {
             c_offset,
             CColor::BLACK);
       m_tLEDs.push_back(new SActuator(*pcLED, c_offset, s_anchor, c_type));
+      m_tLEDs.back()->Pose = GetAnchorPose(s_anchor);
       AddComponent(*pcLED);
    }
 
    /****************************************/
    /****************************************/
 
+   const CEPuck2LEDEquippedEntity* CEPuck2LEDEquippedEntity::GetBodyRingOwner(const CLEDEntity& c_led) {
+      if(s_mapBodyRingOwners.empty()) return NULL;
+      TBodyRingOwnerMap::const_iterator it = s_mapBodyRingOwners.find(&c_led);
+      return (it != s_mapBodyRingOwners.end()) ? it->second : NULL;
+   }
+
+   /****************************************/
+   /****************************************/
+
    void CEPuck2LEDEquippedEntity::AddLEDs(const CVector3& c_center,
                                        Real f_radius,
                                        const CRadians& c_start_angle,
                                        UInt32 un_num_leds,
                                        const CVector3& c_body_center,
                                        const CVector3& c_front_offset,
-                                       SAnchor& s_anchor) {
+                                       SAnchor& s_anchor,
+                                       bool b_single_body_led) {
       CRadians cLEDSpacing = CRadians::TWO_PI / un_num_leds;
       CRadians cAngle;
       CVector3 cOffset;
@@ -185,6 +241,15 @@ namespace argos {
 
       AddLED(c_front_offset, s_anchor, TYPE_FRONT);
 
+      m_fBodyRingRadius = f_radius;
+      if(b_single_body_led) {
+         /* The body ring is lit as a whole: one LED in its centre is enough */
+         AddLED(c_body_center, s_anchor, TYPE_BODY);
+         m_pcBodyRingLED = &m_tLEDs.back()->LED;
+         s_mapBodyRingOwners[m_pcBodyRingLED] = this;
+         return;
+      }
+
       for(UInt32 i = 0; i < un_num_leds; ++i) {
          cAngle = c_start_angle + i * cLEDSpacing;
          cAngle.SignedNormalize();
@@ -223,6 +288,11 @@ namespace argos {
                    ", m_tLEDs.size() = " <<
                    m_tLEDs.size());
       m_tLEDs[un_index]->Offset = c_offset;
+      /* Force the position to be recomputed */
+      m_tLEDs[un_index]->PoseVersion = 0;
+      if(m_tLEDs[un_index]->Indexed) {
+         UpdatePosition(*m_tLEDs[un_index]);
+      }
    }
 
 
@@ -238,8 +308,7 @@ namespace argos {
                     un_index <<
                     ", m_tLEDs.size() = " <<
                     m_tLEDs.size() << " RGBLEDs are 1, 3, 5, and 7");
-       m_tLEDs[un_index]->LED.SetColor(c_color);
-
+       SetColor(*m_tLEDs[un_index], c_color);
    }
 
    /****************************************/
@@ -254,7 +323,7 @@ namespace argos {
                     un_index <<
                     ", m_tLEDs.size() = " <<
                     m_tLEDs.size() << " RedLEDs are 0, 2, 4, and 6");
-       m_tLEDs[un_index]->LED.SetColor(c_state ? CColor::RED : CColor::BLACK);
+       SetColor(*m_tLEDs[un_index], c_state ? CColor::RED : CColor::BLACK);
    }
 
    /****************************************/
@@ -266,7 +335,7 @@ namespace argos {
                     GetId() <<
                     "\": there is no LEDs, m_tLEDs.size() = " <<
                     m_tLEDs.size());
-       m_tLEDs[8]->LED.SetColor(c_state ? CColor::RED : CColor::BLACK);
+       SetColor(*m_tLEDs[8], c_state ? CColor::RED : CColor::BLACK);
    }
 
    /****************************************/
@@ -279,37 +348,38 @@ namespace argos {
                     "\": there is no LEDs, m_tLEDs.size() = " <<
                     m_tLEDs.size());
        for (UInt32 i = 9; i < m_tLEDs.size(); ++i) {
-          m_tLEDs[i]->LED.SetColor(c_state ? CColor::GREEN : CColor::BLACK);
-          LOG << i << " " << m_tLEDs[i]->LED.GetColor() << std::endl;
+          SetColor(*m_tLEDs[i], c_state ? CColor::GREEN : CColor::BLACK);
+          EPUCK2_LOG_DEBUG("leds", GetId() << " body LED " << i << " " << m_tLEDs[i]->LED.GetColor());
        }
    }
 
    /****************************************/
    /****************************************/
 
-   void CEPuck2LEDEquippedEntity::SetAllLEDsColors(const std::vector<CColor>& vec_colors) {
-       ARGOS_ASSERT(m_tLEDs.size() == 10,
-                   "CEPuck2LEDEquippedEntity::SetAllLEDsColors(), id=\"" <<
-                   GetId() << "\": there is not 10 LEDs, m_tLEDs.size() = " <<
+   void CEPuck2LEDEquippedEntity::SetLEDColor(UInt32 un_index,
+                                              const CColor& c_color) {
+      ARGOS_ASSERT(un_index < m_tLEDs.size(),
+                   "CEPuck2LEDEquippedEntity::SetLEDColor(), id=\"" <<
+                   GetId() <<
+                   "\": index out of bounds: un_index = " <<
+                   un_index <<
+                   ", m_tLEDs.size() = " <<
                    m_tLEDs.size());
-       ARGOS_ASSERT((vec_colors[0] == CColor::BLACK || vec_colors[0] == CColor::RED) &&
-                    (vec_colors[2] == CColor::BLACK || vec_colors[2] == CColor::RED) &&
-                    (vec_colors[4] == CColor::BLACK || vec_colors[4] == CColor::RED) &&
-                    (vec_colors[6] == CColor::BLACK || vec_colors[6] == CColor::RED) &&
-                    (vec_colors[8] == CColor::BLACK || vec_colors[8] == CColor::RED) &&
-                    (vec_colors[9] == CColor::BLACK || vec_colors[9] == CColor::GREEN) &&
-                    (vec_colors[10] == CColor::BLACK || vec_colors[10] == CColor::GREEN) &&
-                    (vec_colors[11] == CColor::BLACK || vec_colors[11] == CColor::GREEN) &&
-                    (vec_colors[12] == CColor::BLACK || vec_colors[12] == CColor::GREEN) &&
-                    (vec_colors[13] == CColor::BLACK || vec_colors[13] == CColor::GREEN) &&
-                    (vec_colors[14] == CColor::BLACK || vec_colors[14] == CColor::GREEN) &&
-                    (vec_colors[15] == CColor::BLACK || vec_colors[15] == CColor::GREEN) &&
-                    (vec_colors[16] == CColor::BLACK || vec_colors[16] == CColor::GREEN),
-                   "CEPuck2LEDEquippedEntity::SetAllLEDsColors(), id=\"" <<
-                   GetId() << "\": the provided colours are invalid.");
+      ARGOS_ASSERT(IsValidColor(m_tLEDs[un_index]->Type, c_color),
+                   "CEPuck2LEDEquippedEntity::SetLEDColor(), id=\"" <<
+                   GetId() <<
+                   "\": colour " << c_color <<
+                   " is invalid for LED " << un_index);
+      SetColor(*m_tLEDs[un_index], c_color);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2LEDEquippedEntity::SetAllLEDsColors(const std::vector<CColor>& vec_colors) {
       if(vec_colors.size() == m_tLEDs.size()) {
          for(UInt32 i = 0; i < vec_colors.size(); ++i) {
-            m_tLEDs[i]->LED.SetColor(vec_colors[i]);
+            SetLEDColor(i, vec_colors[i]);
          }
       }
       else {
@@ -318,7 +388,7 @@ namespace argos {
             GetId() <<
             "\": number of LEDs (" <<
             m_tLEDs.size() <<
-            ") is lower than the passed colour vector size (" <<
+            ") is different from the passed colour vector size (" <<
             vec_colors.size() <<
             ")");
       }
@@ -327,15 +397,34 @@ namespace argos {
    /****************************************/
    /****************************************/
 
+   bool CEPuck2LEDEquippedEntity::IsValidColor(ELEDType e_type,
+                                               const CColor& c_color) const {
+      switch(e_type) {
+         case TYPE_RED:
+         case TYPE_FRONT:
+            return c_color == CColor::BLACK || c_color == CColor::RED;
+         case TYPE_BODY:
+            return c_color == CColor::BLACK || c_color == CColor::GREEN;
+         default:
+            return true;
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
    void CEPuck2LEDEquippedEntity::UpdateComponents() {
-      /* LED position wrt global reference frame */
-      CVector3 cLEDPosition;
+      /* Bump the version of the anchors that moved */
+      for(size_t i = 0; i < m_vecAnchorPoses.size(); ++i) {
+         UpdateAnchorPose(m_vecAnchorPoses[i]);
+      }
+      /* Black LEDs are not in the index, no need to move them.
+         The others move only if their anchor moved. */
       for(UInt32 i = 0; i < m_tLEDs.size(); ++i) {
-         if(m_tLEDs[i]->LED.IsEnabled()) {
-            cLEDPosition = m_tLEDs[i]->Offset;
-            cLEDPosition.Rotate(m_tLEDs[i]->Anchor.Orientation);
-            cLEDPosition += m_tLEDs[i]->Anchor.Position;
-            m_tLEDs[i]->LED.SetPosition(cLEDPosition);
+         if(m_tLEDs[i]->LED.IsEnabled() &&
+            m_tLEDs[i]->LED.GetColor() != CColor::BLACK &&
+            m_tLEDs[i]->PoseVersion != m_vecAnchorPoses[m_tLEDs[i]->Pose].Version) {
+            UpdatePosition(*m_tLEDs[i]);
          }
       }
    }
@@ -344,9 +433,104 @@ namespace argos {
    /****************************************/
 
    void CEPuck2LEDEquippedEntity::SetMedium(CLEDMedium& c_medium) {
+      m_pcMedium = &c_medium;
       for(UInt32 i = 0; i < m_tLEDs.size(); ++i) {
+         /* The LED entity registers itself in the medium index */
          m_tLEDs[i]->LED.SetMedium(c_medium);
+         m_tLEDs[i]->Indexed = true;
+         /* Keep only the lit LEDs there */
+         UpdateIndex(*m_tLEDs[i]);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2LEDEquippedEntity::SetColor(SActuator& s_led,
+                                           const CColor& c_color) {
+      s_led.LED.SetColor(c_color);
+      UpdateIndex(s_led);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   /*
+    * Actuators of different robots can run in parallel threads, while the
+    * index is shared by the whole swarm. Insertions and removals only happen
+    * when an LED is switched on or off, so a single lock is cheap enough.
+    */
+   static std::mutex LED_INDEX_MUTEX;
+
+   void CEPuck2LEDEquippedEntity::UpdateIndex(SActuator& s_led) {
+      if(m_pcMedium == NULL) return;
+      bool bIndexed = IsEnabled() && s_led.LED.GetColor() != CColor::BLACK;
+      if(bIndexed == s_led.Indexed) return;
+      std::lock_guard<std::mutex> cLock(LED_INDEX_MUTEX);
+      if(bIndexed) {
+         /* The position was not updated while the LED was off */
+         UpdatePosition(s_led);
+         m_pcMedium->GetIndex().AddEntity(s_led.LED);
+      }
+      else {
+         m_pcMedium->GetIndex().RemoveEntity(s_led.LED);
+      }
+      s_led.Indexed = bIndexed;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2LEDEquippedEntity::UpdatePosition(SActuator& s_led) {
+      SAnchorPose& sPose = m_vecAnchorPoses[s_led.Pose];
+      UpdateAnchorPose(sPose);
+      /* LED position wrt global reference frame */
+      CVector3 cLEDPosition;
+      if(sPose.Planar) {
+         cLEDPosition.Set(sPose.Cos * s_led.Offset.GetX() - sPose.Sin * s_led.Offset.GetY(),
+                          sPose.Sin * s_led.Offset.GetX() + sPose.Cos * s_led.Offset.GetY(),
+                          s_led.Offset.GetZ());
+      }
+      else {
+         cLEDPosition = s_led.Offset;
+         cLEDPosition.Rotate(sPose.Orientation);
+      }
+      cLEDPosition += sPose.Position;
+      s_led.LED.SetPosition(cLEDPosition);
+      s_led.PoseVersion = sPose.Version;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2LEDEquippedEntity::UpdateAnchorPose(SAnchorPose& s_pose) {
+      if(s_pose.Version > 0 &&
+         s_pose.Position == s_pose.Anchor->Position &&
+         s_pose.Orientation == s_pose.Anchor->Orientation) return;
+      s_pose.Position = s_pose.Anchor->Position;
+      s_pose.Orientation = s_pose.Anchor->Orientation;
+      ++s_pose.Version;
+      /* Robots on the floor only rotate around Z: use sin/cos instead of the quaternion.
+         For q = (w,0,0,z), cos(a) = w^2 - z^2 and sin(a) = 2wz. */
+      s_pose.Planar = (Abs(s_pose.Orientation.GetX()) < 1e-9 &&
+                       Abs(s_pose.Orientation.GetY()) < 1e-9);
+      if(s_pose.Planar) {
+         Real fW = s_pose.Orientation.GetW();
+         Real fZ = s_pose.Orientation.GetZ();
+         s_pose.Cos = fW * fW - fZ * fZ;
+         s_pose.Sin = 2.0f * fW * fZ;
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   UInt32 CEPuck2LEDEquippedEntity::GetAnchorPose(const SAnchor& s_anchor) {
+      for(UInt32 i = 0; i < m_vecAnchorPoses.size(); ++i) {
+         if(m_vecAnchorPoses[i].Anchor == &s_anchor) return i;
       }
+      m_vecAnchorPoses.push_back(SAnchorPose(s_anchor));
+      return m_vecAnchorPoses.size() - 1;
    }
 
    /****************************************/
@@ -28,6 +28,12 @@ namespace argos {
     * want to manage them comfortably.
     * </p>
     * <p>
+    * Only lit LEDs are kept in the positional index of the LED medium, since the
+    * cameras ignore black LEDs anyway. An LED is removed from the index when it
+    * is switched off and inserted back when it is lit again. The position of an
+    * LED is updated only while it is lit.
+    * </p>
+    * <p>
     * You can define a positional entity as the <em>reference</em> of this entity.
     * In this way, if the reference entity moves, this entity will follow automatically.
     * The contained LEDs will also move accordingly. If you don't define a reference
@@ -58,6 +64,12 @@ namespace argos {
          CVector3 Offset;
          SAnchor& Anchor;
          ELEDType Type;
+         /** True when the LED is in the positional index of the medium */
+         bool Indexed;
+         /** Index of the anchor pose in the pose cache */
+         UInt32 Pose;
+         /** Version of the anchor pose the position was computed with */
+         UInt32 PoseVersion;
 
 
          SActuator(CLEDEntity& c_led,
@@ -66,6 +78,24 @@ namespace argos {
                    const ELEDType c_type);
       };
 
+      /**
+       * The last known pose of an anchor.
+       * The version is increased every time the anchor moves, so that the LED
+       * positions are recomputed only when needed.
+       */
+      struct SAnchorPose {
+         const SAnchor* Anchor;
+         CVector3 Position;
+         CQuaternion Orientation;
+         UInt32 Version;
+         /** True when the orientation is a rotation around the Z axis only */
+         bool Planar;
+         Real Cos;
+         Real Sin;
+
+         SAnchorPose(const SAnchor& s_anchor);
+      };
+
    public:
 
       /**
@@ -104,6 +134,8 @@ namespace argos {
        * @param c_body_center The position of LED ring centre wrt the reference entity.
        * @param c_front_offset The offset for the front LED.
        * @param s_anchor The anchor of the LEDs.
+       * @param b_single_body_led When true, the body ring is represented by a single LED.
+       * @see IsBodyRingLED()
        */
       void AddLEDs(const CVector3& c_center,
             Real f_radius,
@@ -111,7 +143,39 @@ namespace argos {
             UInt32 un_num_leds,
             const CVector3& c_body_center,
             const CVector3& c_front_offset,
-            SAnchor& s_anchor);
+            SAnchor& s_anchor,
+            bool b_single_body_led = false);
+
+      /**
+       * Returns <tt>true</tt> if the given LED represents the whole body ring.
+       * In this case, the LED is placed at the centre of the ring, and its
+       * apparent position is the point of the ring facing the observer.
+       * @param c_led The LED to check.
+       * @return <tt>true</tt> if the given LED represents the whole body ring.
+       * @see GetBodyRingRadius()
+       */
+      inline bool IsBodyRingLED(const CLEDEntity& c_led) const {
+         return &c_led == m_pcBodyRingLED;
+      }
+
+      /**
+       * Returns the radius of the body ring.
+       * @return The radius of the body ring.
+       * @see IsBodyRingLED()
+       */
+      inline Real GetBodyRingRadius() const {
+         return m_fBodyRingRadius;
+      }
+
+      /**
+       * Returns the entity whose single body ring LED is the given LED.
+       * The owner is recorded when the body ring LED is created, so this
+       * lookup needs no cast of the LED's parent.
+       * @param c_led The LED to look up.
+       * @return The owner, or <tt>NULL</tt> if the LED is not a body ring LED.
+       * @see IsBodyRingLED()
+       */
+      static const CEPuck2LEDEquippedEntity* GetBodyRingOwner(const CLEDEntity& c_led);
 
 
       /**
@@ -183,6 +247,16 @@ namespace argos {
        */
       void SetBodyLED(const bool c_state);
 
+      /**
+       * Sets the colour of an LED by numeric index.
+       * The colour must be valid for the type of the LED: red LEDs and the
+       * front LED accept red or black, body LEDs green or black.
+       * @param un_index The index of the wanted LED.
+       * @param c_color The colour of the LED.
+       */
+      void SetLEDColor(UInt32 un_index,
+                       const CColor& c_color);
+
       /**
        * Sets the colour of all the LEDs to the given setting.
        * @param vec_colors A vector containing the colours of the LEDs.
@@ -212,7 +286,33 @@ namespace argos {
       /** List of the LEDs managed by this entity */
       SActuator::TList m_tLEDs;
 
+      /** The medium the LEDs are associated to */
+      CLEDMedium* m_pcMedium;
+
+      /** The last known poses of the anchors of the LEDs */
+      std::vector<SAnchorPose> m_vecAnchorPoses;
+
+      /** The LED representing the whole body ring, if any */
+      CLEDEntity* m_pcBodyRingLED;
+
+      /** The radius of the body ring */
+      Real m_fBodyRingRadius;
+
    private:
+       void SetColor(SActuator& s_led,
+                     const CColor& c_color);
+
+       void UpdateIndex(SActuator& s_led);
+
+       void UpdatePosition(SActuator& s_led);
+
+       void UpdateAnchorPose(SAnchorPose& s_pose);
+
+       UInt32 GetAnchorPose(const SAnchor& s_anchor);
+
+       bool IsValidColor(ELEDType e_type,
+                         const CColor& c_color) const;
+
        void AddLED(const CVector3& c_offset,
                    SAnchor& s_anchor,
                    const ELEDType c_type);
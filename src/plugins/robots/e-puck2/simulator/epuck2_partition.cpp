@@ -0,0 +1,489 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/epuck2_partition.cpp>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#include "epuck2_partition.h"
+#include "epuck2_entity.h"
+
+#include <argos3/core/simulator/simulator.h>
+#include <argos3/core/simulator/space/space.h>
+#include <argos3/core/utility/math/vector3.h>
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_log.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace argos {
+
+   /****************************************/
+   /****************************************/
+
+   /* Interior cuts are moved off the grid lines, so that robots placed on
+      round coordinates do not lie on two tiles */
+   static const Real CUT_OFFSET = 1e-4;
+
+   /****************************************/
+   /****************************************/
+
+   static void SetTileEngine(TConfigurationNode& t_engine,
+                             const std::string& str_id,
+                             UInt32 un_index,
+                             const CEPuck2Partition::STile& s_tile,
+                             Real f_bottom,
+                             Real f_top) {
+      std::ostringstream cId;
+      cId << str_id << "_" << un_index;
+      t_engine.SetAttribute("id", cId.str());
+      TConfigurationNode tBoundaries("boundaries");
+      TConfigurationNode tTop("top");
+      tTop.SetAttribute("height", f_top);
+      tBoundaries.InsertEndChild(tTop);
+      TConfigurationNode tBottom("bottom");
+      tBottom.SetAttribute("height", f_bottom);
+      tBoundaries.InsertEndChild(tBottom);
+      /* Counterclockwise, as in the ARGoS examples */
+      CVector2 pcCorners[4] = {
+         CVector2(s_tile.Min.GetX(), s_tile.Min.GetY()),
+         CVector2(s_tile.Max.GetX(), s_tile.Min.GetY()),
+         CVector2(s_tile.Max.GetX(), s_tile.Max.GetY()),
+         CVector2(s_tile.Min.GetX(), s_tile.Max.GetY())
+      };
+      TConfigurationNode tSides("sides");
+      for(UInt32 i = 0; i < 4; ++i) {
+         std::ostringstream cPoint;
+         cPoint.precision(10);
+         cPoint << pcCorners[i].GetX() << "," << pcCorners[i].GetY();
+         TConfigurationNode tVertex("vertex");
+         tVertex.SetAttribute("point", cPoint.str());
+         tSides.InsertEndChild(tVertex);
+      }
+      tBoundaries.InsertEndChild(tSides);
+      t_engine.InsertEndChild(tBoundaries);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CEPuck2Partition::CEPuck2Partition() :
+      m_unCols(0),
+      m_unRows(0),
+      m_unSamples(0),
+      m_fMemory(0.5),
+      m_unSamplePeriod(10),
+      m_unSteps(0) {}
+
+   /****************************************/
+   /****************************************/
+
+   bool CEPuck2Partition::Preprocess() {
+      TConfigurationNode& tRoot = CSimulator::GetInstance().GetConfigurationRoot();
+      if(!NodeExists(tRoot, "loop_functions") ||
+         !NodeExists(GetNode(tRoot, "loop_functions"), "partition")) {
+         return false;
+      }
+      try {
+         TConfigurationNode& tPartition = GetNode(GetNode(tRoot, "loop_functions"), "partition");
+         /* The arena */
+         TConfigurationNode& tArena = GetNode(tRoot, "arena");
+         CVector3 cSize, cCenter;
+         GetNodeAttribute(tArena, "size", cSize);
+         GetNodeAttributeOrDefault(tArena, "center", cCenter, cCenter);
+         /* The parameters */
+         UInt32 unEngines = std::max<UInt32>(1, CSimulator::GetInstance().GetNumThreads());
+         Real fResolution = 0.25;
+         GetNodeAttributeOrDefault(tPartition, "engines", unEngines, unEngines);
+         GetNodeAttributeOrDefault(tPartition, "resolution", fResolution, fResolution);
+         GetNodeAttributeOrDefault(tPartition, "density_file", m_strDensityFile, m_strDensityFile);
+         GetNodeAttributeOrDefault(tPartition, "memory", m_fMemory, m_fMemory);
+         GetNodeAttributeOrDefault(tPartition, "sample_period", m_unSamplePeriod, m_unSamplePeriod);
+         if(unEngines == 0) {
+            THROW_ARGOSEXCEPTION("The number of engines must be positive");
+         }
+         if(fResolution <= 0.0) {
+            THROW_ARGOSEXCEPTION("The resolution must be positive, got " << fResolution);
+         }
+         if(m_fMemory < 0.0 || m_fMemory > 1.0) {
+            THROW_ARGOSEXCEPTION("The memory must be in [0,1], got " << m_fMemory);
+         }
+         if(m_unSamplePeriod == 0) {
+            THROW_ARGOSEXCEPTION("The sample period must be positive");
+         }
+         Resize(CVector2(cCenter.GetX() - cSize.GetX() * 0.5, cCenter.GetY() - cSize.GetY() * 0.5),
+                CVector2(cCenter.GetX() + cSize.GetX() * 0.5, cCenter.GetY() + cSize.GetY() * 0.5),
+                fResolution);
+         /* The density of the last run, or a guess from the configuration */
+         if(m_strDensityFile.empty() || !Load(m_strDensityFile)) {
+            Estimate(tRoot);
+         }
+         Compute(unEngines, m_vecTiles);
+         if(unEngines > 1) {
+            WriteEngines(GetNode(tRoot, "physics_engines"),
+                         cCenter.GetZ() - cSize.GetZ() * 0.5,
+                         cCenter.GetZ() + cSize.GetZ() * 0.5);
+         }
+         for(size_t i = 0; i < m_vecTiles.size(); ++i) {
+            EPUCK2_LOG_INFO("partition", "Tile " << i << ": " << m_vecTiles[i].Min << " - "
+                            << m_vecTiles[i].Max << ", " << m_vecTiles[i].Robots << " robots");
+         }
+         return true;
+      }
+      catch(CARGoSException& ex) {
+         THROW_ARGOSEXCEPTION_NESTED("Error partitioning the arena", ex);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Partition::Sample() {
+      if(m_unCols == 0 || ++m_unSteps < m_unSamplePeriod) {
+         return;
+      }
+      m_unSteps = 0;
+      CSpace::TMapPerTypePerId& tEntities = CSimulator::GetInstance().GetSpace().GetEntityMapPerTypePerId();
+      CSpace::TMapPerTypePerId::iterator itType = tEntities.find("e-puck2");
+      if(itType != tEntities.end()) {
+         for(CSpace::TMapPerType::iterator it = itType->second.begin();
+             it != itType->second.end();
+             ++it) {
+            const CVector3& cPosition =
+               any_cast<CEPuck2Entity*>(it->second)->GetEmbodiedEntity().GetOriginAnchor().Position;
+            m_vecObserved[GetCellAt(CVector2(cPosition.GetX(), cPosition.GetY()))] += 1.0;
+         }
+      }
+      ++m_unSamples;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Partition::Save() {
+      if(m_strDensityFile.empty() || m_unSamples == 0) {
+         return;
+      }
+      for(size_t i = 0; i < m_vecDensity.size(); ++i) {
+         m_vecDensity[i] = m_fMemory * m_vecDensity[i] +
+            (1.0 - m_fMemory) * m_vecObserved[i] / m_unSamples;
+      }
+      std::fill(m_vecObserved.begin(), m_vecObserved.end(), 0.0);
+      m_unSamples = 0;
+      std::ofstream cFile(m_strDensityFile.c_str());
+      if(!cFile) {
+         THROW_ARGOSEXCEPTION("Can't write the density file \"" << m_strDensityFile << "\"");
+      }
+      cFile.precision(10);
+      cFile << "# e-puck2 density: columns rows min_x min_y max_x max_y, then the robots per cell, row by row" << std::endl;
+      cFile << m_unCols << " " << m_unRows << " "
+            << m_cMin.GetX() << " " << m_cMin.GetY() << " "
+            << m_cMax.GetX() << " " << m_cMax.GetY() << std::endl;
+      for(UInt32 j = 0; j < m_unRows; ++j) {
+         for(UInt32 i = 0; i < m_unCols; ++i) {
+            cFile << m_vecDensity[GetCell(i, j)] << ((i + 1 < m_unCols) ? " " : "\n");
+         }
+      }
+      EPUCK2_LOG_INFO("partition", "Density saved to \"" << m_strDensityFile << "\"");
+   }
+
+   /****************************************/
+   /****************************************/
+
+   bool CEPuck2Partition::Load(const std::string& str_file) {
+      std::ifstream cFile(str_file.c_str());
+      if(!cFile) {
+         return false;
+      }
+      /* Skip the comments */
+      while(cFile.peek() == '#') {
+         cFile.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+      }
+      UInt32 unCols, unRows;
+      Real fMinX, fMinY, fMaxX, fMaxY;
+      cFile >> unCols >> unRows >> fMinX >> fMinY >> fMaxX >> fMaxY;
+      if(!cFile ||
+         unCols != m_unCols || unRows != m_unRows ||
+         std::abs(fMinX - m_cMin.GetX()) > 1e-6 || std::abs(fMinY - m_cMin.GetY()) > 1e-6 ||
+         std::abs(fMaxX - m_cMax.GetX()) > 1e-6 || std::abs(fMaxY - m_cMax.GetY()) > 1e-6) {
+         EPUCK2_LOG_WARNING("partition", "The density file \"" << str_file
+                            << "\" does not match the arena, ignoring it");
+         return false;
+      }
+      std::vector<Real> vecDensity(m_vecDensity.size());
+      for(size_t i = 0; i < vecDensity.size(); ++i) {
+         cFile >> vecDensity[i];
+      }
+      if(!cFile) {
+         EPUCK2_LOG_WARNING("partition", "The density file \"" << str_file
+                            << "\" is truncated, ignoring it");
+         return false;
+      }
+      m_vecDensity.swap(vecDensity);
+      EPUCK2_LOG_INFO("partition", "Density loaded from \"" << str_file << "\"");
+      return true;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Partition::AddRobots(const CVector2& c_position,
+                                    Real f_robots) {
+      m_vecDensity[GetCellAt(c_position)] += f_robots;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Partition::AddRobots(const CVector2& c_min,
+                                    const CVector2& c_max,
+                                    Real f_robots) {
+      /* Keep the part of the rectangle within the arena */
+      CVector2 cMin(std::max(c_min.GetX(), m_cMin.GetX()), std::max(c_min.GetY(), m_cMin.GetY()));
+      CVector2 cMax(std::min(c_max.GetX(), m_cMax.GetX()), std::min(c_max.GetY(), m_cMax.GetY()));
+      Real fArea = (cMax.GetX() - cMin.GetX()) * (cMax.GetY() - cMin.GetY());
+      if(cMax.GetX() <= cMin.GetX() || cMax.GetY() <= cMin.GetY() || fArea <= 0.0) {
+         AddRobots((c_min + c_max) * 0.5, f_robots);
+         return;
+      }
+      /* Each cell gets the robots of the area it overlaps */
+      for(UInt32 j = 0; j < m_unRows; ++j) {
+         Real fY0 = std::max(cMin.GetY(), m_cMin.GetY() + j * m_cCellSize.GetY());
+         Real fY1 = std::min(cMax.GetY(), m_cMin.GetY() + (j + 1) * m_cCellSize.GetY());
+         if(fY1 <= fY0) continue;
+         for(UInt32 i = 0; i < m_unCols; ++i) {
+            Real fX0 = std::max(cMin.GetX(), m_cMin.GetX() + i * m_cCellSize.GetX());
+            Real fX1 = std::min(cMax.GetX(), m_cMin.GetX() + (i + 1) * m_cCellSize.GetX());
+            if(fX1 <= fX0) continue;
+            m_vecDensity[GetCell(i, j)] += f_robots * (fX1 - fX0) * (fY1 - fY0) / fArea;
+         }
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Partition::Compute(UInt32 un_tiles,
+                                  std::vector<STile>& vec_tiles) const {
+      if(un_tiles > m_unCols * m_unRows) {
+         THROW_ARGOSEXCEPTION("The resolution is too coarse for " << un_tiles << " engines");
+      }
+      /* A little weight everywhere, so that empty areas are split by area */
+      Real fTotal = 0.0;
+      for(size_t i = 0; i < m_vecDensity.size(); ++i) {
+         fTotal += m_vecDensity[i];
+      }
+      Real fFloor = (fTotal > 0.0) ? 1e-3 * fTotal / m_vecDensity.size() : 1.0;
+      std::vector<Real> vecWeights(m_vecDensity.size());
+      for(size_t i = 0; i < m_vecDensity.size(); ++i) {
+         vecWeights[i] = m_vecDensity[i] + fFloor;
+      }
+      vec_tiles.clear();
+      Split(0, m_unCols, 0, m_unRows, un_tiles, vecWeights, vec_tiles);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Partition::Resize(const CVector2& c_min,
+                                 const CVector2& c_max,
+                                 Real f_resolution) {
+      m_cMin = c_min;
+      m_cMax = c_max;
+      m_unCols = std::max<UInt32>(1, static_cast<UInt32>(std::ceil((c_max.GetX() - c_min.GetX()) / f_resolution - 1e-9)));
+      m_unRows = std::max<UInt32>(1, static_cast<UInt32>(std::ceil((c_max.GetY() - c_min.GetY()) / f_resolution - 1e-9)));
+      /* The cells cover the arena exactly */
+      m_cCellSize.Set((c_max.GetX() - c_min.GetX()) / m_unCols,
+                      (c_max.GetY() - c_min.GetY()) / m_unRows);
+      m_vecDensity.assign(m_unCols * m_unRows, 0.0);
+      m_vecObserved.assign(m_unCols * m_unRows, 0.0);
+      m_unSamples = 0;
+      m_unSteps = 0;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   UInt32 CEPuck2Partition::GetCellAt(const CVector2& c_position) const {
+      /* Positions outside the arena go to the closest cell */
+      UInt32 unX = std::min<UInt32>(m_unCols - 1, static_cast<UInt32>(
+                      std::max<Real>(0.0, (c_position.GetX() - m_cMin.GetX()) / m_cCellSize.GetX())));
+      UInt32 unY = std::min<UInt32>(m_unRows - 1, static_cast<UInt32>(
+                      std::max<Real>(0.0, (c_position.GetY() - m_cMin.GetY()) / m_cCellSize.GetY())));
+      return GetCell(unX, unY);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Partition::Estimate(TConfigurationNode& t_root) {
+      /* The e-puck2s of the arena */
+      TConfigurationNode& tArena = GetNode(t_root, "arena");
+      TConfigurationNodeIterator itEntity;
+      for(itEntity = itEntity.begin(&tArena);
+          itEntity != itEntity.end();
+          ++itEntity) {
+         if(itEntity->Value() == "e-puck2" && NodeExists(*itEntity, "body")) {
+            CVector3 cPosition;
+            GetNodeAttribute(GetNode(*itEntity, "body"), "position", cPosition);
+            AddRobots(CVector2(cPosition.GetX(), cPosition.GetY()), 1.0);
+         }
+         else if(itEntity->Value() == "distribute" &&
+                 NodeExists(*itEntity, "position") &&
+                 NodeExists(*itEntity, "entity") &&
+                 NodeExists(GetNode(*itEntity, "entity"), "e-puck2")) {
+            TConfigurationNode& tPosition = GetNode(*itEntity, "position");
+            UInt32 unQuantity = 0;
+            GetNodeAttribute(GetNode(*itEntity, "entity"), "quantity", unQuantity);
+            std::string strMethod;
+            GetNodeAttribute(tPosition, "method", strMethod);
+            CVector3 cMin(m_cMin.GetX(), m_cMin.GetY(), 0.0);
+            CVector3 cMax(m_cMax.GetX(), m_cMax.GetY(), 0.0);
+            if(strMethod == "uniform") {
+               GetNodeAttribute(tPosition, "min", cMin);
+               GetNodeAttribute(tPosition, "max", cMax);
+            }
+            else if(strMethod == "gaussian") {
+               CVector3 cMean, cStdDev;
+               GetNodeAttribute(tPosition, "mean", cMean);
+               GetNodeAttribute(tPosition, "std_dev", cStdDev);
+               cMin = cMean - cStdDev * 2.0;
+               cMax = cMean + cStdDev * 2.0;
+            }
+            else if(strMethod == "grid") {
+               CVector3 cGridCenter, cDistances, cLayout;
+               GetNodeAttribute(tPosition, "center", cGridCenter);
+               GetNodeAttribute(tPosition, "distances", cDistances);
+               GetNodeAttribute(tPosition, "layout", cLayout);
+               CVector3 cHalf(0.5 * cDistances.GetX() * std::max<Real>(0.0, cLayout.GetX() - 1.0),
+                              0.5 * cDistances.GetY() * std::max<Real>(0.0, cLayout.GetY() - 1.0),
+                              0.0);
+               cMin = cGridCenter - cHalf;
+               cMax = cGridCenter + cHalf;
+            }
+            AddRobots(CVector2(cMin.GetX(), cMin.GetY()),
+                      CVector2(cMax.GetX(), cMax.GetY()),
+                      unQuantity);
+         }
+      }
+      /* The e-puck2s placed by the loop functions */
+      TConfigurationNode& tLoopFunctions = GetNode(t_root, "loop_functions");
+      TConfigurationNodeIterator itPlacement("placement");
+      for(itPlacement = itPlacement.begin(&tLoopFunctions);
+          itPlacement != itPlacement.end();
+          ++itPlacement) {
+         UInt32 unQuantity = 0;
+         CVector2 cMin, cMax;
+         GetNodeAttribute(*itPlacement, "quantity", unQuantity);
+         GetNodeAttribute(*itPlacement, "min", cMin);
+         GetNodeAttribute(*itPlacement, "max", cMax);
+         AddRobots(cMin, cMax, unQuantity);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Partition::Split(UInt32 un_x0,
+                                UInt32 un_x1,
+                                UInt32 un_y0,
+                                UInt32 un_y1,
+                                UInt32 un_tiles,
+                                const std::vector<Real>& vec_weights,
+                                std::vector<STile>& vec_tiles) const {
+      if(un_tiles == 1) {
+         STile sTile;
+         sTile.Min.Set(un_x0 == 0 ? m_cMin.GetX() : m_cMin.GetX() + un_x0 * m_cCellSize.GetX() + CUT_OFFSET,
+                       un_y0 == 0 ? m_cMin.GetY() : m_cMin.GetY() + un_y0 * m_cCellSize.GetY() + CUT_OFFSET);
+         sTile.Max.Set(un_x1 == m_unCols ? m_cMax.GetX() : m_cMin.GetX() + un_x1 * m_cCellSize.GetX() + CUT_OFFSET,
+                       un_y1 == m_unRows ? m_cMax.GetY() : m_cMin.GetY() + un_y1 * m_cCellSize.GetY() + CUT_OFFSET);
+         sTile.Robots = 0.0;
+         for(UInt32 j = un_y0; j < un_y1; ++j) {
+            for(UInt32 i = un_x0; i < un_x1; ++i) {
+               sTile.Robots += m_vecDensity[GetCell(i, j)];
+            }
+         }
+         vec_tiles.push_back(sTile);
+         return;
+      }
+      /* Cut across the longer side, if it has at least two cells */
+      UInt32 unWidth = un_x1 - un_x0;
+      UInt32 unHeight = un_y1 - un_y0;
+      bool bCutX = (unWidth * m_cCellSize.GetX() >= unHeight * m_cCellSize.GetY());
+      if(bCutX && unWidth < 2) bCutX = false;
+      if(!bCutX && unHeight < 2) bCutX = true;
+      UInt32 unLines = bCutX ? unWidth : unHeight;
+      UInt32 unAcross = bCutX ? unHeight : unWidth;
+      /* Weight of each line of cells along the cut direction */
+      std::vector<Real> vecLines(unLines, 0.0);
+      Real fTotal = 0.0;
+      for(UInt32 j = un_y0; j < un_y1; ++j) {
+         for(UInt32 i = un_x0; i < un_x1; ++i) {
+            Real fWeight = vec_weights[GetCell(i, j)];
+            vecLines[bCutX ? (i - un_x0) : (j - un_y0)] += fWeight;
+            fTotal += fWeight;
+         }
+      }
+      /* The cut that best gives each side its share of the robots */
+      UInt32 unFirst = un_tiles / 2;
+      UInt32 unSecond = un_tiles - unFirst;
+      Real fTarget = fTotal * unFirst / un_tiles;
+      Real fCumulative = 0.0;
+      Real fBestError = -1.0;
+      UInt32 unCut = 0;
+      for(UInt32 c = 1; c < unLines; ++c) {
+         fCumulative += vecLines[c - 1];
+         /* Each side needs at least a cell per tile */
+         if(c * unAcross < unFirst || (unLines - c) * unAcross < unSecond) continue;
+         Real fError = std::abs(fCumulative - fTarget);
+         if(fBestError < 0.0 || fError < fBestError) {
+            fBestError = fError;
+            unCut = c;
+         }
+      }
+      if(unCut == 0) {
+         THROW_ARGOSEXCEPTION("The resolution is too coarse for " << un_tiles
+                              << " engines in " << unWidth << "x" << unHeight << " cells");
+      }
+      if(bCutX) {
+         Split(un_x0, un_x0 + unCut, un_y0, un_y1, unFirst, vec_weights, vec_tiles);
+         Split(un_x0 + unCut, un_x1, un_y0, un_y1, unSecond, vec_weights, vec_tiles);
+      }
+      else {
+         Split(un_x0, un_x1, un_y0, un_y0 + unCut, unFirst, vec_weights, vec_tiles);
+         Split(un_x0, un_x1, un_y0 + unCut, un_y1, unSecond, vec_weights, vec_tiles);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Partition::WriteEngines(TConfigurationNode& t_engines,
+                                       Real f_bottom,
+                                       Real f_top) const {
+      TConfigurationNodeIterator itEngine("dynamics2d");
+      itEngine = itEngine.begin(&t_engines);
+      if(itEngine == itEngine.end()) {
+         THROW_ARGOSEXCEPTION("The partition needs a <dynamics2d> engine in <physics_engines>");
+      }
+      TConfigurationNode& tTemplate = *itEngine;
+      if(NodeExists(tTemplate, "boundaries")) {
+         THROW_ARGOSEXCEPTION("The <dynamics2d> engine of the partition must not have <boundaries>");
+      }
+      std::string strId;
+      GetNodeAttribute(tTemplate, "id", strId);
+      /* Copy the template before it gets its own boundaries */
+      for(UInt32 i = 1; i < m_vecTiles.size(); ++i) {
+         ticpp::Node* pcEngine = t_engines.InsertEndChild(tTemplate);
+         SetTileEngine(*pcEngine->ToElement(), strId, i, m_vecTiles[i], f_bottom, f_top);
+      }
+      SetTileEngine(tTemplate, strId, 0, m_vecTiles[0], f_bottom, f_top);
+   }
+
+   /****************************************/
+   /****************************************/
+
+}
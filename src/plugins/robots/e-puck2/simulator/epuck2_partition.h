@@ -0,0 +1,190 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/epuck2_partition.h>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#ifndef EPUCK2_PARTITION_H
+#define EPUCK2_PARTITION_H
+
+namespace argos {
+   class CEPuck2Partition;
+}
+
+#include <argos3/core/utility/math/vector2.h>
+#include <argos3/core/utility/configuration/argos_configuration.h>
+#include <string>
+#include <vector>
+
+namespace argos {
+
+   /**
+    * Splits the arena among several dynamics2d engines with the same number
+    * of e-puck2s each.
+    * <p>
+    * The density of the robots is kept on a grid over the arena. The arena is
+    * cut in two along its longer side where the robots split in proportion to
+    * the engines on each side, and each half is cut again until there is one
+    * tile per engine. Empty areas are split by area.
+    * </p>
+    * <p>
+    * The engines must be known before ARGoS creates them, so Preprocess()
+    * rewrites the &lt;physics_engines&gt; section of the configuration. It
+    * must be called from the constructor of the loop functions, which runs
+    * before the physics engines are initialized. The first &lt;dynamics2d&gt;
+    * engine is used as a template: it is replaced by one copy per tile, with
+    * ids "<id>_0", "<id>_1", ... and the boundaries of the tile. The number of
+    * engines defaults to the number of threads, so that the physics scales
+    * with 'threads':
+    * </p>
+    * <pre>
+    *   <loop_functions library="..." label="partition_loop_functions">
+    *     <partition engines="4" resolution="0.25"
+    *                density_file="density.txt" memory="0.5" sample_period="10" />
+    *   </loop_functions>
+    * </pre>
+    * <p>
+    * The density comes from 'density_file', if it exists. Otherwise, it is
+    * estimated from the e-puck2s of the &lt;arena&gt;, from their &lt;distribute&gt;
+    * areas and from the &lt;placement&gt; nodes of the loop functions.
+    * </p>
+    * <p>
+    * During the experiment, Sample() records where the robots are every
+    * 'sample_period' steps. Save() blends the observed density with the
+    * previous one, weighted by 'memory', and writes 'density_file'. The next
+    * episode then starts with boundaries that follow where the robots
+    * actually went.
+    * </p>
+    * <p>
+    * As with any ARGoS multi-engine setup, a static obstacle only belongs to
+    * the engines that contain its origin. Each engine also has its own wind
+    * stage, so no wake crosses a boundary, see CDynamics2DEPuck2Wind. Keep a
+    * single engine when &lt;air_resistance&gt; shielding must be exact.
+    * </p>
+    */
+   class CEPuck2Partition {
+
+   public:
+
+      /**
+       * A tile of the arena.
+       */
+      struct STile {
+         CVector2 Min;
+         CVector2 Max;
+         /** Expected number of robots */
+         Real Robots;
+      };
+
+   public:
+
+      CEPuck2Partition();
+
+      /**
+       * Parses &lt;arena&gt; and &lt;loop_functions&gt;&lt;partition&gt; and
+       * rewrites &lt;physics_engines&gt;.
+       * Does nothing without a &lt;partition&gt; node.
+       * @return <tt>true</tt> if the partition is enabled.
+       */
+      bool Preprocess();
+
+      /**
+       * Records the positions of all the e-puck2s, every 'sample_period' calls.
+       */
+      void Sample();
+
+      /**
+       * Blends the observed density with the previous one and writes it.
+       */
+      void Save();
+
+      /**
+       * Splits the arena into tiles with the same number of robots.
+       * @param un_tiles The number of tiles.
+       * @param vec_tiles The tiles, written by the call.
+       * @throws CARGoSException if the density grid is too coarse.
+       */
+      void Compute(UInt32 un_tiles,
+                   std::vector<STile>& vec_tiles) const;
+
+      /**
+       * Adds robots at a position.
+       */
+      void AddRobots(const CVector2& c_position,
+                     Real f_robots);
+
+      /**
+       * Adds robots spread uniformly over a rectangle.
+       */
+      void AddRobots(const CVector2& c_min,
+                     const CVector2& c_max,
+                     Real f_robots);
+
+      /**
+       * Loads a density file.
+       * @return <tt>false</tt> if the file does not exist or does not match the grid.
+       */
+      bool Load(const std::string& str_file);
+
+      inline const std::vector<STile>& GetTiles() const {
+         return m_vecTiles;
+      }
+
+   private:
+
+      /** Sets the grid over the arena */
+      void Resize(const CVector2& c_min,
+                  const CVector2& c_max,
+                  Real f_resolution);
+
+      /** Estimates the density from the configuration */
+      void Estimate(TConfigurationNode& t_root);
+
+      /** Cuts a range of cells into tiles */
+      void Split(UInt32 un_x0,
+                 UInt32 un_x1,
+                 UInt32 un_y0,
+                 UInt32 un_y1,
+                 UInt32 un_tiles,
+                 const std::vector<Real>& vec_weights,
+                 std::vector<STile>& vec_tiles) const;
+
+      /** Replaces the template engine with one engine per tile */
+      void WriteEngines(TConfigurationNode& t_engines,
+                        Real f_bottom,
+                        Real f_top) const;
+
+      inline UInt32 GetCell(UInt32 un_x,
+                            UInt32 un_y) const {
+         return un_y * m_unCols + un_x;
+      }
+
+      /** Returns the cell of a position */
+      UInt32 GetCellAt(const CVector2& c_position) const;
+
+   private:
+
+      CVector2 m_cMin;
+      CVector2 m_cMax;
+      CVector2 m_cCellSize;
+      UInt32 m_unCols;
+      UInt32 m_unRows;
+
+      /* Expected robots per cell, and the robots observed over the samples */
+      std::vector<Real> m_vecDensity;
+      std::vector<Real> m_vecObserved;
+      UInt32 m_unSamples;
+
+      std::vector<STile> m_vecTiles;
+      std::string m_strDensityFile;
+      Real m_fMemory;
+      UInt32 m_unSamplePeriod;
+      UInt32 m_unSteps;
+
+   };
+
+}
+
+#endif
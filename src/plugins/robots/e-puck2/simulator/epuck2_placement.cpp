@@ -0,0 +1,407 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/epuck2_placement.cpp>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#include "epuck2_placement.h"
+#include "epuck2_entity.h"
+
+#include <argos3/core/simulator/simulator.h>
+#include <argos3/core/simulator/space/space.h>
+#include <argos3/core/utility/math/quaternion.h>
+#include <cmath>
+
+namespace argos {
+
+   /****************************************/
+   /****************************************/
+
+   /* Candidates tried around each active position by the Poisson-disc sampling */
+   static const UInt32 POISSON_CANDIDATES = 30;
+
+   /* Random attempts per robot before switching to the Poisson-disc fill */
+   static const UInt32 DART_ATTEMPTS = 16;
+
+   /****************************************/
+   /****************************************/
+
+   CEPuck2Placement::CEPuck2Placement(const CVector2& c_min,
+                                      const CVector2& c_max,
+                                      Real f_min_distance,
+                                      CRandom::CRNG* pc_rng) :
+      m_cMin(c_min),
+      m_cMax(c_max),
+      m_fMinDistance(f_min_distance),
+      m_fMinDistanceSquare(f_min_distance * f_min_distance),
+      m_pcRNG(pc_rng) {
+      if(m_cMax.GetX() <= m_cMin.GetX() || m_cMax.GetY() <= m_cMin.GetY()) {
+         THROW_ARGOSEXCEPTION("The placement area is empty: min = " << m_cMin << ", max = " << m_cMax);
+      }
+      if(m_fMinDistance <= 0.0f) {
+         THROW_ARGOSEXCEPTION("The minimum distance between robots must be positive, got " << m_fMinDistance);
+      }
+      m_unCols = static_cast<UInt32>(std::ceil((m_cMax.GetX() - m_cMin.GetX()) / m_fMinDistance));
+      m_unRows = static_cast<UInt32>(std::ceil((m_cMax.GetY() - m_cMin.GetY()) / m_fMinDistance));
+      m_vecCellHeads.assign(m_unCols * m_unRows, -1);
+      m_vecAreaHeads.assign(m_unCols * m_unRows, -1);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Placement::Reserve(const CVector2& c_position) {
+      Insert(c_position);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Placement::ReserveRectangle(const CVector2& c_center,
+                                           const CVector2& c_half_size,
+                                           const CRadians& c_orientation) {
+      SArea sArea;
+      sArea.Center = c_center;
+      sArea.HalfSize.Set(Abs(c_half_size.GetX()), Abs(c_half_size.GetY()));
+      sArea.Cos = Cos(c_orientation);
+      sArea.Sin = Sin(c_orientation);
+      sArea.Radius = 0.0f;
+      InsertArea(sArea);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Placement::ReserveDisc(const CVector2& c_center,
+                                      Real f_radius) {
+      SArea sArea;
+      sArea.Center = c_center;
+      sArea.HalfSize.Set(0.0f, 0.0f);
+      sArea.Cos = 1.0f;
+      sArea.Sin = 0.0f;
+      sArea.Radius = Abs(f_radius);
+      InsertArea(sArea);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   bool CEPuck2Placement::IsFree(const CVector2& c_position) const {
+      if(IsInTakenArea(c_position)) {
+         return false;
+      }
+      /* The cells are as large as the minimum distance: checking the 3x3 block is enough */
+      SInt32 nCol = static_cast<SInt32>(GetCell(c_position) % m_unCols);
+      SInt32 nRow = static_cast<SInt32>(GetCell(c_position) / m_unCols);
+      for(SInt32 nR = Max<SInt32>(nRow - 1, 0); nR <= Min<SInt32>(nRow + 1, m_unRows - 1); ++nR) {
+         for(SInt32 nC = Max<SInt32>(nCol - 1, 0); nC <= Min<SInt32>(nCol + 1, m_unCols - 1); ++nC) {
+            for(SInt32 nIdx = m_vecCellHeads[nR * m_unCols + nC];
+                nIdx >= 0;
+                nIdx = m_vecNext[nIdx]) {
+               if(SquareDistance(m_vecPositions[nIdx], c_position) < m_fMinDistanceSquare) {
+                  return false;
+               }
+            }
+         }
+      }
+      return true;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Placement::Generate(UInt32 un_quantity,
+                                   EMethod e_method,
+                                   std::vector<CVector2>& vec_positions) {
+      vec_positions.reserve(vec_positions.size() + un_quantity);
+      switch(e_method) {
+         case METHOD_POISSON:
+            GeneratePoisson(un_quantity, vec_positions);
+            break;
+         case METHOD_GRID_JITTER:
+            GenerateGridJitter(un_quantity, vec_positions);
+            break;
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   std::vector<CEPuck2Entity*> CEPuck2Placement::CreateEntities(const std::vector<CVector2>& vec_positions,
+                                                               const std::string& str_id_prefix,
+                                                               const std::string& str_controller_id,
+                                                               CRandom::CRNG* pc_rng) {
+      CSpace& cSpace = CSimulator::GetInstance().GetSpace();
+      std::vector<CEPuck2Entity*> vecEntities;
+      vecEntities.reserve(vec_positions.size());
+      for(size_t i = 0; i < vec_positions.size(); ++i) {
+         std::ostringstream cId;
+         cId << str_id_prefix << i;
+         CEPuck2Entity* pcEntity =
+            new CEPuck2Entity(cId.str(),
+                              str_controller_id,
+                              CVector3(vec_positions[i].GetX(), vec_positions[i].GetY(), 0.0f),
+                              CQuaternion(pc_rng->Uniform(CRadians::UNSIGNED_RANGE), CVector3::Z));
+         CallEntityOperation<CSpaceOperationAddEntity, CSpace, void>(cSpace, *pcEntity);
+         vecEntities.push_back(pcEntity);
+      }
+      return vecEntities;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CEPuck2Placement::EMethod CEPuck2Placement::ParseMethod(const std::string& str_method) {
+      if(str_method == "poisson") return METHOD_POISSON;
+      if(str_method == "grid_jitter") return METHOD_GRID_JITTER;
+      THROW_ARGOSEXCEPTION("Unknown placement method \"" << str_method << "\", allowed values are \"poisson\" and \"grid_jitter\"");
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Placement::GeneratePoisson(UInt32 un_quantity,
+                                          std::vector<CVector2>& vec_positions) {
+      size_t unBase = m_vecPositions.size();
+      /*
+       * Sparse case: random positions are accepted most of the time, and
+       * the result is uniformly spread over the area
+       */
+      UInt32 unAttempts = DART_ATTEMPTS * un_quantity;
+      while(m_vecPositions.size() - unBase < un_quantity && unAttempts > 0) {
+         CVector2 cPos = RandomPosition(m_cMin, m_cMax);
+         if(IsFree(cPos)) Insert(cPos);
+         --unAttempts;
+      }
+      size_t unDarts = m_vecPositions.size();
+      if(unDarts - unBase < un_quantity) {
+         /*
+          * Dense case: fill the remaining space with Poisson-disc sampling,
+          * growing from the positions taken so far, then keep as many of the
+          * new positions as needed
+          */
+         std::vector<UInt32> vecActive;
+         for(UInt32 i = unBase; i < unDarts; ++i) {
+            vecActive.push_back(i);
+         }
+         if(vecActive.empty()) {
+            /* Look for a free seed */
+            for(UInt32 i = 0; i < DART_ATTEMPTS; ++i) {
+               CVector2 cPos = RandomPosition(m_cMin, m_cMax);
+               if(IsFree(cPos)) {
+                  Insert(cPos);
+                  vecActive.push_back(m_vecPositions.size() - 1);
+                  break;
+               }
+            }
+         }
+         while(! vecActive.empty()) {
+            UInt32 unActive = m_pcRNG->Uniform(CRange<UInt32>(0, vecActive.size()));
+            const CVector2 cCenter = m_vecPositions[vecActive[unActive]];
+            bool bFound = false;
+            for(UInt32 i = 0; i < POISSON_CANDIDATES && !bFound; ++i) {
+               CVector2 cPos = cCenter +
+                  CVector2(m_pcRNG->Uniform(CRange<Real>(m_fMinDistance, 2.0f * m_fMinDistance)),
+                           m_pcRNG->Uniform(CRadians::UNSIGNED_RANGE));
+               if(IsInArea(cPos) && IsFree(cPos)) {
+                  Insert(cPos);
+                  vecActive.push_back(m_vecPositions.size() - 1);
+                  bFound = true;
+               }
+            }
+            if(! bFound) {
+               vecActive[unActive] = vecActive.back();
+               vecActive.pop_back();
+            }
+         }
+         UInt32 unMissing = un_quantity - (unDarts - unBase);
+         if(m_vecPositions.size() - unDarts < unMissing) {
+            THROW_ARGOSEXCEPTION("Cannot place " << un_quantity <<
+                                 " e-puck2s at least " << m_fMinDistance <<
+                                 "m apart in the area " << m_cMin << " - " << m_cMax <<
+                                 ": only " << (m_vecPositions.size() - unBase) << " fit");
+         }
+         /* Keep a random subset of the filling positions and rebuild the hash */
+         std::vector<UInt32> vecFill;
+         vecFill.reserve(m_vecPositions.size() - unDarts);
+         for(UInt32 i = unDarts; i < m_vecPositions.size(); ++i) {
+            vecFill.push_back(i);
+         }
+         Shuffle(vecFill, unMissing);
+         std::vector<CVector2> vecKept(m_vecPositions.begin(), m_vecPositions.begin() + unDarts);
+         for(UInt32 i = 0; i < unMissing; ++i) {
+            vecKept.push_back(m_vecPositions[vecFill[i]]);
+         }
+         m_vecPositions.clear();
+         m_vecNext.clear();
+         m_vecCellHeads.assign(m_vecCellHeads.size(), -1);
+         for(size_t i = 0; i < vecKept.size(); ++i) {
+            Insert(vecKept[i]);
+         }
+      }
+      vec_positions.insert(vec_positions.end(),
+                           m_vecPositions.begin() + unBase,
+                           m_vecPositions.end());
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Placement::GenerateGridJitter(UInt32 un_quantity,
+                                             std::vector<CVector2>& vec_positions) {
+      if(un_quantity == 0) return;
+      Real fWidth = m_cMax.GetX() - m_cMin.GetX();
+      Real fHeight = m_cMax.GetY() - m_cMin.GetY();
+      /* Find the grid with enough cells and the largest square cells */
+      Real fSide = 0.0f;
+      UInt32 unCols = 0;
+      UInt32 unRows = 0;
+      for(UInt32 unC = 1; unC <= un_quantity; ++unC) {
+         UInt32 unR = (un_quantity + unC - 1) / unC;
+         Real fS = Min(fWidth / unC, fHeight / unR);
+         if(fS > fSide) {
+            fSide = fS;
+            unCols = unC;
+            unRows = unR;
+         }
+      }
+      if(fSide < m_fMinDistance) {
+         THROW_ARGOSEXCEPTION("Cannot place " << un_quantity <<
+                              " e-puck2s at least " << m_fMinDistance <<
+                              "m apart in the area " << m_cMin << " - " << m_cMax <<
+                              " with a grid: the cells would be " << fSide << "m wide");
+      }
+      /*
+       * Each position stays within half the slack from its cell centre, so two
+       * positions are never closer than the minimum distance
+       */
+      Real fJitter = (fSide - m_fMinDistance) * 0.5f;
+      CVector2 cOrigin = m_cMin + CVector2((fWidth - unCols * fSide) * 0.5f + fSide * 0.5f,
+                                           (fHeight - unRows * fSide) * 0.5f + fSide * 0.5f);
+      std::vector<UInt32> vecCells(unCols * unRows);
+      for(UInt32 i = 0; i < vecCells.size(); ++i) {
+         vecCells[i] = i;
+      }
+      Shuffle(vecCells, vecCells.size());
+      UInt32 unPlaced = 0;
+      for(UInt32 i = 0; i < vecCells.size() && unPlaced < un_quantity; ++i) {
+         CVector2 cCenter = cOrigin + CVector2((vecCells[i] % unCols) * fSide,
+                                               (vecCells[i] / unCols) * fSide);
+         CVector2 cPos = RandomPosition(cCenter - CVector2(fJitter, fJitter),
+                                        cCenter + CVector2(fJitter, fJitter));
+         /* Only reserved positions can get in the way */
+         if(IsFree(cPos)) {
+            Insert(cPos);
+            vec_positions.push_back(cPos);
+            ++unPlaced;
+         }
+      }
+      if(unPlaced < un_quantity) {
+         THROW_ARGOSEXCEPTION("Cannot place " << un_quantity <<
+                              " e-puck2s in the area " << m_cMin << " - " << m_cMax <<
+                              ": only " << unPlaced << " fit around the reserved positions");
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Placement::Insert(const CVector2& c_position) {
+      UInt32 unCell = GetCell(c_position);
+      m_vecPositions.push_back(c_position);
+      m_vecNext.push_back(m_vecCellHeads[unCell]);
+      m_vecCellHeads[unCell] = m_vecPositions.size() - 1;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Placement::InsertArea(const SArea& s_area) {
+      /* List the area in all the cells its bounding box covers, grown by the clearance */
+      Real fGrow = s_area.Radius + 0.5f * m_fMinDistance;
+      Real fExtentX = Abs(s_area.Cos) * s_area.HalfSize.GetX() + Abs(s_area.Sin) * s_area.HalfSize.GetY() + fGrow;
+      Real fExtentY = Abs(s_area.Sin) * s_area.HalfSize.GetX() + Abs(s_area.Cos) * s_area.HalfSize.GetY() + fGrow;
+      UInt32 unMin = GetCell(s_area.Center - CVector2(fExtentX, fExtentY));
+      UInt32 unMax = GetCell(s_area.Center + CVector2(fExtentX, fExtentY));
+      m_vecAreas.push_back(s_area);
+      for(UInt32 unRow = unMin / m_unCols; unRow <= unMax / m_unCols; ++unRow) {
+         for(UInt32 unCol = unMin % m_unCols; unCol <= unMax % m_unCols; ++unCol) {
+            UInt32 unCell = unRow * m_unCols + unCol;
+            m_vecAreaIndices.push_back(m_vecAreas.size() - 1);
+            m_vecAreaNext.push_back(m_vecAreaHeads[unCell]);
+            m_vecAreaHeads[unCell] = m_vecAreaIndices.size() - 1;
+         }
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   bool CEPuck2Placement::IsInTakenArea(const CVector2& c_position) const {
+      Real fClearance = 0.5f * m_fMinDistance;
+      for(SInt32 nIdx = m_vecAreaHeads[GetCell(c_position)];
+          nIdx >= 0;
+          nIdx = m_vecAreaNext[nIdx]) {
+         const SArea& sArea = m_vecAreas[m_vecAreaIndices[nIdx]];
+         /* The position in the frame of the rectangle, clamped to it */
+         CVector2 cDelta = c_position - sArea.Center;
+         Real fX =  sArea.Cos * cDelta.GetX() + sArea.Sin * cDelta.GetY();
+         Real fY = -sArea.Sin * cDelta.GetX() + sArea.Cos * cDelta.GetY();
+         CVector2 cOutside(fX - Min(Max(fX, -sArea.HalfSize.GetX()), sArea.HalfSize.GetX()),
+                           fY - Min(Max(fY, -sArea.HalfSize.GetY()), sArea.HalfSize.GetY()));
+         Real fReach = sArea.Radius + fClearance;
+         if(cOutside.SquareLength() < fReach * fReach) {
+            return true;
+         }
+      }
+      return false;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   UInt32 CEPuck2Placement::GetCell(const CVector2& c_position) const {
+      /* Positions outside the area go to the border cells */
+      SInt32 nCol = static_cast<SInt32>(std::floor((c_position.GetX() - m_cMin.GetX()) / m_fMinDistance));
+      SInt32 nRow = static_cast<SInt32>(std::floor((c_position.GetY() - m_cMin.GetY()) / m_fMinDistance));
+      nCol = Min<SInt32>(Max<SInt32>(nCol, 0), m_unCols - 1);
+      nRow = Min<SInt32>(Max<SInt32>(nRow, 0), m_unRows - 1);
+      return nRow * m_unCols + nCol;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   bool CEPuck2Placement::IsInArea(const CVector2& c_position) const {
+      return
+         c_position.GetX() >= m_cMin.GetX() && c_position.GetX() <= m_cMax.GetX() &&
+         c_position.GetY() >= m_cMin.GetY() && c_position.GetY() <= m_cMax.GetY();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CVector2 CEPuck2Placement::RandomPosition(const CVector2& c_min,
+                                             const CVector2& c_max) {
+      return CVector2(m_pcRNG->Uniform(CRange<Real>(c_min.GetX(), c_max.GetX())),
+                      m_pcRNG->Uniform(CRange<Real>(c_min.GetY(), c_max.GetY())));
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Placement::Shuffle(std::vector<UInt32>& vec_indices,
+                                  UInt32 un_quantity) {
+      /* Partial Fisher-Yates: only the first un_quantity elements are drawn */
+      for(UInt32 i = 0; i < un_quantity && i + 1 < vec_indices.size(); ++i) {
+         UInt32 unPick = m_pcRNG->Uniform(CRange<UInt32>(i, vec_indices.size()));
+         std::swap(vec_indices[i], vec_indices[unPick]);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+}
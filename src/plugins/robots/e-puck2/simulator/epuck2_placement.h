@@ -0,0 +1,198 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/epuck2_placement.h>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#ifndef EPUCK2_PLACEMENT_H
+#define EPUCK2_PLACEMENT_H
+
+namespace argos {
+   class CEPuck2Placement;
+   class CEPuck2Entity;
+}
+
+#include <argos3/core/utility/math/vector2.h>
+#include <argos3/core/utility/math/rng.h>
+#include <argos3/core/utility/configuration/argos_configuration.h>
+#include <vector>
+
+namespace argos {
+
+   /**
+    * Places large numbers of e-puck2s without overlaps.
+    * <p>
+    * Instead of trying random positions and checking them against the physics
+    * engine, as &lt;distribute&gt; does, the positions are generated in a
+    * rectangular area and checked against a spatial hash of the positions
+    * already taken. Two methods are available:
+    * </p>
+    * <ul>
+    * <li>METHOD_POISSON: Poisson-disc sampling. The area is filled with
+    *     positions at least the minimum distance apart, and the requested
+    *     number of positions is drawn from them. The result looks random and
+    *     works up to the densest packing the sampling can reach;</li>
+    * <li>METHOD_GRID_JITTER: the area is split into a grid with as many cells
+    *     as needed, and each chosen cell gets a position randomly displaced
+    *     from its centre. Cheaper, and it reaches higher densities, but it
+    *     looks more regular.</li>
+    * </ul>
+    * <p>
+    * The positions of robots already in the arena can be reserved with
+    * Reserve() before generating the new ones. Obstacles, such as walls, boxes
+    * and cylinders, are reserved as areas with ReserveRectangle() and
+    * ReserveDisc(): the new robot centres are kept at least half the minimum
+    * distance away from them. The areas are stored in the spatial hash too,
+    * so each check only visits the areas that cover its cell.
+    * </p>
+    */
+   class CEPuck2Placement {
+
+   public:
+
+      enum EMethod {
+         METHOD_POISSON = 0,
+         METHOD_GRID_JITTER
+      };
+
+   public:
+
+      /**
+       * Class constructor.
+       * @param c_min The minimum corner of the area.
+       * @param c_max The maximum corner of the area.
+       * @param f_min_distance The minimum distance between two robot centres.
+       * @param pc_rng The random number generator.
+       */
+      CEPuck2Placement(const CVector2& c_min,
+                       const CVector2& c_max,
+                       Real f_min_distance,
+                       CRandom::CRNG* pc_rng);
+
+      /**
+       * Marks a position as taken.
+       * The position may lie outside the area.
+       * @param c_position The position.
+       */
+      void Reserve(const CVector2& c_position);
+
+      /**
+       * Marks a rectangle as taken, e.g., a wall or a box.
+       * The rectangle may lie partly or fully outside the area.
+       * @param c_center The centre of the rectangle.
+       * @param c_half_size Half the size of the rectangle along its own axes.
+       * @param c_orientation The rotation of the rectangle around the <em>z</em>-axis.
+       */
+      void ReserveRectangle(const CVector2& c_center,
+                            const CVector2& c_half_size,
+                            const CRadians& c_orientation);
+
+      /**
+       * Marks a disc as taken, e.g., a cylinder.
+       * The disc may lie partly or fully outside the area.
+       * @param c_center The centre of the disc.
+       * @param f_radius The radius of the disc.
+       */
+      void ReserveDisc(const CVector2& c_center,
+                       Real f_radius);
+
+      /**
+       * Returns <tt>true</tt> if a position is far enough from all the taken ones.
+       * @param c_position The position.
+       */
+      bool IsFree(const CVector2& c_position) const;
+
+      /**
+       * Generates new positions and marks them as taken.
+       * @param un_quantity The number of positions.
+       * @param e_method The sampling method.
+       * @param vec_positions The generated positions are appended here.
+       * @throws CARGoSException if the area cannot hold that many robots.
+       */
+      void Generate(UInt32 un_quantity,
+                    EMethod e_method,
+                    std::vector<CVector2>& vec_positions);
+
+      /**
+       * Creates e-puck2s at the given positions, with random orientations, and
+       * adds them to the space.
+       * The ids are the prefix followed by a progressive number.
+       * @param vec_positions The positions.
+       * @param str_id_prefix The prefix of the ids.
+       * @param str_controller_id The id of the controller.
+       * @param pc_rng The random number generator for the orientations.
+       * @return The created entities.
+       */
+      static std::vector<CEPuck2Entity*> CreateEntities(const std::vector<CVector2>& vec_positions,
+                                                        const std::string& str_id_prefix,
+                                                        const std::string& str_controller_id,
+                                                        CRandom::CRNG* pc_rng);
+
+      /**
+       * Parses a sampling method.
+       * @param str_method Either "poisson" or "grid_jitter".
+       * @throws CARGoSException if the method is unknown.
+       */
+      static EMethod ParseMethod(const std::string& str_method);
+
+   private:
+
+      /** A taken area: a rectangle grown by a radius */
+      struct SArea {
+         CVector2 Center;
+         CVector2 HalfSize;
+         Real Cos;
+         Real Sin;
+         Real Radius;
+      };
+
+      void GeneratePoisson(UInt32 un_quantity,
+                           std::vector<CVector2>& vec_positions);
+
+      void GenerateGridJitter(UInt32 un_quantity,
+                              std::vector<CVector2>& vec_positions);
+
+      void Insert(const CVector2& c_position);
+
+      void InsertArea(const SArea& s_area);
+
+      bool IsInTakenArea(const CVector2& c_position) const;
+
+      UInt32 GetCell(const CVector2& c_position) const;
+
+      bool IsInArea(const CVector2& c_position) const;
+
+      CVector2 RandomPosition(const CVector2& c_min,
+                              const CVector2& c_max);
+
+      void Shuffle(std::vector<UInt32>& vec_indices,
+                   UInt32 un_quantity);
+
+   private:
+
+      CVector2 m_cMin;
+      CVector2 m_cMax;
+      Real m_fMinDistance;
+      Real m_fMinDistanceSquare;
+      CRandom::CRNG* m_pcRNG;
+
+      /* Spatial hash, with cells as large as the minimum distance */
+      UInt32 m_unCols;
+      UInt32 m_unRows;
+      std::vector<SInt32> m_vecCellHeads;
+      std::vector<SInt32> m_vecNext;
+      std::vector<CVector2> m_vecPositions;
+
+      /* The taken areas, listed in every cell they cover */
+      std::vector<SArea> m_vecAreas;
+      std::vector<SInt32> m_vecAreaHeads;
+      std::vector<SInt32> m_vecAreaNext;
+      std::vector<UInt32> m_vecAreaIndices;
+
+   };
+
+}
+
+#endif
@@ -0,0 +1,235 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/epuck2_recorder.cpp>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#include "epuck2_recorder.h"
+#include "epuck2_entity.h"
+#include "epuck2_led_equipped_entity.h"
+#include "epuck2_battery_equipped_entity.h"
+#include "epuck2_snapshot.h"
+
+#include <argos3/core/simulator/simulator.h>
+#include <argos3/core/simulator/space/space.h>
+#include <argos3/core/simulator/physics_engine/physics_engine.h>
+#include <argos3/core/simulator/entity/controllable_entity.h>
+#include <argos3/core/simulator/entity/embodied_entity.h>
+#include <argos3/core/control_interface/ci_controller.h>
+#include <argos3/plugins/robots/e-puck2/control_interface/ci_epuck2_proximity_sensor.h>
+#include <argos3/plugins/robots/e-puck2/control_interface/ci_epuck2_light_sensor.h>
+#include <argos3/plugins/robots/e-puck2/control_interface/ci_epuck2_ground_sensor.h>
+
+namespace argos {
+
+   /****************************************/
+   /****************************************/
+
+   template<typename SENSOR>
+   static SENSOR* FindSensor(CEPuck2Entity& c_entity,
+                             const std::string& str_name) {
+      CCI_Controller& cController = c_entity.GetControllableEntity().GetController();
+      CCI_Controller::TSensorMap::const_iterator it = cController.GetAllSensors().find(str_name);
+      return it != cController.GetAllSensors().end() ?
+         dynamic_cast<SENSOR*>(it->second) : NULL;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CEPuck2Recorder::CEPuck2Recorder() :
+      m_unPeriod(1),
+      m_unChunkTicks(64),
+      m_bSensors(false) {}
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Recorder::Init(TConfigurationNode& t_tree) {
+      try {
+         CMedium::Init(t_tree);
+         GetNodeAttribute(t_tree, "file", m_strFile);
+         GetNodeAttributeOrDefault(t_tree, "period", m_unPeriod, m_unPeriod);
+         GetNodeAttributeOrDefault(t_tree, "chunk", m_unChunkTicks, m_unChunkTicks);
+         GetNodeAttributeOrDefault(t_tree, "sensors", m_bSensors, m_bSensors);
+         if(m_unPeriod == 0) {
+            THROW_ARGOSEXCEPTION("'period' must be positive");
+         }
+         if(m_unChunkTicks == 0) {
+            THROW_ARGOSEXCEPTION("'chunk' must be positive");
+         }
+      }
+      catch(CARGoSException& ex) {
+         THROW_ARGOSEXCEPTION_NESTED("Error initializing the e-puck2 recorder medium", ex);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Recorder::Reset() {
+      /* The next step starts the file over */
+      m_cWriter.Close();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Recorder::Destroy() {
+      m_cWriter.Close();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Recorder::Update() {
+      UInt32 unClock = CSimulator::GetInstance().GetSpace().GetSimulationClock();
+      if(unClock % m_unPeriod != 0) return;
+      if(! m_cWriter.IsOpen()) {
+         Start(unClock);
+      }
+      std::vector<CEPuck2Entity*> vecRobots = CEPuck2Snapshot::GetRobots();
+      if(vecRobots.size() != m_sHeader.Robots.size()) {
+         THROW_ARGOSEXCEPTION("e-puck2 recorder: the e-puck2s changed during the recording of \"" <<
+                              m_strFile << "\"");
+      }
+      for(size_t i = 0; i < vecRobots.size(); ++i) {
+         if(vecRobots[i]->GetId() != m_sHeader.Robots[i].Id) {
+            THROW_ARGOSEXCEPTION("e-puck2 recorder: expected \"" << m_sHeader.Robots[i].Id <<
+                                 "\", found \"" << vecRobots[i]->GetId() << "\"");
+         }
+         Record(*vecRobots[i], m_sHeader.Robots[i], &m_vecFrame[m_vecOffsets[i]]);
+      }
+      m_cWriter.Append(m_vecFrame);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Recorder::Start(UInt32 un_clock) {
+      m_sHeader = CEPuck2Trajectory::SHeader();
+      m_sHeader.TicksPerSecond = static_cast<UInt32>(Round(1.0 / CPhysicsEngine::GetSimulationClockTick()));
+      m_sHeader.StartClock = un_clock;
+      m_sHeader.Period = m_unPeriod;
+      m_sHeader.ChunkTicks = m_unChunkTicks;
+      std::vector<CEPuck2Entity*> vecRobots = CEPuck2Snapshot::GetRobots();
+      m_sHeader.Robots.resize(vecRobots.size());
+      for(size_t i = 0; i < vecRobots.size(); ++i) {
+         CEPuck2Entity& cEntity = *vecRobots[i];
+         CEPuck2Trajectory::SRobot& sRobot = m_sHeader.Robots[i];
+         sRobot.Id = cEntity.GetId();
+         if(cEntity.HasLEDEquippedEntity()) {
+            sRobot.LEDs = cEntity.GetLEDEquippedEntity().GetLEDs().size();
+         }
+         if(m_bSensors) {
+            CCI_EPuck2ProximitySensor* pcProximity =
+               FindSensor<CCI_EPuck2ProximitySensor>(cEntity, "epuck2_proximity");
+            if(pcProximity != NULL) sRobot.Proximity = pcProximity->GetReadings().size();
+            CCI_EPuck2LightSensor* pcLight =
+               FindSensor<CCI_EPuck2LightSensor>(cEntity, "epuck2_light");
+            if(pcLight != NULL) sRobot.Light = pcLight->GetReadings().size();
+            CCI_Epuck2GroundSensor* pcGround =
+               FindSensor<CCI_Epuck2GroundSensor>(cEntity, "epuck2_ground");
+            if(pcGround != NULL) sRobot.Ground = pcGround->GetReadings().size();
+         }
+      }
+      m_vecOffsets = m_sHeader.GetOffsets();
+      m_vecFrame.assign(m_sHeader.GetColumns(), 0);
+      m_cWriter.Open(m_strFile, m_sHeader);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Recorder::Record(CEPuck2Entity& c_entity,
+                                const CEPuck2Trajectory::SRobot& s_robot,
+                                SInt64* pn_columns) {
+      /* Pose */
+      const SAnchor& sOrigin = c_entity.GetEmbodiedEntity().GetOriginAnchor();
+      CRadians cYaw, cPitch, cRoll;
+      sOrigin.Orientation.ToEulerAngles(cYaw, cPitch, cRoll);
+      cYaw.UnsignedNormalize();
+      pn_columns[CEPuck2Trajectory::COLUMN_X] =
+         Round(sOrigin.Position.GetX() / CEPuck2Trajectory::POSITION_UNIT);
+      pn_columns[CEPuck2Trajectory::COLUMN_Y] =
+         Round(sOrigin.Position.GetY() / CEPuck2Trajectory::POSITION_UNIT);
+      pn_columns[CEPuck2Trajectory::COLUMN_YAW] =
+         Round(cYaw.GetValue() / CRadians::TWO_PI.GetValue() / CEPuck2Trajectory::YAW_UNIT) % 65536;
+      /* Battery */
+      pn_columns[CEPuck2Trajectory::COLUMN_CHARGE] = c_entity.HasBatterySensorEquippedEntity() ?
+         Round(c_entity.GetBatterySensorEquippedEntity().GetAvailableCharge() / CEPuck2Trajectory::CHARGE_UNIT) :
+         0;
+      /* LEDs */
+      SInt64* pnColumn = pn_columns + CEPuck2Trajectory::COLUMN_LEDS;
+      for(UInt32 i = 0; i < s_robot.LEDs; ++i) {
+         const CColor& cColor = c_entity.GetLEDEquippedEntity().GetLED(i).GetColor();
+         *pnColumn++ =
+            (static_cast<SInt64>(cColor.GetRed())   << 16) |
+            (static_cast<SInt64>(cColor.GetGreen()) <<  8) |
+            (static_cast<SInt64>(cColor.GetBlue()));
+      }
+      /* Sensors, missing readings are recorded as 0 */
+      if(s_robot.Proximity > 0) {
+         const CCI_EPuck2ProximitySensor::TReadings& tReadings =
+            FindSensor<CCI_EPuck2ProximitySensor>(c_entity, "epuck2_proximity")->GetReadings();
+         for(UInt32 i = 0; i < s_robot.Proximity; ++i) {
+            *pnColumn++ = i < tReadings.size() ? tReadings[i].Value : 0;
+         }
+      }
+      if(s_robot.Light > 0) {
+         const CCI_EPuck2LightSensor::TReadings& tReadings =
+            FindSensor<CCI_EPuck2LightSensor>(c_entity, "epuck2_light")->GetReadings();
+         for(UInt32 i = 0; i < s_robot.Light; ++i) {
+            *pnColumn++ = i < tReadings.size() ? tReadings[i].Value : 0;
+         }
+      }
+      if(s_robot.Ground > 0) {
+         const std::vector<SInt32>& vecReadings =
+            FindSensor<CCI_Epuck2GroundSensor>(c_entity, "epuck2_ground")->GetReadings();
+         for(UInt32 i = 0; i < s_robot.Ground; ++i) {
+            *pnColumn++ = i < vecReadings.size() ? vecReadings[i] : 0;
+         }
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   REGISTER_MEDIUM(CEPuck2Recorder,
+                   "epuck2_recorder",
+                   "Daniel H. Stolfi based on the Carlo Pinciroli's work",
+                   "1.0",
+                   "Records the trajectories of the e-puck2s to a compact binary file.",
+                   "Every 'period' steps, this medium records the planar pose, battery charge and\n"
+                   "LED colours of all the e-puck2s. With 'sensors' set, the readings of the\n"
+                   "epuck2_proximity, epuck2_light and epuck2_ground sensors of the controllers\n"
+                   "are recorded as well.\n"
+                   "The values are stored in fixed point: positions in units of 0.1 mm, the yaw\n"
+                   "in 1/65536 of a turn and the charge in millionths. The ticks are grouped in\n"
+                   "chunks of 'chunk' ticks. Inside a chunk, each value is stored as the\n"
+                   "difference from the previous tick, and runs of unchanged values take a\n"
+                   "single byte, so a swarm that mostly stands still takes little space. The\n"
+                   "file is written a chunk at a time.\n"
+                   "A reset starts the file over. The file can be played back with the\n"
+                   "epuck2_replay medium.\n\n"
+                   "REQUIRED XML CONFIGURATION\n\n"
+                   "  <media>\n"
+                   "    <epuck2_recorder id=\"recorder\" file=\"run.ep2t\" />\n"
+                   "    ...\n"
+                   "  </media>\n\n"
+                   "OPTIONAL XML CONFIGURATION\n\n"
+                   "To record one step in ten, in chunks of 128 ticks, with the sensor readings:\n\n"
+                   "  <media>\n"
+                   "    <epuck2_recorder id=\"recorder\" file=\"run.ep2t\" period=\"10\"\n"
+                   "                     chunk=\"128\" sensors=\"true\" />\n"
+                   "    ...\n"
+                   "  </media>\n",
+                   "Usable"
+   );
+
+   /****************************************/
+   /****************************************/
+
+}
@@ -0,0 +1,77 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/epuck2_recorder.h>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#ifndef EPUCK2_RECORDER_H
+#define EPUCK2_RECORDER_H
+
+namespace argos {
+   class CEPuck2Recorder;
+   class CEPuck2Entity;
+}
+
+#include <argos3/core/simulator/medium/medium.h>
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_trajectory.h>
+#include <string>
+#include <vector>
+
+namespace argos {
+
+   /**
+    * Records the trajectories of all the e-puck2s to a compact binary file.
+    * <p>
+    * Every 'period' steps, the pose, battery charge and LED colours of each
+    * robot, and optionally the readings of its proximity, light and ground
+    * sensors, are appended to a CEPuck2TrajectoryWriter. The file is written
+    * one chunk at a time, so a crash only loses the last chunk. It can be
+    * played back without the controllers with CEPuck2Replay.
+    * </p>
+    * <p>
+    * The robots are taken when the recording starts, and must not change
+    * during the experiment.
+    * </p>
+    */
+   class CEPuck2Recorder : public CMedium {
+
+   public:
+
+      CEPuck2Recorder();
+
+      virtual ~CEPuck2Recorder() {}
+
+      virtual void Init(TConfigurationNode& t_tree);
+      virtual void Reset();
+      virtual void Destroy();
+      virtual void Update();
+
+   private:
+
+      /** Describes the robots and creates the file */
+      void Start(UInt32 un_clock);
+
+      /** Fills the frame with the state of a robot */
+      void Record(CEPuck2Entity& c_entity,
+                  const CEPuck2Trajectory::SRobot& s_robot,
+                  SInt64* pn_columns);
+
+   private:
+
+      std::string m_strFile;
+      UInt32 m_unPeriod;
+      UInt32 m_unChunkTicks;
+      bool m_bSensors;
+
+      CEPuck2TrajectoryWriter m_cWriter;
+      CEPuck2Trajectory::SHeader m_sHeader;
+      std::vector<UInt32> m_vecOffsets;
+      std::vector<SInt64> m_vecFrame;
+
+   };
+
+}
+
+#endif
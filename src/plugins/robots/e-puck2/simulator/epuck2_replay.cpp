@@ -0,0 +1,215 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/epuck2_replay.cpp>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#include "epuck2_replay.h"
+#include "epuck2_entity.h"
+#include "epuck2_led_equipped_entity.h"
+#include "epuck2_battery_equipped_entity.h"
+#include "epuck2_snapshot.h"
+#include "kinematic_epuck2_engine.h"
+
+#include <argos3/core/simulator/simulator.h>
+#include <argos3/core/simulator/space/space.h>
+#include <argos3/core/simulator/physics_engine/physics_engine.h>
+#include <argos3/core/simulator/entity/controllable_entity.h>
+#include <argos3/core/simulator/entity/embodied_entity.h>
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_log.h>
+
+#include <map>
+
+namespace argos {
+
+   /****************************************/
+   /****************************************/
+
+   CEPuck2Replay::CEPuck2Replay() :
+      m_nStep(1),
+      m_unStart(0),
+      m_bLoop(false),
+      m_bMatched(false),
+      m_unTick(0) {}
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Replay::Init(TConfigurationNode& t_tree) {
+      try {
+         CMedium::Init(t_tree);
+         /* The replay moves the robots itself: a full physics engine would only
+            simulate them again, and push them off their recorded poses */
+         CPhysicsEngine::TVector& vecEngines = CSimulator::GetInstance().GetPhysicsEngines();
+         for(size_t i = 0; i < vecEngines.size(); ++i) {
+            if(dynamic_cast<CKinematicEPuck2Engine*>(vecEngines[i]) == NULL) {
+               THROW_ARGOSEXCEPTION("The physics engine \"" << vecEngines[i]->GetId()
+                                    << "\" is not an epuck2_kinematic engine: a replay only "
+                                    "supports the epuck2_kinematic engine");
+            }
+         }
+         GetNodeAttribute(t_tree, "file", m_strFile);
+         GetNodeAttributeOrDefault(t_tree, "step", m_nStep, m_nStep);
+         GetNodeAttributeOrDefault(t_tree, "start", m_unStart, m_unStart);
+         GetNodeAttributeOrDefault(t_tree, "loop", m_bLoop, m_bLoop);
+         m_cReader.Open(m_strFile);
+         if(m_unStart > 0) Seek(m_unStart);
+         m_vecOffsets = m_cReader.GetHeader().GetOffsets();
+      }
+      catch(CARGoSException& ex) {
+         THROW_ARGOSEXCEPTION_NESTED("Error initializing the e-puck2 replay medium", ex);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Replay::Reset() {
+      /* Back to the start, disabling the controllers again at the next step */
+      m_bMatched = false;
+      m_unTick = m_unStart;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Replay::Update() {
+      if(m_cReader.GetTicks() == 0) return;
+      if(! m_bMatched) Match();
+      const SInt64* pnFrame = m_cReader.GetFrame(m_unTick);
+      const CEPuck2Trajectory::SHeader& sHeader = m_cReader.GetHeader();
+      for(size_t i = 0; i < m_vecRobots.size(); ++i) {
+         if(m_vecRobots[i] != NULL) {
+            Apply(*m_vecRobots[i], sHeader.Robots[i], pnFrame + m_vecOffsets[i]);
+         }
+      }
+      /* Next tick, which stays on the last one at either end unless looping */
+      SInt64 nTicks = m_cReader.GetTicks();
+      SInt64 nNext = static_cast<SInt64>(m_unTick) + m_nStep;
+      if(m_bLoop) {
+         nNext %= nTicks;
+         if(nNext < 0) nNext += nTicks;
+      }
+      else if(nNext < 0) {
+         nNext = 0;
+      }
+      else if(nNext >= nTicks) {
+         nNext = nTicks - 1;
+      }
+      m_unTick = nNext;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Replay::Seek(UInt32 un_tick) {
+      if(un_tick >= m_cReader.GetTicks()) {
+         THROW_ARGOSEXCEPTION("e-puck2 replay: tick " << un_tick << " out of " << m_cReader.GetTicks());
+      }
+      m_unTick = un_tick;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Replay::Match() {
+      std::vector<CEPuck2Entity*> vecArena = CEPuck2Snapshot::GetRobots();
+      std::map<std::string, CEPuck2Entity*> mapArena;
+      for(size_t i = 0; i < vecArena.size(); ++i) {
+         mapArena[vecArena[i]->GetId()] = vecArena[i];
+      }
+      const CEPuck2Trajectory::SHeader& sHeader = m_cReader.GetHeader();
+      m_vecRobots.assign(sHeader.Robots.size(), NULL);
+      for(size_t i = 0; i < sHeader.Robots.size(); ++i) {
+         std::map<std::string, CEPuck2Entity*>::iterator it = mapArena.find(sHeader.Robots[i].Id);
+         if(it == mapArena.end()) {
+            EPUCK2_LOG_WARNING("replay", "\"" << sHeader.Robots[i].Id << "\" is not in the arena");
+            continue;
+         }
+         m_vecRobots[i] = it->second;
+         it->second->GetControllableEntity().SetEnabled(false);
+         mapArena.erase(it);
+      }
+      for(std::map<std::string, CEPuck2Entity*>::iterator it = mapArena.begin();
+          it != mapArena.end();
+          ++it) {
+         EPUCK2_LOG_WARNING("replay", "\"" << it->first << "\" is not in \"" << m_strFile
+                            << "\" and runs its controller");
+      }
+      m_bMatched = true;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Replay::Apply(CEPuck2Entity& c_entity,
+                             const CEPuck2Trajectory::SRobot& s_robot,
+                             const SInt64* pn_columns) {
+      /* Pose, on the plane the robot stands on */
+      CEmbodiedEntity& cBody = c_entity.GetEmbodiedEntity();
+      CVector3 cPosition(pn_columns[CEPuck2Trajectory::COLUMN_X] * CEPuck2Trajectory::POSITION_UNIT,
+                         pn_columns[CEPuck2Trajectory::COLUMN_Y] * CEPuck2Trajectory::POSITION_UNIT,
+                         cBody.GetOriginAnchor().Position.GetZ());
+      CQuaternion cOrientation;
+      cOrientation.FromAngleAxis(
+         CRadians::TWO_PI * (pn_columns[CEPuck2Trajectory::COLUMN_YAW] * CEPuck2Trajectory::YAW_UNIT),
+         CVector3::Z);
+      cBody.MoveTo(cPosition, cOrientation, false, true);
+      /* Battery */
+      if(c_entity.HasBatterySensorEquippedEntity()) {
+         c_entity.GetBatterySensorEquippedEntity().SetAvailableCharge(
+            pn_columns[CEPuck2Trajectory::COLUMN_CHARGE] * CEPuck2Trajectory::CHARGE_UNIT);
+      }
+      /* LEDs */
+      if(c_entity.HasLEDEquippedEntity()) {
+         CEPuck2LEDEquippedEntity& cLEDs = c_entity.GetLEDEquippedEntity();
+         UInt32 unLEDs = Min<UInt32>(s_robot.LEDs, cLEDs.GetLEDs().size());
+         const SInt64* pnColor = pn_columns + CEPuck2Trajectory::COLUMN_LEDS;
+         for(UInt32 i = 0; i < unLEDs; ++i) {
+            cLEDs.SetLEDColor(i, CColor((pnColor[i] >> 16) & 0xFF,
+                                        (pnColor[i] >>  8) & 0xFF,
+                                        pnColor[i] & 0xFF));
+         }
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   REGISTER_MEDIUM(CEPuck2Replay,
+                   "epuck2_replay",
+                   "Daniel H. Stolfi based on the Carlo Pinciroli's work",
+                   "1.0",
+                   "Plays back a trajectory written by the epuck2_recorder medium.",
+                   "This medium loads a file written by epuck2_recorder and, at every step, moves\n"
+                   "the e-puck2s to their recorded poses and sets their LEDs and battery charge.\n"
+                   "The robots are matched by id, and their controllers are disabled; robots that\n"
+                   "are not in the file run as usual. The configuration must create the recorded\n"
+                   "robots, e.g., with the same <distribute> as the recorded experiment. The\n"
+                   "only physics engine allowed is epuck2_kinematic, which just holds the robots:\n"
+                   "other engines are rejected, as they would simulate the robots again.\n"
+                   "'step' recorded ticks are played per simulation step: 1 plays the file at the\n"
+                   "recorded speed, larger values fast-forward and negative values rewind. The\n"
+                   "playback starts from tick 'start' and stops on the last tick, or starts over\n"
+                   "with 'loop' set.\n\n"
+                   "REQUIRED XML CONFIGURATION\n\n"
+                   "  <media>\n"
+                   "    <epuck2_replay id=\"replay\" file=\"run.ep2t\" />\n"
+                   "    ...\n"
+                   "  </media>\n\n"
+                   "OPTIONAL XML CONFIGURATION\n\n"
+                   "To play every fourth tick from tick 1000, over and over:\n\n"
+                   "  <media>\n"
+                   "    <epuck2_replay id=\"replay\" file=\"run.ep2t\" step=\"4\" start=\"1000\"\n"
+                   "                   loop=\"true\" />\n"
+                   "    ...\n"
+                   "  </media>\n",
+                   "Usable"
+   );
+
+   /****************************************/
+   /****************************************/
+
+}
@@ -0,0 +1,98 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/epuck2_replay.h>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#ifndef EPUCK2_REPLAY_H
+#define EPUCK2_REPLAY_H
+
+namespace argos {
+   class CEPuck2Replay;
+   class CEPuck2Entity;
+}
+
+#include <argos3/core/simulator/medium/medium.h>
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_trajectory.h>
+#include <string>
+#include <vector>
+
+namespace argos {
+
+   /**
+    * Plays back a trajectory written by CEPuck2Recorder.
+    * <p>
+    * The e-puck2s of the arena are matched with the recorded ones by id, and
+    * their controllers are disabled. At every step, the robots are moved to
+    * their recorded poses, and their LEDs and batteries are set, so that an
+    * experiment can be watched again in the visualization without running
+    * the controllers or the physics. Physics engines other than
+    * epuck2_kinematic are rejected. 'step' recorded ticks are played per
+    * simulation step: larger values fast-forward, negative ones rewind.
+    * </p>
+    */
+   class CEPuck2Replay : public CMedium {
+
+   public:
+
+      CEPuck2Replay();
+
+      virtual ~CEPuck2Replay() {}
+
+      virtual void Init(TConfigurationNode& t_tree);
+      virtual void Reset();
+      virtual void Destroy() {}
+      virtual void Update();
+
+      /**
+       * Moves to a recorded tick, shown at the next step.
+       * @throws CARGoSException if the tick is out of range.
+       */
+      void Seek(UInt32 un_tick);
+
+      /** The recorded tick shown next */
+      inline UInt32 GetTick() const {
+         return m_unTick;
+      }
+
+      /** Number of recorded ticks */
+      inline UInt32 GetTicks() const {
+         return m_cReader.GetTicks();
+      }
+
+      /** Recorded ticks played per simulation step */
+      inline void SetStep(SInt32 n_step) {
+         m_nStep = n_step;
+      }
+
+   private:
+
+      /** Matches the robots and disables their controllers */
+      void Match();
+
+      /** Sets a robot to its recorded state */
+      void Apply(CEPuck2Entity& c_entity,
+                 const CEPuck2Trajectory::SRobot& s_robot,
+                 const SInt64* pn_columns);
+
+   private:
+
+      std::string m_strFile;
+      SInt32 m_nStep;
+      UInt32 m_unStart;
+      bool m_bLoop;
+
+      CEPuck2TrajectoryReader m_cReader;
+      /* The e-puck2 of each recorded robot, NULL if not in the arena */
+      std::vector<CEPuck2Entity*> m_vecRobots;
+      std::vector<UInt32> m_vecOffsets;
+      bool m_bMatched;
+      UInt32 m_unTick;
+
+   };
+
+}
+
+#endif
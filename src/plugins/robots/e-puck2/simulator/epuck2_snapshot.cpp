@@ -0,0 +1,228 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/epuck2_snapshot.cpp>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#include "epuck2_snapshot.h"
+#include "epuck2_entity.h"
+#include "epuck2_led_equipped_entity.h"
+#include "epuck2_battery_equipped_entity.h"
+#include "epuck2_encoder_default_sensor.h"
+#include "epuck2_led_default_actuator.h"
+#include "dynamics2d_epuck2_model.h"
+
+#include <argos3/core/simulator/simulator.h>
+#include <argos3/core/simulator/space/space.h>
+#include <argos3/core/simulator/entity/controllable_entity.h>
+#include <argos3/core/simulator/entity/embodied_entity.h>
+#include <argos3/core/control_interface/ci_controller.h>
+
+namespace argos {
+
+   /****************************************/
+   /****************************************/
+
+   static const UInt32 SNAPSHOT_MAGIC = 0x53325045; // "EP2S"
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Snapshot::Take() {
+      Clear();
+      std::vector<CEPuck2Entity*> vecRobots = GetRobots();
+      Write(SNAPSHOT_MAGIC);
+      Write(VERSION);
+      Write<UInt32>(CSimulator::GetInstance().GetSpace().GetSimulationClock());
+      Write<UInt32>(vecRobots.size());
+      for(size_t i = 0; i < vecRobots.size(); ++i) {
+         TakeRobot(*vecRobots[i]);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Snapshot::Restore() {
+      m_unCursor = 0;
+      UInt32 unMagic, unVersion, unClock, unRobots;
+      Read(unMagic);
+      Read(unVersion);
+      if(unMagic != SNAPSHOT_MAGIC || unVersion != VERSION) {
+         THROW_ARGOSEXCEPTION("e-puck2 snapshot: not a snapshot, or version " << unVersion <<
+                              " instead of " << VERSION);
+      }
+      Read(unClock);
+      Read(unRobots);
+      std::vector<CEPuck2Entity*> vecRobots = GetRobots();
+      if(unRobots != vecRobots.size()) {
+         THROW_ARGOSEXCEPTION("e-puck2 snapshot: it contains " << unRobots <<
+                              " e-puck2s, but the space has " << vecRobots.size());
+      }
+      for(size_t i = 0; i < vecRobots.size(); ++i) {
+         RestoreRobot(*vecRobots[i]);
+      }
+      CSimulator::GetInstance().GetSpace().SetSimulationClock(unClock);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Snapshot::TakeRobot(CEPuck2Entity& c_entity) {
+      Write(c_entity.GetId());
+      /* Wheels, restored before the bodies that follow them */
+      Write(c_entity.GetWheeledEntity().GetWheelVelocities()[0]);
+      Write(c_entity.GetWheeledEntity().GetWheelVelocities()[1]);
+      /* Body, in the dynamics2d engines */
+      CEmbodiedEntity& cBody = c_entity.GetEmbodiedEntity();
+      for(size_t i = 0; i < cBody.GetPhysicsModelsNum(); ++i) {
+         CDynamics2DEPuck2Model* pcModel = dynamic_cast<CDynamics2DEPuck2Model*>(&cBody.GetPhysicsModel(i));
+         if(pcModel != NULL) {
+            Write<UInt8>(1);
+            pcModel->SaveState(*this);
+         }
+      }
+      Write<UInt8>(0);
+      /* Battery */
+      Write<UInt8>(c_entity.HasBatterySensorEquippedEntity());
+      if(c_entity.HasBatterySensorEquippedEntity()) {
+         c_entity.GetBatterySensorEquippedEntity().SaveState(*this);
+      }
+      /* LEDs */
+      Write<UInt8>(c_entity.HasLEDEquippedEntity());
+      if(c_entity.HasLEDEquippedEntity()) {
+         CEPuck2LEDEquippedEntity& cLEDs = c_entity.GetLEDEquippedEntity();
+         Write<UInt32>(cLEDs.GetLEDs().size());
+         for(UInt32 i = 0; i < cLEDs.GetLEDs().size(); ++i) {
+            const CColor& cColor = cLEDs.GetLED(i).GetColor();
+            Write<UInt8>(cColor.GetRed());
+            Write<UInt8>(cColor.GetGreen());
+            Write<UInt8>(cColor.GetBlue());
+            Write<UInt8>(cColor.GetAlpha());
+         }
+      }
+      /* Controller, encoders included */
+      CCI_Controller& cController = c_entity.GetControllableEntity().GetController();
+      CCI_Controller::TSensorMap::const_iterator itEncoder = cController.GetAllSensors().find("epuck2_encoder");
+      CEPuck2EncoderDefaultSensor* pcEncoder =
+         itEncoder != cController.GetAllSensors().end() ?
+         dynamic_cast<CEPuck2EncoderDefaultSensor*>(itEncoder->second) : NULL;
+      Write<UInt8>(pcEncoder != NULL);
+      if(pcEncoder != NULL) {
+         pcEncoder->SaveState(*this);
+      }
+      CEPuck2SnapshotState* pcState = dynamic_cast<CEPuck2SnapshotState*>(&cController);
+      Write<UInt8>(pcState != NULL);
+      if(pcState != NULL) {
+         pcState->SaveState(*this);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Snapshot::RestoreRobot(CEPuck2Entity& c_entity) {
+      std::string strId;
+      Read(strId);
+      if(strId != c_entity.GetId()) {
+         THROW_ARGOSEXCEPTION("e-puck2 snapshot: expected \"" << strId <<
+                              "\", found \"" << c_entity.GetId() << "\"");
+      }
+      /* Wheels */
+      Real pfWheels[2];
+      Read(pfWheels[0]);
+      Read(pfWheels[1]);
+      c_entity.GetWheeledEntity().SetVelocities(pfWheels);
+      /* Body, in the dynamics2d engines */
+      CEmbodiedEntity& cBody = c_entity.GetEmbodiedEntity();
+      UInt8 unMore;
+      for(size_t i = 0; i < cBody.GetPhysicsModelsNum(); ++i) {
+         CDynamics2DEPuck2Model* pcModel = dynamic_cast<CDynamics2DEPuck2Model*>(&cBody.GetPhysicsModel(i));
+         if(pcModel != NULL) {
+            Read(unMore);
+            if(! unMore) {
+               THROW_ARGOSEXCEPTION("e-puck2 snapshot: \"" << strId << "\" has more bodies than stored");
+            }
+            pcModel->LoadState(*this);
+         }
+      }
+      Read(unMore);
+      if(unMore) {
+         THROW_ARGOSEXCEPTION("e-puck2 snapshot: \"" << strId << "\" has fewer bodies than stored");
+      }
+      /* Battery */
+      UInt8 unHas;
+      Read(unHas);
+      if(unHas != c_entity.HasBatterySensorEquippedEntity()) {
+         THROW_ARGOSEXCEPTION("e-puck2 snapshot: \"" << strId << "\" battery mismatch");
+      }
+      if(unHas) {
+         c_entity.GetBatterySensorEquippedEntity().LoadState(*this);
+      }
+      /* LEDs */
+      Read(unHas);
+      if(unHas != c_entity.HasLEDEquippedEntity()) {
+         THROW_ARGOSEXCEPTION("e-puck2 snapshot: \"" << strId << "\" LED mismatch");
+      }
+      if(unHas) {
+         CEPuck2LEDEquippedEntity& cLEDs = c_entity.GetLEDEquippedEntity();
+         UInt32 unLEDs;
+         Read(unLEDs);
+         if(unLEDs != cLEDs.GetLEDs().size()) {
+            THROW_ARGOSEXCEPTION("e-puck2 snapshot: \"" << strId << "\" has " <<
+                                 cLEDs.GetLEDs().size() << " LEDs, " << unLEDs << " stored");
+         }
+         for(UInt32 i = 0; i < unLEDs; ++i) {
+            UInt8 punRGBA[4];
+            Read(punRGBA, 4);
+            cLEDs.SetLEDColor(i, CColor(punRGBA[0], punRGBA[1], punRGBA[2], punRGBA[3]));
+         }
+      }
+      /* Controller */
+      CCI_Controller& cController = c_entity.GetControllableEntity().GetController();
+      /* The LED actuator must agree with the LEDs, or it would skip changes */
+      CCI_Controller::TActuatorMap::const_iterator itLEDs = cController.GetAllActuators().find("epuck2_leds");
+      if(itLEDs != cController.GetAllActuators().end()) {
+         CEPuck2LEDsDefaultActuator* pcLEDs = dynamic_cast<CEPuck2LEDsDefaultActuator*>(itLEDs->second);
+         if(pcLEDs != NULL) pcLEDs->SyncWithLEDs();
+      }
+      Read(unHas);
+      if(unHas) {
+         CCI_Controller::TSensorMap::const_iterator itEncoder = cController.GetAllSensors().find("epuck2_encoder");
+         CEPuck2EncoderDefaultSensor* pcEncoder =
+            itEncoder != cController.GetAllSensors().end() ?
+            dynamic_cast<CEPuck2EncoderDefaultSensor*>(itEncoder->second) : NULL;
+         if(pcEncoder == NULL) {
+            THROW_ARGOSEXCEPTION("e-puck2 snapshot: \"" << strId << "\" has no encoder sensor");
+         }
+         pcEncoder->LoadState(*this);
+      }
+      Read(unHas);
+      if(unHas) {
+         CEPuck2SnapshotState* pcState = dynamic_cast<CEPuck2SnapshotState*>(&cController);
+         if(pcState == NULL) {
+            THROW_ARGOSEXCEPTION("e-puck2 snapshot: the controller of \"" << strId << "\" cannot load its state");
+         }
+         pcState->LoadState(*this);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   std::vector<CEPuck2Entity*> CEPuck2Snapshot::GetRobots() {
+      std::vector<CEPuck2Entity*> vecRobots;
+      CSpace::TVecEntities& vecEntities = CSimulator::GetInstance().GetSpace().GetRootEntityVector();
+      for(size_t i = 0; i < vecEntities.size(); ++i) {
+         CEPuck2Entity* pcRobot = dynamic_cast<CEPuck2Entity*>(vecEntities[i]);
+         if(pcRobot != NULL) vecRobots.push_back(pcRobot);
+      }
+      return vecRobots;
+   }
+
+   /****************************************/
+   /****************************************/
+
+}
@@ -0,0 +1,188 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/epuck2_snapshot.h>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#ifndef EPUCK2_SNAPSHOT_H
+#define EPUCK2_SNAPSHOT_H
+
+namespace argos {
+   class CEPuck2Snapshot;
+   class CEPuck2SnapshotState;
+   class CEPuck2Entity;
+}
+
+#include <argos3/core/utility/datatypes/datatypes.h>
+#include <argos3/core/utility/configuration/argos_exception.h>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace argos {
+
+   /**
+    * The state of all the e-puck2s, in a compact binary blob.
+    * <p>
+    * Take() stores the state of every e-puck2 in the space: the pose and
+    * velocity of its body in dynamics2d, its wheel speeds, its battery charge
+    * and discharge model state, its encoder counts, its LED colours and,
+    * if the controller implements CEPuck2SnapshotState, the state of the
+    * controller. Restore() puts it back, so that an experiment can be run
+    * many times from the same intermediate state without replaying it.
+    * </p>
+    * <p>
+    * The blob is written in the native byte order and is meant to stay in
+    * memory. The same e-puck2s, with the same ids, must exist when restoring.
+    * The random number generators and the other entities are not stored.
+    * </p>
+    */
+   class CEPuck2Snapshot {
+
+   public:
+
+      /** Version of the blob layout, bumped when it changes */
+      static const UInt32 VERSION = 2;
+
+   public:
+
+      CEPuck2Snapshot() :
+         m_unCursor(0) {}
+
+      /**
+       * Stores the state of all the e-puck2s, replacing the current contents.
+       */
+      void Take();
+
+      /**
+       * Restores the state of all the e-puck2s.
+       * @throws CARGoSException if the e-puck2s in the space do not match the snapshot.
+       */
+      void Restore();
+
+      /**
+       * Clears the contents.
+       */
+      inline void Clear() {
+         m_vecData.clear();
+         m_unCursor = 0;
+      }
+
+      /**
+       * Returns the contents.
+       */
+      inline const std::vector<UInt8>& GetData() const {
+         return m_vecData;
+      }
+
+      /**
+       * Replaces the contents, e.g., with a blob loaded from a file.
+       */
+      inline void SetData(const UInt8* pun_data,
+                          size_t un_size) {
+         m_vecData.assign(pun_data, pun_data + un_size);
+         m_unCursor = 0;
+      }
+
+      /**
+       * Appends raw bytes.
+       */
+      inline void Write(const void* pv_data,
+                        size_t un_size) {
+         const UInt8* punData = static_cast<const UInt8*>(pv_data);
+         m_vecData.insert(m_vecData.end(), punData, punData + un_size);
+      }
+
+      /**
+       * Appends a plain value.
+       */
+      template<typename T>
+      inline void Write(const T& t_value) {
+         static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be written");
+         Write(&t_value, sizeof(T));
+      }
+
+      /**
+       * Appends a string.
+       */
+      inline void Write(const std::string& str_value) {
+         Write<UInt32>(str_value.size());
+         Write(str_value.data(), str_value.size());
+      }
+
+      /**
+       * Reads raw bytes.
+       * @throws CARGoSException if the blob is too short.
+       */
+      inline void Read(void* pv_data,
+                       size_t un_size) {
+         if(m_unCursor + un_size > m_vecData.size()) {
+            THROW_ARGOSEXCEPTION("e-puck2 snapshot: unexpected end of data");
+         }
+         ::memcpy(pv_data, &m_vecData[m_unCursor], un_size);
+         m_unCursor += un_size;
+      }
+
+      /**
+       * Reads a plain value.
+       */
+      template<typename T>
+      inline void Read(T& t_value) {
+         static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be read");
+         Read(&t_value, sizeof(T));
+      }
+
+      /**
+       * Reads a string.
+       */
+      inline void Read(std::string& str_value) {
+         UInt32 unSize;
+         Read(unSize);
+         str_value.resize(unSize);
+         if(unSize > 0) Read(&str_value[0], unSize);
+      }
+
+      /**
+       * Returns all the e-puck2s in the space, in a stable order.
+       */
+      static std::vector<CEPuck2Entity*> GetRobots();
+
+   private:
+
+      void TakeRobot(CEPuck2Entity& c_entity);
+
+      void RestoreRobot(CEPuck2Entity& c_entity);
+
+   private:
+
+      std::vector<UInt8> m_vecData;
+      size_t m_unCursor;
+
+   };
+
+   /**
+    * Interface for controllers whose state must be part of the snapshots.
+    * <p>
+    * A controller that implements it is asked to write its state when a
+    * snapshot is taken, and to read it back, in the same order, when the
+    * snapshot is restored.
+    * </p>
+    */
+   class CEPuck2SnapshotState {
+
+   public:
+
+      virtual ~CEPuck2SnapshotState() {}
+
+      virtual void SaveState(CEPuck2Snapshot& c_snapshot) = 0;
+
+      virtual void LoadState(CEPuck2Snapshot& c_snapshot) = 0;
+
+   };
+
+}
+
+#endif
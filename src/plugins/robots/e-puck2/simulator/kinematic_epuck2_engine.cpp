@@ -0,0 +1,682 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/kinematic_epuck2_engine.cpp>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#include "kinematic_epuck2_engine.h"
+#include "kinematic_epuck2_model.h"
+#include "epuck2_entity.h"
+
+#include <argos3/core/simulator/simulator.h>
+#include <argos3/core/simulator/entity/embodied_entity.h>
+#include <argos3/core/utility/math/ray3.h>
+#include <argos3/plugins/simulator/entities/box_entity.h>
+#include <argos3/plugins/simulator/entities/cylinder_entity.h>
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_layout.h>
+#include <algorithm>
+#include <limits>
+
+namespace argos {
+
+   /****************************************/
+   /****************************************/
+
+   static const Real EPUCK2_RADIUS   = SEPuck2Layout::BODY_RADIUS;
+   static const Real EPUCK2_DIAMETER = 2.0 * SEPuck2Layout::BODY_RADIUS;
+   static const Real EPUCK2_HEIGHT   = SEPuck2Layout::BODY_HEIGHT;
+   static const Real EPUCK2_INVERSE_INTERWHEEL_DISTANCE = 1.0 / SEPuck2Layout::INTERWHEEL_DISTANCE;
+
+   /* Bodies per thread chunk */
+   static const UInt32 CHUNK_SIZE = 256;
+
+   /****************************************/
+   /****************************************/
+
+   static CEmbodiedEntity* GetBody(CEntity& c_entity) {
+      if(CEPuck2Entity* pcEPuck2 = dynamic_cast<CEPuck2Entity*>(&c_entity))
+         return &pcEPuck2->GetEmbodiedEntity();
+      if(CBoxEntity* pcBox = dynamic_cast<CBoxEntity*>(&c_entity))
+         return &pcBox->GetEmbodiedEntity();
+      if(CCylinderEntity* pcCylinder = dynamic_cast<CCylinderEntity*>(&c_entity))
+         return &pcCylinder->GetEmbodiedEntity();
+      return NULL;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CKinematicEPuck2Engine::CKinematicEPuck2Engine() :
+      m_fCellSize(EPUCK2_DIAMETER),
+      m_fInvCellSize(1.0 / EPUCK2_DIAMETER),
+      m_unBucketMask(0),
+      m_bGridDirty(true),
+      m_unSeparationPasses(2) {}
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2Engine::Init(TConfigurationNode& t_tree) {
+      try {
+         CPhysicsEngine::Init(t_tree);
+         /* The engine covers the whole arena, so it cannot share it */
+         TConfigurationNode& tEngines = GetNode(CSimulator::GetInstance().GetConfigurationRoot(), "physics_engines");
+         UInt32 unEngines = 0;
+         TConfigurationNodeIterator itEngine;
+         for(itEngine = itEngine.begin(&tEngines);
+             itEngine != itEngine.end();
+             ++itEngine) {
+            ++unEngines;
+         }
+         if(unEngines > 1) {
+            THROW_ARGOSEXCEPTION("The e-puck2 kinematic engine must be the only physics engine, found " << unEngines);
+         }
+         /*
+          * ARGoS already updates the engines from its own threads, so the
+          * engine runs on the calling thread unless asked otherwise
+          */
+         UInt32 unThreads = 1;
+         GetNodeAttributeOrDefault(t_tree, "threads", unThreads, unThreads);
+         GetNodeAttributeOrDefault(t_tree, "separation_passes", m_unSeparationPasses, m_unSeparationPasses);
+         m_cThreadPool.Start(unThreads, CHUNK_SIZE);
+      }
+      catch(CARGoSException& ex) {
+         THROW_ARGOSEXCEPTION_NESTED("Error initializing the e-puck2 kinematic engine", ex);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2Engine::PostSpaceInit() {
+      UpdateGrid();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2Engine::Reset() {
+      for(size_t i = 0; i < m_vecModels.size(); ++i) {
+         m_vecModels[i]->Reset();
+      }
+      for(size_t i = 0; i < m_vecObstacleModels.size(); ++i) {
+         m_vecObstacleModels[i]->Reset();
+      }
+      UpdateGrid();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2Engine::Destroy() {
+      m_cThreadPool.Stop();
+      /* The models remove themselves from the lists when deleted */
+      while(!m_vecModels.empty()) {
+         delete m_vecModels.back();
+      }
+      while(!m_vecObstacleModels.empty()) {
+         delete m_vecObstacleModels.back();
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2Engine::Update() {
+      size_t unBodies = m_vecX.size();
+      Real fDT = GetPhysicsClockTick();
+      for(UInt32 i = 0; i < GetIterations(); ++i) {
+         /* Move the bodies */
+         m_cThreadPool.ParallelFor(unBodies,
+                                   [this, fDT](size_t un_begin, size_t un_end) {
+                                      Integrate(un_begin, un_end, fDT);
+                                   });
+         m_bGridDirty = true;
+         UpdateGrid();
+         /* Remove the overlaps, in cell order for locality */
+         for(UInt32 j = 0; j < m_unSeparationPasses; ++j) {
+            m_cThreadPool.ParallelFor(unBodies,
+                                      [this](size_t un_begin, size_t un_end) {
+                                         Separate(un_begin, un_end);
+                                      });
+            m_cThreadPool.ParallelFor(unBodies,
+                                      [this](size_t un_begin, size_t un_end) {
+                                         for(size_t k = un_begin; k < un_end; ++k) {
+                                            m_vecX[k] += m_vecDX[k];
+                                            m_vecY[k] += m_vecDY[k];
+                                         }
+                                      });
+         }
+         m_bGridDirty = true;
+      }
+      /* Keep the grid ready for the sensors */
+      UpdateGrid();
+      /* Each model only touches its own entity */
+      m_cThreadPool.ParallelFor(unBodies,
+                                [this](size_t un_begin, size_t un_end) {
+                                   for(size_t k = un_begin; k < un_end; ++k) {
+                                      m_vecModels[k]->UpdateEntityStatus();
+                                   }
+                                });
+   }
+
+   /****************************************/
+   /****************************************/
+
+   bool CKinematicEPuck2Engine::IsPointContained(const CVector3& c_point) {
+      /* The engine is the only one, and covers the whole arena */
+      return true;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   size_t CKinematicEPuck2Engine::GetNumPhysicsModels() {
+      return m_vecModels.size() + m_vecObstacleModels.size();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   bool CKinematicEPuck2Engine::AddEntity(CEntity& c_entity) {
+      CPhysicsModel* pcModel = NULL;
+      if(CEPuck2Entity* pcEPuck2 = dynamic_cast<CEPuck2Entity*>(&c_entity)) {
+         pcModel = new CKinematicEPuck2Model(*this, *pcEPuck2);
+      }
+      else if(CBoxEntity* pcBox = dynamic_cast<CBoxEntity*>(&c_entity)) {
+         if(pcBox->GetEmbodiedEntity().IsMovable()) {
+            THROW_ARGOSEXCEPTION("The e-puck2 kinematic engine does not support movable boxes (\"" <<
+                                 c_entity.GetId() << "\")");
+         }
+         pcModel = new CKinematicEPuck2StaticModel(*this, pcBox->GetEmbodiedEntity(), pcBox->GetSize());
+      }
+      else if(CCylinderEntity* pcCylinder = dynamic_cast<CCylinderEntity*>(&c_entity)) {
+         if(pcCylinder->GetEmbodiedEntity().IsMovable()) {
+            THROW_ARGOSEXCEPTION("The e-puck2 kinematic engine does not support movable cylinders (\"" <<
+                                 c_entity.GetId() << "\")");
+         }
+         pcModel = new CKinematicEPuck2StaticModel(*this, pcCylinder->GetEmbodiedEntity(),
+                                                   pcCylinder->GetRadius(), pcCylinder->GetHeight());
+      }
+      else {
+         return false;
+      }
+      pcModel->GetEmbodiedEntity().AddPhysicsModel(GetId(), *pcModel);
+      return true;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   bool CKinematicEPuck2Engine::RemoveEntity(CEntity& c_entity) {
+      CEmbodiedEntity* pcBody = GetBody(c_entity);
+      if(pcBody == NULL) return false;
+      CPhysicsModel& cModel = pcBody->GetPhysicsModel(GetId());
+      pcBody->RemovePhysicsModel(GetId());
+      delete &cModel;
+      return true;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2Engine::CheckIntersectionWithRay(TEmbodiedEntityIntersectionData& t_data,
+                                                         const CRay3& c_ray) const {
+      UpdateGrid();
+      const CVector3& cStart = c_ray.GetStart();
+      const CVector3& cEnd = c_ray.GetEnd();
+      Real fDX = cEnd.GetX() - cStart.GetX();
+      Real fDY = cEnd.GetY() - cStart.GetY();
+      Real fDZ = cEnd.GetZ() - cStart.GetZ();
+      Real fA = fDX * fDX + fDY * fDY;
+      /*
+       * Bodies: walk the cells crossed by the ray and collect the bodies of
+       * the cells around them, since a body can stick out of its cell
+       */
+      static thread_local std::vector<UInt32> vecCandidates;
+      vecCandidates.clear();
+      UInt32 punBuckets[9];
+      SInt32 nCellX = GetCell(cStart.GetX()), nCellY = GetCell(cStart.GetY());
+      SInt32 nStepX = (fDX > 0.0) ? 1 : -1, nStepY = (fDY > 0.0) ? 1 : -1;
+      Real fMaxX = std::numeric_limits<Real>::max(), fDeltaX = 0.0;
+      Real fMaxY = std::numeric_limits<Real>::max(), fDeltaY = 0.0;
+      if(fDX != 0.0) {
+         fMaxX = ((nCellX + (nStepX > 0 ? 1 : 0)) * m_fCellSize - cStart.GetX()) / fDX;
+         fDeltaX = m_fCellSize / Abs(fDX);
+      }
+      if(fDY != 0.0) {
+         fMaxY = ((nCellY + (nStepY > 0 ? 1 : 0)) * m_fCellSize - cStart.GetY()) / fDY;
+         fDeltaY = m_fCellSize / Abs(fDY);
+      }
+      UInt32 unSteps = Abs(GetCell(cEnd.GetX()) - nCellX) + Abs(GetCell(cEnd.GetY()) - nCellY);
+      for(UInt32 i = 0; i <= unSteps; ++i) {
+         UInt32 unBuckets = GetNeighborBuckets(nCellX, nCellY, punBuckets);
+         for(UInt32 b = 0; b < unBuckets; ++b) {
+            vecCandidates.insert(vecCandidates.end(),
+                                 m_vecSorted.begin() + m_vecBucketStart[punBuckets[b]],
+                                 m_vecSorted.begin() + m_vecBucketStart[punBuckets[b] + 1]);
+         }
+         if(fMaxX < fMaxY) { nCellX += nStepX; fMaxX += fDeltaX; }
+         else              { nCellY += nStepY; fMaxY += fDeltaY; }
+      }
+      std::sort(vecCandidates.begin(), vecCandidates.end());
+      vecCandidates.erase(std::unique(vecCandidates.begin(), vecCandidates.end()), vecCandidates.end());
+      for(size_t i = 0; i < vecCandidates.size(); ++i) {
+         UInt32 j = vecCandidates[i];
+         Real fFX = cStart.GetX() - m_vecX[j];
+         Real fFY = cStart.GetY() - m_vecY[j];
+         Real fC = fFX * fFX + fFY * fFY - EPUCK2_RADIUS * EPUCK2_RADIUS;
+         /* Rays starting inside a body do not hit it, like in dynamics2d */
+         if(fC <= 0.0 || fA == 0.0) continue;
+         Real fB = fFX * fDX + fFY * fDY;
+         Real fDisc = fB * fB - fA * fC;
+         if(fDisc < 0.0) continue;
+         Real fT = (-fB - Sqrt(fDisc)) / fA;
+         if(fT < 0.0 || fT > 1.0) continue;
+         Real fZ = cStart.GetZ() + fT * fDZ;
+         if(fZ < m_vecZ[j] || fZ > m_vecZ[j] + EPUCK2_HEIGHT) continue;
+         t_data.push_back(SEmbodiedEntityIntersectionItem(&m_vecModels[j]->GetEmbodiedEntity(), fT));
+      }
+      /* Obstacles: there are few of them, test them all */
+      for(size_t i = 0; i < m_vecObstacles.size(); ++i) {
+         const SObstacle& sObstacle = m_vecObstacles[i];
+         Real fT;
+         if(sObstacle.IsBox) {
+            /* Slab test in the frame of the box */
+            Real fSX = cStart.GetX() - sObstacle.Center.GetX();
+            Real fSY = cStart.GetY() - sObstacle.Center.GetY();
+            Real pfS[2] = { sObstacle.Cos * fSX + sObstacle.Sin * fSY,
+                           -sObstacle.Sin * fSX + sObstacle.Cos * fSY };
+            Real pfD[2] = { sObstacle.Cos * fDX + sObstacle.Sin * fDY,
+                           -sObstacle.Sin * fDX + sObstacle.Cos * fDY };
+            Real pfH[2] = { sObstacle.HalfSize.GetX(), sObstacle.HalfSize.GetY() };
+            Real fEnter = 0.0, fExit = 1.0;
+            bool bInside = true;
+            for(UInt32 k = 0; k < 2 && fEnter <= fExit; ++k) {
+               if(Abs(pfS[k]) > pfH[k]) bInside = false;
+               if(pfD[k] == 0.0) {
+                  if(Abs(pfS[k]) > pfH[k]) fEnter = 2.0;
+                  continue;
+               }
+               Real fT1 = (-pfH[k] - pfS[k]) / pfD[k];
+               Real fT2 = ( pfH[k] - pfS[k]) / pfD[k];
+               if(fT1 > fT2) std::swap(fT1, fT2);
+               fEnter = Max(fEnter, fT1);
+               fExit = Min(fExit, fT2);
+            }
+            if(bInside || fEnter > fExit) continue;
+            fT = fEnter;
+         }
+         else {
+            Real fFX = cStart.GetX() - sObstacle.Center.GetX();
+            Real fFY = cStart.GetY() - sObstacle.Center.GetY();
+            Real fC = fFX * fFX + fFY * fFY - sObstacle.Radius * sObstacle.Radius;
+            if(fC <= 0.0 || fA == 0.0) continue;
+            Real fB = fFX * fDX + fFY * fDY;
+            Real fDisc = fB * fB - fA * fC;
+            if(fDisc < 0.0) continue;
+            fT = (-fB - Sqrt(fDisc)) / fA;
+            if(fT < 0.0 || fT > 1.0) continue;
+         }
+         Real fZ = cStart.GetZ() + fT * fDZ;
+         if(fZ < sObstacle.MinZ || fZ > sObstacle.MaxZ) continue;
+         t_data.push_back(SEmbodiedEntityIntersectionItem(&m_vecObstacleModels[i]->GetEmbodiedEntity(), fT));
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   UInt32 CKinematicEPuck2Engine::AddBody(CKinematicEPuck2Model& c_model,
+                                          const Real* pf_wheel_velocities) {
+      m_vecX.push_back(0.0);
+      m_vecY.push_back(0.0);
+      m_vecZ.push_back(0.0);
+      m_vecTheta.push_back(0.0);
+      m_vecDX.push_back(0.0);
+      m_vecDY.push_back(0.0);
+      m_vecWheels.push_back(pf_wheel_velocities);
+      m_vecModels.push_back(&c_model);
+      m_bGridDirty = true;
+      return m_vecModels.size() - 1;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2Engine::RemoveBody(UInt32 un_body) {
+      /* Move the last body into the hole */
+      size_t unLast = m_vecModels.size() - 1;
+      if(un_body != unLast) {
+         m_vecX[un_body]      = m_vecX[unLast];
+         m_vecY[un_body]      = m_vecY[unLast];
+         m_vecZ[un_body]      = m_vecZ[unLast];
+         m_vecTheta[un_body]  = m_vecTheta[unLast];
+         m_vecWheels[un_body] = m_vecWheels[unLast];
+         m_vecModels[un_body] = m_vecModels[unLast];
+         m_vecModels[un_body]->SetIndex(un_body);
+      }
+      m_vecX.pop_back();
+      m_vecY.pop_back();
+      m_vecZ.pop_back();
+      m_vecTheta.pop_back();
+      m_vecDX.pop_back();
+      m_vecDY.pop_back();
+      m_vecWheels.pop_back();
+      m_vecModels.pop_back();
+      m_bGridDirty = true;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2Engine::SetBodyPose(UInt32 un_body,
+                                            const CVector3& c_position,
+                                            const CRadians& c_orientation) {
+      m_vecX[un_body] = c_position.GetX();
+      m_vecY[un_body] = c_position.GetY();
+      m_vecZ[un_body] = c_position.GetZ();
+      m_vecTheta[un_body] = c_orientation.GetValue();
+      m_bGridDirty = true;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   bool CKinematicEPuck2Engine::IsBodyColliding(UInt32 un_body) const {
+      UpdateGrid();
+      Real fX = m_vecX[un_body], fY = m_vecY[un_body], fZ = m_vecZ[un_body];
+      UInt32 punBuckets[9];
+      UInt32 unBuckets = GetNeighborBuckets(GetCell(fX), GetCell(fY), punBuckets);
+      for(UInt32 b = 0; b < unBuckets; ++b) {
+         for(UInt32 k = m_vecBucketStart[punBuckets[b]]; k < m_vecBucketStart[punBuckets[b] + 1]; ++k) {
+            UInt32 j = m_vecSorted[k];
+            if(j == un_body) continue;
+            Real fDX = fX - m_vecX[j], fDY = fY - m_vecY[j];
+            if(fDX * fDX + fDY * fDY < EPUCK2_DIAMETER * EPUCK2_DIAMETER &&
+               Abs(fZ - m_vecZ[j]) < EPUCK2_HEIGHT) return true;
+         }
+      }
+      Real fPushX = 0.0, fPushY = 0.0;
+      for(size_t i = 0; i < m_vecObstacles.size(); ++i) {
+         if(PushOut(m_vecObstacles[i], fX, fY, fZ, fPushX, fPushY)) return true;
+      }
+      return false;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   UInt32 CKinematicEPuck2Engine::AddObstacle(CKinematicEPuck2StaticModel& c_model,
+                                              const SObstacle& s_obstacle) {
+      m_vecObstacles.push_back(s_obstacle);
+      m_vecObstacleModels.push_back(&c_model);
+      return m_vecObstacles.size() - 1;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2Engine::RemoveObstacle(UInt32 un_obstacle) {
+      size_t unLast = m_vecObstacles.size() - 1;
+      if(un_obstacle != unLast) {
+         m_vecObstacles[un_obstacle] = m_vecObstacles[unLast];
+         m_vecObstacleModels[un_obstacle] = m_vecObstacleModels[unLast];
+         m_vecObstacleModels[un_obstacle]->SetIndex(un_obstacle);
+      }
+      m_vecObstacles.pop_back();
+      m_vecObstacleModels.pop_back();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2Engine::SetObstacle(UInt32 un_obstacle,
+                                            const SObstacle& s_obstacle) {
+      m_vecObstacles[un_obstacle] = s_obstacle;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   bool CKinematicEPuck2Engine::IsObstacleColliding(UInt32 un_obstacle) const {
+      Real fPushX = 0.0, fPushY = 0.0;
+      for(size_t i = 0; i < m_vecX.size(); ++i) {
+         if(PushOut(m_vecObstacles[un_obstacle], m_vecX[i], m_vecY[i], m_vecZ[i], fPushX, fPushY)) return true;
+      }
+      return false;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2Engine::Integrate(size_t un_begin,
+                                          size_t un_end,
+                                          Real f_dt) {
+      for(size_t i = un_begin; i < un_end; ++i) {
+         Real fLeft = m_vecWheels[i][0];
+         Real fRight = m_vecWheels[i][1];
+         if(fLeft == 0.0 && fRight == 0.0) continue;
+         /* Same wheel semantics as the dynamics2d differential steering */
+         Real fLinear = (fLeft + fRight) * 0.5;
+         Real fAngular = (fRight - fLeft) * EPUCK2_INVERSE_INTERWHEEL_DISTANCE;
+         Real fTheta = m_vecTheta[i];
+         if(Abs(fAngular) < 1e-9) {
+            m_vecX[i] += fLinear * std::cos(fTheta) * f_dt;
+            m_vecY[i] += fLinear * std::sin(fTheta) * f_dt;
+         }
+         else {
+            /* Exact motion along the arc */
+            Real fNewTheta = fTheta + fAngular * f_dt;
+            Real fRadius = fLinear / fAngular;
+            m_vecX[i] += fRadius * (std::sin(fNewTheta) - std::sin(fTheta));
+            m_vecY[i] -= fRadius * (std::cos(fNewTheta) - std::cos(fTheta));
+            if(fNewTheta > ARGOS_PI)       fNewTheta -= 2.0 * ARGOS_PI;
+            else if(fNewTheta < -ARGOS_PI) fNewTheta += 2.0 * ARGOS_PI;
+            m_vecTheta[i] = fNewTheta;
+         }
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2Engine::Separate(size_t un_begin,
+                                         size_t un_end) {
+      UInt32 punBuckets[9];
+      for(size_t k = un_begin; k < un_end; ++k) {
+         UInt32 i = m_vecSorted[k];
+         Real fX = m_vecX[i], fY = m_vecY[i], fZ = m_vecZ[i];
+         Real fPushX = 0.0, fPushY = 0.0;
+         /* Each body moves by half of each overlap; the other body moves by the other half */
+         UInt32 unBuckets = GetNeighborBuckets(GetCell(fX), GetCell(fY), punBuckets);
+         for(UInt32 b = 0; b < unBuckets; ++b) {
+            for(UInt32 n = m_vecBucketStart[punBuckets[b]]; n < m_vecBucketStart[punBuckets[b] + 1]; ++n) {
+               UInt32 j = m_vecSorted[n];
+               if(j == i) continue;
+               Real fDX = fX - m_vecX[j], fDY = fY - m_vecY[j];
+               Real fDist2 = fDX * fDX + fDY * fDY;
+               if(fDist2 >= EPUCK2_DIAMETER * EPUCK2_DIAMETER ||
+                  Abs(fZ - m_vecZ[j]) >= EPUCK2_HEIGHT) continue;
+               if(fDist2 > 1e-18) {
+                  Real fDist = Sqrt(fDist2);
+                  Real fScale = (EPUCK2_DIAMETER - fDist) * 0.5 / fDist;
+                  fPushX += fDX * fScale;
+                  fPushY += fDY * fScale;
+               }
+               else {
+                  /* Same position: split them along x */
+                  fPushX += (i < j ? 0.5 : -0.5) * EPUCK2_DIAMETER;
+               }
+            }
+         }
+         /* Obstacles do not move, so the body takes the whole overlap */
+         for(size_t o = 0; o < m_vecObstacles.size(); ++o) {
+            PushOut(m_vecObstacles[o], fX, fY, fZ, fPushX, fPushY);
+         }
+         m_vecDX[i] = fPushX;
+         m_vecDY[i] = fPushY;
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   bool CKinematicEPuck2Engine::PushOut(const SObstacle& s_obstacle,
+                                        Real f_x,
+                                        Real f_y,
+                                        Real f_z,
+                                        Real& f_dx,
+                                        Real& f_dy) const {
+      if(f_z >= s_obstacle.MaxZ || f_z + EPUCK2_HEIGHT <= s_obstacle.MinZ) return false;
+      if(f_x + EPUCK2_RADIUS <= s_obstacle.Min.GetX() || f_x - EPUCK2_RADIUS >= s_obstacle.Max.GetX() ||
+         f_y + EPUCK2_RADIUS <= s_obstacle.Min.GetY() || f_y - EPUCK2_RADIUS >= s_obstacle.Max.GetY()) return false;
+      Real fRX = f_x - s_obstacle.Center.GetX();
+      Real fRY = f_y - s_obstacle.Center.GetY();
+      if(s_obstacle.IsBox) {
+         /* Work in the frame of the box */
+         Real fLX =  s_obstacle.Cos * fRX + s_obstacle.Sin * fRY;
+         Real fLY = -s_obstacle.Sin * fRX + s_obstacle.Cos * fRY;
+         Real fHX = s_obstacle.HalfSize.GetX(), fHY = s_obstacle.HalfSize.GetY();
+         Real fOX = fLX - Min(Max(fLX, -fHX), fHX);
+         Real fOY = fLY - Min(Max(fLY, -fHY), fHY);
+         Real fDist2 = fOX * fOX + fOY * fOY;
+         Real fPX, fPY;
+         if(fDist2 > 0.0) {
+            /* Center outside the box: move away from the closest point */
+            if(fDist2 >= EPUCK2_RADIUS * EPUCK2_RADIUS) return false;
+            Real fDist = Sqrt(fDist2);
+            Real fScale = (EPUCK2_RADIUS - fDist) / fDist;
+            fPX = fOX * fScale;
+            fPY = fOY * fScale;
+         }
+         else {
+            /* Center inside the box: leave through the closest side */
+            Real fPenX = fHX - Abs(fLX), fPenY = fHY - Abs(fLY);
+            if(fPenX < fPenY) { fPX = (fLX >= 0.0 ? 1.0 : -1.0) * (fPenX + EPUCK2_RADIUS); fPY = 0.0; }
+            else              { fPX = 0.0; fPY = (fLY >= 0.0 ? 1.0 : -1.0) * (fPenY + EPUCK2_RADIUS); }
+         }
+         f_dx += s_obstacle.Cos * fPX - s_obstacle.Sin * fPY;
+         f_dy += s_obstacle.Sin * fPX + s_obstacle.Cos * fPY;
+      }
+      else {
+         Real fReach = EPUCK2_RADIUS + s_obstacle.Radius;
+         Real fDist2 = fRX * fRX + fRY * fRY;
+         if(fDist2 >= fReach * fReach) return false;
+         if(fDist2 > 1e-18) {
+            Real fDist = Sqrt(fDist2);
+            Real fScale = (fReach - fDist) / fDist;
+            f_dx += fRX * fScale;
+            f_dy += fRY * fScale;
+         }
+         else {
+            f_dx += fReach;
+         }
+      }
+      return true;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2Engine::UpdateGrid() const {
+      if(!m_bGridDirty.load(std::memory_order_acquire)) return;
+      /* Sensors may ask from several threads at once */
+      std::lock_guard<std::mutex> cLock(m_cGridMutex);
+      if(m_bGridDirty.load(std::memory_order_relaxed)) {
+         RebuildGrid();
+         m_bGridDirty.store(false, std::memory_order_release);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2Engine::RebuildGrid() const {
+      size_t unBodies = m_vecX.size();
+      UInt32 unBuckets = 64;
+      while(unBuckets < 2 * unBodies) unBuckets <<= 1;
+      m_unBucketMask = unBuckets - 1;
+      /* Counting sort: count, then turn the counts into bucket ends */
+      m_vecBucketStart.assign(unBuckets + 1, 0);
+      m_vecSorted.resize(unBodies);
+      m_vecBodyBucket.resize(unBodies);
+      for(size_t i = 0; i < unBodies; ++i) {
+         m_vecBodyBucket[i] = GetBucket(GetCell(m_vecX[i]), GetCell(m_vecY[i]));
+         ++m_vecBucketStart[m_vecBodyBucket[i]];
+      }
+      for(UInt32 b = 1; b < unBuckets; ++b) {
+         m_vecBucketStart[b] += m_vecBucketStart[b - 1];
+      }
+      m_vecBucketStart[unBuckets] = unBodies;
+      /* Filling from the back leaves each entry at the start of its bucket */
+      for(size_t i = unBodies; i > 0; --i) {
+         m_vecSorted[--m_vecBucketStart[m_vecBodyBucket[i - 1]]] = i - 1;
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   UInt32 CKinematicEPuck2Engine::GetNeighborBuckets(SInt32 n_cell_x,
+                                                     SInt32 n_cell_y,
+                                                     UInt32* pun_buckets) const {
+      UInt32 unBuckets = 0;
+      for(SInt32 nY = n_cell_y - 1; nY <= n_cell_y + 1; ++nY) {
+         for(SInt32 nX = n_cell_x - 1; nX <= n_cell_x + 1; ++nX) {
+            UInt32 unBucket = GetBucket(nX, nY);
+            /* Different cells can share a bucket; visit it once */
+            if(std::find(pun_buckets, pun_buckets + unBuckets, unBucket) == pun_buckets + unBuckets) {
+               pun_buckets[unBuckets++] = unBucket;
+            }
+         }
+      }
+      return unBuckets;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   REGISTER_PHYSICS_ENGINE(CKinematicEPuck2Engine,
+                           "epuck2_kinematic",
+                           "Daniel H. Stolfi based on the Carlo Pinciroli's work",
+                           "1.0",
+                           "A fast kinematic engine for e-puck2 swarms.",
+                           "This physics engine moves each e-puck2 with the differential-drive\n"
+                           "equations, using the same wheel velocities as dynamics2d, and then removes\n"
+                           "the overlaps between robots, and between robots and static boxes and\n"
+                           "cylinders. There are no forces: robots cannot push objects, and movable\n"
+                           "objects are not supported. It is meant for navigation experiments with\n"
+                           "large swarms, where it is much faster than dynamics2d.\n"
+                           "The robots are kept in a uniform grid as large as an e-puck2, and the work\n"
+                           "can be split among a pool of threads.\n"
+                           "The engine covers the whole arena, so it must be the only physics engine.\n\n"
+                           "REQUIRED XML CONFIGURATION\n\n"
+                           "  <physics_engines>\n"
+                           "    ...\n"
+                           "    <epuck2_kinematic id=\"kinematic\" />\n"
+                           "    ...\n"
+                           "  </physics_engines>\n\n"
+                           "OPTIONAL XML CONFIGURATION\n\n"
+                           "The 'iterations' attribute sets the number of steps per simulation step, 1\n"
+                           "by default. The 'threads' attribute sets the number of threads, including the\n"
+                           "main one, 1 by default. The simulator 'threads' already run the engine next to\n"
+                           "the controllers, so more threads only pay off with large swarms and spare\n"
+                           "cores. The\n"
+                           "'separation_passes' attribute sets how many times per step the overlaps are\n"
+                           "removed, 2 by default; more passes resolve dense crowds better:\n\n"
+                           "  <physics_engines>\n"
+                           "    ...\n"
+                           "    <epuck2_kinematic id=\"kinematic\" iterations=\"2\" threads=\"4\"\n"
+                           "                      separation_passes=\"3\" />\n"
+                           "    ...\n"
+                           "  </physics_engines>\n",
+                           "Usable"
+      );
+
+   /****************************************/
+   /****************************************/
+
+}
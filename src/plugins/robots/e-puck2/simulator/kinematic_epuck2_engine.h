@@ -0,0 +1,229 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/kinematic_epuck2_engine.h>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#ifndef KINEMATIC_EPUCK2_ENGINE_H
+#define KINEMATIC_EPUCK2_ENGINE_H
+
+namespace argos {
+   class CKinematicEPuck2Engine;
+   class CKinematicEPuck2Model;
+   class CKinematicEPuck2StaticModel;
+}
+
+#include <argos3/core/simulator/physics_engine/physics_engine.h>
+#include <argos3/core/utility/math/vector2.h>
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_thread_pool.h>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+namespace argos {
+
+   /**
+    * A kinematic physics engine for e-puck2 swarms.
+    * <p>
+    * Each e-puck2 is a disc driven by the differential-drive equations, with
+    * the same wheel velocities as the dynamics2d model. After the motion, the
+    * overlaps are removed by moving the discs apart, and out of the static
+    * boxes and cylinders. There are no forces, masses or frictions: robots
+    * cannot push objects, and objects cannot push robots.
+    * </p>
+    * <p>
+    * The state of the bodies is kept in flat arrays, one per quantity. The
+    * bodies are bucketed in a uniform grid, whose cells are as large as an
+    * e-puck2, so that each body only looks at the 3x3 cells around it. The
+    * motion and the overlap removal can run in parallel over the bodies,
+    * sorted by cell, with the 'threads' attribute.
+    * </p>
+    * <p>
+    * The engine covers the whole arena, so it must be the only physics
+    * engine of the experiment.
+    * </p>
+    */
+   class CKinematicEPuck2Engine : public CPhysicsEngine {
+
+   public:
+
+      /**
+       * A static obstacle: a box or a cylinder.
+       */
+      struct SObstacle {
+         /** True for boxes, false for cylinders */
+         bool IsBox;
+         /** Center of the base */
+         CVector2 Center;
+         /** Orientation of a box */
+         Real Cos, Sin;
+         /** Half size of a box */
+         CVector2 HalfSize;
+         /** Radius of a cylinder */
+         Real Radius;
+         /** Vertical extent */
+         Real MinZ, MaxZ;
+         /** Bounding box on the ground */
+         CVector2 Min, Max;
+
+         SObstacle() :
+            IsBox(true), Cos(1.0), Sin(0.0), Radius(0.0), MinZ(0.0), MaxZ(0.0) {}
+      };
+
+   public:
+
+      CKinematicEPuck2Engine();
+
+      virtual ~CKinematicEPuck2Engine() {}
+
+      virtual void Init(TConfigurationNode& t_tree);
+      virtual void PostSpaceInit();
+      virtual void Reset();
+      virtual void Destroy();
+      virtual void Update();
+
+      virtual bool IsPointContained(const CVector3& c_point);
+
+      virtual size_t GetNumPhysicsModels();
+
+      virtual bool AddEntity(CEntity& c_entity);
+
+      virtual bool RemoveEntity(CEntity& c_entity);
+
+      virtual bool IsEntityTransferNeeded() const {
+         return false;
+      }
+
+      virtual void TransferEntities() {}
+
+      virtual void CheckIntersectionWithRay(TEmbodiedEntityIntersectionData& t_data,
+                                            const CRay3& c_ray) const;
+
+      /*
+       * Body state, used by the e-puck2 models.
+       */
+
+      UInt32 AddBody(CKinematicEPuck2Model& c_model,
+                     const Real* pf_wheel_velocities);
+
+      void RemoveBody(UInt32 un_body);
+
+      void SetBodyPose(UInt32 un_body,
+                       const CVector3& c_position,
+                       const CRadians& c_orientation);
+
+      inline Real GetBodyX(UInt32 un_body) const {
+         return m_vecX[un_body];
+      }
+
+      inline Real GetBodyY(UInt32 un_body) const {
+         return m_vecY[un_body];
+      }
+
+      inline Real GetBodyZ(UInt32 un_body) const {
+         return m_vecZ[un_body];
+      }
+
+      inline Real GetBodyOrientation(UInt32 un_body) const {
+         return m_vecTheta[un_body];
+      }
+
+      bool IsBodyColliding(UInt32 un_body) const;
+
+      /*
+       * Obstacles, used by the static models.
+       */
+
+      UInt32 AddObstacle(CKinematicEPuck2StaticModel& c_model,
+                         const SObstacle& s_obstacle);
+
+      void RemoveObstacle(UInt32 un_obstacle);
+
+      void SetObstacle(UInt32 un_obstacle,
+                       const SObstacle& s_obstacle);
+
+      inline const SObstacle& GetObstacle(UInt32 un_obstacle) const {
+         return m_vecObstacles[un_obstacle];
+      }
+
+      bool IsObstacleColliding(UInt32 un_obstacle) const;
+
+   private:
+
+      /** Moves the bodies in [un_begin,un_end) by their wheels */
+      void Integrate(size_t un_begin,
+                     size_t un_end,
+                     Real f_dt);
+
+      /** Computes how far the sorted bodies in [un_begin,un_end) must move to stop overlapping */
+      void Separate(size_t un_begin,
+                    size_t un_end);
+
+      /** Adds to (f_dx,f_dy) the move out of an obstacle, returns true if they overlap */
+      bool PushOut(const SObstacle& s_obstacle,
+                   Real f_x,
+                   Real f_y,
+                   Real f_z,
+                   Real& f_dx,
+                   Real& f_dy) const;
+
+      /** Rebuilds the grid if a body moved */
+      void UpdateGrid() const;
+
+      /** Sorts the bodies by cell */
+      void RebuildGrid() const;
+
+      /** Returns the distinct buckets of the 3x3 cells around a cell */
+      UInt32 GetNeighborBuckets(SInt32 n_cell_x,
+                                SInt32 n_cell_y,
+                                UInt32* pun_buckets) const;
+
+      inline SInt32 GetCell(Real f_coord) const {
+         return static_cast<SInt32>(std::floor(f_coord * m_fInvCellSize));
+      }
+
+      inline UInt32 GetBucket(SInt32 n_cell_x,
+                              SInt32 n_cell_y) const {
+         return ((static_cast<UInt32>(n_cell_x) * 73856093u) ^
+                 (static_cast<UInt32>(n_cell_y) * 19349663u)) & m_unBucketMask;
+      }
+
+   private:
+
+      /* Body state, one entry per e-puck2 */
+      std::vector<Real> m_vecX;
+      std::vector<Real> m_vecY;
+      std::vector<Real> m_vecZ;
+      std::vector<Real> m_vecTheta;
+      std::vector<Real> m_vecDX;
+      std::vector<Real> m_vecDY;
+      std::vector<const Real*> m_vecWheels;
+      std::vector<CKinematicEPuck2Model*> m_vecModels;
+
+      /* Static obstacles */
+      std::vector<SObstacle> m_vecObstacles;
+      std::vector<CKinematicEPuck2StaticModel*> m_vecObstacleModels;
+
+      /* Uniform grid, hashed into buckets; bodies sorted by bucket */
+      Real m_fCellSize;
+      Real m_fInvCellSize;
+      mutable UInt32 m_unBucketMask;
+      mutable std::vector<UInt32> m_vecBucketStart;
+      mutable std::vector<UInt32> m_vecSorted;
+      mutable std::vector<UInt32> m_vecBodyBucket;
+      mutable std::atomic<bool> m_bGridDirty;
+      mutable std::mutex m_cGridMutex;
+
+      /** Number of overlap removal passes per step */
+      UInt32 m_unSeparationPasses;
+
+      CEPuck2ThreadPool m_cThreadPool;
+
+   };
+
+}
+
+#endif
@@ -0,0 +1,223 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/kinematic_epuck2_model.cpp>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#include "kinematic_epuck2_model.h"
+#include "epuck2_entity.h"
+#include <argos3/core/simulator/entity/embodied_entity.h>
+#include <argos3/plugins/simulator/entities/wheeled_entity.h>
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_layout.h>
+
+namespace argos {
+
+   /****************************************/
+   /****************************************/
+
+   static CRadians GetYaw(const CQuaternion& c_orientation) {
+      CRadians cZAngle, cYAngle, cXAngle;
+      c_orientation.ToEulerAngles(cZAngle, cYAngle, cXAngle);
+      return cZAngle;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CKinematicEPuck2Model::CKinematicEPuck2Model(CKinematicEPuck2Engine& c_engine,
+                                                CEPuck2Entity& c_entity) :
+      CPhysicsModel(c_engine, c_entity.GetEmbodiedEntity()),
+      m_cEngine(c_engine),
+      m_unIndex(c_engine.AddBody(*this, c_entity.GetWheeledEntity().GetWheelVelocities())) {
+      RegisterAnchorMethod<CKinematicEPuck2Model>(GetEmbodiedEntity().GetOriginAnchor(),
+                                                  &CKinematicEPuck2Model::UpdateOriginAnchor);
+      Reset();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CKinematicEPuck2Model::~CKinematicEPuck2Model() {
+      m_cEngine.RemoveBody(m_unIndex);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2Model::Reset() {
+      const SAnchor& sOrigin = GetEmbodiedEntity().GetOriginAnchor();
+      m_cEngine.SetBodyPose(m_unIndex, sOrigin.Position, GetYaw(sOrigin.Orientation));
+      UpdateEntityStatus();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2Model::MoveTo(const CVector3& c_position,
+                                      const CQuaternion& c_orientation) {
+      m_cEngine.SetBodyPose(m_unIndex, c_position, GetYaw(c_orientation));
+      UpdateEntityStatus();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2Model::CalculateBoundingBox() {
+      Real fX = m_cEngine.GetBodyX(m_unIndex);
+      Real fY = m_cEngine.GetBodyY(m_unIndex);
+      Real fZ = m_cEngine.GetBodyZ(m_unIndex);
+      GetBoundingBox().MinCorner.Set(fX - SEPuck2Layout::BODY_RADIUS,
+                                     fY - SEPuck2Layout::BODY_RADIUS,
+                                     fZ);
+      GetBoundingBox().MaxCorner.Set(fX + SEPuck2Layout::BODY_RADIUS,
+                                     fY + SEPuck2Layout::BODY_RADIUS,
+                                     fZ + SEPuck2Layout::BODY_HEIGHT);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2Model::UpdateFromEntityStatus() {
+      /* The engine reads the wheel velocities directly */
+   }
+
+   /****************************************/
+   /****************************************/
+
+   bool CKinematicEPuck2Model::IsCollidingWithSomething() const {
+      return m_cEngine.IsBodyColliding(m_unIndex);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2Model::UpdateOriginAnchor(SAnchor& s_anchor) {
+      s_anchor.Position.Set(m_cEngine.GetBodyX(m_unIndex),
+                            m_cEngine.GetBodyY(m_unIndex),
+                            m_cEngine.GetBodyZ(m_unIndex));
+      s_anchor.Orientation.FromAngleAxis(CRadians(m_cEngine.GetBodyOrientation(m_unIndex)),
+                                         CVector3::Z);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CKinematicEPuck2StaticModel::CKinematicEPuck2StaticModel(CKinematicEPuck2Engine& c_engine,
+                                                            CEmbodiedEntity& c_entity,
+                                                            const CVector3& c_size) :
+      CPhysicsModel(c_engine, c_entity),
+      m_cEngine(c_engine),
+      m_bIsBox(true),
+      m_cSize(c_size),
+      m_cPosition(c_entity.GetOriginAnchor().Position),
+      m_cOrientation(c_entity.GetOriginAnchor().Orientation) {
+      m_unIndex = m_cEngine.AddObstacle(*this, MakeObstacle(m_cPosition, m_cOrientation));
+      RegisterAnchorMethod<CKinematicEPuck2StaticModel>(GetEmbodiedEntity().GetOriginAnchor(),
+                                                        &CKinematicEPuck2StaticModel::UpdateOriginAnchor);
+      UpdateEntityStatus();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CKinematicEPuck2StaticModel::CKinematicEPuck2StaticModel(CKinematicEPuck2Engine& c_engine,
+                                                            CEmbodiedEntity& c_entity,
+                                                            Real f_radius,
+                                                            Real f_height) :
+      CPhysicsModel(c_engine, c_entity),
+      m_cEngine(c_engine),
+      m_bIsBox(false),
+      m_cSize(2.0 * f_radius, 2.0 * f_radius, f_height),
+      m_cPosition(c_entity.GetOriginAnchor().Position),
+      m_cOrientation(c_entity.GetOriginAnchor().Orientation) {
+      m_unIndex = m_cEngine.AddObstacle(*this, MakeObstacle(m_cPosition, m_cOrientation));
+      RegisterAnchorMethod<CKinematicEPuck2StaticModel>(GetEmbodiedEntity().GetOriginAnchor(),
+                                                        &CKinematicEPuck2StaticModel::UpdateOriginAnchor);
+      UpdateEntityStatus();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CKinematicEPuck2StaticModel::~CKinematicEPuck2StaticModel() {
+      m_cEngine.RemoveObstacle(m_unIndex);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2StaticModel::Reset() {
+      MoveTo(GetEmbodiedEntity().GetOriginAnchor().Position,
+             GetEmbodiedEntity().GetOriginAnchor().Orientation);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2StaticModel::MoveTo(const CVector3& c_position,
+                                            const CQuaternion& c_orientation) {
+      m_cPosition = c_position;
+      m_cOrientation = c_orientation;
+      m_cEngine.SetObstacle(m_unIndex, MakeObstacle(m_cPosition, m_cOrientation));
+      UpdateEntityStatus();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2StaticModel::CalculateBoundingBox() {
+      const CKinematicEPuck2Engine::SObstacle& sObstacle = m_cEngine.GetObstacle(m_unIndex);
+      GetBoundingBox().MinCorner.Set(sObstacle.Min.GetX(), sObstacle.Min.GetY(), sObstacle.MinZ);
+      GetBoundingBox().MaxCorner.Set(sObstacle.Max.GetX(), sObstacle.Max.GetY(), sObstacle.MaxZ);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   bool CKinematicEPuck2StaticModel::IsCollidingWithSomething() const {
+      return m_cEngine.IsObstacleColliding(m_unIndex);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CKinematicEPuck2StaticModel::UpdateOriginAnchor(SAnchor& s_anchor) {
+      s_anchor.Position = m_cPosition;
+      s_anchor.Orientation = m_cOrientation;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CKinematicEPuck2Engine::SObstacle CKinematicEPuck2StaticModel::MakeObstacle(const CVector3& c_position,
+                                                                               const CQuaternion& c_orientation) const {
+      CKinematicEPuck2Engine::SObstacle sObstacle;
+      sObstacle.IsBox = m_bIsBox;
+      sObstacle.Center.Set(c_position.GetX(), c_position.GetY());
+      sObstacle.MinZ = c_position.GetZ();
+      sObstacle.MaxZ = c_position.GetZ() + m_cSize.GetZ();
+      if(m_bIsBox) {
+         CRadians cYaw = GetYaw(c_orientation);
+         sObstacle.Cos = Cos(cYaw);
+         sObstacle.Sin = Sin(cYaw);
+         sObstacle.HalfSize.Set(m_cSize.GetX() * 0.5, m_cSize.GetY() * 0.5);
+         /* Extent of the rotated box along each axis */
+         Real fExtentX = Abs(sObstacle.Cos) * sObstacle.HalfSize.GetX() + Abs(sObstacle.Sin) * sObstacle.HalfSize.GetY();
+         Real fExtentY = Abs(sObstacle.Sin) * sObstacle.HalfSize.GetX() + Abs(sObstacle.Cos) * sObstacle.HalfSize.GetY();
+         sObstacle.Min.Set(sObstacle.Center.GetX() - fExtentX, sObstacle.Center.GetY() - fExtentY);
+         sObstacle.Max.Set(sObstacle.Center.GetX() + fExtentX, sObstacle.Center.GetY() + fExtentY);
+      }
+      else {
+         sObstacle.Radius = m_cSize.GetX() * 0.5;
+         sObstacle.Min.Set(sObstacle.Center.GetX() - sObstacle.Radius, sObstacle.Center.GetY() - sObstacle.Radius);
+         sObstacle.Max.Set(sObstacle.Center.GetX() + sObstacle.Radius, sObstacle.Center.GetY() + sObstacle.Radius);
+      }
+      return sObstacle;
+   }
+
+   /****************************************/
+   /****************************************/
+
+}
@@ -0,0 +1,128 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/kinematic_epuck2_model.h>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#ifndef KINEMATIC_EPUCK2_MODEL_H
+#define KINEMATIC_EPUCK2_MODEL_H
+
+namespace argos {
+   class CKinematicEPuck2Model;
+   class CKinematicEPuck2StaticModel;
+   class CEPuck2Entity;
+}
+
+#include <argos3/core/simulator/physics_engine/physics_model.h>
+#include <argos3/plugins/robots/e-puck2/simulator/kinematic_epuck2_engine.h>
+
+namespace argos {
+
+   /**
+    * An e-puck2 in the kinematic engine.
+    * The state lives in the engine; the model only knows its index.
+    */
+   class CKinematicEPuck2Model : public CPhysicsModel {
+
+   public:
+
+      CKinematicEPuck2Model(CKinematicEPuck2Engine& c_engine,
+                            CEPuck2Entity& c_entity);
+
+      virtual ~CKinematicEPuck2Model();
+
+      virtual void Reset();
+
+      virtual void MoveTo(const CVector3& c_position,
+                          const CQuaternion& c_orientation);
+
+      virtual void CalculateBoundingBox();
+
+      virtual void UpdateFromEntityStatus();
+
+      virtual bool IsCollidingWithSomething() const;
+
+      void UpdateOriginAnchor(SAnchor& s_anchor);
+
+      inline UInt32 GetIndex() const {
+         return m_unIndex;
+      }
+
+      inline void SetIndex(UInt32 un_index) {
+         m_unIndex = un_index;
+      }
+
+   private:
+
+      CKinematicEPuck2Engine& m_cEngine;
+      UInt32 m_unIndex;
+
+   };
+
+   /**
+    * A static box or cylinder in the kinematic engine.
+    */
+   class CKinematicEPuck2StaticModel : public CPhysicsModel {
+
+   public:
+
+      /**
+       * Creates the model of a box.
+       */
+      CKinematicEPuck2StaticModel(CKinematicEPuck2Engine& c_engine,
+                                  CEmbodiedEntity& c_entity,
+                                  const CVector3& c_size);
+
+      /**
+       * Creates the model of a cylinder.
+       */
+      CKinematicEPuck2StaticModel(CKinematicEPuck2Engine& c_engine,
+                                  CEmbodiedEntity& c_entity,
+                                  Real f_radius,
+                                  Real f_height);
+
+      virtual ~CKinematicEPuck2StaticModel();
+
+      virtual void Reset();
+
+      virtual void MoveTo(const CVector3& c_position,
+                          const CQuaternion& c_orientation);
+
+      virtual void CalculateBoundingBox();
+
+      virtual void UpdateFromEntityStatus() {}
+
+      virtual bool IsCollidingWithSomething() const;
+
+      void UpdateOriginAnchor(SAnchor& s_anchor);
+
+      inline UInt32 GetIndex() const {
+         return m_unIndex;
+      }
+
+      inline void SetIndex(UInt32 un_index) {
+         m_unIndex = un_index;
+      }
+
+   private:
+
+      /** Computes the obstacle for the given pose */
+      CKinematicEPuck2Engine::SObstacle MakeObstacle(const CVector3& c_position,
+                                                     const CQuaternion& c_orientation) const;
+
+   private:
+
+      CKinematicEPuck2Engine& m_cEngine;
+      UInt32 m_unIndex;
+      bool m_bIsBox;
+      CVector3 m_cSize;
+      CVector3 m_cPosition;
+      CQuaternion m_cOrientation;
+
+   };
+
+}
+
+#endif
@@ -8,13 +8,20 @@
 
 #include "qtopengl_epuck2.h"
 #include "epuck2_entity.h"
+#include <argos3/core/simulator/simulator.h>
 #include <argos3/core/simulator/entity/embodied_entity.h>
 #include <argos3/core/utility/math/vector2.h>
 #include <argos3/core/utility/math/vector3.h>
 #include <argos3/plugins/simulator/visualizations/qt-opengl/qtopengl_widget.h>
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_log.h>
 
 #include "epuck2_led_equipped_entity.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+
 namespace argos {
 
    /****************************************/
@@ -50,14 +57,47 @@ namespace argos {
 
    static const Real ARROW_OFFSET = 0.0025f;
 
+   static const Real LOD_ELEVATION      = BODY_ELEVATION + BODY_HEIGHT + LED_HEIGHT;
+   static const Real HEADING_HALF_WIDTH = BODY_RADIUS * 0.1f;
+
+   /* The drawn LEDs: the ring, the front LED and the body LED */
+   static const UInt32 DRAWN_LEDS = 10;
+
+   /* The colour of the heading tick of distant robots */
+   static const GLubyte HEADING_COLOR[4] = { 255, 255, 0, 255 };
+
+   /* Whether the user functions end the frames, and the model they end */
+   static bool s_bEndFrameHook = false;
+   static CQTOpenGLEPuck2* s_pcInstancedModel = NULL;
+
+   /* Triangles of a quad, for GL_QUADS and GL_QUAD_STRIP */
+   static const size_t QUADS_ORDER[6]      = { 0, 1, 2, 0, 2, 3 };
+   static const size_t QUAD_STRIP_ORDER[6] = { 0, 1, 3, 0, 3, 2 };
+
    /****************************************/
    /****************************************/
 
    CQTOpenGLEPuck2::CQTOpenGLEPuck2() :
       m_unVertices(40),
-      m_fLEDAngleSlice(360.0f / 16.0f) {
+      m_fLEDAngleSlice(360.0f / 16.0f),
+      m_bInstanced(false),
+      m_fDiscDistance(0.0f),
+      m_fPointDistance(0.0f),
+      m_fPointSize(4.0f),
+      m_unStreamBuffer(0),
+      m_nUnlitFirst(0),
+      m_nBodyGlowFirst(0),
+      m_nBodyLitFirst(0),
+      m_nLitFirst(0),
+      m_nDiscFirst(0),
+      m_nHeadingFirst(0),
+      m_bFrameStarted(false),
+      m_bRecording(false),
+      m_ePaint(PAINT_LIT),
+      m_unPaintSlot(0),
+      m_unPrimitive(GL_TRIANGLES) {
       /* Reserve the needed display lists */
-      m_unLists = glGenLists(6);
+      m_unLists = glGenLists(8);
 
       /* Assign indices for better referencing (later) */
       m_unWheelList   = m_unLists;
@@ -66,6 +106,8 @@ namespace argos {
       m_unLEDList     = m_unLists + 3;
       m_unGapList     = m_unLists + 4;
       m_unFrontLED    = m_unLists + 5;
+      m_unDiscList    = m_unLists + 6;
+      m_unHeadingList = m_unLists + 7;
 
       /* Create the wheel display list */
       glNewList(m_unWheelList, GL_COMPILE);
@@ -96,21 +138,91 @@ namespace argos {
       glNewList(m_unFrontLED, GL_COMPILE);
       RenderFrontLED();
       glEndList();
+
+      /* Create the disc and heading lists */
+      glNewList(m_unDiscList, GL_COMPILE);
+      RenderDisc();
+      glEndList();
+      glNewList(m_unHeadingList, GL_COMPILE);
+      RenderHeading();
+      glEndList();
+
+      /* Parse <visualization><qt-opengl><epuck2>, if any */
+      TConfigurationNode& tRoot = CSimulator::GetInstance().GetConfigurationRoot();
+      if(NodeExists(tRoot, "visualization") &&
+         NodeExists(GetNode(tRoot, "visualization"), "qt-opengl")) {
+         TConfigurationNode& tQTOpenGL = GetNode(GetNode(tRoot, "visualization"), "qt-opengl");
+         if(NodeExists(tQTOpenGL, "epuck2")) {
+            TConfigurationNode& tEPuck2 = GetNode(tQTOpenGL, "epuck2");
+            GetNodeAttributeOrDefault(tEPuck2, "instanced", m_bInstanced, m_bInstanced);
+            GetNodeAttributeOrDefault(tEPuck2, "disc_distance", m_fDiscDistance, m_fDiscDistance);
+            GetNodeAttributeOrDefault(tEPuck2, "point_distance", m_fPointDistance, m_fPointDistance);
+            GetNodeAttributeOrDefault(tEPuck2, "point_size", m_fPointSize, m_fPointSize);
+            if(m_fDiscDistance < 0.0f || m_fPointDistance < 0.0f || m_fPointSize <= 0.0f) {
+               THROW_ARGOSEXCEPTION("The e-puck2 level of detail distances must be non-negative, and the point size positive");
+            }
+         }
+      }
+      if(m_bInstanced && !s_bEndFrameHook) {
+         EPUCK2_LOG_WARNING("qtopengl", "Instanced e-puck2 rendering needs the epuck2_qtopengl_user_functions "
+                            "user functions, or user functions derived from CQTOpenGLEPuck2UserFunctions: "
+                            "drawing each robot on its own");
+         m_bInstanced = false;
+      }
+      if(m_bInstanced) {
+         BuildMesh();
+         s_pcInstancedModel = this;
+      }
    }
 
    /****************************************/
    /****************************************/
 
    CQTOpenGLEPuck2::~CQTOpenGLEPuck2() {
-      glDeleteLists(m_unLists, 4);
+      if(s_pcInstancedModel == this) {
+         s_pcInstancedModel = NULL;
+      }
+      glDeleteLists(m_unLists, 8);
+      if(m_unStreamBuffer != 0) {
+         glDeleteBuffers(1, &m_unStreamBuffer);
+      }
    }
 
    /****************************************/
    /****************************************/
 
    void CQTOpenGLEPuck2::Draw(CEPuck2Entity& c_entity) {
-      CEPuck2LEDEquippedEntity& cLEDEquippedEntity = c_entity.GetLEDEquippedEntity();
-      const CColor& cBodyColor = cLEDEquippedEntity.GetLED(9).GetColor();
+      /* Robots whose controller does not use the LEDs have no LED entity */
+      CEPuck2LEDEquippedEntity* pcLEDEquippedEntity =
+         c_entity.HasLEDEquippedEntity() ? &c_entity.GetLEDEquippedEntity() : NULL;
+      /* The modelview holds the pose of the robot */
+      GLfloat pfModelView[16];
+      glGetFloatv(GL_MODELVIEW_MATRIX, pfModelView);
+      ELevel eLevel = GetLevel(pfModelView);
+      if(eLevel != LEVEL_FULL) {
+         CColor pcLEDs[DRAWN_LEDS];
+         GetLEDColors(pcLEDEquippedEntity, pcLEDs);
+         GLubyte punColor[4];
+         GetLODColor(pcLEDs, punColor);
+         SetLEDMaterial(punColor[0] / 255.0f,
+                        punColor[1] / 255.0f,
+                        punColor[2] / 255.0f);
+         if(eLevel == LEVEL_DISC) {
+            glCallList(m_unDiscList);
+            SetLEDMaterial(1.0f, 1.0f, 0.0f);
+            glCallList(m_unHeadingList);
+         }
+         else {
+            glPushAttrib(GL_POINT_BIT);
+            glPointSize(m_fPointSize);
+            glBegin(GL_POINTS);
+            glVertex3f(0.0f, 0.0f, LOD_ELEVATION);
+            glEnd();
+            glPopAttrib();
+         }
+         return;
+      }
+      const CColor& cBodyColor = GetLEDColor(pcLEDEquippedEntity, 9);
       if (cBodyColor == CColor::BLACK) {
          SetGreenPlasticMaterial();
       } else {
@@ -132,7 +244,7 @@ namespace argos {
       /* Place the LEDs */
       glPushMatrix();
       for(UInt32 i = 0; i < 8; i++) {
-         const CColor& cColor = cLEDEquippedEntity.GetLED(i).GetColor();
+         const CColor& cColor = GetLEDColor(pcLEDEquippedEntity, i);
          glRotatef(-m_fLEDAngleSlice, 0.0f, 0.0f, 1.0f);
          SetLEDMaterial(cColor.GetRed() / 255.0f ,
                         cColor.GetGreen() / 255.0f,
@@ -147,7 +259,7 @@ namespace argos {
       /* Front LED */
       glPushMatrix();
       glRotatef(-15.0f, 0.0f, 0.0f, 1.0f);
-      const CColor& cFrontColor = cLEDEquippedEntity.GetLED(8).GetColor();
+      const CColor& cFrontColor = GetLEDColor(pcLEDEquippedEntity, 8);
       SetLEDMaterial(cFrontColor.GetRed() / 255.0f,
                      cFrontColor.GetGreen() / 255.0f,
                      cFrontColor.GetBlue() / 255.0f);
@@ -158,11 +270,400 @@ namespace argos {
    /****************************************/
    /****************************************/
 
+   void CQTOpenGLEPuck2::AddInstance(CEPuck2Entity& c_entity) {
+      if(!m_bFrameStarted) {
+         /* A new frame: the entities are visited before anything else is drawn */
+         glGetFloatv(GL_MODELVIEW_MATRIX, m_pfCamera);
+         m_bFrameStarted = true;
+      }
+      const SAnchor& sOrigin = c_entity.GetEmbodiedEntity().GetOriginAnchor();
+      CColor pcLEDs[DRAWN_LEDS];
+      GetLEDColors(c_entity.HasLEDEquippedEntity() ? &c_entity.GetLEDEquippedEntity() : NULL,
+                   pcLEDs);
+      QueueRobot(sOrigin.Position, sOrigin.Orientation, pcLEDs);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CQTOpenGLEPuck2::EndFrame() {
+      if(!m_bFrameStarted) {
+         return;
+      }
+      DrawInstances();
+      m_vecInstances.clear();
+      m_vecDiscs.clear();
+      m_vecPoints.clear();
+      m_bFrameStarted = false;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CQTOpenGLEPuck2::EndFrames() {
+      if(s_pcInstancedModel != NULL) {
+         s_pcInstancedModel->EndFrame();
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CQTOpenGLEPuck2::SetEndFrameHook(bool b_hook) {
+      s_bEndFrameHook = b_hook;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CQTOpenGLEPuck2::QueueRobot(const CVector3& c_position,
+                                    const CQuaternion& c_orientation,
+                                    const CColor* pc_leds) {
+      SInstance sInstance;
+      /* The pose of the robot, as a column-major matrix */
+      GLfloat fW = c_orientation.GetW(), fX = c_orientation.GetX(), fY = c_orientation.GetY(), fZ = c_orientation.GetZ();
+      const GLfloat pfPose[16] = {
+         1.0f - 2.0f * (fY * fY + fZ * fZ), 2.0f * (fX * fY + fW * fZ), 2.0f * (fX * fZ - fW * fY), 0.0f,
+         2.0f * (fX * fY - fW * fZ), 1.0f - 2.0f * (fX * fX + fZ * fZ), 2.0f * (fY * fZ + fW * fX), 0.0f,
+         2.0f * (fX * fZ + fW * fY), 2.0f * (fY * fZ - fW * fX), 1.0f - 2.0f * (fX * fX + fY * fY), 0.0f,
+         static_cast<GLfloat>(c_position.GetX()),
+         static_cast<GLfloat>(c_position.GetY()),
+         static_cast<GLfloat>(c_position.GetZ()), 1.0f
+      };
+      std::copy(pfPose, pfPose + 16, sInstance.Pose);
+      /* The robot seen from the camera, for the level of detail */
+      GLfloat pfTransform[16];
+      for(UInt32 c = 0; c < 4; ++c) {
+         for(UInt32 r = 0; r < 4; ++r) {
+            GLfloat fSum = 0.0f;
+            for(UInt32 k = 0; k < 4; ++k) {
+               fSum += m_pfCamera[k * 4 + r] * pfPose[c * 4 + k];
+            }
+            pfTransform[c * 4 + r] = fSum;
+         }
+      }
+      switch(GetLevel(pfTransform)) {
+         case LEVEL_POINT: {
+            SPoint sPoint;
+            sPoint.Position[0] = c_position.GetX();
+            sPoint.Position[1] = c_position.GetY();
+            sPoint.Position[2] = c_position.GetZ() + LOD_ELEVATION;
+            GetLODColor(pc_leds, sPoint.Color);
+            m_vecPoints.push_back(sPoint);
+            break;
+         }
+         case LEVEL_DISC:
+            GetLODColor(pc_leds, sInstance.Color);
+            m_vecDiscs.push_back(sInstance);
+            break;
+         default:
+            AddFullInstance(sInstance, pc_leds);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CQTOpenGLEPuck2::AddFullInstance(SInstance& s_instance,
+                                         const CColor* pc_leds) {
+      /* The colours of the ring and front LEDs */
+      s_instance.BodyGlow = (pc_leds[9] != CColor::BLACK);
+      for(UInt32 i = 0; i < 9; ++i) {
+         const CColor& cColor = pc_leds[i];
+         s_instance.LEDs[i][0] = cColor.GetRed();
+         s_instance.LEDs[i][1] = cColor.GetGreen();
+         s_instance.LEDs[i][2] = cColor.GetBlue();
+         s_instance.LEDs[i][3] = 255;
+      }
+      m_vecInstances.push_back(s_instance);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CQTOpenGLEPuck2::DrawInstances() {
+      /* Transform the robots into world coordinates: the lit parts first... */
+      m_vecStream.clear();
+      for(size_t i = 0; i < m_vecInstances.size(); ++i) {
+         const SInstance& sInstance = m_vecInstances[i];
+         StreamRange(sInstance, sInstance.BodyGlow ? m_nLitFirst : m_nBodyLitFirst, m_nDiscFirst, NULL);
+      }
+      GLsizei nLitVertices = m_vecStream.size();
+      /* ...then the LEDs, the emissive parts and the discs of distant robots */
+      GLint nLEDVertices = m_vecLEDSlots.size();
+      for(size_t i = 0; i < m_vecInstances.size(); ++i) {
+         const SInstance& sInstance = m_vecInstances[i];
+         size_t unLEDs = m_vecStream.size();
+         StreamRange(sInstance, 0, nLEDVertices, NULL);
+         for(GLint j = 0; j < nLEDVertices; ++j) {
+            std::copy(sInstance.LEDs[m_vecLEDSlots[j]],
+                      sInstance.LEDs[m_vecLEDSlots[j]] + 4,
+                      m_vecStream[unLEDs + j].Color);
+         }
+         StreamRange(sInstance, m_nUnlitFirst, sInstance.BodyGlow ? m_nBodyLitFirst : m_nBodyGlowFirst, NULL);
+      }
+      for(size_t i = 0; i < m_vecDiscs.size(); ++i) {
+         StreamRange(m_vecDiscs[i], m_nDiscFirst, m_nHeadingFirst, m_vecDiscs[i].Color);
+         StreamRange(m_vecDiscs[i], m_nHeadingFirst, m_vecMesh.size(), HEADING_COLOR);
+      }
+      GLsizei nUnlitVertices = m_vecStream.size() - nLitVertices;
+      glPushAttrib(GL_ENABLE_BIT | GL_LIGHTING_BIT | GL_CURRENT_BIT | GL_POINT_BIT);
+      glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+      glPushMatrix();
+      glLoadMatrixf(m_pfCamera);
+      if(!m_vecStream.empty()) {
+         /* Stream the frame */
+         if(m_unStreamBuffer != 0) {
+            glBindBuffer(GL_ARRAY_BUFFER, m_unStreamBuffer);
+            glBufferData(GL_ARRAY_BUFFER, m_vecStream.size() * sizeof(SVertex), &m_vecStream[0], GL_STREAM_DRAW);
+         }
+         glEnableClientState(GL_VERTEX_ARRAY);
+         glEnableClientState(GL_NORMAL_ARRAY);
+         glEnableClientState(GL_COLOR_ARRAY);
+         glVertexPointer(3, GL_FLOAT, sizeof(SVertex), GetStreamPointer(offsetof(SVertex, Position)));
+         glNormalPointer(GL_FLOAT, sizeof(SVertex), GetStreamPointer(offsetof(SVertex, Normal)));
+         glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(SVertex), GetStreamPointer(offsetof(SVertex, Color)));
+         /* A single plastic material, coloured by the vertices */
+         const GLfloat pfSpecular[]  = {   0.5f, 0.5f, 0.5f, 1.0f };
+         const GLfloat pfShininess[] = { 100.0f                   };
+         const GLfloat pfEmission[]  = {   0.0f, 0.0f, 0.0f, 1.0f };
+         glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR,            pfSpecular);
+         glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS,           pfShininess);
+         glMaterialfv(GL_FRONT_AND_BACK, GL_EMISSION,            pfEmission);
+         glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
+         glEnable(GL_COLOR_MATERIAL);
+         if(nLitVertices > 0) {
+            glDrawArrays(GL_TRIANGLES, 0, nLitVertices);
+         }
+         glDisable(GL_LIGHTING);
+         if(nUnlitVertices > 0) {
+            glDrawArrays(GL_TRIANGLES, nLitVertices, nUnlitVertices);
+         }
+         if(m_unStreamBuffer != 0) {
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+         }
+      }
+      /* Points, all at once */
+      if(!m_vecPoints.empty()) {
+         glDisable(GL_LIGHTING);
+         glEnableClientState(GL_VERTEX_ARRAY);
+         glDisableClientState(GL_NORMAL_ARRAY);
+         glEnableClientState(GL_COLOR_ARRAY);
+         glVertexPointer(3, GL_FLOAT, sizeof(SPoint), m_vecPoints[0].Position);
+         glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(SPoint), m_vecPoints[0].Color);
+         glPointSize(m_fPointSize);
+         glDrawArrays(GL_POINTS, 0, m_vecPoints.size());
+      }
+      glPopMatrix();
+      glPopClientAttrib();
+      glPopAttrib();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CQTOpenGLEPuck2::StreamRange(const SInstance& s_instance,
+                                     GLint n_first,
+                                     GLint n_last,
+                                     const GLubyte* pun_color) {
+      if(n_last <= n_first) {
+         return;
+      }
+      const GLfloat* pfPose = s_instance.Pose;
+      size_t unBase = m_vecStream.size();
+      m_vecStream.resize(unBase + (n_last - n_first));
+      SVertex* psOut = &m_vecStream[unBase];
+      for(GLint i = n_first; i < n_last; ++i, ++psOut) {
+         const SVertex& sIn = m_vecMesh[i];
+         /* The pose is rigid: the normals only need its rotation */
+         for(UInt32 r = 0; r < 3; ++r) {
+            psOut->Position[r] =
+               pfPose[r] * sIn.Position[0] + pfPose[4 + r] * sIn.Position[1] + pfPose[8 + r] * sIn.Position[2] + pfPose[12 + r];
+            psOut->Normal[r] =
+               pfPose[r] * sIn.Normal[0] + pfPose[4 + r] * sIn.Normal[1] + pfPose[8 + r] * sIn.Normal[2];
+         }
+         const GLubyte* punColor = (pun_color != NULL) ? pun_color : sIn.Color;
+         std::copy(punColor, punColor + 4, psOut->Color);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   const GLvoid* CQTOpenGLEPuck2::GetStreamPointer(size_t un_offset) const {
+      if(m_unStreamBuffer != 0) {
+         return reinterpret_cast<const GLvoid*>(un_offset);
+      }
+      return reinterpret_cast<const GLubyte*>(&m_vecStream[0]) + un_offset;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CQTOpenGLEPuck2::BuildMesh() {
+      m_bRecording = true;
+      m_pfNormal[0] = 0.0f;
+      m_pfNormal[1] = 0.0f;
+      m_pfNormal[2] = 1.0f;
+      /* The LEDs of the ring and the gaps between them, placed as in Draw() */
+      for(UInt32 i = 0; i < 8; ++i) {
+         m_cRecordAngle = ToRadians(CDegrees(-m_fLEDAngleSlice * (2 * i + 1)));
+         SetPaint(PAINT_LED, 0.0f, 0.0f, 0.0f);
+         m_unPaintSlot = i;
+         RenderLED();
+         m_cRecordAngle = ToRadians(CDegrees(-m_fLEDAngleSlice * (2 * i + 2)));
+         SetWhitePlasticMaterial();
+         RenderGap();
+      }
+      /* Front LED */
+      m_cRecordAngle = ToRadians(CDegrees(-15.0f));
+      SetPaint(PAINT_LED, 0.0f, 0.0f, 0.0f);
+      m_unPaintSlot = 8;
+      RenderFrontLED();
+      /* Chassis and body */
+      m_cRecordAngle = CRadians::ZERO;
+      SetPaint(PAINT_BODY, 0.0f, 0.8f, 0.0f);
+      RenderChassis();
+      RenderBody();
+      /* Wheels */
+      m_cRecordOffset.Set(0.0f, HALF_INTERWHEEL_DISTANCE);
+      RenderWheel();
+      m_cRecordOffset.Set(0.0f, -HALF_INTERWHEEL_DISTANCE);
+      RenderWheel();
+      m_cRecordOffset = CVector2();
+      /* Disc and heading of distant robots */
+      SetPaint(PAINT_DISC, 1.0f, 1.0f, 1.0f);
+      RenderDisc();
+      SetPaint(PAINT_HEADING, 1.0f, 1.0f, 0.0f);
+      RenderHeading();
+      m_bRecording = false;
+      /* Lay out the parts so that each pass draws one range */
+      m_vecMesh = m_vecParts[PAINT_LED];
+      m_vecLEDSlots.swap(m_vecPartSlots);
+      m_nUnlitFirst = m_vecMesh.size();
+      m_vecMesh.insert(m_vecMesh.end(), m_vecParts[PAINT_UNLIT].begin(), m_vecParts[PAINT_UNLIT].end());
+      m_nBodyGlowFirst = m_vecMesh.size();
+      for(size_t i = 0; i < m_vecParts[PAINT_BODY].size(); ++i) {
+         /* Lit green, as with SetLEDMaterial(0.0f, 1.0f, 0.0f) */
+         SVertex sVertex = m_vecParts[PAINT_BODY][i];
+         sVertex.Color[0] = 0;
+         sVertex.Color[1] = 255;
+         sVertex.Color[2] = 0;
+         m_vecMesh.push_back(sVertex);
+      }
+      m_nBodyLitFirst = m_vecMesh.size();
+      m_vecMesh.insert(m_vecMesh.end(), m_vecParts[PAINT_BODY].begin(), m_vecParts[PAINT_BODY].end());
+      m_nLitFirst = m_vecMesh.size();
+      m_vecMesh.insert(m_vecMesh.end(), m_vecParts[PAINT_LIT].begin(), m_vecParts[PAINT_LIT].end());
+      m_nDiscFirst = m_vecMesh.size();
+      m_vecMesh.insert(m_vecMesh.end(), m_vecParts[PAINT_DISC].begin(), m_vecParts[PAINT_DISC].end());
+      m_nHeadingFirst = m_vecMesh.size();
+      m_vecMesh.insert(m_vecMesh.end(), m_vecParts[PAINT_HEADING].begin(), m_vecParts[PAINT_HEADING].end());
+      for(UInt32 i = 0; i < PAINT_NUM; ++i) {
+         std::vector<SVertex>().swap(m_vecParts[i]);
+      }
+      /* Vertex buffers are core since OpenGL 1.5 */
+      const GLubyte* punVersion = glGetString(GL_VERSION);
+      int nMajor = 0, nMinor = 0;
+      if(punVersion != NULL &&
+         std::sscanf(reinterpret_cast<const char*>(punVersion), "%d.%d", &nMajor, &nMinor) == 2 &&
+         (nMajor > 1 || (nMajor == 1 && nMinor >= 5))) {
+         glGenBuffers(1, &m_unStreamBuffer);
+      }
+      EPUCK2_LOG_INFO("qtopengl", "Instanced e-puck2 rendering with " << m_vecMesh.size()
+                      << " vertices per robot, streamed in " << (m_unStreamBuffer != 0 ? "a vertex buffer" : "client arrays"));
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CQTOpenGLEPuck2::SetPaint(EPaint e_paint,
+                                  GLfloat f_red,
+                                  GLfloat f_green,
+                                  GLfloat f_blue) {
+      m_ePaint = e_paint;
+      m_punPaintColor[0] = static_cast<GLubyte>(f_red   * 255.0f);
+      m_punPaintColor[1] = static_cast<GLubyte>(f_green * 255.0f);
+      m_punPaintColor[2] = static_cast<GLubyte>(f_blue  * 255.0f);
+      m_punPaintColor[3] = 255;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CQTOpenGLEPuck2::ELevel CQTOpenGLEPuck2::GetLevel(const GLfloat* pf_transform) const {
+      /* The translation is the robot seen from the camera */
+      GLfloat fDistance = std::sqrt(pf_transform[12] * pf_transform[12] +
+                                    pf_transform[13] * pf_transform[13] +
+                                    pf_transform[14] * pf_transform[14]);
+      if(m_fPointDistance > 0.0f && fDistance >= m_fPointDistance) {
+         return LEVEL_POINT;
+      }
+      if(m_fDiscDistance > 0.0f && fDistance >= m_fDiscDistance) {
+         return LEVEL_DISC;
+      }
+      return LEVEL_FULL;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CQTOpenGLEPuck2::GetLODColor(const CColor* pc_leds,
+                                     GLubyte* pun_color) {
+      UInt32 unRed = 0, unGreen = 0, unBlue = 0, unLit = 0;
+      for(UInt32 i = 0; i < DRAWN_LEDS; ++i) {
+         const CColor& cColor = pc_leds[i];
+         if(cColor != CColor::BLACK) {
+            unRed   += cColor.GetRed();
+            unGreen += cColor.GetGreen();
+            unBlue  += cColor.GetBlue();
+            ++unLit;
+         }
+      }
+      if(unLit > 0) {
+         pun_color[0] = unRed   / unLit;
+         pun_color[1] = unGreen / unLit;
+         pun_color[2] = unBlue  / unLit;
+      }
+      else {
+         /* Green plastic */
+         pun_color[0] = 0;
+         pun_color[1] = 204;
+         pun_color[2] = 0;
+      }
+      pun_color[3] = 255;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   const CColor& CQTOpenGLEPuck2::GetLEDColor(CEPuck2LEDEquippedEntity* pc_leds,
+                                              UInt32 un_index) {
+      return pc_leds != NULL ? pc_leds->GetLED(un_index).GetColor() : CColor::BLACK;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CQTOpenGLEPuck2::GetLEDColors(CEPuck2LEDEquippedEntity* pc_leds,
+                                      CColor* pc_colors) {
+      for(UInt32 i = 0; i < DRAWN_LEDS; ++i) {
+         pc_colors[i] = GetLEDColor(pc_leds, i);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
    void CQTOpenGLEPuck2::SetWhitePlasticMaterial() {
       const GLfloat pfColor[]     = {   0.95f, 0.95f, 0.95f, 1.0f };
       const GLfloat pfSpecular[]  = {   1.0f,  1.0f,  1.0f,  1.0f };
       const GLfloat pfShininess[] = {  50.0f                   };
       const GLfloat pfEmission[]  = {   0.0f, 0.0f, 0.0f, 1.0f };
+      if(m_bRecording) {
+         SetPaint(PAINT_LIT, pfColor[0], pfColor[1], pfColor[2]);
+         return;
+      }
       glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, pfColor);
       glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR,            pfSpecular);
       glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS,           pfShininess);
@@ -177,6 +678,10 @@ namespace argos {
       const GLfloat pfSpecular[]  = {   0.5f, 0.5f, 0.5f, 1.0f };
       const GLfloat pfShininess[] = { 100.0f                   };
       const GLfloat pfEmission[]  = {   0.0f, 0.0f, 0.0f, 1.0f };
+      if(m_bRecording) {
+         SetPaint(PAINT_LIT, pfColor[0], pfColor[1], pfColor[2]);
+         return;
+      }
       glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, pfColor);
       glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR,            pfSpecular);
       glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS,           pfShininess);
@@ -191,6 +696,10 @@ namespace argos {
       const GLfloat pfSpecular[]  = {   0.9f, 0.9f, 0.9f, 1.0f };
       const GLfloat pfShininess[] = { 100.0f                   };
       const GLfloat pfEmission[]  = {   0.0f, 0.0f, 0.0f, 1.0f };
+      if(m_bRecording) {
+         SetPaint(PAINT_LIT, pfColor[0], pfColor[1], pfColor[2]);
+         return;
+      }
       glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, pfColor);
       glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR,            pfSpecular);
       glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS,           pfShininess);
@@ -205,6 +714,10 @@ namespace argos {
       const GLfloat pfSpecular[]  = { 0.5f, 0.5f, 1.0f, 1.0f };
       const GLfloat pfShininess[] = { 10.0f                  };
       const GLfloat pfEmission[]  = { 0.0f, 0.0f, 0.0f, 1.0f };
+      if(m_bRecording) {
+         SetPaint(PAINT_LIT, pfColor[0], pfColor[1], pfColor[2]);
+         return;
+      }
       glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, pfColor);
       glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR,            pfSpecular);
       glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS,           pfShininess);
@@ -221,6 +734,10 @@ namespace argos {
       const GLfloat pfSpecular[]  = {  0.0f,    0.0f,   0.0f, 1.0f };
       const GLfloat pfShininess[] = {  0.0f                        };
       const GLfloat pfEmission[]  = { f_red, f_green, f_blue, 1.0f };
+      if(m_bRecording) {
+         SetPaint(PAINT_UNLIT, f_red, f_green, f_blue);
+         return;
+      }
       glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, pfColor);
       glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR,            pfSpecular);
       glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS,           pfShininess);
@@ -238,40 +755,40 @@ namespace argos {
       CRadians cAngle(CRadians::TWO_PI / m_unVertices);
       CVector3 cNormal(-1.0f, -1.0f, 0.0f);
       cNormal.Normalize();
-      glBegin(GL_POLYGON);
+      Begin(GL_POLYGON);
       for(GLuint i = 0; i <= m_unVertices; i++) {
-         glNormal3f(cNormal.GetX(), cNormal.GetY(), cNormal.GetZ());
-         glVertex3f(cVertex.GetX(), -HALF_WHEEL_WIDTH, WHEEL_RADIUS + cVertex.GetY());
+         Normal(cNormal.GetX(), cNormal.GetY(), cNormal.GetZ());
+         Vertex(cVertex.GetX(), -HALF_WHEEL_WIDTH, WHEEL_RADIUS + cVertex.GetY());
          cVertex.Rotate(cAngle);
          cNormal.RotateY(cAngle);
       }
-      glEnd();
+      End();
       /* Left side */
       cVertex.Set(WHEEL_RADIUS, 0.0f);
       cNormal.Set(-1.0f, 1.0f, 0.0f);
       cNormal.Normalize();
       cAngle = -cAngle;
-      glBegin(GL_POLYGON);
+      Begin(GL_POLYGON);
       for(GLuint i = 0; i <= m_unVertices; i++) {
-         glNormal3f(cNormal.GetX(), cNormal.GetY(), cNormal.GetZ());
-         glVertex3f(cVertex.GetX(), HALF_WHEEL_WIDTH, WHEEL_RADIUS + cVertex.GetY());
+         Normal(cNormal.GetX(), cNormal.GetY(), cNormal.GetZ());
+         Vertex(cVertex.GetX(), HALF_WHEEL_WIDTH, WHEEL_RADIUS + cVertex.GetY());
          cVertex.Rotate(cAngle);
          cNormal.RotateY(cAngle);
       }
-      glEnd();
+      End();
       /* Tire */
       cNormal.Set(1.0f, 0.0f, 0.0f);
       cVertex.Set(WHEEL_RADIUS, 0.0f);
       cAngle = -cAngle;
-      glBegin(GL_QUAD_STRIP);
+      Begin(GL_QUAD_STRIP);
       for(GLuint i = 0; i <= m_unVertices; i++) {
-         glNormal3f(cNormal.GetX(), cNormal.GetY(), cNormal.GetZ());
-         glVertex3f(cVertex.GetX(), -HALF_WHEEL_WIDTH, WHEEL_RADIUS + cVertex.GetY());
-         glVertex3f(cVertex.GetX(),  HALF_WHEEL_WIDTH, WHEEL_RADIUS + cVertex.GetY());
+         Normal(cNormal.GetX(), cNormal.GetY(), cNormal.GetZ());
+         Vertex(cVertex.GetX(), -HALF_WHEEL_WIDTH, WHEEL_RADIUS + cVertex.GetY());
+         Vertex(cVertex.GetX(),  HALF_WHEEL_WIDTH, WHEEL_RADIUS + cVertex.GetY());
          cVertex.Rotate(cAngle);
          cNormal.RotateY(cAngle);
       }
-      glEnd();
+      End();
    }
 
    /****************************************/
@@ -279,36 +796,36 @@ namespace argos {
 
    void CQTOpenGLEPuck2::RenderChassis() {
       /* This part covers the bottom face (parallel to XY) */
-      glBegin(GL_QUADS);
+      Begin(GL_QUADS);
       /* Bottom face */
-      glNormal3f(0.0f, 0.0f, -1.0f);
-      glVertex3f( HALF_CHASSIS_LENGTH,  HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION);
-      glVertex3f( HALF_CHASSIS_LENGTH, -HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION);
-      glVertex3f(-HALF_CHASSIS_LENGTH, -HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION);
-      glVertex3f(-HALF_CHASSIS_LENGTH,  HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION);
-      glEnd();
+      Normal(0.0f, 0.0f, -1.0f);
+      Vertex( HALF_CHASSIS_LENGTH,  HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION);
+      Vertex( HALF_CHASSIS_LENGTH, -HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION);
+      Vertex(-HALF_CHASSIS_LENGTH, -HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION);
+      Vertex(-HALF_CHASSIS_LENGTH,  HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION);
+      End();
       /* This part covers the faces (South, East, North, West) */
-      glBegin(GL_QUAD_STRIP);
+      Begin(GL_QUAD_STRIP);
       /* Starting side */
-      glNormal3f(-1.0f, 0.0f, 0.0f);
-      glVertex3f(-HALF_CHASSIS_LENGTH, -HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION + WHEEL_DIAMETER);
-      glVertex3f(-HALF_CHASSIS_LENGTH, -HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION);
+      Normal(-1.0f, 0.0f, 0.0f);
+      Vertex(-HALF_CHASSIS_LENGTH, -HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION + WHEEL_DIAMETER);
+      Vertex(-HALF_CHASSIS_LENGTH, -HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION);
       /* South face */
-      glVertex3f( HALF_CHASSIS_LENGTH, -HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION + WHEEL_DIAMETER);
-      glVertex3f( HALF_CHASSIS_LENGTH, -HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION);
+      Vertex( HALF_CHASSIS_LENGTH, -HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION + WHEEL_DIAMETER);
+      Vertex( HALF_CHASSIS_LENGTH, -HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION);
       /* East face */
-      glNormal3f(0.0f, -1.0f, 0.0f);
-      glVertex3f( HALF_CHASSIS_LENGTH,  HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION + WHEEL_DIAMETER);
-      glVertex3f( HALF_CHASSIS_LENGTH,  HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION);
+      Normal(0.0f, -1.0f, 0.0f);
+      Vertex( HALF_CHASSIS_LENGTH,  HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION + WHEEL_DIAMETER);
+      Vertex( HALF_CHASSIS_LENGTH,  HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION);
       /* North face */
-      glNormal3f(1.0f, 0.0f, 0.0f);
-      glVertex3f(-HALF_CHASSIS_LENGTH,  HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION + WHEEL_DIAMETER);
-      glVertex3f(-HALF_CHASSIS_LENGTH,  HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION);
+      Normal(1.0f, 0.0f, 0.0f);
+      Vertex(-HALF_CHASSIS_LENGTH,  HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION + WHEEL_DIAMETER);
+      Vertex(-HALF_CHASSIS_LENGTH,  HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION);
       /* West face */
-      glNormal3f(0.0f, 1.0f, 0.0f);
-      glVertex3f(-HALF_CHASSIS_LENGTH, -HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION + WHEEL_DIAMETER);
-      glVertex3f(-HALF_CHASSIS_LENGTH, -HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION);
-      glEnd();
+      Normal(0.0f, 1.0f, 0.0f);
+      Vertex(-HALF_CHASSIS_LENGTH, -HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION + WHEEL_DIAMETER);
+      Vertex(-HALF_CHASSIS_LENGTH, -HALF_CHASSIS_WIDTH, CHASSIS_ELEVATION);
+      End();
    }
 
    /****************************************/
@@ -319,66 +836,66 @@ namespace argos {
       CVector2 cVertex(BODY_RADIUS, 0.0f);
       CRadians cAngle(-CRadians::TWO_PI / m_unVertices);
       /* Bottom part */
-      glBegin(GL_POLYGON);
-      glNormal3f(0.0f, 0.0f, -1.0f);
+      Begin(GL_POLYGON);
+      Normal(0.0f, 0.0f, -1.0f);
       for(GLuint i = 0; i <= m_unVertices; i++) {
-         glVertex3f(cVertex.GetX(), cVertex.GetY(), BODY_ELEVATION);
+         Vertex(cVertex.GetX(), cVertex.GetY(), BODY_ELEVATION);
          cVertex.Rotate(cAngle);
       }
-      glEnd();
+      End();
       /* Side surface */
       cAngle = -cAngle;
       CVector2 cNormal(1.0f, 0.0f);
       cVertex.Set(BODY_RADIUS, 0.0f);
-      glBegin(GL_QUAD_STRIP);
+      Begin(GL_QUAD_STRIP);
       for(GLuint i = 0; i <= m_unVertices; i++) {
-         glNormal3f(cNormal.GetX(), cNormal.GetY(), 0.0f);
-         glVertex3f(cVertex.GetX(), cVertex.GetY(), BODY_ELEVATION + BODY_HEIGHT);
-         glVertex3f(cVertex.GetX(), cVertex.GetY(), BODY_ELEVATION);
+         Normal(cNormal.GetX(), cNormal.GetY(), 0.0f);
+         Vertex(cVertex.GetX(), cVertex.GetY(), BODY_ELEVATION + BODY_HEIGHT);
+         Vertex(cVertex.GetX(), cVertex.GetY(), BODY_ELEVATION);
          cVertex.Rotate(cAngle);
          cNormal.Rotate(cAngle);
       }
-      glEnd();
+      End();
       /* Top part */
       SetGreenPlasticMaterial();
-      glBegin(GL_POLYGON);
+      Begin(GL_POLYGON);
       cVertex.Set(LED_UPPER_RING_INNER_RADIUS, 0.0f);
-      glNormal3f(0.0f, 0.0f, 1.0f);
+      Normal(0.0f, 0.0f, 1.0f);
       for(GLuint i = 0; i <= m_unVertices; i++) {
-         glVertex3f(cVertex.GetX(), cVertex.GetY(), BODY_ELEVATION + BODY_HEIGHT + LED_HEIGHT);
+         Vertex(cVertex.GetX(), cVertex.GetY(), BODY_ELEVATION + BODY_HEIGHT + LED_HEIGHT);
          cVertex.Rotate(cAngle);
       }
-      glEnd();
+      End();
       /* Triangle to set the direction */
       SetLEDMaterial(1.0f, 1.0f, 0.0f);
-      glBegin(GL_TRIANGLES);
-      glVertex3f(ARROW_OFFSET + BODY_RADIUS * 0.5,               0.0f, BODY_ELEVATION + BODY_HEIGHT + LED_HEIGHT + 0.001f);
-      glVertex3f(ARROW_OFFSET - BODY_RADIUS * 0.5,  BODY_RADIUS * 0.2, BODY_ELEVATION + BODY_HEIGHT + LED_HEIGHT + 0.001f);
-      glVertex3f(ARROW_OFFSET - BODY_RADIUS * 0.5, -BODY_RADIUS * 0.2, BODY_ELEVATION + BODY_HEIGHT + LED_HEIGHT + 0.001f);
-      glEnd();
+      Begin(GL_TRIANGLES);
+      Vertex(ARROW_OFFSET + BODY_RADIUS * 0.5,               0.0f, BODY_ELEVATION + BODY_HEIGHT + LED_HEIGHT + 0.001f);
+      Vertex(ARROW_OFFSET - BODY_RADIUS * 0.5,  BODY_RADIUS * 0.2, BODY_ELEVATION + BODY_HEIGHT + LED_HEIGHT + 0.001f);
+      Vertex(ARROW_OFFSET - BODY_RADIUS * 0.5, -BODY_RADIUS * 0.2, BODY_ELEVATION + BODY_HEIGHT + LED_HEIGHT + 0.001f);
+      End();
    }
 
    /****************************************/
    /****************************************/
     void CQTOpenGLEPuck2::RenderFrontLED() {
-      glBegin(GL_TRIANGLES);
+      Begin(GL_TRIANGLES);
       /* Top */
-      glVertex3f(FRONT_LED_HEIGHT + FRONT_LED_OFFSET,                 0.0f + FRONT_LED_DEV, FRONT_LED_ELEVATION                        );
-      glVertex3f(                   FRONT_LED_OFFSET,  FRONT_LED_HALF_SIDE + FRONT_LED_DEV, FRONT_LED_ELEVATION + FRONT_LED_HALF_SIDE);
-      glVertex3f(                   FRONT_LED_OFFSET, -FRONT_LED_HALF_SIDE + FRONT_LED_DEV, FRONT_LED_ELEVATION + FRONT_LED_HALF_SIDE);
+      Vertex(FRONT_LED_HEIGHT + FRONT_LED_OFFSET,                 0.0f + FRONT_LED_DEV, FRONT_LED_ELEVATION                        );
+      Vertex(                   FRONT_LED_OFFSET,  FRONT_LED_HALF_SIDE + FRONT_LED_DEV, FRONT_LED_ELEVATION + FRONT_LED_HALF_SIDE);
+      Vertex(                   FRONT_LED_OFFSET, -FRONT_LED_HALF_SIDE + FRONT_LED_DEV, FRONT_LED_ELEVATION + FRONT_LED_HALF_SIDE);
       /* Bottom */
-      glVertex3f(FRONT_LED_HEIGHT + FRONT_LED_OFFSET,                 0.0f + FRONT_LED_DEV, FRONT_LED_ELEVATION                        );
-      glVertex3f(                   FRONT_LED_OFFSET, -FRONT_LED_HALF_SIDE + FRONT_LED_DEV, FRONT_LED_ELEVATION - FRONT_LED_HALF_SIDE);
-      glVertex3f(                   FRONT_LED_OFFSET,  FRONT_LED_HALF_SIDE + FRONT_LED_DEV, FRONT_LED_ELEVATION - FRONT_LED_HALF_SIDE);
+      Vertex(FRONT_LED_HEIGHT + FRONT_LED_OFFSET,                 0.0f + FRONT_LED_DEV, FRONT_LED_ELEVATION                        );
+      Vertex(                   FRONT_LED_OFFSET, -FRONT_LED_HALF_SIDE + FRONT_LED_DEV, FRONT_LED_ELEVATION - FRONT_LED_HALF_SIDE);
+      Vertex(                   FRONT_LED_OFFSET,  FRONT_LED_HALF_SIDE + FRONT_LED_DEV, FRONT_LED_ELEVATION - FRONT_LED_HALF_SIDE);
       /* Left */
-      glVertex3f(FRONT_LED_HEIGHT + FRONT_LED_OFFSET,                 0.0f + FRONT_LED_DEV, FRONT_LED_ELEVATION                        );
-      glVertex3f(                   FRONT_LED_OFFSET,  FRONT_LED_HALF_SIDE + FRONT_LED_DEV, FRONT_LED_ELEVATION - FRONT_LED_HALF_SIDE);
-      glVertex3f(                   FRONT_LED_OFFSET,  FRONT_LED_HALF_SIDE + FRONT_LED_DEV, FRONT_LED_ELEVATION + FRONT_LED_HALF_SIDE);
+      Vertex(FRONT_LED_HEIGHT + FRONT_LED_OFFSET,                 0.0f + FRONT_LED_DEV, FRONT_LED_ELEVATION                        );
+      Vertex(                   FRONT_LED_OFFSET,  FRONT_LED_HALF_SIDE + FRONT_LED_DEV, FRONT_LED_ELEVATION - FRONT_LED_HALF_SIDE);
+      Vertex(                   FRONT_LED_OFFSET,  FRONT_LED_HALF_SIDE + FRONT_LED_DEV, FRONT_LED_ELEVATION + FRONT_LED_HALF_SIDE);
       /* Right */
-      glVertex3f(FRONT_LED_HEIGHT + FRONT_LED_OFFSET,                 0.0f + FRONT_LED_DEV, FRONT_LED_ELEVATION                        );
-      glVertex3f(                   FRONT_LED_OFFSET, -FRONT_LED_HALF_SIDE + FRONT_LED_DEV, FRONT_LED_ELEVATION + FRONT_LED_HALF_SIDE);
-      glVertex3f(                   FRONT_LED_OFFSET, -FRONT_LED_HALF_SIDE + FRONT_LED_DEV, FRONT_LED_ELEVATION - FRONT_LED_HALF_SIDE);
-      glEnd();
+      Vertex(FRONT_LED_HEIGHT + FRONT_LED_OFFSET,                 0.0f + FRONT_LED_DEV, FRONT_LED_ELEVATION                        );
+      Vertex(                   FRONT_LED_OFFSET, -FRONT_LED_HALF_SIDE + FRONT_LED_DEV, FRONT_LED_ELEVATION + FRONT_LED_HALF_SIDE);
+      Vertex(                   FRONT_LED_OFFSET, -FRONT_LED_HALF_SIDE + FRONT_LED_DEV, FRONT_LED_ELEVATION - FRONT_LED_HALF_SIDE);
+      End();
    }
 
 
@@ -390,31 +907,31 @@ namespace argos {
       CVector2 cVertex(BODY_RADIUS, 0.0f);
       CRadians cAngle(CRadians::TWO_PI / m_unVertices);
       CVector2 cNormal(1.0f, 0.0f);
-      glBegin(GL_QUAD_STRIP);
+      Begin(GL_QUAD_STRIP);
       cVertex.Rotate(CRadians::PI / 10.0f);
       cNormal.Rotate(CRadians::PI / 10.0f);
       for(GLuint i = 0; i <= m_unVertices / 32; i++) {
-         glNormal3f(cNormal.GetX(), cNormal.GetY(), 0.0f);
-         glVertex3f(cVertex.GetX(), cVertex.GetY(), LED_ELEVATION + LED_HEIGHT);
-         glVertex3f(cVertex.GetX(), cVertex.GetY(), LED_ELEVATION);
+         Normal(cNormal.GetX(), cNormal.GetY(), 0.0f);
+         Vertex(cVertex.GetX(), cVertex.GetY(), LED_ELEVATION + LED_HEIGHT);
+         Vertex(cVertex.GetX(), cVertex.GetY(), LED_ELEVATION);
          cVertex.Rotate(cAngle);
          cNormal.Rotate(cAngle);
       }
-      glEnd();
+      End();
       /* Top surface  */
       cVertex.Set(BODY_RADIUS, 0.0f);
       CVector2 cVertex2(LED_UPPER_RING_INNER_RADIUS, 0.0f);
-      glBegin(GL_QUAD_STRIP);
+      Begin(GL_QUAD_STRIP);
       cVertex.Rotate(CRadians::PI / 10.0f);
       cVertex2.Rotate(CRadians::PI / 10.0f);
-      glNormal3f(0.0f, 0.0f, 1.0f);
+      Normal(0.0f, 0.0f, 1.0f);
       for(GLuint i = 0; i <= m_unVertices / 32; i++) {
-         glVertex3f(cVertex2.GetX(), cVertex2.GetY(), BODY_ELEVATION + BODY_HEIGHT + LED_HEIGHT);
-         glVertex3f(cVertex.GetX(), cVertex.GetY(), BODY_ELEVATION + BODY_HEIGHT + LED_HEIGHT);
+         Vertex(cVertex2.GetX(), cVertex2.GetY(), BODY_ELEVATION + BODY_HEIGHT + LED_HEIGHT);
+         Vertex(cVertex.GetX(), cVertex.GetY(), BODY_ELEVATION + BODY_HEIGHT + LED_HEIGHT);
          cVertex.Rotate(cAngle);
          cVertex2.Rotate(cAngle);
       }
-      glEnd();
+      End();
    }
 
    /****************************************/
@@ -425,31 +942,154 @@ namespace argos {
       CVector2 cVertex(BODY_RADIUS, 0.0f);
       CRadians cAngle(CRadians::TWO_PI / m_unVertices);
       CVector2 cNormal(1.0f, 0.0f);
-      glBegin(GL_QUAD_STRIP);
+      Begin(GL_QUAD_STRIP);
       cVertex.Rotate(CRadians::PI / 3.65f);
       cNormal.Rotate(CRadians::PI / 3.65f);
       for(GLuint i = 0; i <= m_unVertices / 10; i++) {
-         glNormal3f(cNormal.GetX(), cNormal.GetY(), 0.0f);
-         glVertex3f(cVertex.GetX(), cVertex.GetY(), LED_ELEVATION + LED_HEIGHT);
-         glVertex3f(cVertex.GetX(), cVertex.GetY(), LED_ELEVATION);
+         Normal(cNormal.GetX(), cNormal.GetY(), 0.0f);
+         Vertex(cVertex.GetX(), cVertex.GetY(), LED_ELEVATION + LED_HEIGHT);
+         Vertex(cVertex.GetX(), cVertex.GetY(), LED_ELEVATION);
          cVertex.Rotate(cAngle);
          cNormal.Rotate(cAngle);
       }
-      glEnd();
+      End();
       /* Top surface  */
       cVertex.Set(BODY_RADIUS, 0.0f);
       CVector2 cVertex2(LED_UPPER_RING_INNER_RADIUS, 0.0f);
-      glBegin(GL_QUAD_STRIP);
+      Begin(GL_QUAD_STRIP);
       cVertex.Rotate(CRadians::PI / 3.65f);
       cVertex2.Rotate(CRadians::PI / 3.65f);
-      glNormal3f(0.0f, 0.0f, 1.0f);
+      Normal(0.0f, 0.0f, 1.0f);
       for(GLuint i = 0; i <= m_unVertices / 10; i++) {
-         glVertex3f(cVertex2.GetX(), cVertex2.GetY(), BODY_ELEVATION + BODY_HEIGHT + LED_HEIGHT);
-         glVertex3f(cVertex.GetX(), cVertex.GetY(), BODY_ELEVATION + BODY_HEIGHT + LED_HEIGHT);
+         Vertex(cVertex2.GetX(), cVertex2.GetY(), BODY_ELEVATION + BODY_HEIGHT + LED_HEIGHT);
+         Vertex(cVertex.GetX(), cVertex.GetY(), BODY_ELEVATION + BODY_HEIGHT + LED_HEIGHT);
          cVertex.Rotate(cAngle);
          cVertex2.Rotate(cAngle);
       }
-      glEnd();
+      End();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CQTOpenGLEPuck2::RenderDisc() {
+      /* A coarse disc is enough far away */
+      CVector2 cVertex(BODY_RADIUS, 0.0f);
+      CRadians cAngle(CRadians::TWO_PI / (m_unVertices / 4));
+      Begin(GL_POLYGON);
+      Normal(0.0f, 0.0f, 1.0f);
+      for(GLuint i = 0; i <= m_unVertices / 4; i++) {
+         Vertex(cVertex.GetX(), cVertex.GetY(), LOD_ELEVATION);
+         cVertex.Rotate(cAngle);
+      }
+      End();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CQTOpenGLEPuck2::RenderHeading() {
+      Begin(GL_QUADS);
+      Normal(0.0f, 0.0f, 1.0f);
+      Vertex(       0.0f, -HEADING_HALF_WIDTH, LOD_ELEVATION + 0.001f);
+      Vertex(BODY_RADIUS, -HEADING_HALF_WIDTH, LOD_ELEVATION + 0.001f);
+      Vertex(BODY_RADIUS,  HEADING_HALF_WIDTH, LOD_ELEVATION + 0.001f);
+      Vertex(       0.0f,  HEADING_HALF_WIDTH, LOD_ELEVATION + 0.001f);
+      End();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CQTOpenGLEPuck2::Begin(GLenum un_mode) {
+      if(m_bRecording) {
+         m_unPrimitive = un_mode;
+         m_vecPrimitive.clear();
+      }
+      else {
+         glBegin(un_mode);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CQTOpenGLEPuck2::Normal(GLfloat f_x, GLfloat f_y, GLfloat f_z) {
+      if(m_bRecording) {
+         CVector2 cNormal(f_x, f_y);
+         cNormal.Rotate(m_cRecordAngle);
+         m_pfNormal[0] = cNormal.GetX();
+         m_pfNormal[1] = cNormal.GetY();
+         m_pfNormal[2] = f_z;
+      }
+      else {
+         glNormal3f(f_x, f_y, f_z);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CQTOpenGLEPuck2::Vertex(GLfloat f_x, GLfloat f_y, GLfloat f_z) {
+      if(m_bRecording) {
+         CVector2 cPosition(f_x, f_y);
+         cPosition.Rotate(m_cRecordAngle);
+         cPosition += m_cRecordOffset;
+         SVertex sVertex;
+         sVertex.Position[0] = cPosition.GetX();
+         sVertex.Position[1] = cPosition.GetY();
+         sVertex.Position[2] = f_z;
+         std::copy(m_pfNormal, m_pfNormal + 3, sVertex.Normal);
+         std::copy(m_punPaintColor, m_punPaintColor + 4, sVertex.Color);
+         m_vecPrimitive.push_back(sVertex);
+      }
+      else {
+         glVertex3f(f_x, f_y, f_z);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CQTOpenGLEPuck2::End() {
+      if(!m_bRecording) {
+         glEnd();
+         return;
+      }
+      /* Split the primitive into triangles */
+      std::vector<SVertex>& vecPart = m_vecParts[m_ePaint];
+      size_t unCount = m_vecPrimitive.size();
+      switch(m_unPrimitive) {
+         case GL_TRIANGLES:
+            vecPart.insert(vecPart.end(), m_vecPrimitive.begin(), m_vecPrimitive.begin() + unCount / 3 * 3);
+            break;
+         case GL_POLYGON:
+            for(size_t i = 2; i < unCount; ++i) {
+               vecPart.push_back(m_vecPrimitive[0]);
+               vecPart.push_back(m_vecPrimitive[i - 1]);
+               vecPart.push_back(m_vecPrimitive[i]);
+            }
+            break;
+         case GL_QUADS:
+            for(size_t i = 0; i + 3 < unCount; i += 4) {
+               for(size_t j = 0; j < 6; ++j) {
+                  vecPart.push_back(m_vecPrimitive[i + QUADS_ORDER[j]]);
+               }
+            }
+            break;
+         case GL_QUAD_STRIP:
+            for(size_t i = 0; i + 3 < unCount; i += 2) {
+               for(size_t j = 0; j < 6; ++j) {
+                  vecPart.push_back(m_vecPrimitive[i + QUAD_STRIP_ORDER[j]]);
+               }
+            }
+            break;
+         default:
+            THROW_ARGOSEXCEPTION("Unsupported primitive " << m_unPrimitive << " in the e-puck2 mesh");
+      }
+      if(m_ePaint == PAINT_LED) {
+         m_vecPartSlots.resize(vecPart.size(), m_unPaintSlot);
+      }
    }
 
    /****************************************/
@@ -461,8 +1101,14 @@ namespace argos {
                    CEPuck2Entity& c_entity) {
          static CQTOpenGLEPuck2 m_cModel;
          c_visualization.DrawRays(c_entity.GetControllableEntity());
-         c_visualization.DrawEntity(c_entity.GetEmbodiedEntity());
-         m_cModel.Draw(c_entity);
+         if(m_cModel.IsInstanced()) {
+            /* Drawn with the other e-puck2s, in world coordinates */
+            m_cModel.AddInstance(c_entity);
+         }
+         else {
+            c_visualization.DrawEntity(c_entity.GetEmbodiedEntity());
+            m_cModel.Draw(c_entity);
+         }
       }
    };
 
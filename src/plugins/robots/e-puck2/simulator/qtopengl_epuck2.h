@@ -12,16 +12,66 @@
 namespace argos {
    class CQTOpenGLEPuck2;
    class CEPuck2Entity;
+   class CEPuck2LEDEquippedEntity;
 }
 
+#include <argos3/core/utility/datatypes/color.h>
+#include <argos3/core/utility/math/vector2.h>
+#include <argos3/core/utility/math/quaternion.h>
+#include <argos3/core/utility/math/vector3.h>
+#include <vector>
+
 #ifdef __APPLE__
 #include <OpenGL/gl.h>
 #else
+#ifndef GL_GLEXT_PROTOTYPES
+#define GL_GLEXT_PROTOTYPES
+#endif
 #include <GL/gl.h>
+#include <GL/glext.h>
 #endif
 
 namespace argos {
 
+   /**
+    * Draws the e-puck2 in the Qt-OpenGL visualization.
+    * <p>
+    * By default, each robot is drawn on its own with display lists. With
+    * many robots, the instanced path is faster: the robots are queued as they
+    * are visited and drawn all together at the end of the frame, with no
+    * material changes. The mesh of each queued robot is transformed on the
+    * CPU into world coordinates, with the colours of its LEDs, and streamed
+    * into a single vertex buffer. A frame then takes one draw call for the
+    * lit parts, one for the unlit parts, LEDs and distant discs, and one for
+    * the points, whatever the number of robots. It only needs OpenGL 1.5 and
+    * the fixed pipeline, so it also works with Mesa software rendering
+    * (llvmpipe, softpipe). Under OpenGL 1.4, the stream is kept in client
+    * memory.
+    * </p>
+    * <p>
+    * The end of the frame comes from CQTOpenGLEPuck2UserFunctions, which must
+    * be the user functions of the visualization, or their base class.
+    * Without them, the robots are drawn on their own. The model and the hook
+    * are process-wide, so a single visualization can use the instanced path.
+    * </p>
+    * <p>
+    * Robots far from the camera can be drawn with less detail: beyond
+    * 'disc_distance' (in meters), a disc with the colour of the lit LEDs and
+    * a heading tick; beyond 'point_distance', a point of 'point_size' pixels.
+    * A distance of 0 disables the level. This works on both paths; with the
+    * instanced path, all the points are drawn with a single call.
+    * </p>
+    * <pre>
+    *   <visualization>
+    *     <qt-opengl>
+    *       <epuck2 instanced="true"
+    *               disc_distance="1.5" point_distance="5" point_size="4" />
+    *       <user_functions label="epuck2_qtopengl_user_functions" />
+    *       ...
+    *     </qt-opengl>
+    *   </visualization>
+    * </pre>
+    */
    class CQTOpenGLEPuck2 {
 
    public:
@@ -32,8 +82,40 @@ namespace argos {
 
       virtual void Draw(CEPuck2Entity& c_entity);
 
+      /**
+       * Queues a robot for the instanced path. The first robot of a frame
+       * takes the modelview as the camera, so it must only hold the camera.
+       */
+      void AddInstance(CEPuck2Entity& c_entity);
+
+      /**
+       * Draws the robots queued in this frame, in world coordinates.
+       */
+      void EndFrame();
+
+      /**
+       * Ends the frame of the instanced model, if any.
+       * CQTOpenGLEPuck2UserFunctions calls it after the entities are drawn.
+       */
+      static void EndFrames();
+
+      /**
+       * Tells the models whether something calls EndFrames() at every frame.
+       */
+      static void SetEndFrameHook(bool b_hook);
+
+      inline bool IsInstanced() const {
+         return m_bInstanced;
+      }
+
    protected:
 
+      /** Returns the color of an LED, or black if the robot has no LEDs */
+      static const CColor& GetLEDColor(CEPuck2LEDEquippedEntity* pc_leds,
+                                       UInt32 un_index);
+      /** Copies the colours of the drawn LEDs */
+      static void GetLEDColors(CEPuck2LEDEquippedEntity* pc_leds,
+                               CColor* pc_colors);
       /** Sets a white plastic material */
       void SetWhitePlasticMaterial();
       /** Sets a green plastic material */
@@ -59,6 +141,110 @@ namespace argos {
       void RenderGap();
       /** The front LED */
       void RenderFrontLED();
+      /** A flat disc on top of the robot */
+      void RenderDisc();
+      /** A tick pointing forward, on top of the disc */
+      void RenderHeading();
+
+      /*
+       * The Render*() methods emit their geometry through these calls, which
+       * go to OpenGL or, while the mesh is built, to the mesh.
+       */
+      void Begin(GLenum un_mode);
+      void Normal(GLfloat f_x, GLfloat f_y, GLfloat f_z);
+      void Vertex(GLfloat f_x, GLfloat f_y, GLfloat f_z);
+      void End();
+
+   private:
+
+      /** How a part of the mesh is painted */
+      enum EPaint {
+         /** An LED, with the colour of the robot */
+         PAINT_LED = 0,
+         /** Emissive, with a fixed colour */
+         PAINT_UNLIT,
+         /** Chassis and body, green plastic or lit green */
+         PAINT_BODY,
+         /** Plastic, with a fixed colour */
+         PAINT_LIT,
+         /** The disc, with the colour of the robot */
+         PAINT_DISC,
+         /** The heading tick */
+         PAINT_HEADING,
+         PAINT_NUM
+      };
+
+      /** The detail a robot is drawn with */
+      enum ELevel {
+         LEVEL_FULL = 0,
+         LEVEL_DISC,
+         LEVEL_POINT
+      };
+
+      /** A vertex of the mesh */
+      struct SVertex {
+         GLfloat Position[3];
+         GLfloat Normal[3];
+         GLubyte Color[4];
+      };
+
+      /** A queued robot */
+      struct SInstance {
+         /** The pose of the robot in the world, column-major */
+         GLfloat Pose[16];
+         /** Whether the body LED is on */
+         bool BodyGlow;
+         /** The colour of the disc */
+         GLubyte Color[4];
+         /** The colours of the ring and front LEDs */
+         GLubyte LEDs[9][4];
+      };
+
+      /** A robot drawn as a point, in world coordinates */
+      struct SPoint {
+         GLfloat Position[3];
+         GLubyte Color[4];
+      };
+
+      /** Sets the paint of the next primitives while the mesh is built */
+      void SetPaint(EPaint e_paint,
+                    GLfloat f_red,
+                    GLfloat f_green,
+                    GLfloat f_blue);
+
+      /** Builds the mesh from the Render*() methods */
+      void BuildMesh();
+
+      /** Queues a robot at the level of detail of its distance */
+      void QueueRobot(const CVector3& c_position,
+                      const CQuaternion& c_orientation,
+                      const CColor* pc_leds);
+
+      /** Queues a robot drawn in full, with the colours of its LEDs */
+      void AddFullInstance(SInstance& s_instance,
+                           const CColor* pc_leds);
+
+      /** Draws the queued robots */
+      void DrawInstances();
+
+      /**
+       * Appends a range of the mesh to the stream, in world coordinates.
+       * The vertices take the given colour, or keep theirs if NULL.
+       */
+      void StreamRange(const SInstance& s_instance,
+                       GLint n_first,
+                       GLint n_last,
+                       const GLubyte* pun_color);
+
+      /** Returns the level of a robot from its modelview */
+      ELevel GetLevel(const GLfloat* pf_transform) const;
+
+      /** Returns the mean colour of the lit LEDs, or the body colour */
+      static void GetLODColor(const CColor* pc_leds,
+                              GLubyte* pun_color);
+
+      /** Returns an offset in the bound buffer, or a pointer in client memory */
+      const GLvoid* GetStreamPointer(size_t un_offset) const;
 
    private:
 
@@ -83,6 +269,10 @@ namespace argos {
       /** Front LED list */
       GLuint m_unFrontLED;
 
+      /** Disc and heading lists, for distant robots */
+      GLuint m_unDiscList;
+      GLuint m_unHeadingList;
+
       /** Number of vertices to display the round parts
           (wheels, chassis, etc.) */
       GLuint m_unVertices;
@@ -90,6 +280,59 @@ namespace argos {
       /* Angle gap between two leds */
       GLfloat m_fLEDAngleSlice;
 
+      /** Whether the instanced path is used */
+      bool m_bInstanced;
+
+      /** Level of detail thresholds, 0 to disable */
+      GLfloat m_fDiscDistance;
+      GLfloat m_fPointDistance;
+      GLfloat m_fPointSize;
+
+      /** The buffer the robots are streamed into, or 0 for client arrays */
+      GLuint m_unStreamBuffer;
+
+      /**
+       * The mesh, made of triangles: the LEDs first, then the unlit parts,
+       * the body twice (lit green, then plastic), the plastic parts, and the
+       * disc and heading tick of distant robots. This way, each robot adds a
+       * few contiguous ranges to each pass.
+       */
+      std::vector<SVertex> m_vecMesh;
+      GLint m_nUnlitFirst;
+      GLint m_nBodyGlowFirst;
+      GLint m_nBodyLitFirst;
+      GLint m_nLitFirst;
+      GLint m_nDiscFirst;
+      GLint m_nHeadingFirst;
+
+      /** The LED of each LED vertex */
+      std::vector<UInt32> m_vecLEDSlots;
+
+      /** Queued robots */
+      std::vector<SInstance> m_vecInstances;
+      std::vector<SInstance> m_vecDiscs;
+      std::vector<SPoint> m_vecPoints;
+      /** The queued robots in world coordinates, lit parts first */
+      std::vector<SVertex> m_vecStream;
+      /** Whether robots were queued since the last EndFrame() */
+      bool m_bFrameStarted;
+
+      /** The modelview of the camera, when the frame started */
+      GLfloat m_pfCamera[16];
+
+      /* State while the mesh is built */
+      bool m_bRecording;
+      EPaint m_ePaint;
+      UInt32 m_unPaintSlot;
+      GLubyte m_punPaintColor[4];
+      GLenum m_unPrimitive;
+      GLfloat m_pfNormal[3];
+      CRadians m_cRecordAngle;
+      CVector2 m_cRecordOffset;
+      std::vector<SVertex> m_vecPrimitive;
+      std::vector<SVertex> m_vecParts[PAINT_NUM];
+      std::vector<UInt32> m_vecPartSlots;
+
 
    };
 
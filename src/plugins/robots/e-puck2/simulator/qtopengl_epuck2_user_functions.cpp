@@ -0,0 +1,44 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/qtopengl_epuck2_user_functions.cpp>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#include "qtopengl_epuck2_user_functions.h"
+#include "qtopengl_epuck2.h"
+#include <argos3/plugins/robots/e-puck2/utility/epuck2_log.h>
+
+namespace argos {
+
+   /****************************************/
+   /****************************************/
+
+   CQTOpenGLEPuck2UserFunctions::CQTOpenGLEPuck2UserFunctions() {
+      /* The user functions exist before the first frame is drawn */
+      CQTOpenGLEPuck2::SetEndFrameHook(true);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CQTOpenGLEPuck2UserFunctions::~CQTOpenGLEPuck2UserFunctions() {
+      CQTOpenGLEPuck2::SetEndFrameHook(false);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CQTOpenGLEPuck2UserFunctions::DrawInWorld() {
+      CQTOpenGLEPuck2::EndFrames();
+      /* Show the messages of the controller threads in the log window */
+      CEPuck2Log::GetInstance().Flush();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   REGISTER_QTOPENGL_USER_FUNCTIONS(CQTOpenGLEPuck2UserFunctions, "epuck2_qtopengl_user_functions");
+
+}
@@ -0,0 +1,52 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/simulator/qtopengl_epuck2_user_functions.h>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#ifndef QTOPENGL_EPUCK2_USER_FUNCTIONS_H
+#define QTOPENGL_EPUCK2_USER_FUNCTIONS_H
+
+namespace argos {
+   class CQTOpenGLEPuck2UserFunctions;
+}
+
+#include <argos3/plugins/simulator/visualizations/qt-opengl/qtopengl_user_functions.h>
+
+namespace argos {
+
+   /**
+    * User functions that end the frames of the instanced e-puck2 renderer.
+    * <p>
+    * The widget draws the entities first and then calls DrawInWorld(), which
+    * draws the e-puck2s queued in the frame. Use the label directly, or
+    * derive your user functions from this class and call
+    * CQTOpenGLEPuck2UserFunctions::DrawInWorld() from yours:
+    * </p>
+    * <pre>
+    *   <visualization>
+    *     <qt-opengl>
+    *       <epuck2 instanced="true" />
+    *       <user_functions label="epuck2_qtopengl_user_functions" />
+    *       ...
+    *     </qt-opengl>
+    *   </visualization>
+    * </pre>
+    */
+   class CQTOpenGLEPuck2UserFunctions : public CQTOpenGLUserFunctions {
+
+   public:
+
+      CQTOpenGLEPuck2UserFunctions();
+
+      virtual ~CQTOpenGLEPuck2UserFunctions();
+
+      virtual void DrawInWorld();
+
+   };
+
+}
+
+#endif
@@ -0,0 +1,36 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/utility/epuck2_layout.cpp>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#include "epuck2_layout.h"
+
+namespace argos {
+
+   /****************************************/
+   /****************************************/
+
+   const SEPuck2Layout::SRingSensor* SEPuck2Layout::GetRingSensors() {
+      /* Thread-safe, computed by the first caller only */
+      static const struct SRing {
+         SRingSensor Sensors[NUM_RING_SENSORS];
+         SRing() {
+            for(UInt32 i = 0; i < NUM_RING_SENSORS; ++i) {
+               Sensors[i].Angle = GetRingSensorAngle(i);
+               Sensors[i].Direction.Set(1.0, 0.0, 0.0);
+               Sensors[i].Direction.RotateZ(Sensors[i].Angle);
+               Sensors[i].Offset = Sensors[i].Direction * RING_RADIUS;
+               Sensors[i].Offset.SetZ(RING_ELEVATION);
+            }
+         }
+      } sRing;
+      return sRing.Sensors;
+   }
+
+   /****************************************/
+   /****************************************/
+
+}
@@ -0,0 +1,117 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/utility/epuck2_layout.h>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#ifndef EPUCK2_LAYOUT_H
+#define EPUCK2_LAYOUT_H
+
+namespace argos {
+   struct SEPuck2Layout;
+}
+
+#include <argos3/core/utility/math/angles.h>
+#include <argos3/core/utility/math/vector3.h>
+
+namespace argos {
+
+   /**
+    * The geometry of the e-puck2 body, sensors and LEDs.
+    * <p>
+    * The layout is the same for every robot, so it is defined once and shared by
+    * the robot entity, the physics model and the control interface, instead of
+    * being recomputed by each of them. The scalar values are compile-time
+    * constants. The positions of the sensors of the proximity/light ring need
+    * trigonometry, so they are computed on first use and kept for the whole
+    * process.
+    * </p>
+    * <p>
+    * Angles are in radians, distances in meters. The origin is the middle point
+    * between the wheels on the floor, with the X axis pointing forward.
+    * </p>
+    */
+   struct SEPuck2Layout {
+
+      /* Body */
+      static constexpr Real BODY_RADIUS         = 0.035;
+      static constexpr Real BODY_HEIGHT         = 0.086;
+      static constexpr Real INTERWHEEL_DISTANCE = 0.053;
+      static constexpr Real WHEEL_RADIUS        = 0.0205;
+
+      /* Proximity and light sensor ring */
+      static constexpr UInt32 NUM_RING_SENSORS  = 8;
+      static constexpr Real RING_ELEVATION      = 0.043;
+      static constexpr Real RING_RADIUS         = BODY_RADIUS + 0.001;
+      static constexpr Real PROXIMITY_RANGE     = 0.05;
+      static constexpr Real LIGHT_RANGE         = 0.50;
+      /** Angles of the ring sensors, counter-clockwise from the front, in (-pi,pi] */
+      static constexpr Real RING_SENSOR_ANGLES[NUM_RING_SENSORS] = {
+         -ARGOS_PI / 10.5884,
+         -ARGOS_PI / 3.5999,
+         -ARGOS_PI / 2.0,     // side sensor
+         -ARGOS_PI / 1.2,     // back sensor
+          ARGOS_PI / 1.2,     // back sensor
+          ARGOS_PI / 2.0,     // side sensor
+          ARGOS_PI / 3.5999,
+          ARGOS_PI / 10.5884
+      };
+
+      /* Time-of-flight sensor */
+      static constexpr Real TOF_ELEVATION       = 0.036;
+      static constexpr Real TOF_OFFSET          = BODY_RADIUS - 0.003;
+      static constexpr Real TOF_RANGE           = 2.0;
+
+      /* Ground sensors, as X,Y pairs */
+      static constexpr UInt32 NUM_GROUND_SENSORS = 3;
+      static constexpr Real GROUND_SENSOR_OFFSETS[NUM_GROUND_SENSORS][2] = {
+         { 0.03, -0.009 },
+         { 0.03,  0.0   },
+         { 0.03,  0.009 }
+      };
+
+      /* LEDs */
+      static constexpr UInt32 NUM_RING_LEDS     = 8;
+      static constexpr Real LED_RING_RADIUS     = BODY_RADIUS + 0.002;
+      static constexpr Real LED_RING_ELEVATION  = 0.048;
+      static constexpr Real BODY_LED_ELEVATION  = RING_ELEVATION;
+      static constexpr Real FRONT_LED_X         = 0.0345;
+      static constexpr Real FRONT_LED_Y         = -0.01;
+      static constexpr Real FRONT_LED_ELEVATION = 0.032;
+
+      /* Range-and-bearing */
+      static constexpr Real RAB_ELEVATION       = LED_RING_ELEVATION;
+
+      /**
+       * The pose of a sensor of the proximity/light ring.
+       */
+      struct SRingSensor {
+         /** Angle of the sensor */
+         CRadians Angle;
+         /** Position of the sensor */
+         CVector3 Offset;
+         /** Unit vector pointing outwards */
+         CVector3 Direction;
+      };
+
+      /**
+       * Returns the ring sensors.
+       * The array has NUM_RING_SENSORS elements.
+       */
+      static const SRingSensor* GetRingSensors();
+
+      /**
+       * Returns the angle of the given ring sensor.
+       * @param un_index The index of the sensor.
+       */
+      static inline CRadians GetRingSensorAngle(UInt32 un_index) {
+         return CRadians(RING_SENSOR_ANGLES[un_index]);
+      }
+
+   };
+
+}
+
+#endif
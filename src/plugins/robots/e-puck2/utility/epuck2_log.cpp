@@ -0,0 +1,287 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/utility/epuck2_log.cpp>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#include "epuck2_log.h"
+
+#include <argos3/core/utility/logging/argos_log.h>
+#include <argos3/core/utility/string_utilities.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace argos {
+
+   /****************************************/
+   /****************************************/
+
+   /* Number of messages per thread buffer, must be a power of two */
+   static const size_t RING_SIZE = 1024;
+   /* Maximum length of a message, longer ones are truncated */
+   static const size_t MESSAGE_SIZE = 240;
+   /* The simulation thread, i.e., the thread that loads the plugin */
+   static const std::thread::id SIMULATION_THREAD = std::this_thread::get_id();
+
+   static const char* LEVEL_NAMES[] = {
+      "none", "error", "warning", "info", "debug"
+   };
+
+   /****************************************/
+   /****************************************/
+
+   struct SEPuck2LogRecord {
+      UInt8 Level;
+      UInt8 Module;
+      UInt16 Length;
+      char Text[MESSAGE_SIZE];
+   };
+
+   /*
+    * Single-producer single-consumer ring buffer.
+    * The owning thread moves Head, Flush() moves Tail.
+    */
+   struct SEPuck2LogRing {
+      SEPuck2LogRecord Records[RING_SIZE];
+      std::atomic<size_t> Head;
+      std::atomic<size_t> Tail;
+      std::atomic<UInt64> Dropped;
+
+      SEPuck2LogRing() :
+         Head(0),
+         Tail(0),
+         Dropped(0) {}
+   };
+
+   /****************************************/
+   /****************************************/
+
+   struct CEPuck2Log::SImpl {
+      /* Protects the module table and the ring list */
+      std::mutex Mutex;
+      /* Serialises the consumers */
+      std::mutex FlushMutex;
+      std::vector<std::string> Modules;
+      std::map<std::string, UInt8> Levels;
+      UInt8 DefaultLevel;
+      std::vector<SEPuck2LogRing*> Rings;
+
+      SImpl() :
+         DefaultLevel(LEVEL_INFO) {}
+   };
+
+   /****************************************/
+   /****************************************/
+
+   CEPuck2Log& CEPuck2Log::GetInstance() {
+      static CEPuck2Log cInstance;
+      return cInstance;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CEPuck2Log::CEPuck2Log() :
+      m_psImpl(new SImpl) {
+      for(UInt32 i = 0; i < MAX_MODULES; ++i) {
+         m_punLevels[i].store(m_psImpl->DefaultLevel);
+      }
+      /* Parse the run-time filters, e.g., "leds=debug,*=warning" */
+      const char* pchFilters = ::getenv("EPUCK2_LOG");
+      if(pchFilters != NULL) {
+         std::vector<std::string> vecFilters;
+         Tokenize(pchFilters, vecFilters, ",");
+         for(size_t i = 0; i < vecFilters.size(); ++i) {
+            size_t unSep = vecFilters[i].find('=');
+            if(unSep != std::string::npos) {
+               SetLevel(vecFilters[i].substr(0, unSep),
+                        ParseLevel(vecFilters[i].substr(unSep + 1)));
+            }
+         }
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CEPuck2Log::~CEPuck2Log() {
+      /* LOG and LOGERR may be gone by now, write the leftovers to stdio */
+      Drain(true);
+      while(! m_psImpl->Rings.empty()) {
+         delete m_psImpl->Rings.back();
+         m_psImpl->Rings.pop_back();
+      }
+      delete m_psImpl;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   UInt32 CEPuck2Log::GetModule(const std::string& str_module) {
+      std::lock_guard<std::mutex> cLock(m_psImpl->Mutex);
+      for(UInt32 i = 0; i < m_psImpl->Modules.size(); ++i) {
+         if(m_psImpl->Modules[i] == str_module) return i;
+      }
+      if(m_psImpl->Modules.size() == MAX_MODULES) {
+         /* Out of slots: share the last one */
+         return MAX_MODULES - 1;
+      }
+      UInt32 unModule = m_psImpl->Modules.size();
+      m_psImpl->Modules.push_back(str_module);
+      std::map<std::string, UInt8>::const_iterator it = m_psImpl->Levels.find(str_module);
+      m_punLevels[unModule].store(it != m_psImpl->Levels.end() ? it->second : m_psImpl->DefaultLevel);
+      return unModule;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Log::SetLevel(const std::string& str_module,
+                             ELevel e_level) {
+      std::lock_guard<std::mutex> cLock(m_psImpl->Mutex);
+      if(str_module == "*") {
+         /* Change the default, and the modules without an explicit level */
+         m_psImpl->DefaultLevel = e_level;
+         for(UInt32 i = 0; i < MAX_MODULES; ++i) {
+            if(i >= m_psImpl->Modules.size() ||
+               m_psImpl->Levels.find(m_psImpl->Modules[i]) == m_psImpl->Levels.end()) {
+               m_punLevels[i].store(e_level);
+            }
+         }
+      }
+      else {
+         m_psImpl->Levels[str_module] = e_level;
+         for(UInt32 i = 0; i < m_psImpl->Modules.size(); ++i) {
+            if(m_psImpl->Modules[i] == str_module) {
+               m_punLevels[i].store(e_level);
+            }
+         }
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Log::Push(ELevel e_level,
+                         UInt32 un_module,
+                         const std::string& str_message) {
+      /* Get the buffer of this thread, creating it the first time */
+      static thread_local SEPuck2LogRing* pcRing = NULL;
+      if(pcRing == NULL) {
+         pcRing = new SEPuck2LogRing;
+         std::lock_guard<std::mutex> cLock(m_psImpl->Mutex);
+         m_psImpl->Rings.push_back(pcRing);
+      }
+      /* Drop the message if the buffer is full */
+      size_t unHead = pcRing->Head.load(std::memory_order_relaxed);
+      if(unHead - pcRing->Tail.load(std::memory_order_acquire) >= RING_SIZE) {
+         pcRing->Dropped.fetch_add(1, std::memory_order_relaxed);
+         return;
+      }
+      SEPuck2LogRecord& sRecord = pcRing->Records[unHead & (RING_SIZE - 1)];
+      sRecord.Level = e_level;
+      sRecord.Module = un_module;
+      sRecord.Length = std::min(str_message.size(), MESSAGE_SIZE);
+      ::memcpy(sRecord.Text, str_message.data(), sRecord.Length);
+      pcRing->Head.store(unHead + 1, std::memory_order_release);
+      /* On the simulation thread, write it right away */
+      if(std::this_thread::get_id() == SIMULATION_THREAD) {
+         Flush();
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Log::Flush() {
+      if(std::this_thread::get_id() == SIMULATION_THREAD) {
+         Drain(false);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2Log::Drain(bool b_stdio) {
+      std::lock_guard<std::mutex> cFlushLock(m_psImpl->FlushMutex);
+      /* Copy the module names and the buffer list, they only grow */
+      std::vector<SEPuck2LogRing*> vecRings;
+      std::vector<std::string> vecModules;
+      {
+         std::lock_guard<std::mutex> cLock(m_psImpl->Mutex);
+         vecRings = m_psImpl->Rings;
+         vecModules = m_psImpl->Modules;
+      }
+      bool bWritten = false;
+      for(size_t i = 0; i < vecRings.size(); ++i) {
+         SEPuck2LogRing& sRing = *vecRings[i];
+         size_t unTail = sRing.Tail.load(std::memory_order_relaxed);
+         size_t unHead = sRing.Head.load(std::memory_order_acquire);
+         for(; unTail != unHead; ++unTail) {
+            const SEPuck2LogRecord& sRecord = sRing.Records[unTail & (RING_SIZE - 1)];
+            const std::string& strModule =
+               sRecord.Module < vecModules.size() ? vecModules[sRecord.Module] : "";
+            /* Drop the line end, if any, the streams add their own */
+            std::string strText(sRecord.Text, sRecord.Length);
+            if(! strText.empty() && strText[strText.size() - 1] == '\n') {
+               strText.resize(strText.size() - 1);
+            }
+            if(b_stdio) {
+               ::fprintf(sRecord.Level <= LEVEL_WARNING ? stderr : stdout,
+                         "[%s] %s\n", strModule.c_str(), strText.c_str());
+            }
+            else if(sRecord.Level <= LEVEL_WARNING) {
+               LOGERR << "[" << strModule << "] " << strText << std::endl;
+            }
+            else {
+               LOG << "[" << strModule << "] " << strText << std::endl;
+            }
+            bWritten = true;
+         }
+         sRing.Tail.store(unTail, std::memory_order_release);
+         UInt64 unDropped = sRing.Dropped.exchange(0, std::memory_order_relaxed);
+         if(unDropped > 0) {
+            if(b_stdio) {
+               ::fprintf(stderr, "[epuck2_log] %llu messages dropped\n",
+                         static_cast<unsigned long long>(unDropped));
+            }
+            else {
+               LOGERR << "[epuck2_log] " << unDropped << " messages dropped" << std::endl;
+            }
+            bWritten = true;
+         }
+      }
+      if(bWritten) {
+         if(b_stdio) {
+            ::fflush(stdout);
+            ::fflush(stderr);
+         }
+         else {
+            LOG.Flush();
+            LOGERR.Flush();
+         }
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CEPuck2Log::ELevel CEPuck2Log::ParseLevel(const std::string& str_level) {
+      for(UInt32 i = 0; i < sizeof(LEVEL_NAMES) / sizeof(LEVEL_NAMES[0]); ++i) {
+         if(str_level == LEVEL_NAMES[i]) return static_cast<ELevel>(i);
+      }
+      return LEVEL_INFO;
+   }
+
+   /****************************************/
+   /****************************************/
+
+}
@@ -0,0 +1,202 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/utility/epuck2_log.h>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#ifndef EPUCK2_LOG_H
+#define EPUCK2_LOG_H
+
+namespace argos {
+   class CEPuck2Log;
+}
+
+#include <argos3/core/utility/datatypes/datatypes.h>
+#include <atomic>
+#include <sstream>
+#include <string>
+
+/*
+ * Compile-time log levels.
+ * Messages above EPUCK2_LOG_LEVEL are removed by the preprocessor, so they
+ * cost nothing at run time. By default, Release builds drop the debug
+ * messages only, while Debug builds keep everything. Output that the user
+ * asks for, e.g., with a 'debug' parameter, must therefore be logged as info.
+ * Define EPUCK2_LOG_LEVEL on the compiler command line to override the
+ * default.
+ */
+#define EPUCK2_LOG_LEVEL_NONE    0
+#define EPUCK2_LOG_LEVEL_ERROR   1
+#define EPUCK2_LOG_LEVEL_WARNING 2
+#define EPUCK2_LOG_LEVEL_INFO    3
+#define EPUCK2_LOG_LEVEL_DEBUG   4
+
+#ifndef EPUCK2_LOG_LEVEL
+#  ifdef NDEBUG
+#    define EPUCK2_LOG_LEVEL EPUCK2_LOG_LEVEL_INFO
+#  else
+#    define EPUCK2_LOG_LEVEL EPUCK2_LOG_LEVEL_DEBUG
+#  endif
+#endif
+
+namespace argos {
+
+   /**
+    * Buffered logger for the e-puck2 plugin.
+    * <p>
+    * Each thread writes its messages to its own lock-free ring buffer. The
+    * messages are written to LOG (info and debug) or LOGERR (warnings and
+    * errors) on the simulation thread only, so they reach the log of the Qt
+    * user interface too. A message logged on the simulation thread is written
+    * right away, along with those queued by the other threads. The messages of
+    * the other threads, e.g., those of the controllers of a threaded
+    * simulation, wait for the next Flush(), which loop functions should call
+    * in PostStep(). When a buffer is full, new messages are dropped and
+    * counted, instead of blocking the simulation.
+    * </p>
+    * <p>
+    * Messages belong to a module, e.g., "leds". The level of each module can be
+    * set at run time with SetLevel() or with the EPUCK2_LOG environment variable,
+    * e.g., EPUCK2_LOG="leds=debug,epuck2_swarm=info,*=warning". The level of the
+    * modules not listed is given by "*", which is info by default.
+    * </p>
+    * <p>
+    * Do not use this class directly, use the EPUCK2_LOG_* macros instead.
+    * </p>
+    */
+   class CEPuck2Log {
+
+   public:
+
+      enum ELevel {
+         LEVEL_NONE = EPUCK2_LOG_LEVEL_NONE,
+         LEVEL_ERROR = EPUCK2_LOG_LEVEL_ERROR,
+         LEVEL_WARNING = EPUCK2_LOG_LEVEL_WARNING,
+         LEVEL_INFO = EPUCK2_LOG_LEVEL_INFO,
+         LEVEL_DEBUG = EPUCK2_LOG_LEVEL_DEBUG
+      };
+
+      /** The maximum number of modules */
+      static const UInt32 MAX_MODULES = 64;
+
+   public:
+
+      /**
+       * Returns the logger.
+       */
+      static CEPuck2Log& GetInstance();
+
+      /**
+       * Returns the handle of a module, registering it if needed.
+       * @param str_module The name of the module.
+       * @return The handle of the module.
+       */
+      UInt32 GetModule(const std::string& str_module);
+
+      /**
+       * Sets the run-time level of a module.
+       * @param str_module The name of the module, or "*" for the default level.
+       * @param e_level The level.
+       */
+      void SetLevel(const std::string& str_module,
+                    ELevel e_level);
+
+      /**
+       * Returns <tt>true</tt> if messages of the given level must be logged for a module.
+       * @param e_level The level of the message.
+       * @param un_module The handle of the module.
+       */
+      inline bool IsEnabled(ELevel e_level,
+                            UInt32 un_module) const {
+         return e_level <= m_punLevels[un_module].load(std::memory_order_relaxed);
+      }
+
+      /**
+       * Queues a message.
+       * @param e_level The level of the message.
+       * @param un_module The handle of the module.
+       * @param str_message The message.
+       */
+      void Push(ELevel e_level,
+                UInt32 un_module,
+                const std::string& str_message);
+
+      /**
+       * Writes all the queued messages to LOG and LOGERR.
+       * Does nothing unless called on the simulation thread.
+       */
+      void Flush();
+
+   private:
+
+      CEPuck2Log();
+
+      ~CEPuck2Log();
+
+      CEPuck2Log(const CEPuck2Log&) = delete;
+
+      CEPuck2Log& operator=(const CEPuck2Log&) = delete;
+
+      void Drain(bool b_stdio);
+
+      static ELevel ParseLevel(const std::string& str_level);
+
+   private:
+
+      struct SImpl;
+
+      SImpl* m_psImpl;
+
+      std::atomic<UInt8> m_punLevels[MAX_MODULES];
+
+   };
+
+}
+
+/*
+ * Logs a message of the given level.
+ * The module handle is looked up once per call site, and the message is
+ * formatted only if the module accepts the level.
+ */
+#define EPUCK2_LOG(LEVEL, MODULE, MESSAGE)                              \
+   do {                                                                 \
+      static const argos::UInt32 unEPuck2LogModule =                    \
+         argos::CEPuck2Log::GetInstance().GetModule(MODULE);            \
+      if(argos::CEPuck2Log::GetInstance().IsEnabled(LEVEL, unEPuck2LogModule)) { \
+         std::ostringstream cEPuck2LogStream;                           \
+         cEPuck2LogStream << MESSAGE;                                   \
+         argos::CEPuck2Log::GetInstance().Push(LEVEL,                   \
+                                               unEPuck2LogModule,       \
+                                               cEPuck2LogStream.str()); \
+      }                                                                 \
+   } while(0)
+
+#define EPUCK2_LOG_DISCARD do {} while(0)
+
+#if EPUCK2_LOG_LEVEL >= EPUCK2_LOG_LEVEL_ERROR
+#  define EPUCK2_LOG_ERROR(MODULE, MESSAGE) EPUCK2_LOG(argos::CEPuck2Log::LEVEL_ERROR, MODULE, MESSAGE)
+#else
+#  define EPUCK2_LOG_ERROR(MODULE, MESSAGE) EPUCK2_LOG_DISCARD
+#endif
+
+#if EPUCK2_LOG_LEVEL >= EPUCK2_LOG_LEVEL_WARNING
+#  define EPUCK2_LOG_WARNING(MODULE, MESSAGE) EPUCK2_LOG(argos::CEPuck2Log::LEVEL_WARNING, MODULE, MESSAGE)
+#else
+#  define EPUCK2_LOG_WARNING(MODULE, MESSAGE) EPUCK2_LOG_DISCARD
+#endif
+
+#if EPUCK2_LOG_LEVEL >= EPUCK2_LOG_LEVEL_INFO
+#  define EPUCK2_LOG_INFO(MODULE, MESSAGE) EPUCK2_LOG(argos::CEPuck2Log::LEVEL_INFO, MODULE, MESSAGE)
+#else
+#  define EPUCK2_LOG_INFO(MODULE, MESSAGE) EPUCK2_LOG_DISCARD
+#endif
+
+#if EPUCK2_LOG_LEVEL >= EPUCK2_LOG_LEVEL_DEBUG
+#  define EPUCK2_LOG_DEBUG(MODULE, MESSAGE) EPUCK2_LOG(argos::CEPuck2Log::LEVEL_DEBUG, MODULE, MESSAGE)
+#else
+#  define EPUCK2_LOG_DEBUG(MODULE, MESSAGE) EPUCK2_LOG_DISCARD
+#endif
+
+#endif
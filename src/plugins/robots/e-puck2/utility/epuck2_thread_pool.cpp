@@ -0,0 +1,150 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/utility/epuck2_thread_pool.cpp>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#include "epuck2_thread_pool.h"
+#include <argos3/core/utility/configuration/argos_exception.h>
+#include <algorithm>
+
+namespace argos {
+
+   /****************************************/
+   /****************************************/
+
+   CEPuck2ThreadPool::CEPuck2ThreadPool() :
+      m_unChunkSize(64),
+      m_unGeneration(0),
+      m_unBusy(0),
+      m_bStop(false),
+      m_pfunTask(NULL),
+      m_unTaskSize(0),
+      m_unNextChunk(0) {}
+
+   /****************************************/
+   /****************************************/
+
+   CEPuck2ThreadPool::~CEPuck2ThreadPool() {
+      Stop();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2ThreadPool::Start(UInt32 un_threads,
+                                 UInt32 un_chunk_size) {
+      Stop();
+      m_unChunkSize = std::max<UInt32>(un_chunk_size, 1);
+      m_bStop = false;
+      /* The calling thread takes part in the work too */
+      for(UInt32 i = 1; i < un_threads; ++i) {
+         m_vecWorkers.push_back(std::thread(&CEPuck2ThreadPool::Work, this, m_unGeneration));
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2ThreadPool::Stop() {
+      {
+         std::lock_guard<std::mutex> cLock(m_cMutex);
+         m_bStop = true;
+      }
+      m_cStart.notify_all();
+      for(size_t i = 0; i < m_vecWorkers.size(); ++i) {
+         m_vecWorkers[i].join();
+      }
+      m_vecWorkers.clear();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2ThreadPool::ParallelFor(size_t un_size,
+                                       const std::function<void(size_t, size_t)>& fun_chunk) {
+      if(m_vecWorkers.empty() || un_size <= m_unChunkSize) {
+         fun_chunk(0, un_size);
+         return;
+      }
+      {
+         std::lock_guard<std::mutex> cLock(m_cMutex);
+         m_pfunTask = &fun_chunk;
+         m_unTaskSize = un_size;
+         m_unNextChunk.store(0);
+         m_unBusy = m_vecWorkers.size();
+         ++m_unGeneration;
+      }
+      m_cStart.notify_all();
+      RunChunks();
+      /* Wait for the workers to finish their last chunk */
+      std::exception_ptr pcError;
+      {
+         std::unique_lock<std::mutex> cLock(m_cMutex);
+         m_cDone.wait(cLock, [this] { return m_unBusy == 0; });
+         m_pfunTask = NULL;
+         std::swap(pcError, m_pcError);
+      }
+      /* Surface the failure of any thread here, as an ARGoS exception */
+      if(pcError) {
+         try {
+            std::rethrow_exception(pcError);
+         }
+         catch(CARGoSException&) {
+            throw;
+         }
+         catch(std::exception& ex) {
+            THROW_ARGOSEXCEPTION("Error in a parallel task: " << ex.what());
+         }
+         catch(...) {
+            THROW_ARGOSEXCEPTION("Unknown error in a parallel task");
+         }
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2ThreadPool::RunChunks() {
+      size_t unBegin;
+      while((unBegin = m_unNextChunk.fetch_add(m_unChunkSize)) < m_unTaskSize) {
+         try {
+            (*m_pfunTask)(unBegin, std::min(unBegin + m_unChunkSize, m_unTaskSize));
+         }
+         catch(...) {
+            /* Keep the first error and hand out no more chunks */
+            std::lock_guard<std::mutex> cLock(m_cMutex);
+            if(!m_pcError) {
+               m_pcError = std::current_exception();
+            }
+            m_unNextChunk.store(m_unTaskSize);
+         }
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2ThreadPool::Work(UInt64 un_generation) {
+      /* The tasks up to un_generation were run before this worker was started */
+      UInt64 unSeen = un_generation;
+      std::unique_lock<std::mutex> cLock(m_cMutex);
+      while(true) {
+         m_cStart.wait(cLock, [this, &unSeen] { return m_bStop || m_unGeneration != unSeen; });
+         if(m_bStop) return;
+         unSeen = m_unGeneration;
+         cLock.unlock();
+         RunChunks();
+         cLock.lock();
+         if(--m_unBusy == 0) {
+            m_cDone.notify_one();
+         }
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+}
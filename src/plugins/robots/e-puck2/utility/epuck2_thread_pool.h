@@ -0,0 +1,101 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/utility/epuck2_thread_pool.h>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#ifndef EPUCK2_THREAD_POOL_H
+#define EPUCK2_THREAD_POOL_H
+
+namespace argos {
+   class CEPuck2ThreadPool;
+}
+
+#include <argos3/core/utility/datatypes/datatypes.h>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace argos {
+
+   /**
+    * A small pool of worker threads that runs loops in chunks.
+    * <p>
+    * ParallelFor() splits a range in chunks. The calling thread and the
+    * workers take chunks until none is left, so uneven chunks balance
+    * themselves. The call returns when the whole range is done.
+    * </p>
+    * <p>
+    * If a chunk throws, no new chunk is started, and ParallelFor() throws
+    * the first exception on the calling thread once the workers are idle.
+    * </p>
+    */
+   class CEPuck2ThreadPool {
+
+   public:
+
+      CEPuck2ThreadPool();
+
+      ~CEPuck2ThreadPool();
+
+      /**
+       * Starts the workers.
+       * @param un_threads The number of threads, including the calling one.
+       * @param un_chunk_size How many items a thread takes at a time.
+       */
+      void Start(UInt32 un_threads,
+                 UInt32 un_chunk_size);
+
+      /**
+       * Stops the workers.
+       */
+      void Stop();
+
+      /**
+       * Returns the number of threads, including the calling one.
+       */
+      inline UInt32 GetNumThreads() const {
+         return m_vecWorkers.size() + 1;
+      }
+
+      /**
+       * Runs a function over [0,un_size) in chunks.
+       * The function receives the beginning and the end of each chunk.
+       * @throws CARGoSException if a chunk threw.
+       */
+      void ParallelFor(size_t un_size,
+                       const std::function<void(size_t, size_t)>& fun_chunk);
+
+   private:
+
+      void RunChunks();
+
+      void Work(UInt64 un_generation);
+
+   private:
+
+      UInt32 m_unChunkSize;
+      std::vector<std::thread> m_vecWorkers;
+      std::mutex m_cMutex;
+      std::condition_variable m_cStart;
+      std::condition_variable m_cDone;
+      UInt64 m_unGeneration;
+      UInt32 m_unBusy;
+      bool m_bStop;
+      const std::function<void(size_t, size_t)>* m_pfunTask;
+      size_t m_unTaskSize;
+      std::atomic<size_t> m_unNextChunk;
+      /* The first exception thrown by a chunk of the current task */
+      std::exception_ptr m_pcError;
+
+   };
+
+}
+
+#endif
@@ -0,0 +1,397 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/utility/epuck2_trajectory.cpp>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#include "epuck2_trajectory.h"
+#include "epuck2_log.h"
+#include <argos3/core/utility/configuration/argos_exception.h>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace argos {
+
+   /****************************************/
+   /****************************************/
+
+   static const UInt8 TRAJECTORY_MAGIC[4] = { 'E', 'P', '2', 'T' };
+
+   const Real CEPuck2Trajectory::POSITION_UNIT = 1e-4;
+   const Real CEPuck2Trajectory::YAW_UNIT      = 1.0 / 65536.0;
+   const Real CEPuck2Trajectory::CHARGE_UNIT   = 1e-6;
+
+   /****************************************/
+   /****************************************/
+
+   static void WriteVarint(std::vector<UInt8>& vec_out,
+                           UInt64 un_value) {
+      while(un_value >= 0x80) {
+         vec_out.push_back(static_cast<UInt8>(un_value | 0x80));
+         un_value >>= 7;
+      }
+      vec_out.push_back(static_cast<UInt8>(un_value));
+   }
+
+   /****************************************/
+   /****************************************/
+
+   static UInt64 ReadVarint(const UInt8*& pun_cursor,
+                            const UInt8* pun_end) {
+      UInt64 unValue = 0;
+      for(UInt32 unShift = 0; unShift < 64; unShift += 7) {
+         if(pun_cursor >= pun_end) {
+            THROW_ARGOSEXCEPTION("e-puck2 trajectory: unexpected end of data");
+         }
+         UInt8 unByte = *pun_cursor++;
+         unValue |= static_cast<UInt64>(unByte & 0x7F) << unShift;
+         if((unByte & 0x80) == 0) {
+            return unValue;
+         }
+      }
+      THROW_ARGOSEXCEPTION("e-puck2 trajectory: invalid integer");
+   }
+
+   /****************************************/
+   /****************************************/
+
+   /* Maps small negative numbers to small positive ones */
+   static inline UInt64 ZigZag(SInt64 n_value) {
+      return (static_cast<UInt64>(n_value) << 1) ^ static_cast<UInt64>(n_value >> 63);
+   }
+
+   static inline SInt64 UnZigZag(UInt64 un_value) {
+      return static_cast<SInt64>(un_value >> 1) ^ -static_cast<SInt64>(un_value & 1);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   UInt32 CEPuck2Trajectory::SHeader::GetColumns() const {
+      UInt32 unColumns = 0;
+      for(size_t i = 0; i < Robots.size(); ++i) {
+         unColumns += Robots[i].GetColumns();
+      }
+      return unColumns;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   std::vector<UInt32> CEPuck2Trajectory::SHeader::GetOffsets() const {
+      std::vector<UInt32> vecOffsets(Robots.size());
+      UInt32 unColumns = 0;
+      for(size_t i = 0; i < Robots.size(); ++i) {
+         vecOffsets[i] = unColumns;
+         unColumns += Robots[i].GetColumns();
+      }
+      return vecOffsets;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CEPuck2TrajectoryWriter::CEPuck2TrajectoryWriter() :
+      m_pcFile(NULL),
+      m_unColumns(0),
+      m_unChunkTicks(0),
+      m_unTicks(0),
+      m_unBytes(0),
+      m_unBuffered(0) {}
+
+   /****************************************/
+   /****************************************/
+
+   CEPuck2TrajectoryWriter::~CEPuck2TrajectoryWriter() {
+      try {
+         Close();
+      }
+      catch(CARGoSException& ex) {
+         EPUCK2_LOG_ERROR("trajectory", ex.what());
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2TrajectoryWriter::Open(const std::string& str_file,
+                                      const CEPuck2Trajectory::SHeader& s_header) {
+      Close();
+      if(s_header.ChunkTicks == 0 || s_header.Period == 0) {
+         THROW_ARGOSEXCEPTION("e-puck2 trajectory: the chunk size and the period must be positive");
+      }
+      m_pcFile = ::fopen(str_file.c_str(), "wb");
+      if(m_pcFile == NULL) {
+         THROW_ARGOSEXCEPTION("Cannot write trajectory \"" << str_file << "\": " << ::strerror(errno));
+      }
+      m_strFile = str_file;
+      m_unColumns = s_header.GetColumns();
+      m_unChunkTicks = s_header.ChunkTicks;
+      m_unTicks = 0;
+      m_unBuffered = 0;
+      m_vecFrames.resize(static_cast<size_t>(m_unColumns) * m_unChunkTicks);
+      /* Header */
+      m_vecChunk.assign(TRAJECTORY_MAGIC, TRAJECTORY_MAGIC + 4);
+      WriteVarint(m_vecChunk, CEPuck2Trajectory::VERSION);
+      WriteVarint(m_vecChunk, s_header.TicksPerSecond);
+      WriteVarint(m_vecChunk, s_header.StartClock);
+      WriteVarint(m_vecChunk, s_header.Period);
+      WriteVarint(m_vecChunk, s_header.ChunkTicks);
+      WriteVarint(m_vecChunk, s_header.Robots.size());
+      for(size_t i = 0; i < s_header.Robots.size(); ++i) {
+         const CEPuck2Trajectory::SRobot& sRobot = s_header.Robots[i];
+         WriteVarint(m_vecChunk, sRobot.Id.size());
+         m_vecChunk.insert(m_vecChunk.end(), sRobot.Id.begin(), sRobot.Id.end());
+         WriteVarint(m_vecChunk, sRobot.LEDs);
+         WriteVarint(m_vecChunk, sRobot.Proximity);
+         WriteVarint(m_vecChunk, sRobot.Light);
+         WriteVarint(m_vecChunk, sRobot.Ground);
+      }
+      if(::fwrite(m_vecChunk.data(), 1, m_vecChunk.size(), m_pcFile) != m_vecChunk.size()) {
+         THROW_ARGOSEXCEPTION("Cannot write trajectory \"" << m_strFile << "\": " << ::strerror(errno));
+      }
+      m_unBytes = m_vecChunk.size();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2TrajectoryWriter::Append(const std::vector<SInt64>& vec_frame) {
+      if(m_pcFile == NULL) {
+         THROW_ARGOSEXCEPTION("e-puck2 trajectory: the file is not open");
+      }
+      if(vec_frame.size() != m_unColumns) {
+         THROW_ARGOSEXCEPTION("e-puck2 trajectory: the frame has " << vec_frame.size() <<
+                              " columns instead of " << m_unColumns);
+      }
+      std::copy(vec_frame.begin(), vec_frame.end(),
+                m_vecFrames.begin() + static_cast<size_t>(m_unBuffered) * m_unColumns);
+      if(++m_unBuffered == m_unChunkTicks) {
+         Flush();
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2TrajectoryWriter::Close() {
+      if(m_pcFile == NULL) return;
+      FILE* pcFile = m_pcFile;
+      try {
+         Flush();
+      }
+      catch(CARGoSException& ex) {
+         ::fclose(pcFile);
+         m_pcFile = NULL;
+         throw;
+      }
+      m_pcFile = NULL;
+      if(::fclose(pcFile) != 0) {
+         THROW_ARGOSEXCEPTION("Cannot write trajectory \"" << m_strFile << "\": " << ::strerror(errno));
+      }
+      EPUCK2_LOG_INFO("trajectory", "Wrote " << m_unTicks << " ticks to \"" << m_strFile
+                      << "\" in " << m_unBytes << " bytes");
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2TrajectoryWriter::Flush() {
+      if(m_unBuffered == 0) return;
+      /*
+       * Each column on its own, as differences from the previous tick. An odd
+       * token is a run of unchanged values, an even one a difference.
+       */
+      std::vector<UInt8> vecBody;
+      for(UInt32 c = 0; c < m_unColumns; ++c) {
+         SInt64 nPrevious = 0;
+         UInt64 unRun = 0;
+         for(UInt32 t = 0; t < m_unBuffered; ++t) {
+            SInt64 nValue = m_vecFrames[static_cast<size_t>(t) * m_unColumns + c];
+            SInt64 nDelta = nValue - nPrevious;
+            nPrevious = nValue;
+            if(nDelta == 0 && t > 0) {
+               ++unRun;
+               continue;
+            }
+            if(unRun > 0) {
+               WriteVarint(vecBody, ((unRun - 1) << 1) | 1);
+               unRun = 0;
+            }
+            WriteVarint(vecBody, ZigZag(nDelta) << 1);
+         }
+         if(unRun > 0) {
+            WriteVarint(vecBody, ((unRun - 1) << 1) | 1);
+         }
+      }
+      m_vecChunk.clear();
+      WriteVarint(m_vecChunk, m_unTicks);
+      WriteVarint(m_vecChunk, m_unBuffered);
+      WriteVarint(m_vecChunk, vecBody.size());
+      m_vecChunk.insert(m_vecChunk.end(), vecBody.begin(), vecBody.end());
+      /* Flushed right away, so that a crash loses one chunk at most */
+      if(::fwrite(m_vecChunk.data(), 1, m_vecChunk.size(), m_pcFile) != m_vecChunk.size() ||
+         ::fflush(m_pcFile) != 0) {
+         THROW_ARGOSEXCEPTION("Cannot write trajectory \"" << m_strFile << "\": " << ::strerror(errno));
+      }
+      m_unBytes += m_vecChunk.size();
+      m_unTicks += m_unBuffered;
+      m_unBuffered = 0;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CEPuck2TrajectoryReader::CEPuck2TrajectoryReader() :
+      m_unColumns(0),
+      m_unTicks(0),
+      m_unDecoded(static_cast<size_t>(-1)) {}
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2TrajectoryReader::Open(const std::string& str_file) {
+      std::ifstream cFile(str_file.c_str(), std::ios::binary);
+      if(!cFile) {
+         THROW_ARGOSEXCEPTION("Cannot open trajectory \"" << str_file << "\": " << ::strerror(errno));
+      }
+      m_strFile = str_file;
+      m_vecData.assign(std::istreambuf_iterator<char>(cFile), std::istreambuf_iterator<char>());
+      m_vecChunks.clear();
+      m_unTicks = 0;
+      m_unDecoded = static_cast<size_t>(-1);
+      const UInt8* punCursor = m_vecData.data();
+      const UInt8* punEnd = punCursor + m_vecData.size();
+      try {
+         /* Header */
+         if(m_vecData.size() < 4 || ::memcmp(punCursor, TRAJECTORY_MAGIC, 4) != 0) {
+            THROW_ARGOSEXCEPTION("not an e-puck2 trajectory");
+         }
+         punCursor += 4;
+         UInt64 unVersion = ReadVarint(punCursor, punEnd);
+         if(unVersion != CEPuck2Trajectory::VERSION) {
+            THROW_ARGOSEXCEPTION("version " << unVersion << " instead of " << CEPuck2Trajectory::VERSION);
+         }
+         m_sHeader = CEPuck2Trajectory::SHeader();
+         m_sHeader.TicksPerSecond = ReadVarint(punCursor, punEnd);
+         m_sHeader.StartClock     = ReadVarint(punCursor, punEnd);
+         m_sHeader.Period         = ReadVarint(punCursor, punEnd);
+         m_sHeader.ChunkTicks     = ReadVarint(punCursor, punEnd);
+         m_sHeader.Robots.resize(ReadVarint(punCursor, punEnd));
+         for(size_t i = 0; i < m_sHeader.Robots.size(); ++i) {
+            CEPuck2Trajectory::SRobot& sRobot = m_sHeader.Robots[i];
+            UInt64 unLength = ReadVarint(punCursor, punEnd);
+            if(unLength > static_cast<UInt64>(punEnd - punCursor)) {
+               THROW_ARGOSEXCEPTION("unexpected end of data");
+            }
+            sRobot.Id.assign(reinterpret_cast<const char*>(punCursor), unLength);
+            punCursor += unLength;
+            sRobot.LEDs      = ReadVarint(punCursor, punEnd);
+            sRobot.Proximity = ReadVarint(punCursor, punEnd);
+            sRobot.Light     = ReadVarint(punCursor, punEnd);
+            sRobot.Ground    = ReadVarint(punCursor, punEnd);
+         }
+         m_unColumns = m_sHeader.GetColumns();
+      }
+      catch(CARGoSException& ex) {
+         THROW_ARGOSEXCEPTION_NESTED("Trajectory \"" << str_file << "\"", ex);
+      }
+      /* Index the chunks */
+      while(punCursor < punEnd) {
+         SChunk sChunk;
+         try {
+            sChunk.FirstTick = ReadVarint(punCursor, punEnd);
+            sChunk.Ticks     = ReadVarint(punCursor, punEnd);
+            sChunk.Size      = ReadVarint(punCursor, punEnd);
+         }
+         catch(CARGoSException& ex) {
+            sChunk.Size = punEnd - punCursor + 1;
+         }
+         if(sChunk.Size > static_cast<size_t>(punEnd - punCursor)) {
+            EPUCK2_LOG_WARNING("trajectory", "\"" << str_file << "\" is truncated after tick " << m_unTicks);
+            break;
+         }
+         if(sChunk.FirstTick != m_unTicks || sChunk.Ticks == 0) {
+            THROW_ARGOSEXCEPTION("Trajectory \"" << str_file << "\": corrupted chunk at tick " << m_unTicks);
+         }
+         sChunk.Offset = punCursor - m_vecData.data();
+         m_vecChunks.push_back(sChunk);
+         m_unTicks += sChunk.Ticks;
+         punCursor += sChunk.Size;
+      }
+      EPUCK2_LOG_INFO("trajectory", "Loaded " << m_unTicks << " ticks of " << m_sHeader.Robots.size()
+                      << " e-puck2s from \"" << str_file << "\"");
+   }
+
+   /****************************************/
+   /****************************************/
+
+   const SInt64* CEPuck2TrajectoryReader::GetFrame(UInt32 un_tick) {
+      if(un_tick >= m_unTicks) {
+         THROW_ARGOSEXCEPTION("Trajectory \"" << m_strFile << "\": tick " << un_tick <<
+                              " out of " << m_unTicks);
+      }
+      /* All the chunks but the last one are full */
+      size_t unChunk = un_tick / m_sHeader.ChunkTicks;
+      if(unChunk >= m_vecChunks.size() ||
+         un_tick < m_vecChunks[unChunk].FirstTick) {
+         unChunk = m_vecChunks.size() - 1;
+      }
+      while(un_tick < m_vecChunks[unChunk].FirstTick) --unChunk;
+      if(unChunk != m_unDecoded) {
+         Decode(unChunk);
+      }
+      return m_vecFrames.data() +
+         static_cast<size_t>(un_tick - m_vecChunks[unChunk].FirstTick) * m_unColumns;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2TrajectoryReader::Decode(size_t un_chunk) {
+      const SChunk& sChunk = m_vecChunks[un_chunk];
+      m_vecFrames.resize(static_cast<size_t>(m_unColumns) * sChunk.Ticks);
+      const UInt8* punCursor = m_vecData.data() + sChunk.Offset;
+      const UInt8* punEnd = punCursor + sChunk.Size;
+      try {
+         for(UInt32 c = 0; c < m_unColumns; ++c) {
+            SInt64 nValue = 0;
+            UInt32 t = 0;
+            while(t < sChunk.Ticks) {
+               UInt64 unToken = ReadVarint(punCursor, punEnd);
+               if(unToken & 1) {
+                  UInt64 unRun = (unToken >> 1) + 1;
+                  if(unRun > sChunk.Ticks - t) {
+                     THROW_ARGOSEXCEPTION("run too long");
+                  }
+                  for(; unRun > 0; --unRun, ++t) {
+                     m_vecFrames[static_cast<size_t>(t) * m_unColumns + c] = nValue;
+                  }
+               }
+               else {
+                  nValue += UnZigZag(unToken >> 1);
+                  m_vecFrames[static_cast<size_t>(t) * m_unColumns + c] = nValue;
+                  ++t;
+               }
+            }
+         }
+         if(punCursor != punEnd) {
+            THROW_ARGOSEXCEPTION("trailing data");
+         }
+      }
+      catch(CARGoSException& ex) {
+         m_unDecoded = static_cast<size_t>(-1);
+         THROW_ARGOSEXCEPTION_NESTED("Trajectory \"" << m_strFile << "\": corrupted chunk at tick " <<
+                                     sChunk.FirstTick, ex);
+      }
+      m_unDecoded = un_chunk;
+   }
+
+   /****************************************/
+   /****************************************/
+
+}
@@ -0,0 +1,237 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/utility/epuck2_trajectory.h>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#ifndef EPUCK2_TRAJECTORY_H
+#define EPUCK2_TRAJECTORY_H
+
+namespace argos {
+   class CEPuck2Trajectory;
+   class CEPuck2TrajectoryWriter;
+   class CEPuck2TrajectoryReader;
+}
+
+#include <argos3/core/utility/datatypes/datatypes.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace argos {
+
+   /**
+    * The layout of an e-puck2 trajectory file.
+    * <p>
+    * A trajectory stores, for every recorded tick, a frame of integer
+    * columns: for each robot, its planar pose, its battery charge, the
+    * colours of its LEDs and, optionally, the readings of its proximity,
+    * light and ground sensors. The real values are stored in fixed point,
+    * with the units below.
+    * </p>
+    * <p>
+    * The ticks are grouped in chunks. Inside a chunk, each column is stored
+    * on its own as the differences between consecutive ticks, in variable
+    * length integers, and runs of unchanged values take a single byte. The
+    * first tick of a chunk is stored in full, so any tick can be decoded
+    * from the start of its chunk. The file only contains bytes, so it does
+    * not depend on the byte order of the machine.
+    * </p>
+    */
+   class CEPuck2Trajectory {
+
+   public:
+
+      /** Version of the file layout, bumped when it changes */
+      static const UInt32 VERSION = 1;
+
+      /** Position unit, in meters */
+      static const Real POSITION_UNIT;
+      /** Turns of yaw per unit */
+      static const Real YAW_UNIT;
+      /** Battery charge unit */
+      static const Real CHARGE_UNIT;
+
+      /** The columns every robot starts with */
+      enum EColumn {
+         COLUMN_X = 0,
+         COLUMN_Y,
+         COLUMN_YAW,
+         COLUMN_CHARGE,
+         COLUMN_LEDS
+      };
+
+      /**
+       * A recorded robot.
+       */
+      struct SRobot {
+         std::string Id;
+         /** Number of LEDs, stored as 0xRRGGBB */
+         UInt32 LEDs;
+         /** Number of readings of each sensor, 0 if not recorded */
+         UInt32 Proximity;
+         UInt32 Light;
+         UInt32 Ground;
+
+         SRobot() :
+            LEDs(0),
+            Proximity(0),
+            Light(0),
+            Ground(0) {}
+
+         /** Number of columns of the robot */
+         inline UInt32 GetColumns() const {
+            return COLUMN_LEDS + LEDs + Proximity + Light + Ground;
+         }
+      };
+
+      /**
+       * The description of a trajectory.
+       */
+      struct SHeader {
+         /** Simulation ticks per second */
+         UInt32 TicksPerSecond;
+         /** Simulation clock of the first recorded tick */
+         UInt32 StartClock;
+         /** Simulation steps between recorded ticks */
+         UInt32 Period;
+         /** Recorded ticks per chunk */
+         UInt32 ChunkTicks;
+         std::vector<SRobot> Robots;
+
+         SHeader() :
+            TicksPerSecond(0),
+            StartClock(0),
+            Period(1),
+            ChunkTicks(64) {}
+
+         /** Number of columns of a frame */
+         UInt32 GetColumns() const;
+
+         /** Index of the first column of each robot */
+         std::vector<UInt32> GetOffsets() const;
+      };
+
+   };
+
+   /**
+    * Writes a trajectory, one frame at a time.
+    */
+   class CEPuck2TrajectoryWriter {
+
+   public:
+
+      CEPuck2TrajectoryWriter();
+
+      ~CEPuck2TrajectoryWriter();
+
+      /**
+       * Creates the file and writes the header.
+       * @throws CARGoSException if the file cannot be written.
+       */
+      void Open(const std::string& str_file,
+                const CEPuck2Trajectory::SHeader& s_header);
+
+      /**
+       * Appends a frame, with SHeader::GetColumns() values.
+       * @throws CARGoSException if the frame has the wrong size or a chunk cannot be written.
+       */
+      void Append(const std::vector<SInt64>& vec_frame);
+
+      /**
+       * Writes the last chunk and closes the file.
+       */
+      void Close();
+
+      inline bool IsOpen() const {
+         return m_pcFile != NULL;
+      }
+
+      inline UInt64 GetBytes() const {
+         return m_unBytes;
+      }
+
+   private:
+
+      /** Encodes the buffered frames as a chunk */
+      void Flush();
+
+   private:
+
+      FILE* m_pcFile;
+      std::string m_strFile;
+      UInt32 m_unColumns;
+      UInt32 m_unChunkTicks;
+      UInt32 m_unTicks;
+      UInt64 m_unBytes;
+      /* Buffered frames, one row per tick */
+      std::vector<SInt64> m_vecFrames;
+      UInt32 m_unBuffered;
+      std::vector<UInt8> m_vecChunk;
+
+   };
+
+   /**
+    * Reads a trajectory, in any order.
+    */
+   class CEPuck2TrajectoryReader {
+
+   public:
+
+      CEPuck2TrajectoryReader();
+
+      /**
+       * Loads a file and indexes its chunks.
+       * A truncated last chunk, as left by a crash, is dropped.
+       * @throws CARGoSException if the file is not a trajectory.
+       */
+      void Open(const std::string& str_file);
+
+      inline const CEPuck2Trajectory::SHeader& GetHeader() const {
+         return m_sHeader;
+      }
+
+      /** Number of recorded ticks */
+      inline UInt32 GetTicks() const {
+         return m_unTicks;
+      }
+
+      /**
+       * Returns the frame of a tick, with SHeader::GetColumns() values.
+       * Consecutive ticks of a chunk are decoded only once.
+       * @throws CARGoSException if the tick is out of range or the chunk is corrupted.
+       */
+      const SInt64* GetFrame(UInt32 un_tick);
+
+   private:
+
+      /** A chunk of the file */
+      struct SChunk {
+         UInt32 FirstTick;
+         UInt32 Ticks;
+         size_t Offset;
+         size_t Size;
+      };
+
+      /** Decodes a chunk into m_vecFrames */
+      void Decode(size_t un_chunk);
+
+   private:
+
+      std::string m_strFile;
+      CEPuck2Trajectory::SHeader m_sHeader;
+      UInt32 m_unColumns;
+      UInt32 m_unTicks;
+      std::vector<UInt8> m_vecData;
+      std::vector<SChunk> m_vecChunks;
+      /* The decoded chunk, one row per tick */
+      size_t m_unDecoded;
+      std::vector<SInt64> m_vecFrames;
+
+   };
+
+}
+
+#endif
@@ -0,0 +1,129 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/utility/epuck2_wake_solver.cpp>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#include "epuck2_wake_solver.h"
+#include <algorithm>
+
+namespace argos {
+
+   /****************************************/
+   /****************************************/
+
+   CEPuck2WakeSolver::CEPuck2WakeSolver() :
+      m_fCutoff(1e-6),
+      m_fMaxQ(0.0),
+      m_fGaussianScale(0.0),
+      m_unBucketMask(0) {
+      Init(SParams());
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2WakeSolver::Init(const SParams& s_params) {
+      m_sParams = s_params;
+      /* The Gaussian reaches the cutoff at q = -2 ln(cutoff) */
+      m_fMaxQ = -2.0 * std::log(m_fCutoff);
+      m_fGaussianScale = LUT_SIZE / m_fMaxQ;
+      m_vecGaussian.resize(LUT_SIZE + 1);
+      m_vecRemap.resize(LUT_SIZE + 1);
+      Real fGamma = std::max<Real>(1.0, m_sParams.Gamma);
+      for(UInt32 i = 0; i <= LUT_SIZE; ++i) {
+         m_vecGaussian[i] = std::exp(-0.5 * i / m_fGaussianScale);
+         m_vecRemap[i] = 1.0 - std::pow(1.0 - static_cast<Real>(i) / LUT_SIZE, fGamma);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2WakeSolver::Solve(const CVector2& c_wind_dir,
+                                 const Real* pf_x,
+                                 const Real* pf_y,
+                                 size_t un_robots,
+                                 Real f_radius,
+                                 Real* pf_shielding) {
+      Real fSigma = std::max<Real>(1e-6, m_sParams.LateralReach * f_radius);
+      Real fGate = std::max<Real>(1e-6, m_sParams.UpwindGate * f_radius);
+      Real fFade = std::max<Real>(1e-6, m_sParams.ShadowLength * f_radius);
+      Real fInvSigma2 = 1.0 / (fSigma * fSigma);
+      /* A shadow reaches one cell downwind and one cell sideways */
+      Real fInvCellU = 1.0 / (fGate + fFade);
+      Real fInvCellV = 1.0 / (std::sqrt(m_fMaxQ) * fSigma);
+      /* Project the robots on the wind axis (U) and across it (V) */
+      m_vecU.resize(un_robots);
+      m_vecV.resize(un_robots);
+      m_vecCellU.resize(un_robots);
+      m_vecCellV.resize(un_robots);
+      m_vecBucket.resize(un_robots);
+      m_vecSorted.resize(un_robots);
+      UInt32 unBuckets = 64;
+      while(unBuckets < 2 * un_robots) unBuckets <<= 1;
+      m_unBucketMask = unBuckets - 1;
+      m_vecBucketStart.assign(unBuckets + 1, 0);
+      for(size_t i = 0; i < un_robots; ++i) {
+         m_vecU[i] =  pf_x[i] * c_wind_dir.GetX() + pf_y[i] * c_wind_dir.GetY();
+         m_vecV[i] = -pf_x[i] * c_wind_dir.GetY() + pf_y[i] * c_wind_dir.GetX();
+         m_vecCellU[i] = static_cast<SInt32>(std::floor(m_vecU[i] * fInvCellU));
+         m_vecCellV[i] = static_cast<SInt32>(std::floor(m_vecV[i] * fInvCellV));
+         m_vecBucket[i] = GetBucket(m_vecCellU[i], m_vecCellV[i]);
+         ++m_vecBucketStart[m_vecBucket[i]];
+      }
+      /* Counting sort by bucket, keeping the coordinates in bucket order */
+      for(UInt32 b = 1; b < unBuckets; ++b) {
+         m_vecBucketStart[b] += m_vecBucketStart[b - 1];
+      }
+      m_vecBucketStart[unBuckets] = un_robots;
+      for(size_t i = un_robots; i > 0; --i) {
+         m_vecSorted[--m_vecBucketStart[m_vecBucket[i - 1]]] = i - 1;
+      }
+      m_vecSortedU.resize(un_robots);
+      m_vecSortedV.resize(un_robots);
+      for(size_t k = 0; k < un_robots; ++k) {
+         m_vecSortedU[k] = m_vecU[m_vecSorted[k]];
+         m_vecSortedV[k] = m_vecV[m_vecSorted[k]];
+      }
+      /* Each robot looks for blockers in its row and in the row upwind */
+      UInt32 punBuckets[6];
+      for(size_t k = 0; k < un_robots; ++k) {
+         UInt32 i = m_vecSorted[k];
+         UInt32 unNeighbors = 0;
+         for(SInt32 nU = m_vecCellU[i] - 1; nU <= m_vecCellU[i]; ++nU) {
+            for(SInt32 nV = m_vecCellV[i] - 1; nV <= m_vecCellV[i] + 1; ++nV) {
+               UInt32 unBucket = GetBucket(nU, nV);
+               if(std::find(punBuckets, punBuckets + unNeighbors, unBucket) == punBuckets + unNeighbors) {
+                  punBuckets[unNeighbors++] = unBucket;
+               }
+            }
+         }
+         Real fU = m_vecU[i];
+         Real fV = m_vecV[i];
+         Real fBest = 0.0;
+         for(UInt32 b = 0; b < unNeighbors; ++b) {
+            UInt32 unEnd = m_vecBucketStart[punBuckets[b] + 1];
+            for(UInt32 j = m_vecBucketStart[punBuckets[b]]; j < unEnd; ++j) {
+               Real fAlong = fU - m_vecSortedU[j];
+               if(fAlong <= fGate || fAlong >= fGate + fFade) continue;
+               Real fLateral = fV - m_vecSortedV[j];
+               Real fQ = fLateral * fLateral * fInvSigma2;
+               if(fQ >= m_fMaxQ) continue;
+               /* Smoothstep fade: 1 just past the gate, 0 at the end of the shadow */
+               Real fS = (fAlong - fGate) / fFade;
+               Real fShadow = Gaussian(fQ) * (1.0 - fS * fS * (3.0 - 2.0 * fS));
+               if(fShadow > fBest) fBest = fShadow;
+            }
+         }
+         /* The remap is monotonic, so it can be applied to the strongest shadow only */
+         pf_shielding[i] = (fBest > m_fCutoff) ? Remap(fBest) : 0.0;
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+}
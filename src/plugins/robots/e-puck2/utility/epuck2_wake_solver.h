@@ -0,0 +1,149 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/utility/epuck2_wake_solver.h>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#ifndef EPUCK2_WAKE_SOLVER_H
+#define EPUCK2_WAKE_SOLVER_H
+
+namespace argos {
+   class CEPuck2WakeSolver;
+}
+
+#include <argos3/core/utility/math/vector2.h>
+#include <cmath>
+#include <vector>
+
+namespace argos {
+
+   /**
+    * Computes how much each robot of a swarm is shielded from the wind by the
+    * robots upwind of it.
+    * <p>
+    * It is the wake model of the air resistance examples. A blocker casts a
+    * shadow downwind. The shadow starts after a gate, fades out with a
+    * smoothstep along the wind, and with a Gaussian across it. The shielding
+    * of a robot is the strongest shadow it is in, remapped by
+    * 1 - (1 - x)^gamma. All the lengths are in blocker radii.
+    * </p>
+    * <p>
+    * The robots are projected on the wind axis and put in a grid whose cells
+    * are as long as a shadow and as wide as its Gaussian reach. A robot only
+    * looks at the two rows of cells upwind, so one sweep over the grid solves
+    * the whole swarm in linear time. The Gaussian and the gamma remap are
+    * read from tables.
+    * </p>
+    */
+   class CEPuck2WakeSolver {
+
+   public:
+
+      /**
+       * The shape of the wake, in blocker radii.
+       */
+      struct SParams {
+         /** Lateral reach of the Gaussian (its sigma) */
+         Real LateralReach;
+         /** Downwind length of the fade */
+         Real ShadowLength;
+         /** Minimum upwind distance for any shadow */
+         Real UpwindGate;
+         /** Exponent of the remap, 1 disables it */
+         Real Gamma;
+
+         SParams() :
+            LateralReach(3.0),
+            ShadowLength(4.0),
+            UpwindGate(0.5),
+            Gamma(2.0) {}
+      };
+
+   public:
+
+      CEPuck2WakeSolver();
+
+      /**
+       * Sets the shape of the wake and builds the tables.
+       */
+      void Init(const SParams& s_params);
+
+      inline const SParams& GetParams() const {
+         return m_sParams;
+      }
+
+      /**
+       * Computes the shielding of each robot, in [0,1].
+       * @param c_wind_dir The direction of the wind, of unit length.
+       * @param pf_x The X coordinates of the robots.
+       * @param pf_y The Y coordinates of the robots.
+       * @param un_robots The number of robots.
+       * @param f_radius The radius of the robots.
+       * @param pf_shielding The shielding of each robot, written by the call.
+       */
+      void Solve(const CVector2& c_wind_dir,
+                 const Real* pf_x,
+                 const Real* pf_y,
+                 size_t un_robots,
+                 Real f_radius,
+                 Real* pf_shielding);
+
+   private:
+
+      /** Looks up exp(-q/2), q being the squared lateral distance in sigmas */
+      inline Real Gaussian(Real f_q) const {
+         Real fIndex = f_q * m_fGaussianScale;
+         if(fIndex >= LUT_SIZE) return 0.0;
+         UInt32 unIndex = static_cast<UInt32>(fIndex);
+         Real fFrac = fIndex - unIndex;
+         return m_vecGaussian[unIndex] + fFrac * (m_vecGaussian[unIndex + 1] - m_vecGaussian[unIndex]);
+      }
+
+      /** Looks up 1 - (1 - x)^gamma, x being in [0,1] */
+      inline Real Remap(Real f_x) const {
+         Real fIndex = f_x * LUT_SIZE;
+         UInt32 unIndex = static_cast<UInt32>(fIndex);
+         if(unIndex >= LUT_SIZE) return m_vecRemap[LUT_SIZE];
+         Real fFrac = fIndex - unIndex;
+         return m_vecRemap[unIndex] + fFrac * (m_vecRemap[unIndex + 1] - m_vecRemap[unIndex]);
+      }
+
+      inline UInt32 GetBucket(SInt32 n_cell_u,
+                              SInt32 n_cell_v) const {
+         return ((static_cast<UInt32>(n_cell_u) * 73856093u) ^
+                 (static_cast<UInt32>(n_cell_v) * 19349663u)) & m_unBucketMask;
+      }
+
+   private:
+
+      static const UInt32 LUT_SIZE = 1024;
+
+      SParams m_sParams;
+
+      /* Shadows weaker than this are ignored */
+      Real m_fCutoff;
+      /* Squared lateral distance, in sigmas, where the Gaussian reaches the cutoff */
+      Real m_fMaxQ;
+      Real m_fGaussianScale;
+      std::vector<Real> m_vecGaussian;
+      std::vector<Real> m_vecRemap;
+
+      /* Robots in the wind frame, bucketed by cell */
+      std::vector<Real> m_vecU;
+      std::vector<Real> m_vecV;
+      std::vector<SInt32> m_vecCellU;
+      std::vector<SInt32> m_vecCellV;
+      std::vector<UInt32> m_vecBucket;
+      std::vector<UInt32> m_vecBucketStart;
+      std::vector<UInt32> m_vecSorted;
+      std::vector<Real> m_vecSortedU;
+      std::vector<Real> m_vecSortedV;
+      UInt32 m_unBucketMask;
+
+   };
+
+}
+
+#endif
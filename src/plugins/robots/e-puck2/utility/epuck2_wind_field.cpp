@@ -0,0 +1,407 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/utility/epuck2_wind_field.cpp>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#include "epuck2_wind_field.h"
+#include <argos3/core/utility/math/general.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace argos {
+
+   /****************************************/
+   /****************************************/
+
+   /* Distance of a point from a segment */
+   static Real DistanceFromSegment(const CVector2& c_point,
+                                   const CVector2& c_start,
+                                   const CVector2& c_end) {
+      CVector2 cSegment = c_end - c_start;
+      Real fLength2 = cSegment.SquareLength();
+      Real fT = 0.0;
+      if(fLength2 > 0.0) {
+         fT = (c_point - c_start).DotProduct(cSegment) / fLength2;
+         fT = std::min<Real>(1.0, std::max<Real>(0.0, fT));
+      }
+      return (c_point - (c_start + cSegment * fT)).Length();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CEPuck2WindField::CEPuck2WindField() :
+      m_bUniform(true),
+      m_bLoop(false),
+      m_fResolution(1.0),
+      m_fInvResolution(1.0),
+      m_unSizeX(0),
+      m_unSizeY(0),
+      m_unNodes(0),
+      m_unFrameKey(0),
+      m_fFrameWeight(0.0f) {
+      SetUniform(CVector2());
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2WindField::Init(TConfigurationNode& t_tree,
+                               const CVector2& c_wind) {
+      if(!NodeExists(t_tree, "wind_field")) {
+         SetUniform(c_wind);
+         return;
+      }
+      try {
+         TConfigurationNode& tField = GetNode(t_tree, "wind_field");
+         m_bLoop = false;
+         GetNodeAttributeOrDefault(tField, "loop", m_bLoop, m_bLoop);
+         std::string strFile;
+         GetNodeAttributeOrDefault(tField, "file", strFile, strFile);
+         if(!strFile.empty()) {
+            Load(strFile);
+         }
+         else {
+            Generate(tField, c_wind);
+         }
+      }
+      catch(CARGoSException& ex) {
+         THROW_ARGOSEXCEPTION_NESTED("Error initializing the wind field", ex);
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2WindField::SetUniform(const CVector2& c_wind) {
+      m_cOrigin.Set(0.0, 0.0);
+      m_fResolution = 1.0;
+      Resize(2, 2, 1);
+      std::fill(m_vecKeyX.begin(), m_vecKeyX.end(), c_wind.GetX());
+      std::fill(m_vecKeyY.begin(), m_vecKeyY.end(), c_wind.GetY());
+      Finalize();
+      m_bUniform = true;
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2WindField::Load(const std::string& str_file) {
+      std::ifstream cIn(str_file.c_str(), std::ios::binary);
+      if(!cIn) {
+         THROW_ARGOSEXCEPTION("Cannot open wind field file \"" << str_file << "\"");
+      }
+      SHeader sHeader;
+      cIn.read(reinterpret_cast<char*>(&sHeader), sizeof(sHeader));
+      if(!cIn || sHeader.Magic != FILE_MAGIC) {
+         THROW_ARGOSEXCEPTION("\"" << str_file << "\" is not a wind field file");
+      }
+      if(sHeader.Version != FILE_VERSION) {
+         THROW_ARGOSEXCEPTION("Wind field file \"" << str_file << "\" has version " << sHeader.Version
+                              << " instead of " << FILE_VERSION);
+      }
+      if(sHeader.SizeX < 2 || sHeader.SizeY < 2 || sHeader.Keyframes < 1 ||
+         sHeader.Resolution <= 0.0f) {
+         THROW_ARGOSEXCEPTION("Wind field file \"" << str_file << "\" has an invalid grid");
+      }
+      m_cOrigin.Set(sHeader.OriginX, sHeader.OriginY);
+      m_fResolution = sHeader.Resolution;
+      Resize(sHeader.SizeX, sHeader.SizeY, sHeader.Keyframes);
+      cIn.read(reinterpret_cast<char*>(m_vecTimes.data()),
+               m_vecTimes.size() * sizeof(float));
+      for(UInt32 k = 0; k < sHeader.Keyframes; ++k) {
+         cIn.read(reinterpret_cast<char*>(&m_vecKeyX[k * m_unNodes]), m_unNodes * sizeof(float));
+         cIn.read(reinterpret_cast<char*>(&m_vecKeyY[k * m_unNodes]), m_unNodes * sizeof(float));
+      }
+      if(!cIn) {
+         THROW_ARGOSEXCEPTION("Wind field file \"" << str_file << "\" is truncated");
+      }
+      Finalize();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2WindField::Save(const std::string& str_file) const {
+      std::ofstream cOut(str_file.c_str(), std::ios::binary);
+      if(!cOut) {
+         THROW_ARGOSEXCEPTION("Cannot create wind field file \"" << str_file << "\"");
+      }
+      SHeader sHeader;
+      sHeader.Magic      = FILE_MAGIC;
+      sHeader.Version    = FILE_VERSION;
+      sHeader.SizeX      = m_unSizeX;
+      sHeader.SizeY      = m_unSizeY;
+      sHeader.Keyframes  = m_vecTimes.size();
+      sHeader.OriginX    = m_cOrigin.GetX();
+      sHeader.OriginY    = m_cOrigin.GetY();
+      sHeader.Resolution = m_fResolution;
+      cOut.write(reinterpret_cast<const char*>(&sHeader), sizeof(sHeader));
+      cOut.write(reinterpret_cast<const char*>(m_vecTimes.data()),
+                 m_vecTimes.size() * sizeof(float));
+      for(UInt32 k = 0; k < m_vecTimes.size(); ++k) {
+         cOut.write(reinterpret_cast<const char*>(&m_vecKeyX[k * m_unNodes]), m_unNodes * sizeof(float));
+         cOut.write(reinterpret_cast<const char*>(&m_vecKeyY[k * m_unNodes]), m_unNodes * sizeof(float));
+      }
+      if(!cOut) {
+         THROW_ARGOSEXCEPTION("Error writing wind field file \"" << str_file << "\"");
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2WindField::SetTime(Real f_time) {
+      UInt32 unKeyframes = m_vecTimes.size();
+      if(unKeyframes < 2) {
+         return;
+      }
+      /* Bring the time within the keyframes */
+      Real fStart = m_vecTimes.front();
+      Real fEnd = m_vecTimes.back();
+      if(m_bLoop && fEnd > fStart) {
+         f_time = fStart + std::fmod(f_time - fStart, fEnd - fStart);
+         if(f_time < fStart) f_time += fEnd - fStart;
+      }
+      f_time = std::min(fEnd, std::max(fStart, f_time));
+      /* Find the keyframes around the time */
+      UInt32 unKey = std::upper_bound(m_vecTimes.begin(), m_vecTimes.end(), f_time) - m_vecTimes.begin();
+      unKey = std::min(unKeyframes - 1, std::max<UInt32>(1, unKey)) - 1;
+      Real fSpan = m_vecTimes[unKey + 1] - m_vecTimes[unKey];
+      float fWeight = (fSpan > 0.0) ? (f_time - m_vecTimes[unKey]) / fSpan : 0.0;
+      if(unKey == m_unFrameKey && fWeight == m_fFrameWeight) {
+         return;
+      }
+      m_unFrameKey = unKey;
+      m_fFrameWeight = fWeight;
+      /* Blend the two keyframes */
+      const float* pfX0 = &m_vecKeyX[unKey * m_unNodes];
+      const float* pfY0 = &m_vecKeyY[unKey * m_unNodes];
+      const float* pfX1 = pfX0 + m_unNodes;
+      const float* pfY1 = pfY0 + m_unNodes;
+      float* pfX = m_vecFrameX.data();
+      float* pfY = m_vecFrameY.data();
+      for(UInt32 i = 0; i < m_unNodes; ++i) {
+         pfX[i] = pfX0[i] + fWeight * (pfX1[i] - pfX0[i]);
+         pfY[i] = pfY0[i] + fWeight * (pfY1[i] - pfY0[i]);
+      }
+      UpdateMean();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2WindField::UpdateMean() {
+      Real fSumX = 0.0, fSumY = 0.0;
+      for(UInt32 i = 0; i < m_unNodes; ++i) {
+         fSumX += m_vecFrameX[i];
+         fSumY += m_vecFrameY[i];
+      }
+      m_cMean.Set(fSumX / m_unNodes, fSumY / m_unNodes);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   CVector2 CEPuck2WindField::Sample(Real f_x,
+                                     Real f_y) const {
+      Real fWindX, fWindY;
+      Sample(&f_x, &f_y, 1, &fWindX, &fWindY);
+      return CVector2(fWindX, fWindY);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2WindField::Sample(const Real* pf_x,
+                                 const Real* pf_y,
+                                 size_t un_points,
+                                 Real* pf_wind_x,
+                                 Real* pf_wind_y) const {
+      if(m_bUniform) {
+         std::fill(pf_wind_x, pf_wind_x + un_points, m_cMean.GetX());
+         std::fill(pf_wind_y, pf_wind_y + un_points, m_cMean.GetY());
+         return;
+      }
+      Real fMaxX = m_unSizeX - 1;
+      Real fMaxY = m_unSizeY - 1;
+      const float* pfX = m_vecFrameX.data();
+      const float* pfY = m_vecFrameY.data();
+      for(size_t i = 0; i < un_points; ++i) {
+         /* Grid coordinates, clamped to the border */
+         Real fGX = std::min(fMaxX, std::max<Real>(0.0, (pf_x[i] - m_cOrigin.GetX()) * m_fInvResolution));
+         Real fGY = std::min(fMaxY, std::max<Real>(0.0, (pf_y[i] - m_cOrigin.GetY()) * m_fInvResolution));
+         UInt32 unX = std::min<UInt32>(fGX, m_unSizeX - 2);
+         UInt32 unY = std::min<UInt32>(fGY, m_unSizeY - 2);
+         Real fTX = fGX - unX;
+         Real fTY = fGY - unY;
+         UInt32 unNode = unY * m_unSizeX + unX;
+         Real fW00 = (1.0 - fTX) * (1.0 - fTY);
+         Real fW10 = fTX * (1.0 - fTY);
+         Real fW01 = (1.0 - fTX) * fTY;
+         Real fW11 = fTX * fTY;
+         pf_wind_x[i] =
+            fW00 * pfX[unNode]     + fW10 * pfX[unNode + 1] +
+            fW01 * pfX[unNode + m_unSizeX] + fW11 * pfX[unNode + m_unSizeX + 1];
+         pf_wind_y[i] =
+            fW00 * pfY[unNode]     + fW10 * pfY[unNode + 1] +
+            fW01 * pfY[unNode + m_unSizeX] + fW11 * pfY[unNode + m_unSizeX + 1];
+      }
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2WindField::Generate(TConfigurationNode& t_tree,
+                                   const CVector2& c_wind) {
+      /* Grid */
+      CVector2 cSize;
+      GetNodeAttribute(t_tree, "origin", m_cOrigin);
+      GetNodeAttribute(t_tree, "size", cSize);
+      m_fResolution = 0.1;
+      GetNodeAttributeOrDefault(t_tree, "resolution", m_fResolution, m_fResolution);
+      if(m_fResolution <= 0.0 || cSize.GetX() <= 0.0 || cSize.GetY() <= 0.0) {
+         THROW_ARGOSEXCEPTION("The size and the resolution of the wind field must be positive");
+      }
+      m_fInvResolution = 1.0 / m_fResolution;
+      UInt32 unKeyframes = 1;
+      Real fDuration = 0.0;
+      GetNodeAttributeOrDefault(t_tree, "keyframes", unKeyframes, unKeyframes);
+      if(unKeyframes > 1) {
+         GetNodeAttribute(t_tree, "duration", fDuration);
+         if(fDuration <= 0.0) {
+            THROW_ARGOSEXCEPTION("The duration of the wind field must be positive");
+         }
+      }
+      Resize(static_cast<UInt32>(std::floor(cSize.GetX() / m_fResolution + 0.5)) + 1,
+             static_cast<UInt32>(std::floor(cSize.GetY() / m_fResolution + 0.5)) + 1,
+             std::max<UInt32>(1, unKeyframes));
+      /* Spatial features do not change in time */
+      CVector2 cDirection = c_wind;
+      if(cDirection.SquareLength() > 0.0) cDirection.Normalize();
+      std::vector<Real> vecScale(m_unNodes, 1.0);
+      TConfigurationNodeIterator itCorridor("corridor");
+      for(itCorridor = itCorridor.begin(&t_tree);
+          itCorridor != itCorridor.end();
+          ++itCorridor) {
+         CVector2 cStart, cEnd;
+         Real fWidth, fFactor;
+         GetNodeAttribute(*itCorridor, "start", cStart);
+         GetNodeAttribute(*itCorridor, "end", cEnd);
+         GetNodeAttribute(*itCorridor, "width", fWidth);
+         GetNodeAttribute(*itCorridor, "factor", fFactor);
+         Real fHalf = fWidth * 0.5;
+         for(UInt32 j = 0; j < m_unSizeY; ++j) {
+            for(UInt32 i = 0; i < m_unSizeX; ++i) {
+               CVector2 cNode = m_cOrigin + CVector2(i * m_fResolution, j * m_fResolution);
+               Real fDistance = DistanceFromSegment(cNode, cStart, cEnd);
+               /* Full factor inside, back to 1 over one cell */
+               Real fEdge = std::min<Real>(1.0, std::max<Real>(0.0, (fDistance - fHalf) * m_fInvResolution));
+               vecScale[j * m_unSizeX + i] *= fFactor + (1.0 - fFactor) * fEdge;
+            }
+         }
+      }
+      TConfigurationNodeIterator itLee("lee");
+      for(itLee = itLee.begin(&t_tree);
+          itLee != itLee.end();
+          ++itLee) {
+         CVector2 cCenter;
+         Real fRadius, fLength, fFactor;
+         GetNodeAttribute(*itLee, "center", cCenter);
+         GetNodeAttribute(*itLee, "radius", fRadius);
+         GetNodeAttribute(*itLee, "length", fLength);
+         GetNodeAttribute(*itLee, "factor", fFactor);
+         if(fLength <= 0.0) {
+            THROW_ARGOSEXCEPTION("The length of a lee must be positive");
+         }
+         for(UInt32 j = 0; j < m_unSizeY; ++j) {
+            for(UInt32 i = 0; i < m_unSizeX; ++i) {
+               CVector2 cOffset = m_cOrigin + CVector2(i * m_fResolution, j * m_fResolution) - cCenter;
+               Real fAlong = cOffset.DotProduct(cDirection);
+               Real fLateral = (cOffset - cDirection * fAlong).Length();
+               Real fScale = 1.0;
+               if(cOffset.Length() <= fRadius) {
+                  fScale = fFactor;
+               }
+               else if(fAlong > 0.0 && fAlong < fLength && fLateral < fRadius) {
+                  /* The wind recovers linearly behind the obstacle */
+                  fScale = fFactor + (1.0 - fFactor) * fAlong / fLength;
+               }
+               vecScale[j * m_unSizeX + i] *= fScale;
+            }
+         }
+      }
+      /* Gusts scale the whole field in time */
+      std::vector<Real> vecAmplitudes, vecPeriods;
+      TConfigurationNodeIterator itGust("gust");
+      for(itGust = itGust.begin(&t_tree);
+          itGust != itGust.end();
+          ++itGust) {
+         Real fAmplitude, fPeriod;
+         GetNodeAttribute(*itGust, "amplitude", fAmplitude);
+         GetNodeAttribute(*itGust, "period", fPeriod);
+         if(fPeriod <= 0.0) {
+            THROW_ARGOSEXCEPTION("The period of a gust must be positive");
+         }
+         vecAmplitudes.push_back(fAmplitude);
+         vecPeriods.push_back(fPeriod);
+      }
+      for(UInt32 k = 0; k < m_vecTimes.size(); ++k) {
+         m_vecTimes[k] = (m_vecTimes.size() > 1) ? fDuration * k / (m_vecTimes.size() - 1) : 0.0;
+         Real fGust = 1.0;
+         for(size_t g = 0; g < vecAmplitudes.size(); ++g) {
+            fGust *= 1.0 + vecAmplitudes[g] * std::sin(2.0 * ARGOS_PI * m_vecTimes[k] / vecPeriods[g]);
+         }
+         float* pfX = &m_vecKeyX[k * m_unNodes];
+         float* pfY = &m_vecKeyY[k * m_unNodes];
+         for(UInt32 i = 0; i < m_unNodes; ++i) {
+            pfX[i] = c_wind.GetX() * fGust * vecScale[i];
+            pfY[i] = c_wind.GetY() * fGust * vecScale[i];
+         }
+      }
+      Finalize();
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2WindField::Resize(UInt32 un_size_x,
+                                 UInt32 un_size_y,
+                                 UInt32 un_keyframes) {
+      m_unSizeX = un_size_x;
+      m_unSizeY = un_size_y;
+      m_unNodes = un_size_x * un_size_y;
+      m_vecTimes.assign(un_keyframes, 0.0f);
+      m_vecKeyX.assign(un_keyframes * m_unNodes, 0.0f);
+      m_vecKeyY.assign(un_keyframes * m_unNodes, 0.0f);
+      m_vecFrameX.assign(m_unNodes, 0.0f);
+      m_vecFrameY.assign(m_unNodes, 0.0f);
+   }
+
+   /****************************************/
+   /****************************************/
+
+   void CEPuck2WindField::Finalize() {
+      for(UInt32 k = 1; k < m_vecTimes.size(); ++k) {
+         if(m_vecTimes[k] <= m_vecTimes[k - 1]) {
+            THROW_ARGOSEXCEPTION("The times of the wind field keyframes must increase");
+         }
+      }
+      m_bUniform = false;
+      m_fInvResolution = 1.0 / m_fResolution;
+      /* Start from the first keyframe */
+      std::copy(m_vecKeyX.begin(), m_vecKeyX.begin() + m_unNodes, m_vecFrameX.begin());
+      std::copy(m_vecKeyY.begin(), m_vecKeyY.begin() + m_unNodes, m_vecFrameY.begin());
+      m_unFrameKey = 0;
+      m_fFrameWeight = 0.0f;
+      UpdateMean();
+   }
+
+   /****************************************/
+   /****************************************/
+
+}
@@ -0,0 +1,223 @@
+/**
+ * @file <argos3/plugins/robots/e-puck2/utility/epuck2_wind_field.h>
+ *
+ * @author Daniel H. Stolfi based on the Carlo Pinciroli's work
+ *
+ * ADARS project -- PCOG / SnT / University of Luxembourg
+ */
+
+#ifndef EPUCK2_WIND_FIELD_H
+#define EPUCK2_WIND_FIELD_H
+
+namespace argos {
+   class CEPuck2WindField;
+}
+
+#include <argos3/core/utility/configuration/argos_configuration.h>
+#include <argos3/core/utility/math/vector2.h>
+#include <string>
+#include <vector>
+
+namespace argos {
+
+   /**
+    * A wind field that changes in space and time.
+    * <p>
+    * The wind is given on a regular grid at a number of keyframes. Between
+    * keyframes it is interpolated linearly, and within a keyframe it is
+    * interpolated bilinearly. SetTime() blends the two keyframes around the
+    * current time into one frame, once per step, so sampling a robot only
+    * costs a bilinear lookup. The components are kept in separate arrays,
+    * which lets the compiler vectorize the blending.
+    * </p>
+    * <p>
+    * The field is configured inside the <air_resistance> node. Without a
+    * <wind_field> child, the wind is uniform:
+    * </p>
+    * <pre>
+    *   <air_resistance angle_deg="0" magnitude="10.0">
+    *     <wind_field file="wind.bin" loop="true" />
+    *   </air_resistance>
+    * </pre>
+    * <p>
+    * or it is generated from the uniform wind and a list of features:
+    * </p>
+    * <pre>
+    *   <air_resistance angle_deg="0" magnitude="10.0">
+    *     <wind_field origin="-2,-2" size="4,4" resolution="0.1"
+    *                 keyframes="16" duration="60" loop="true">
+    *       <gust amplitude="0.5" period="20" />
+    *       <corridor start="-2,0" end="2,0" width="0.5" factor="2" />
+    *       <lee center="0.5,0.5" radius="0.2" length="1" factor="0.2" />
+    *     </wind_field>
+    *   </air_resistance>
+    * </pre>
+    * <p>
+    * A gust scales the wind by 1 + amplitude * sin(2 pi t / period). A
+    * corridor scales the wind within a band around a segment. A lee is the
+    * calm zone downwind of a round obstacle: the wind is scaled by 'factor'
+    * behind the obstacle and recovers linearly over 'length'.
+    * </p>
+    * <p>
+    * A grid file is little-endian: the header, the keyframe times, and then
+    * for each keyframe the X and the Y components of all the nodes, row by
+    * row, as 32-bit floats. Wind values are in cm/s.
+    * </p>
+    */
+   class CEPuck2WindField {
+
+   public:
+
+      /**
+       * The header of a grid file.
+       */
+      struct SHeader {
+         /** Must be FILE_MAGIC */
+         UInt32 Magic;
+         /** Must be FILE_VERSION */
+         UInt32 Version;
+         /** Number of nodes along X and Y */
+         UInt32 SizeX, SizeY;
+         /** Number of keyframes */
+         UInt32 Keyframes;
+         /** Position of the first node */
+         float OriginX, OriginY;
+         /** Distance between nodes */
+         float Resolution;
+      };
+
+      static const UInt32 FILE_MAGIC   = 0x46573245; // "E2WF"
+      static const UInt32 FILE_VERSION = 1;
+
+   public:
+
+      CEPuck2WindField();
+
+      /**
+       * Configures the field from an <air_resistance> node.
+       * @param t_tree The <air_resistance> node.
+       * @param c_wind The uniform wind, in cm/s.
+       */
+      void Init(TConfigurationNode& t_tree,
+                const CVector2& c_wind);
+
+      /**
+       * Makes the field uniform.
+       */
+      void SetUniform(const CVector2& c_wind);
+
+      /**
+       * Loads a grid file.
+       */
+      void Load(const std::string& str_file);
+
+      /**
+       * Saves the field to a grid file.
+       */
+      void Save(const std::string& str_file) const;
+
+      /**
+       * Blends the keyframes for the given time, in seconds.
+       */
+      void SetTime(Real f_time);
+
+      /**
+       * Returns true if the wind is the same everywhere and at all times.
+       */
+      inline bool IsUniform() const {
+         return m_bUniform;
+      }
+
+      /**
+       * Returns the wind at a point, at the current time.
+       */
+      CVector2 Sample(Real f_x,
+                      Real f_y) const;
+
+      /**
+       * Returns the wind at many points, at the current time.
+       */
+      void Sample(const Real* pf_x,
+                  const Real* pf_y,
+                  size_t un_points,
+                  Real* pf_wind_x,
+                  Real* pf_wind_y) const;
+
+      /**
+       * Returns the mean wind at the current time.
+       */
+      inline const CVector2& GetMean() const {
+         return m_cMean;
+      }
+
+      inline UInt32 GetSizeX() const {
+         return m_unSizeX;
+      }
+
+      inline UInt32 GetSizeY() const {
+         return m_unSizeY;
+      }
+
+      inline const CVector2& GetOrigin() const {
+         return m_cOrigin;
+      }
+
+      inline Real GetResolution() const {
+         return m_fResolution;
+      }
+
+      /**
+       * Returns the wind at a node, at the current time.
+       */
+      inline CVector2 GetNodeWind(UInt32 un_x,
+                                  UInt32 un_y) const {
+         UInt32 unNode = un_y * m_unSizeX + un_x;
+         return CVector2(m_vecFrameX[unNode], m_vecFrameY[unNode]);
+      }
+
+   private:
+
+      /** Generates the keyframes from the features of a <wind_field> node */
+      void Generate(TConfigurationNode& t_tree,
+                    const CVector2& c_wind);
+
+      /** Allocates the keyframes */
+      void Resize(UInt32 un_size_x,
+                  UInt32 un_size_y,
+                  UInt32 un_keyframes);
+
+      /** Checks the keyframes and prepares the first frame */
+      void Finalize();
+
+      /** Averages the current frame */
+      void UpdateMean();
+
+   private:
+
+      bool m_bUniform;
+      bool m_bLoop;
+      CVector2 m_cOrigin;
+      Real m_fResolution;
+      Real m_fInvResolution;
+      UInt32 m_unSizeX;
+      UInt32 m_unSizeY;
+      UInt32 m_unNodes;
+
+      /* Keyframe times, and the components of all keyframes back to back */
+      std::vector<float> m_vecTimes;
+      std::vector<float> m_vecKeyX;
+      std::vector<float> m_vecKeyY;
+
+      /* The current frame */
+      std::vector<float> m_vecFrameX;
+      std::vector<float> m_vecFrameY;
+      CVector2 m_cMean;
+      /* Keyframe pair and weight of the current frame */
+      UInt32 m_unFrameKey;
+      float m_fFrameWeight;
+
+   };
+
+}
+
+#endif